@@ -18,6 +18,7 @@
 #include "p2p_packet_stream_arduino.h"
 #include "p2p_action_server.h"
 #include "sync_time_action_handler.h"
+#include "ping_action_handler.h"
 #include "set_head_pose_action_handler.h"
 #include "set_base_velocity_action_handler.h"
 #include "monitor_base_state_action_handler.h"
@@ -34,18 +35,40 @@
 #include "create_head_mixed_trajectory_view_action_handler.h"
 #include "execute_base_trajectory_view_action_handler.h"
 #include "execute_head_trajectory_view_action_handler.h"
+#include "set_base_state_filter_action_handler.h"
+#include "record_base_state_events_action_handler.h"
+#include "get_periodic_runnable_stats_action_handler.h"
+#include "get_profiler_sections_action_handler.h"
+#include "get_ring_buffer_stats_action_handler.h"
+#include "profiler.h"
+#include "primitives_benchmarks.h"
+#include "i2c_bus_kinetis.h"
+#include "scheduler.h"
+#include "deferred_logger.h"
+#include "stream_logs_action_handler.h"
 
 // Maximum time during which communication can be processed without
 // yielding time to other tasks.
 // This should be the minium period of all control loops.
 #define kMaxRxTxLoopBlockingDurationNs 5'000'000
 
+// Writing a log message to the USB serial port takes ~100us.
+#define kLogDrainBudgetNs 500'000
+
+// Set to 1 to print the cycle counts of the P2P link primitives to the debug serial port at
+// startup (see primitives_benchmarks.h).
+#ifndef kRunPrimitivesBenchmarks
+#define kRunPrimitivesBenchmarks 0
+#endif
+#define kPrimitivesBenchmarkCalls 1000
+
 Logger logger;
 
 P2PByteStreamArduino byte_stream(&Serial1);
 TimerArduino timer;
 GUIDFactory guid_factory;
 P2PPacketStreamArduino p2p_stream(&byte_stream, &timer, guid_factory);
+DeferredLogger deferred_logger(&timer, &logger);
 
 WheelStateEstimator wheel_state_estimator("WheelStateEstimator");
 WheelSpeedController left_wheel("LeftWheelSpeedController", &wheel_state_estimator.left_wheel_state_filter(), &SetLeftMotorDutyCycle);
@@ -55,11 +78,14 @@ BaseTrajectoryController base_trajectory_controller("BaseTrajectoryController",
 HeadTrajectoryController head_trajectory_controller("HeadTrajectoryController");
 
 TrajectoryStore trajectory_store;
+I2CBusKinetis imu_bus;
 
 P2PActionServer p2p_action_server(&p2p_stream);
+Scheduler scheduler;
 SetHeadPoseActionHandler set_head_pose_action_handler(&p2p_stream);
 SetBaseVelocityActionHandler set_base_velocity_action_handler(&p2p_stream, &base_speed_controller);
 SyncTimeActionHandler sync_time_action_handler(&p2p_stream, &timer);
+PingActionHandler ping_action_handler(&p2p_stream, &timer);
 MonitorBaseStateActionHandler monitor_base_state_action_handler(&p2p_stream, &timer);
 CreateBaseTrajectoryActionHandler create_base_trajectory_action_handler(&p2p_stream, &trajectory_store);
 CreateHeadTrajectoryActionHandler create_head_trajectory_action_handler(&p2p_stream, &trajectory_store);
@@ -73,6 +99,54 @@ CreateBaseMixedTrajectoryViewActionHandler create_base_mixed_trajectory_view_act
 CreateHeadMixedTrajectoryViewActionHandler create_head_mixed_trajectory_view_action_handler(&p2p_stream, &trajectory_store);
 ExecuteBaseTrajectoryViewActionHandler execute_base_trajectory_view_action_handler(&p2p_stream, &trajectory_store, &base_trajectory_controller);
 ExecuteHeadTrajectoryViewActionHandler execute_head_trajectory_view_action_handler(&p2p_stream, &trajectory_store, &head_trajectory_controller);
+SetBaseStateFilterActionHandler set_base_state_filter_action_handler(&p2p_stream);
+BaseStateEventRecorder base_state_event_recorder;
+RecordBaseStateEventsActionHandler record_base_state_events_action_handler(&p2p_stream, &base_state_event_recorder);
+PeriodicRunnable *const instrumented_runnables[] = { &wheel_state_estimator, &left_wheel, &right_wheel, &base_trajectory_controller, &head_trajectory_controller };
+GetPeriodicRunnableStatsActionHandler get_periodic_runnable_stats_action_handler(&p2p_stream, instrumented_runnables, sizeof(instrumented_runnables) / sizeof(instrumented_runnables[0]));
+GetProfilerSectionsActionHandler get_profiler_sections_action_handler(&p2p_stream);
+GetRingBufferStatsActionHandler get_ring_buffer_stats_action_handler(&p2p_stream);
+StreamLogsActionHandler stream_logs_action_handler(&p2p_stream, &deferred_logger);
+
+static bool RunStateEstimation(void *) {
+  const bool is_imu_reading_in_progress = RunRobotStateEstimator();
+  NotifyLeftMotorDirection(GetTimerTicks(), !base_trajectory_controller.base_speed_controller().left_wheel_speed_controller().is_turning_forward());
+  NotifyRightMotorDirection(GetTimerTicks(), !base_trajectory_controller.base_speed_controller().right_wheel_speed_controller().is_turning_forward());
+  return is_imu_reading_in_progress;
+}
+
+static bool RunComms(void *) {
+  // Keep processing communications while there are bytes read
+  // or ready to send.
+  bool has_read_bytes;
+  {
+    PROFILE_SCOPE("p2p_input");
+    has_read_bytes = p2p_stream.input().Run() > 0;
+  }
+  {
+    PROFILE_SCOPE("p2p_output");
+    p2p_stream.output().Run();
+  }
+  p2p_action_server.Run();
+  return has_read_bytes || p2p_stream.output().NumCommittedPackets() > 0;
+}
+
+static bool RunLogDrain(void *) {
+  if (stream_logs_action_handler.is_streaming()) {
+    return false;  // The records go to the other end.
+  }
+  return deferred_logger.DrainToBaseLogger(/*max_records=*/1);
+}
+
+#if kRunPrimitivesBenchmarks
+static void RunPrimitivesBenchmarks() {
+  Serial.printf("%-40s %10s %10s\n", "benchmark", "cycles", "ns");
+  for (int i = 0; i < GetNumPrimitivesBenchmarks(); ++i) {
+    const float cycles = MeasurePrimitivesBenchmarkCycles(i, kPrimitivesBenchmarkCalls);
+    Serial.printf("%-40s %10.1f %10.1f\n", GetPrimitivesBenchmark(i).name, cycles, cycles * 1e9f / GetProfilerCyclesPerSecond());
+  }
+}
+#endif
 
 void setup() {
   // Open serial port before anything else, as it enables showing logs and asserts in the console.
@@ -81,12 +155,18 @@ void setup() {
   *logger.base_logger() = SetLogger(&logger);
 
   InitTimer();
+  InitProfiler();
 
   // Serial starts working after some time. Wait, so we don't miss any log.
   while(GetTimerNanoseconds() < 3000000000ULL) {}
 
   LOG_INFO("Initialized debugging serial port and timing modules.");
 
+#if kRunPrimitivesBenchmarks
+  LOG_INFO("Running primitives benchmarks...");
+  RunPrimitivesBenchmarks();
+#endif
+
   LOG_INFO("Initializing encoders...");
   InitEncoders();
   
@@ -94,7 +174,8 @@ void setup() {
   WheelStateEstimator::Init();
 
   LOG_INFO("Initializing robot state estimator...");
-  InitRobotStateEstimator();
+  InitRobotStateEstimator(&imu_bus);
+  SetBaseStateEventRecorder(&base_state_event_recorder);
 
   LOG_INFO("Initializing inter-board communications...");
   Serial1.begin(1000000, SERIAL_8N1);
@@ -106,6 +187,7 @@ void setup() {
   InitServos();
 
   LOG_INFO("Register actions in action server...");
+  p2p_action_server.Register(&ping_action_handler);
   p2p_action_server.Register(&sync_time_action_handler);
   p2p_action_server.Register(&set_head_pose_action_handler);
   p2p_action_server.Register(&set_base_velocity_action_handler);
@@ -122,34 +204,32 @@ void setup() {
   p2p_action_server.Register(&create_head_mixed_trajectory_view_action_handler);
   p2p_action_server.Register(&execute_base_trajectory_view_action_handler);
   p2p_action_server.Register(&execute_head_trajectory_view_action_handler);
+  p2p_action_server.Register(&set_base_state_filter_action_handler);
+  p2p_action_server.Register(&record_base_state_events_action_handler);
+  p2p_action_server.Register(&get_periodic_runnable_stats_action_handler);
+  p2p_action_server.Register(&get_profiler_sections_action_handler);
+  p2p_action_server.Register(&get_ring_buffer_stats_action_handler);
+  p2p_action_server.Register(&stream_logs_action_handler);
 
   LOG_INFO("Ready.");
 
+  // From now on, log messages are formatted and written outside of the control loops.
+  SetLogger(&deferred_logger);
+
   left_wheel.Start();
   right_wheel.Start();
+
+  scheduler.AddPeriodicTask(&wheel_state_estimator);
+  scheduler.AddPeriodicTask(&head_trajectory_controller);
+  scheduler.AddPeriodicTask(&base_trajectory_controller);
+  scheduler.AddPeriodicTask(&left_wheel);
+  scheduler.AddPeriodicTask(&right_wheel);
+  // The controllers act on the base state estimated right before them.
+  scheduler.AddInputTask(&RunStateEstimation, nullptr);
+  scheduler.AddBackgroundTask(&RunComms, nullptr, kMaxRxTxLoopBlockingDurationNs);
+  scheduler.AddBackgroundTask(&RunLogDrain, nullptr, kLogDrainBudgetNs);
 }
 
 void loop() {
-  wheel_state_estimator.Run();
-  RunRobotStateEstimator();
-
-  head_trajectory_controller.Run();
-  base_trajectory_controller.Run();
-  NotifyLeftMotorDirection(GetTimerTicks(), !base_trajectory_controller.base_speed_controller().left_wheel_speed_controller().is_turning_forward());
-  NotifyRightMotorDirection(GetTimerTicks(), !base_trajectory_controller.base_speed_controller().right_wheel_speed_controller().is_turning_forward());
-  left_wheel.Run();
-  right_wheel.Run();
-  
-  bool process_comms = true;
-  const auto process_comms_start_time_ns = timer.GetLocalNanoseconds();
-  while(process_comms) {
-    // Keep processing communications while there are bytes read
-    // or ready to send.
-    process_comms = p2p_stream.input().Run() > 0;
-    p2p_stream.output().Run();
-    p2p_action_server.Run();
-    process_comms = process_comms || p2p_stream.output().NumCommittedPackets() > 0;
-    // If processing for too long, yield time to other tasks.
-    process_comms = process_comms && (timer.GetLocalNanoseconds() - process_comms_start_time_ns > kMaxRxTxLoopBlockingDurationNs);
-  }
+  scheduler.RunOnce();
 }
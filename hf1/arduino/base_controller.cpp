@@ -5,6 +5,7 @@
 #include "logger_interface.h"
 #include "robot_model.h"
 #include "robot_state_estimator.h"
+#include "profiler.h"
 
 #define kBaseStateControllerLoopPeriod 0.33  // [s]
 #define kBaseTrajectoryControllerLoopPeriod 0.03 // [s]
@@ -91,10 +92,10 @@ void BaseStateController::Update(TimerSecondsType now_seconds) {
 
   // Calculate commands for the base's speed controller from errors and reference speed.
   float linear_speed_command = reference_forward_speed_ * cos(yaw_error) + kKx * forward_error;
-  linear_speed_command = std::clamp(linear_speed_command, -0.4, 0.4);
+  linear_speed_command = std::clamp(linear_speed_command, -0.4f, 0.4f);
   // Reference angular speed is assumed to be 0.
   float angular_speed_command = reference_forward_speed_ * (kKy * lateral_error + kKyaw * sin(yaw_error));
-  angular_speed_command = std::clamp(angular_speed_command, -0.8, 0.8);
+  angular_speed_command = std::clamp(angular_speed_command, -0.8f, 0.8f);
   // Serial.printf("%f * (%f * %f + %f * sin(%f))\n", reference_forward_speed_, kKy, lateral_error, kKyaw, yaw_error);
   // Serial.printf("fw_error:%f lat_error:%f yaw_error:%f fw_cmd:%f ang_cmd:%f\n", forward_error, lateral_error, yaw_error, linear_speed_command, angular_speed_command);
   base_speed_controller_.SetTargetSpeeds(linear_speed_command, angular_speed_command);
@@ -116,9 +117,15 @@ bool BaseStateController::IsAtTargetState() const {
 
 BaseTrajectoryController::BaseTrajectoryController(const char *name, BaseSpeedController *base_speed_controller) : 
   TrajectoryController<BaseTargetState>(name, static_cast<TimerSecondsType>(kBaseTrajectoryControllerLoopPeriod)), 
-  base_speed_controller_(*ASSERT_NOT_NULL(base_speed_controller)) {}
+  base_speed_controller_(*ASSERT_NOT_NULL(base_speed_controller)),
+  gains_(DefaultGains()) {}
+
+BaseTrajectoryController::Gains BaseTrajectoryController::DefaultGains() {
+  return Gains{ .k1 = kBaseTrajectoryControllerK1, .k2 = kBaseTrajectoryControllerK2, .k3 = kBaseTrajectoryControllerK3 };
+}
 
 void BaseTrajectoryController::Update(TimerSecondsType seconds_since_start) {
+  PROFILE_SCOPE("base_traj_ctrl");
   TrajectoryController<BaseTargetState>::Update(seconds_since_start);
   if (!is_started()) { return; }
 
@@ -150,14 +157,14 @@ void BaseTrajectoryController::Update(TimerSecondsType seconds_since_start) {
   }
 
   // Get feedback commands.
-  const float feedback_tangential_command = kBaseTrajectoryControllerK1 * forward_error;
-  const float feedback_angular_command = kBaseTrajectoryControllerK2 * lateral_error + kBaseTrajectoryControllerK3 * yaw_error;
+  const float feedback_tangential_command = gains_.k1 * forward_error;
+  const float feedback_angular_command = gains_.k2 * lateral_error + gains_.k3 * yaw_error;
 
   // Get velocity commands.
   const float tangential_command = feedforward_tangential_command + feedback_tangential_command;
   const float angular_command = feedforward_angular_command + feedback_angular_command;
-  const float tangential_command_limitted = std::clamp(tangential_command, -kBaseTrajectoryTangentialSpeedMax, kBaseTrajectoryTangentialSpeedMax);
-  const float angular_command_limitted = std::clamp(angular_command, -kBaseTrajectoryAngularSpeedMax, kBaseTrajectoryAngularSpeedMax);
+  const float tangential_command_limitted = std::clamp<float>(tangential_command, -kBaseTrajectoryTangentialSpeedMax, kBaseTrajectoryTangentialSpeedMax);
+  const float angular_command_limitted = std::clamp<float>(angular_command, -kBaseTrajectoryAngularSpeedMax, kBaseTrajectoryAngularSpeedMax);
 
   base_speed_controller_.SetTargetSpeeds(tangential_command_limitted, angular_command_limitted);
 }
@@ -90,17 +90,30 @@ private:
 // robot will skip to the next one.
 class BaseTrajectoryController : public TrajectoryController<BaseTargetState> {
 public:
+  typedef struct {
+    // Feedback gains of the forward error, and of the lateral and yaw errors.
+    float k1;
+    float k2;
+    float k3;
+  } Gains;
+
   BaseTrajectoryController(const char *name, BaseSpeedController *base_speed_controller);
 
   // Returns the underlying base speed controller.
   const BaseSpeedController &base_speed_controller() const { return base_speed_controller_; }
 
+  // The defaults are tuned on the robot. Other gains are meant for tuning in simulation.
+  static Gains DefaultGains();
+  const Gains &gains() const { return gains_; }
+  void gains(const Gains &gains) { gains_ = gains; }
+
 protected:
   virtual void Update(TimerSecondsType seconds_since_start) override;
   virtual void StopControl() override;
 
 private:
   BaseSpeedController &base_speed_controller_;
+  Gains gains_;
 };
 
 #endif  // ROBOT_SPEED_CONTROLLER_
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "base_state_event_recorder.h"
+
+BaseStateEventRecorder::BaseStateEventRecorder()
+  : is_recording_(false), num_dropped_events_(0), last_wheel_direction_{-1, -1} {}
+
+void BaseStateEventRecorder::Start() {
+  events_.Clear();
+  num_dropped_events_ = 0;
+  last_wheel_direction_[0] = last_wheel_direction_[1] = -1;
+  is_recording_ = true;
+}
+
+void BaseStateEventRecorder::Stop() {
+  is_recording_ = false;
+}
+
+void BaseStateEventRecorder::Record(const Event *events, int num_events) {
+  if (!is_recording_) { return; }
+  for (int i = 0; i < num_events; ++i) {
+    const Event &event = events[i];
+    if (event.type == kLeftWheelDirectionCommand || event.type == kRightWheelDirectionCommand) {
+      int &last_direction = last_wheel_direction_[event.type == kLeftWheelDirectionCommand ? 0 : 1];
+      const int direction = event.payload.wheel_direction.is_forward ? 1 : 0;
+      if (direction == last_direction) { continue; }
+      last_direction = direction;
+    }
+    if (events_.IsFull()) {
+      ++num_dropped_events_;
+      continue;
+    }
+    events_.Write(event);
+  }
+}
+
+void BaseStateEventRecorder::Flush(BaseStateEventBatchEncoder *encoder) {
+  while (events_.Size() > 0 && encoder->Append(BaseStateEventRecordFromEvent(*events_.OldestValue()))) {
+    events_.Consume();
+  }
+  encoder->num_dropped_events(num_dropped_events_);
+  num_dropped_events_ = 0;
+}
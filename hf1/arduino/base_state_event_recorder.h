@@ -0,0 +1,43 @@
+#ifndef BASE_STATE_EVENT_RECORDER_
+#define BASE_STATE_EVENT_RECORDER_
+
+#include "ring_buffer.h"
+#include "base_state_events.h"
+#include "base_state_event_codec.h"
+
+// Must hold the events registered between two progress packets of the
+// kRecordBaseStateEvents action.
+#define kBaseStateEventRecorderCapacity 64
+
+// Keeps a copy of the events consumed by the base state estimator until they are streamed.
+// Not thread-safe: Record() and Flush() must be called from the main loop.
+class BaseStateEventRecorder {
+public:
+  BaseStateEventRecorder();
+
+  // Discards any pending events and starts recording.
+  void Start();
+  void Stop();
+  bool is_recording() const { return is_recording_; }
+
+  // Copies `events` if recording. Events that do not fit are dropped and counted.
+  // Wheel direction commands are issued at every loop iteration, so only changes in direction
+  // are recorded.
+  void Record(const Event *events, int num_events);
+
+  int num_pending_events() const { return events_.Size(); }
+
+  // Moves as many of the oldest events as fit to `encoder`, along with the number of events
+  // dropped since the last flush.
+  void Flush(BaseStateEventBatchEncoder *encoder);
+
+private:
+  bool is_recording_;
+  RingBuffer<Event, kBaseStateEventRecorderCapacity> events_;
+  int num_dropped_events_;
+  // Last recorded direction of the left and right wheels: -1 if unknown, 1 if forward,
+  // 0 otherwise.
+  int last_wheel_direction_[2];
+};
+
+#endif  // BASE_STATE_EVENT_RECORDER_
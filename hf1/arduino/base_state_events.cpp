@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include "base_state_events.h"
+
+// Event types map one to one to the recorded ones.
+static_assert(static_cast<int>(kLeftWheelTick) == kBaseStateEventLeftWheelTick &&
+              static_cast<int>(kRightWheelTick) == kBaseStateEventRightWheelTick &&
+              static_cast<int>(kLeftWheelDirectionCommand) == kBaseStateEventLeftWheelDirection &&
+              static_cast<int>(kRightWheelDirectionCommand) == kBaseStateEventRightWheelDirection &&
+              static_cast<int>(kIMUReading) == kBaseStateEventIMUReading, "EventType does not match P2PBaseStateEventType.");
+
+static int CompareEventPointers(const void *p1, const void *p2) {
+  const Event * const e1 = *reinterpret_cast<const Event * const *>(p1);
+  const Event * const e2 = *reinterpret_cast<const Event * const *>(p2);
+  // Do not just subtract, as the timestamp may be of unsigned type.
+  return e1->timer_ticks < e2->timer_ticks ? -1 : (e1->timer_ticks > e2->timer_ticks ? 1 : 0);
+}
+
+void NotifyBaseStateEvents(Event *events, int num_events, BaseStateFilterInterface *filter) {
+  // Sort event order to process chronologically.
+  Event *event_pointers[num_events];
+  for (int i = 0; i < num_events; ++i) { event_pointers[i] = &events[i]; }
+  qsort(event_pointers, num_events, sizeof(event_pointers[0]), CompareEventPointers);
+
+  // Process events in chronological order.
+  // Serial.println("--- Processing events ---");
+  for (int i = 0; i < num_events; ++i) {
+    const Event &event = *event_pointers[i];
+    // char str[32];
+    // Uint64ToString(event.timer_ticks, str);
+    // Serial.printf("ts:%s\n", str);
+    switch (event.type) {
+      case kLeftWheelTick:
+        // Serial.printf("left wheel tick\n");
+        if (i == num_events - 1 || event_pointers[i + 1]->type != kRightWheelTick || event_pointers[i + 1]->timer_ticks != event.timer_ticks) {
+          filter->NotifyWheelTicks(event.timer_ticks, 1, 0);
+        } else {
+          // There is a tick from the other wheel at the exact same time.
+          filter->NotifyWheelTicks(event.timer_ticks, 1, 1);
+          ++i;  // The next event has been processed.
+        }
+        break;
+      case kRightWheelTick:
+        // Serial.printf("right wheel tick\n");
+        if (i == num_events - 1 || event_pointers[i + 1]->type != kLeftWheelTick || event_pointers[i + 1]->timer_ticks != event.timer_ticks) {
+          filter->NotifyWheelTicks(event.timer_ticks, 0, 1);
+        } else {
+          // There is a tick from the other wheel at the exact same time.
+          filter->NotifyWheelTicks(event.timer_ticks, 1, 1);
+          ++i;  // The next event has been processed.
+        }
+        break;
+      case kLeftWheelDirectionCommand:
+        // Serial.printf("left wheel direction command\n");
+        filter->NotifyLeftWheelDirection(event.payload.wheel_direction.is_forward);
+        break;
+      case kRightWheelDirectionCommand:
+        // Serial.printf("left wheel direction command\n");
+        filter->NotifyRightWheelDirection(event.payload.wheel_direction.is_forward);
+        break;
+      case kIMUReading:
+        // Serial.printf("IMU reading\n");
+        // Serial.printf("imu_ax:%f imu_ay:%f imu_a:%f\n", event.payload.imu.position_acceleration[0], event.payload.imu.position_acceleration[1], event.payload.imu.attitude[2]);
+        filter->NotifyIMUReading(event.timer_ticks, event.payload.imu.position_acceleration[0], event.payload.imu.position_acceleration[1], event.payload.imu.attitude[2]);
+        break;
+    }
+  }
+}
+
+BaseStateEventRecord BaseStateEventRecordFromEvent(const Event &event) {
+  BaseStateEventRecord record = {};
+  record.type = static_cast<P2PBaseStateEventType>(event.type);
+  record.timer_ticks = event.timer_ticks;
+  switch (event.type) {
+    case kLeftWheelDirectionCommand:
+    case kRightWheelDirectionCommand:
+      record.is_forward = event.payload.wheel_direction.is_forward;
+      break;
+    case kIMUReading:
+      memcpy(record.position_acceleration, event.payload.imu.position_acceleration, sizeof(record.position_acceleration));
+      memcpy(record.attitude, event.payload.imu.attitude, sizeof(record.attitude));
+      break;
+    default:
+      break;
+  }
+  return record;
+}
+
+Event EventFromBaseStateEventRecord(const BaseStateEventRecord &record) {
+  Event event = {};
+  event.type = static_cast<EventType>(record.type);
+  event.timer_ticks = record.timer_ticks;
+  switch (event.type) {
+    case kLeftWheelDirectionCommand:
+    case kRightWheelDirectionCommand:
+      event.payload.wheel_direction.is_forward = record.is_forward;
+      break;
+    case kIMUReading:
+      memcpy(event.payload.imu.position_acceleration, record.position_acceleration, sizeof(record.position_acceleration));
+      memcpy(event.payload.imu.attitude, record.attitude, sizeof(record.attitude));
+      break;
+    default:
+      break;
+  }
+  return event;
+}
@@ -0,0 +1,40 @@
+#ifndef BASE_STATE_EVENTS_
+#define BASE_STATE_EVENTS_
+
+#include "base_state_filter_interface.h"
+#include "base_state_event_codec.h"
+#include "timer.h"
+
+// Sensor and actuation events from which the base state is estimated.
+
+typedef enum {
+  kLeftWheelTick,
+  kRightWheelTick,
+  kLeftWheelDirectionCommand,
+  kRightWheelDirectionCommand,
+  kIMUReading,
+} EventType;
+
+typedef struct {
+  EventType type;
+  TimerTicksType timer_ticks;
+  union {
+    struct {
+      bool is_forward;
+    } wheel_direction;
+    struct {  
+      float position_acceleration[3];
+      float attitude[3];
+    } imu;
+  } payload;
+} Event;
+
+// Sorts `events` chronologically and notifies them to `filter`. Ticks of both wheels with
+// the same timestamp are notified together.
+void NotifyBaseStateEvents(Event *events, int num_events, BaseStateFilterInterface *filter);
+
+// Conversions to and from the records streamed by the kRecordBaseStateEvents action.
+BaseStateEventRecord BaseStateEventRecordFromEvent(const Event &event);
+Event EventFromBaseStateEventRecord(const BaseStateEventRecord &record);
+
+#endif  // BASE_STATE_EVENTS_
@@ -42,6 +42,7 @@ BaseStateFilter::BaseStateFilter()
     left_wheel_moving_backward_(false), 
     right_wheel_moving_backward_(false), 
     odom_yaw_(0.0f), 
+    odom_yaw_offset_(0.0f), 
     last_imu_timer_ticks_(0), 
     imu_yaw_(0.0f), 
     last_yaw_estimate_(0), 
@@ -177,7 +178,7 @@ void BaseStateFilter::NotifyWheelTicks(TimerTicksType timer_ticks, int left_tick
   }
   const float x_inc = distance_inc * cosf(distance_inc_yaw);
   const float y_inc = distance_inc * sinf(distance_inc_yaw);
-  odom_yaw_ = ((kRadiansPerWheelTick * kWheelRadius) * (right_wheel_ticks_ - left_wheel_ticks_)) / kRobotDistanceBetweenTireCenters;
+  odom_yaw_ = odom_yaw_offset_ + ((kRadiansPerWheelTick * kWheelRadius) * (right_wheel_ticks_ - left_wheel_ticks_)) / kRobotDistanceBetweenTireCenters;
 
   const float odom_timer_inc = SecondsFromTimerTicks(timer_ticks - last_odom_timer_ticks_);
   if (odom_timer_inc >= sqrtf(x_inc * x_inc + y_inc * y_inc) / kOdomCenterSpeedMax) {
@@ -240,6 +241,29 @@ void BaseStateFilter::NotifyIMUReading(TimerTicksType timer_ticks, float accel_x
   EstimateState(timer_ticks);
 }
 
+void BaseStateFilter::Reset(const BaseState &state, TimerTicksType timer_ticks) {
+  const Point &position = state.location().position();
+  const Point &velocity = state.velocity().position();
+  const float yaw = state.location().yaw();
+
+  left_wheel_ticks_ = 0;
+  right_wheel_ticks_ = 0;
+  odom_center_ = position;
+  odom_center_velocity_ = velocity;
+  odom_yaw_offset_ = yaw;
+  odom_yaw_ = yaw;
+  last_odom_timer_ticks_ = timer_ticks;
+
+  imu_acceleration_ = Point(0, 0);
+  imu_yaw_ = yaw;
+  last_imu_timer_ticks_ = timer_ticks;
+
+  kalman_.x = { position.x, position.y, velocity.x, velocity.y, cosf(yaw), sinf(yaw) };
+  last_yaw_estimate_ = yaw;
+  yaw_velocity_ = state.velocity().yaw();
+  last_state_update_timer_ticks_ = timer_ticks;
+}
+
 float BaseStateFilter::GetFilteredYaw() const {
   return atan2f(kalman_.x(5), kalman_.x(4));
 }
@@ -4,8 +4,7 @@
 #include <Kalman.h>
 #include "robot_model.h"
 #include "timer.h"
-#include "base_state.h"
-#include "timer.h"
+#include "base_state_filter_interface.h"
 
 // Somewhere down the third-party header tree, a macro F is defined, which makes it impossible to access kalman_.F.
 #undef F
@@ -16,23 +15,23 @@
 #define kNumObservationVars 6   // odom_x, odom_y, odom_x',odom_y', cos(odom_yaw), sin(odom_yaw)
 #define kNumCommandVars 4   // imu_x'', imu_y'', cos(imu_yaw), sin(imu_yaw)
 
-// The base state is a first order model.
-using BaseState = State<BaseStateVars, /*order=*/1>;
-
-class BaseStateFilter {
+// Fuses odometry and IMU readings with a Kalman filter.
+class BaseStateFilter : public BaseStateFilterInterface {
   public:
     BaseStateFilter();
     
-    void NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc);
-    void NotifyLeftWheelDirection(bool backward);
-    void NotifyRightWheelDirection(bool backward);
+    void NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc) override;
+    void NotifyLeftWheelDirection(bool backward) override;
+    void NotifyRightWheelDirection(bool backward) override;
+
+    void NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw) override;
+    void EstimateState(TimerTicksType timer_ticks) override;
 
-    void NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw);
-    void EstimateState(TimerTicksType timer_ticks);
+    void Reset(const BaseState &state, TimerTicksType timer_ticks) override;
 
-    BaseState state() const;
-    TimerNanosType state_update_nanos() const {
-      return NanosFromTimerTicks(last_state_update_timer_ticks_);
+    BaseState state() const override;
+    TimerTicksType state_update_timer_ticks() const override {
+      return last_state_update_timer_ticks_;
     }
 
   private:
@@ -47,6 +46,8 @@ class BaseStateFilter {
     Point odom_center_;
     Point odom_center_velocity_;
     float odom_yaw_;
+    // Added to the yaw integrated from the wheel ticks, so it starts at the Reset() yaw.
+    float odom_yaw_offset_;
 
     // IMU.
     TimerTicksType last_imu_timer_ticks_;
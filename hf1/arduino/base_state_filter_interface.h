@@ -0,0 +1,31 @@
+#ifndef BASE_STATE_FILTER_INTERFACE_
+#define BASE_STATE_FILTER_INTERFACE_
+
+#include "base_state.h"
+#include "timer.h"
+
+// Estimates the state of the base from odometry and IMU events.
+// Events must be notified in chronological order.
+class BaseStateFilterInterface {
+  public:
+    virtual ~BaseStateFilterInterface() {}
+
+    virtual void NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc) = 0;
+    virtual void NotifyLeftWheelDirection(bool backward) = 0;
+    virtual void NotifyRightWheelDirection(bool backward) = 0;
+
+    virtual void NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw) = 0;
+    virtual void EstimateState(TimerTicksType timer_ticks) = 0;
+
+    // Restarts the estimation from `state`, as if it had been estimated at `timer_ticks`.
+    // Used to hand over the estimation from one filter to another without discontinuities.
+    virtual void Reset(const BaseState &state, TimerTicksType timer_ticks) = 0;
+
+    virtual BaseState state() const = 0;
+    virtual TimerTicksType state_update_timer_ticks() const = 0;
+    TimerNanosType state_update_nanos() const {
+      return NanosFromTimerTicks(state_update_timer_ticks());
+    }
+};
+
+#endif  // BASE_STATE_FILTER_INTERFACE_
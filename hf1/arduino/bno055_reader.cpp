@@ -0,0 +1,92 @@
+#include <math.h>
+#include "bno055_reader.h"
+
+// Burst from the first Euler angle register (BNO055_EULER_H_LSB_ADDR) to the last linear
+// acceleration register (BNO055_LINEAR_ACCEL_DATA_Z_MSB_ADDR). The quaternion registers in
+// between are read but ignored: a single transfer is cheaper than two.
+#define kFirstRegister 0x1a
+#define kEulerOffset 0x00
+#define kLinearAccelerationOffset 0x0e
+#define kNumRegisters 20
+
+#define kEulerLSBPerDegree 16.0f
+#define kLinearAccelerationLSBPerMeterPerSecondSquared 100.0f
+
+// I2C clock, set by BodyIMU.
+#define kI2CClockHz 400'000
+// Bus time of a reading: the write address, the register, the read address and the data,
+// 9 clock cycles each (8 bits and the acknowledgement). ~0.5 ms at 400 kHz.
+#define kReadingBusTimeNs ((3 + kNumRegisters) * 9 * (1'000'000'000 / kI2CClockHz))
+// Give up if a reading takes several times its bus time, e.g. because the sensor holds the
+// bus. The margin absorbs main loop iterations that delay a few polls, as long as the loop
+// keeps polling while the reading is in progress (see I2CBusInterface::Poll()).
+#define kReadingTimeoutNs (10 * kReadingBusTimeNs)
+
+static float ReadInt16(const uint8_t *registers) {
+  return static_cast<int16_t>(static_cast<uint16_t>(registers[0]) | (static_cast<uint16_t>(registers[1]) << 8));
+}
+
+BNO055Reader::BNO055Reader(I2CBusInterface *bus, uint8_t address)
+  : bus_(*ASSERT_NOT_NULL(bus)), address_(address), in_progress_(false), request_timer_ticks_(0), request_start_ns_(0),
+    reading_{}, reading_timer_ticks_(0) {
+  static_assert(sizeof(registers_) == kNumRegisters);
+}
+
+Status BNO055Reader::Request(TimerTicksType timer_ticks) {
+  if (in_progress_) {
+    return kExistsError;
+  }
+  const Status status = bus_.StartRegisterRead(address_, kFirstRegister, registers_, kNumRegisters);
+  if (status != kSuccess) {
+    return status;
+  }
+  in_progress_ = true;
+  request_timer_ticks_ = timer_ticks;
+  request_start_ns_ = GetTimerNanoseconds();
+  return kSuccess;
+}
+
+Status BNO055Reader::Run() {
+  if (!in_progress_) {
+    return kDoesNotExistError;
+  }
+  const Status status = bus_.Poll();
+  switch (status) {
+    case kUnavailableError:
+      if (GetTimerNanoseconds() - request_start_ns_ < kReadingTimeoutNs) {
+        return kUnavailableError;
+      }
+      bus_.Abort();
+      in_progress_ = false;
+      return kMalformedError;
+    case kSuccess:
+      reading_ = ReadingFromRegisters(registers_);
+      reading_timer_ticks_ = request_timer_ticks_;
+      in_progress_ = false;
+      return kSuccess;
+    default:
+      in_progress_ = false;
+      return kMalformedError;
+  }
+}
+
+BNO055Reading BNO055Reader::ReadingFromRegisters(const uint8_t *registers) {
+  // The sensor returns heading, roll and pitch, where x points to the ground, y points to the
+  // robot's right, and z points to the robot's back. See BodyIMU::GetYawPitchRoll().
+  const uint8_t *euler_registers = &registers[kEulerOffset];
+  const float heading = ReadInt16(&euler_registers[0]) / kEulerLSBPerDegree;
+  const float roll = ReadInt16(&euler_registers[2]) / kEulerLSBPerDegree;
+  const float pitch = ReadInt16(&euler_registers[4]) / kEulerLSBPerDegree;
+  // The heading is in [0, 360), but we want the yaw in [-180, 180).
+  const float yaw_symmetric = heading <= 180 ? -heading : 360 - heading;
+
+  BNO055Reading reading;
+  reading.attitude[0] = (-pitch * M_PI) / 180.0f;
+  reading.attitude[1] = (-roll * M_PI) / 180.0f;
+  reading.attitude[2] = (yaw_symmetric * M_PI) / 180.0f;
+  const uint8_t *acceleration_registers = &registers[kLinearAccelerationOffset];
+  for (int i = 0; i < 3; ++i) {
+    reading.linear_acceleration[i] = ReadInt16(&acceleration_registers[2 * i]) / kLinearAccelerationLSBPerMeterPerSecondSquared;
+  }
+  return reading;
+}
@@ -0,0 +1,58 @@
+#ifndef BNO055_READER_
+#define BNO055_READER_
+
+#include "i2c_bus_interface.h"
+#include "timer.h"
+
+#define kBNO055DefaultAddress 0x28
+
+// Orientation and linear acceleration, in the same reference frame as BodyIMU:
+// x points to the front of the robot, y to its left and z to the sky.
+typedef struct {
+  // Roll (x), pitch (y) and yaw (z) in radians, with the ranges of BodyIMU::GetYawPitchRoll().
+  float attitude[3];
+  // In m/s^2, without gravity.
+  float linear_acceleration[3];
+} BNO055Reading;
+
+// Reads the fusion outputs of a BNO055 without blocking.
+//
+// A reading is a single burst read of the registers from the Euler angles to the linear
+// accelerations, so both come from the same fusion cycle. The transfer is advanced by Run()
+// across main loop iterations. The sensor must have been configured in a fusion mode, e.g. with
+// BodyIMU::Init().
+class BNO055Reader {
+public:
+  // Does not take ownership of the pointee, which must outlive this object.
+  BNO055Reader(I2CBusInterface *bus, uint8_t address = kBNO055DefaultAddress);
+
+  // Starts a reading, which will be timestamped with `timer_ticks`.
+  // Returns kExistsError if a reading is in progress.
+  Status Request(TimerTicksType timer_ticks);
+
+  // Advances the reading in progress. Returns kSuccess once, when a new reading is available;
+  // kUnavailableError while in progress; kDoesNotExistError if no reading was requested; and
+  // kMalformedError if the transfer failed or timed out, in which case the reading is dropped.
+  Status Run();
+
+  bool in_progress() const { return in_progress_; }
+
+  // Last completed reading and its timestamp.
+  const BNO055Reading &reading() const { return reading_; }
+  TimerTicksType reading_timer_ticks() const { return reading_timer_ticks_; }
+
+  // Converts the burst of registers to a reading. Exposed for testing.
+  static BNO055Reading ReadingFromRegisters(const uint8_t *registers);
+
+private:
+  I2CBusInterface &bus_;
+  const uint8_t address_;
+  bool in_progress_;
+  TimerTicksType request_timer_ticks_;
+  TimerNanosType request_start_ns_;
+  uint8_t registers_[20];
+  BNO055Reading reading_;
+  TimerTicksType reading_timer_ticks_;
+};
+
+#endif  // BNO055_READER_
@@ -35,6 +35,8 @@ void BodyIMU::Init() {
     0x0, 0x0, 0x0, 0xff, 0xff, 0x1, 0x0, 0xe8, 0x3, 0x33, 0x2 
   };
   ASSERT(bno_.begin(OPERATION_MODE_CONFIG));
+  // The BNO055 supports fast mode, which shortens the non-blocking reads of BNO055Reader.
+  Wire.setClock(400000);
   bno_.setSensorOffsets(calibration_data);
   bno_.setMode(OPERATION_MODE_IMUPLUS);
 #endif
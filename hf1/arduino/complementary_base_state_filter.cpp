@@ -0,0 +1,133 @@
+#include <math.h>
+#include "complementary_base_state_filter.h"
+#include "robot_model.h"
+#include "utils.h"
+
+// Weight of the IMU yaw in the blend; the odometry yaw gets the rest.
+// Odometry yaw moves in steps of several degrees per encoder edge and is very inaccurate on
+// sudden movements, whereas the IMU yaw comes from its internal fusion filter and is stable,
+// so it dominates the blend. Tuned with base_state_filter_bench.
+#define kIMUYawWeight 0.95f
+
+// Age after which the last IMU reading is no longer extrapolated: 50 ms, a few IMU polling
+// periods. Beyond it the IMU has stalled, and its extrapolated yaw would drift without bound.
+#define kMaxIMUYawAgeTimerTicks (50 * kTimerTicksPerSecond / 1000)
+
+// Any estimate above this value is rejected.
+// Meant to prevent too high estimates due to co-occuring encoder edges.
+#define kMaxOdomSpeed 2.0f  // [m/s]
+
+// Factor applied to the velocity at every state update without wheel ticks, so that it
+// decays to 1e-3 of its last value in the time between wheel ticks at 0.5 m/s, at the
+// approximate update rate of 160 Hz.
+#define kOdomVelocityDecayFactor (expf(logf(1e-3f) / (160.0f * ((kWheelRadius * kRadiansPerWheelTick) / 0.5f))))
+
+ComplementaryBaseStateFilter::ComplementaryBaseStateFilter()
+  : left_wheel_moving_backward_(false),
+    right_wheel_moving_backward_(false),
+    last_odom_timer_ticks_(0),
+    yaw_(0.0f),
+    has_imu_reading_(false),
+    last_imu_timer_ticks_(0),
+    imu_yaw_(0.0f),
+    imu_yaw_velocity_(0.0f),
+    yaw_velocity_(0.0f),
+    last_yaw_estimate_(0.0f),
+    last_state_update_timer_ticks_(0) {}
+
+void ComplementaryBaseStateFilter::NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc) {
+  if (left_wheel_moving_backward_) {
+    left_ticks_inc = -left_ticks_inc;
+  }
+  if (right_wheel_moving_backward_) {
+    right_ticks_inc = -right_ticks_inc;
+  }
+  const float left_distance_inc = kRadiansPerWheelTick * kWheelRadius * left_ticks_inc;
+  const float right_distance_inc = kRadiansPerWheelTick * kWheelRadius * right_ticks_inc;
+  const float yaw_inc = (right_distance_inc - left_distance_inc) / kRobotDistanceBetweenTireCenters;
+  const float distance_inc = 0.5f * (left_distance_inc + right_distance_inc);
+  float new_yaw = yaw_ + yaw_inc;
+  if (HasRecentIMUReading(timer_ticks)) {
+    // IMU readings are sparser than wheel ticks: extrapolate the last one to blend it.
+    const float imu_yaw = imu_yaw_ + imu_yaw_velocity_ * SecondsFromTimerTicks(timer_ticks - last_imu_timer_ticks_);
+    new_yaw = imu_yaw + (1.0f - kIMUYawWeight) * NormalizeRadians(new_yaw - imu_yaw);
+  }
+  // Advance along the mean heading during the increment.
+  const float heading = yaw_ + 0.5f * NormalizeRadians(new_yaw - yaw_);
+  const float x_inc = distance_inc * cosf(heading);
+  const float y_inc = distance_inc * sinf(heading);
+  position_.x += x_inc;
+  position_.y += y_inc;
+  yaw_ = NormalizeRadians(new_yaw);
+
+  const float odom_timer_inc = SecondsFromTimerTicks(timer_ticks - last_odom_timer_ticks_);
+  if (odom_timer_inc >= fabsf(distance_inc) / kMaxOdomSpeed && odom_timer_inc > 0) {
+    velocity_.x = x_inc / odom_timer_inc;
+    velocity_.y = y_inc / odom_timer_inc;
+  }
+  last_odom_timer_ticks_ = timer_ticks;
+
+  EstimateState(timer_ticks);
+}
+
+void ComplementaryBaseStateFilter::NotifyLeftWheelDirection(bool backward) {
+  left_wheel_moving_backward_ = backward;
+}
+
+void ComplementaryBaseStateFilter::NotifyRightWheelDirection(bool backward) {
+  right_wheel_moving_backward_ = backward;
+}
+
+void ComplementaryBaseStateFilter::NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw) {
+  if (HasRecentIMUReading(timer_ticks)) {
+    const float imu_time_inc = SecondsFromTimerTicks(timer_ticks - last_imu_timer_ticks_);
+    if (imu_time_inc > 0) {
+      imu_yaw_velocity_ = NormalizeRadians(yaw - imu_yaw_) / imu_time_inc;
+    }
+  } else {
+    // Too long since the last reading to tell how fast the yaw changes.
+    imu_yaw_velocity_ = 0.0f;
+  }
+  has_imu_reading_ = true;
+  imu_yaw_ = yaw;
+  last_imu_timer_ticks_ = timer_ticks;
+  // Move towards the IMU yaw along the shortest arc.
+  yaw_ = NormalizeRadians(yaw_ + kIMUYawWeight * NormalizeRadians(yaw - yaw_));
+  EstimateState(timer_ticks);
+}
+
+void ComplementaryBaseStateFilter::EstimateState(TimerTicksType timer_ticks) {
+  const float state_update_timer_inc = SecondsFromTimerTicks(timer_ticks - last_state_update_timer_ticks_);
+  if (timer_ticks != last_odom_timer_ticks_) {
+    // Decay odometry velocity, so it goes to zero if no more wheel ticks are received.
+    velocity_ = velocity_ * kOdomVelocityDecayFactor;
+  }
+  if (state_update_timer_inc > 0) {
+    yaw_velocity_ = NormalizeRadians(yaw_ - last_yaw_estimate_) / state_update_timer_inc;
+    last_yaw_estimate_ = yaw_;
+  }
+  last_state_update_timer_ticks_ = timer_ticks;
+}
+
+void ComplementaryBaseStateFilter::Reset(const BaseState &state, TimerTicksType timer_ticks) {
+  position_ = state.location().position();
+  velocity_ = state.velocity().position();
+  yaw_ = state.location().yaw();
+  yaw_velocity_ = state.velocity().yaw();
+  last_yaw_estimate_ = yaw_;
+  // The IMU yaw is only extrapolated from readings taken after the reset.
+  has_imu_reading_ = false;
+  last_odom_timer_ticks_ = timer_ticks;
+  last_state_update_timer_ticks_ = timer_ticks;
+}
+
+bool ComplementaryBaseStateFilter::HasRecentIMUReading(TimerTicksType timer_ticks) const {
+  return has_imu_reading_ && timer_ticks - last_imu_timer_ticks_ <= kMaxIMUYawAgeTimerTicks;
+}
+
+BaseState ComplementaryBaseStateFilter::state() const {
+  return BaseState({
+    BaseStateVars(position_, yaw_),
+    BaseStateVars(velocity_, yaw_velocity_)
+  });
+}
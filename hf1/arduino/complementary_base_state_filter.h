@@ -0,0 +1,52 @@
+#ifndef COMPLEMENTARY_BASE_STATE_FILTER_
+#define COMPLEMENTARY_BASE_STATE_FILTER_
+
+#include "base_state_filter_interface.h"
+#include "point.h"
+
+// Dead-reckons the base position from odometry, along a yaw that blends the odometry yaw
+// increments with the absolute IMU yaw, extrapolated between IMU readings. Without a recent
+// IMU reading, the yaw follows odometry alone.
+//
+// Every update costs a few scalar operations, compared to the matrix products and inversion
+// of BaseStateFilter. IMU accelerations are ignored.
+class ComplementaryBaseStateFilter : public BaseStateFilterInterface {
+  public:
+    ComplementaryBaseStateFilter();
+
+    void NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc) override;
+    void NotifyLeftWheelDirection(bool backward) override;
+    void NotifyRightWheelDirection(bool backward) override;
+
+    void NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw) override;
+    void EstimateState(TimerTicksType timer_ticks) override;
+
+    void Reset(const BaseState &state, TimerTicksType timer_ticks) override;
+
+    BaseState state() const override;
+    TimerTicksType state_update_timer_ticks() const override {
+      return last_state_update_timer_ticks_;
+    }
+
+  private:
+    // Whether the last IMU reading is recent enough to extrapolate to `timer_ticks`.
+    bool HasRecentIMUReading(TimerTicksType timer_ticks) const;
+
+    bool left_wheel_moving_backward_;
+    bool right_wheel_moving_backward_;
+    TimerTicksType last_odom_timer_ticks_;
+
+    Point position_;
+    Point velocity_;
+    float yaw_;
+    bool has_imu_reading_;
+    TimerTicksType last_imu_timer_ticks_;
+    float imu_yaw_;
+    float imu_yaw_velocity_;
+    float yaw_velocity_;
+    float last_yaw_estimate_;
+
+    TimerTicksType last_state_update_timer_ticks_;
+};
+
+#endif  // COMPLEMENTARY_BASE_STATE_FILTER_
@@ -13,9 +13,7 @@ bool CreateBaseMixedTrajectoryViewActionHandler::Run() {
       const auto second_trajectory_view_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view.second_trajectory_view_id.id));
       const int alpha_envelope_trajectory_view_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view.alpha_envelope_trajectory_view_id));
 
-      char str[220];
-      sprintf(str, "create_base_mixed_trajectory_view(id=%d, first_trajectory_view_id=%s:%d, second_trajectory_view_id=%s:%d, alpha_trajectory_view_id=%d)", mixed_trajectory_view_id, GetTrajectoryViewTypeName(first_trajectory_view_type), first_trajectory_view_id, GetTrajectoryViewTypeName(second_trajectory_view_type), second_trajectory_view_id, alpha_envelope_trajectory_view_id);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatCreateBaseMixedTrajectoryView, mixed_trajectory_view_id, first_trajectory_view_type, first_trajectory_view_id, second_trajectory_view_type, second_trajectory_view_id, alpha_envelope_trajectory_view_id);
 
       auto &maybe_mixed_trajectory_view = trajectory_store_.base_mixed_trajectory_views()[mixed_trajectory_view_id];
       if (maybe_mixed_trajectory_view.status() == Status::kDoesNotExistError) {
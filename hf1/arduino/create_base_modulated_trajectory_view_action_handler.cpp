@@ -13,9 +13,7 @@ bool CreateBaseModulatedTrajectoryViewActionHandler::Run() {
       const auto modulator_trajectory_view_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view.modulator_trajectory_view_id.id));
       const auto envelope_trajectory_view_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view.envelope_trajectory_view_id));
 
-      char str[220];
-      sprintf(str, "create_base_modulated_trajectory_view(id=%d, carrier_trajectory_view_id=%s:%d, modulator_trajectory_view_id=%s:%d, envelope_trajectory_view_id=%d)", modulated_trajectory_view_id, GetTrajectoryViewTypeName(carrier_trajectory_view_type), carrier_trajectory_view_id, GetTrajectoryViewTypeName(modulator_trajectory_view_type), modulator_trajectory_view_id, envelope_trajectory_view_id);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatCreateBaseModulatedTrajectoryView, modulated_trajectory_view_id, carrier_trajectory_view_type, carrier_trajectory_view_id, modulator_trajectory_view_type, modulator_trajectory_view_id, envelope_trajectory_view_id);
 
       auto &maybe_modulated_trajectory_view = trajectory_store_.base_modulated_trajectory_views()[modulated_trajectory_view_id];
       if (maybe_modulated_trajectory_view.status() == Status::kDoesNotExistError) {
@@ -9,9 +9,7 @@ bool CreateBaseTrajectoryActionHandler::Run() {
       const int trajectory_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.id));
       const int num_waypoints = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory.num_waypoints));
       
-      char str[80];
-      sprintf(str, "create_base_trajectory(id=%d, num_waypoints=%d)", trajectory_id, num_waypoints);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatCreateBaseTrajectory, trajectory_id, num_waypoints);
 
       auto &maybe_trajectory = trajectory_store_.base_trajectories()[trajectory_id];
       if (maybe_trajectory.status() == Status::kDoesNotExistError) {
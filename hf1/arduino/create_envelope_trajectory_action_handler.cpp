@@ -9,9 +9,7 @@ bool CreateEnvelopeTrajectoryActionHandler::Run() {
       const int trajectory_id = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.id));
       const int num_waypoints = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory.num_waypoints));
       
-      char str[80];
-      sprintf(str, "create_envelope_trajectory(id=%d, num_waypoints=%d)", trajectory_id, num_waypoints);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatCreateEnvelopeTrajectory, trajectory_id, num_waypoints);
 
       auto &maybe_trajectory = trajectory_store_.envelope_trajectories()[trajectory_id];
       if (maybe_trajectory.status() == Status::kDoesNotExistError) {
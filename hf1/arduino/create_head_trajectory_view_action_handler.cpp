@@ -12,9 +12,7 @@ bool CreateHeadTrajectoryViewActionHandler::Run() {
       InterpolationConfig interpolation_config;
       interpolation_config.type = static_cast<InterpolationType>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view.interpolation_config.type));
 
-      char str[150];
-      sprintf(str, "create_head_trajectory_view(id=%d, trajectory_id=%d, loop_after_seconds=%f, interpolation_config={type=%d})", trajectory_view_id, trajectory_id, loop_after_seconds, interpolation_config.type);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatCreateHeadTrajectoryView, trajectory_view_id, trajectory_id, loop_after_seconds, interpolation_config.type);
 
       auto &maybe_trajectory_view = trajectory_store_.head_trajectory_views()[trajectory_view_id];
       if (maybe_trajectory_view.status() == Status::kDoesNotExistError) {
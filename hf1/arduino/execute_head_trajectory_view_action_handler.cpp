@@ -21,9 +21,7 @@ bool ExecuteHeadTrajectoryViewActionHandler::Run() {
       const auto trajectory_view_type = static_cast<P2PTrajectoryViewType>(NetworkToLocal<kP2PLocalEndianness>(request.trajectory_view_id.type));
       last_progress_update_ns_ = 0;
 
-      char str[100];
-      sprintf(str, "execute_head_trajectory_view(trajectory_view_type=%d, trajectory_view_id=%d)", trajectory_view_type, trajectory_view_id);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatExecuteHeadTrajectoryView, trajectory_view_type, trajectory_view_id);
 
       TrajectoryViewInterface<HeadTargetState> *trajectory_view = nullptr;
       switch(trajectory_view_type) {
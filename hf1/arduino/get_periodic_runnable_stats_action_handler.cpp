@@ -0,0 +1,64 @@
+#include "get_periodic_runnable_stats_action_handler.h"
+#include <string.h>
+
+static_assert(sizeof(P2PApplicationPacketHeader) + sizeof(P2PGetPeriodicRunnableStatsReply) <= kP2PMaxContentLength);
+static_assert(kMaxNameLength <= kP2PMaxPeriodicRunnableNameLength);
+
+bool GetPeriodicRunnableStatsActionHandler::Run() {
+  switch(state_) {
+    case kProcessingRequest: 
+      if (TrySendingReply()) {
+        return false; // Reply sent; do not call Run() again.
+      }
+      state_ = kSendingReply;
+      break;
+    
+    case kSendingReply: 
+      if (TrySendingReply()) {
+        state_ = kProcessingRequest;
+        return false; // Reply sent; do not call Run() again.
+      }
+      break;
+  }
+  return true;
+}
+
+bool GetPeriodicRunnableStatsActionHandler::TrySendingReply() {
+  StatusOr<P2PActionPacketAdapter<P2PGetPeriodicRunnableStatsReply>> maybe_reply = NewReply();
+  if (!maybe_reply.ok()) {
+    return false;
+  }
+  P2PActionPacketAdapter<P2PGetPeriodicRunnableStatsReply> reply = *maybe_reply;
+  // The snapshot is taken when the reply can be sent, so that the stats cleared with `reset`
+  // are exactly those sent.
+  const P2PGetPeriodicRunnableStatsRequest &request = GetRequest();
+  const int index = NetworkToLocal<kP2PLocalEndianness>(request.index);
+  *reply.operator->() = P2PGetPeriodicRunnableStatsReply{};
+  reply->num_runnables = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(num_runnables_));
+  if (index >= num_runnables_) {
+    reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kDoesNotExistError));
+    reply.Commit(/*guarantee_delivery=*/true);
+    return true;
+  }
+
+  PeriodicRunnable &runnable = *runnables_[index];
+  reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kSuccess));
+  strncpy(reply->name, runnable.name(), kP2PMaxPeriodicRunnableNameLength - 1);
+  reply->period_nanos = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(runnable.period_nanos()));
+  reply->num_runs = LocalToNetwork<kP2PLocalEndianness>(runnable.run_histogram().total_count());
+  reply->num_overruns = LocalToNetwork<kP2PLocalEndianness>(runnable.num_overruns());
+  reply->num_skipped_periods = LocalToNetwork<kP2PLocalEndianness>(runnable.num_skipped_periods());
+  reply->max_period_error_nanos = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(runnable.period_error_histogram().max_value()));
+  reply->max_run_nanos = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(runnable.run_histogram().max_value()));
+  for (int i = 0; i < kP2PPeriodicRunnablePeriodErrorHistogramNumBuckets; ++i) {
+    reply->period_error_histogram[i] = LocalToNetwork<kP2PLocalEndianness>(runnable.period_error_histogram().count(i));
+  }
+  for (int i = 0; i < kP2PPeriodicRunnableRunHistogramNumBuckets; ++i) {
+    reply->run_histogram[i] = LocalToNetwork<kP2PLocalEndianness>(runnable.run_histogram().count(i));
+  }
+  if (request.reset) {
+    runnable.ClearStats();
+  }
+  reply.Commit(/*guarantee_delivery=*/true);
+  return true;
+}
@@ -0,0 +1,26 @@
+#ifndef GET_PERIODIC_RUNNABLE_STATS_ACTION_HANDLER_
+#define GET_PERIODIC_RUNNABLE_STATS_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "periodic_runnable.h"
+#include "logger_interface.h"
+
+class GetPeriodicRunnableStatsActionHandler : public P2PActionHandler<P2PGetPeriodicRunnableStatsRequest, P2PGetPeriodicRunnableStatsReply> {
+public:
+  // Replies with the stats of `runnables[request.index]`.
+  // Does not take ownsership of the pointees, which must outlive this object.
+  GetPeriodicRunnableStatsActionHandler(P2PPacketStreamArduino *p2p_stream, PeriodicRunnable *const *runnables, int num_runnables)
+    : P2PActionHandler<P2PGetPeriodicRunnableStatsRequest, P2PGetPeriodicRunnableStatsReply>(P2PAction::kGetPeriodicRunnableStats, p2p_stream),
+      runnables_(ASSERT_NOT_NULL(runnables)), num_runnables_(num_runnables) {}
+
+  bool Run() override;
+
+private:
+  bool TrySendingReply();
+
+  PeriodicRunnable *const *runnables_;
+  const int num_runnables_;
+  enum { kProcessingRequest, kSendingReply } state_ = kProcessingRequest;  
+};
+
+#endif  // GET_PERIODIC_RUNNABLE_STATS_ACTION_HANDLER_
@@ -0,0 +1,66 @@
+#include "get_profiler_sections_action_handler.h"
+#include "profiler.h"
+#include <string.h>
+
+static_assert(sizeof(P2PApplicationPacketHeader) + sizeof(P2PGetProfilerSectionsReply) <= kP2PMaxContentLength);
+static_assert(kMaxProfilerSections <= 255);
+
+bool GetProfilerSectionsActionHandler::Run() {
+  switch(state_) {
+    case kProcessingRequest: 
+      if (TrySendingReply()) {
+        return false; // Reply sent; do not call Run() again.
+      }
+      state_ = kSendingReply;
+      break;
+    
+    case kSendingReply: 
+      if (TrySendingReply()) {
+        state_ = kProcessingRequest;
+        return false; // Reply sent; do not call Run() again.
+      }
+      break;
+  }
+  return true;
+}
+
+bool GetProfilerSectionsActionHandler::TrySendingReply() {
+  StatusOr<P2PActionPacketAdapter<P2PGetProfilerSectionsReply>> maybe_reply = NewReply();
+  if (!maybe_reply.ok()) {
+    return false;
+  }
+  P2PActionPacketAdapter<P2PGetProfilerSectionsReply> reply = *maybe_reply;
+  // The snapshot is taken when the reply can be sent, so that the sections cleared with
+  // `reset` are exactly those sent.
+  const P2PGetProfilerSectionsRequest &request = GetRequest();
+  const int first_index = NetworkToLocal<kP2PLocalEndianness>(request.first_index);
+  const int num_sections = GetNumProfilerSections();
+  // Unused sections and name bytes are sent as zeros.
+  *reply.operator->() = P2PGetProfilerSectionsReply{};
+  reply->num_sections = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(num_sections));
+  reply->cycles_per_second = LocalToNetwork<kP2PLocalEndianness>(GetProfilerCyclesPerSecond());
+  if (first_index >= num_sections) {
+    reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kDoesNotExistError));
+    reply.Commit(/*guarantee_delivery=*/true);
+    return true;
+  }
+
+  reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kSuccess));
+  int num_returned_sections = 0;
+  for (int i = first_index; i < num_sections && num_returned_sections < kP2PMaxProfilerSectionsPerReply; ++i) {
+    const ProfilerSection &section = GetProfilerSection(i);
+    P2PProfilerSection &reply_section = reply->sections[num_returned_sections++];
+    strncpy(reply_section.name, section.name, kP2PMaxProfilerSectionNameLength - 1);
+    reply_section.count = LocalToNetwork<kP2PLocalEndianness>(section.count);
+    // An empty section has min_cycles above max_cycles.
+    reply_section.min_cycles = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(section.count > 0 ? section.min_cycles : 0));
+    reply_section.max_cycles = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(section.max_cycles));
+    reply_section.total_cycles = LocalToNetwork<kP2PLocalEndianness>(section.total_cycles);
+    if (request.reset) {
+      ClearProfilerSection(i);
+    }
+  }
+  reply->num_returned_sections = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(num_returned_sections));
+  reply.Commit(/*guarantee_delivery=*/true);
+  return true;
+}
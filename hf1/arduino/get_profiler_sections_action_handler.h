@@ -0,0 +1,21 @@
+#ifndef GET_PROFILER_SECTIONS_ACTION_HANDLER_
+#define GET_PROFILER_SECTIONS_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "logger_interface.h"
+
+class GetProfilerSectionsActionHandler : public P2PActionHandler<P2PGetProfilerSectionsRequest, P2PGetProfilerSectionsReply> {
+public:
+  // Does not take ownsership of the pointee, which must outlive this object.
+  GetProfilerSectionsActionHandler(P2PPacketStreamArduino *p2p_stream)
+    : P2PActionHandler<P2PGetProfilerSectionsRequest, P2PGetProfilerSectionsReply>(P2PAction::kGetProfilerSections, p2p_stream) {}
+
+  bool Run() override;
+
+private:
+  bool TrySendingReply();
+
+  enum { kProcessingRequest, kSendingReply } state_ = kProcessingRequest;  
+};
+
+#endif  // GET_PROFILER_SECTIONS_ACTION_HANDLER_
@@ -0,0 +1,90 @@
+#include "get_ring_buffer_stats_action_handler.h"
+#include "robot_state_estimator.h"
+#include "profiler.h"
+#include <string.h>
+
+// The P2P input buffers of every priority level come first, then the output ones, and the
+// estimator's event buffer last.
+#define kNumP2PPriorities (P2PPriority::kNumLevels - 1)
+#define kNumRingBuffers (2 * kNumP2PPriorities + 1)
+
+static_assert(sizeof(P2PApplicationPacketHeader) + sizeof(P2PGetRingBufferStatsReply) <= kP2PMaxContentLength);
+static_assert(kP2PInputCapacity <= 255 && kP2POutputCapacity <= 255);
+
+static const char *const kRingBufferNames[kNumRingBuffers] = {
+  "p2p_input_high", "p2p_input_medium", "p2p_input_low",
+  "p2p_output_high", "p2p_output_medium", "p2p_output_low",
+  "estimator_events",
+};
+
+bool GetRingBufferStatsActionHandler::Run() {
+  switch(state_) {
+    case kProcessingRequest: 
+      if (TrySendingReply()) {
+        return false; // Reply sent; do not call Run() again.
+      }
+      state_ = kSendingReply;
+      break;
+    
+    case kSendingReply: 
+      if (TrySendingReply()) {
+        state_ = kProcessingRequest;
+        return false; // Reply sent; do not call Run() again.
+      }
+      break;
+  }
+  return true;
+}
+
+bool GetRingBufferStatsActionHandler::TrySendingReply() {
+  StatusOr<P2PActionPacketAdapter<P2PGetRingBufferStatsReply>> maybe_reply = NewReply();
+  if (!maybe_reply.ok()) {
+    return false;
+  }
+  P2PActionPacketAdapter<P2PGetRingBufferStatsReply> reply = *maybe_reply;
+  // The snapshot is taken when the reply can be sent, so that the stats cleared with `reset`
+  // are exactly those sent.
+  const P2PGetRingBufferStatsRequest &request = GetRequest();
+  const int index = NetworkToLocal<kP2PLocalEndianness>(request.index);
+  *reply.operator->() = P2PGetRingBufferStatsReply{};
+  reply->num_buffers = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(kNumRingBuffers));
+  reply->cycles_per_second = LocalToNetwork<kP2PLocalEndianness>(GetProfilerCyclesPerSecond());
+  if (index >= kNumRingBuffers) {
+    reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kDoesNotExistError));
+    reply.Commit(/*guarantee_delivery=*/true);
+    return true;
+  }
+
+  RingBufferStats stats;
+  int capacity;
+  if (index < kNumP2PPriorities) {
+    const P2PPriority priority(index + 1);
+    stats = p2p_stream().input().buffer_stats(priority);
+    capacity = kP2PInputCapacity - 1;
+    if (request.reset) {
+      p2p_stream().input().ClearBufferStats(priority);
+    }
+  } else if (index < 2 * kNumP2PPriorities) {
+    const P2PPriority priority(index - kNumP2PPriorities + 1);
+    stats = p2p_stream().output().buffer_stats(priority);
+    capacity = kP2POutputCapacity - 1;
+    if (request.reset) {
+      p2p_stream().output().ClearBufferStats(priority);
+    }
+  } else {
+    stats = GetEventBufferStats();
+    capacity = GetEventBufferCapacity();
+    if (request.reset) {
+      ClearEventBufferStats();
+    }
+  }
+  reply->status_code = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(Status::kSuccess));
+  strncpy(reply->name, kRingBufferNames[index], kP2PMaxRingBufferNameLength - 1);
+  reply->capacity = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(capacity));
+  reply->high_water_mark = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(stats.high_water_mark));
+  reply->num_overwrites = LocalToNetwork<kP2PLocalEndianness>(stats.num_overwrites);
+  reply->occupancy_cycles = LocalToNetwork<kP2PLocalEndianness>(stats.occupancy_cycles);
+  reply->elapsed_cycles = LocalToNetwork<kP2PLocalEndianness>(stats.elapsed_cycles);
+  reply.Commit(/*guarantee_delivery=*/true);
+  return true;
+}
@@ -0,0 +1,23 @@
+#ifndef GET_RING_BUFFER_STATS_ACTION_HANDLER_
+#define GET_RING_BUFFER_STATS_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "logger_interface.h"
+
+// Replies with the occupancy stats of the packet buffers of the P2P stream, per direction and
+// priority level, and of the event buffer of the robot state estimator.
+class GetRingBufferStatsActionHandler : public P2PActionHandler<P2PGetRingBufferStatsRequest, P2PGetRingBufferStatsReply> {
+public:
+  // Does not take ownsership of the pointee, which must outlive this object.
+  GetRingBufferStatsActionHandler(P2PPacketStreamArduino *p2p_stream)
+    : P2PActionHandler<P2PGetRingBufferStatsRequest, P2PGetRingBufferStatsReply>(P2PAction::kGetRingBufferStats, p2p_stream) {}
+
+  bool Run() override;
+
+private:
+  bool TrySendingReply();
+
+  enum { kProcessingRequest, kSendingReply } state_ = kProcessingRequest;  
+};
+
+#endif  // GET_RING_BUFFER_STATS_ACTION_HANDLER_
@@ -1,5 +1,6 @@
 #include "head_controller.h"
 #include "servos.h"
+#include "profiler.h"
 
 #define kHeadTrajeactoryControllerLoopPeriodSeconds 0.03
 
@@ -7,6 +8,7 @@ HeadTrajectoryController::HeadTrajectoryController(const char *name)
   : TrajectoryController<HeadTargetState>(name, kHeadTrajeactoryControllerLoopPeriodSeconds) {}
 
 void HeadTrajectoryController::Update(TimerSecondsType seconds_since_start) {
+  PROFILE_SCOPE("head_traj_ctrl");
   TrajectoryController<HeadTargetState>::Update(seconds_since_start);
   if (!is_started()) { return; }
   
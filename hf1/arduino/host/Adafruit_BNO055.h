@@ -0,0 +1,15 @@
+#ifndef HOST_ADAFRUIT_BNO055_
+#define HOST_ADAFRUIT_BNO055_
+
+// Host stand-in for the subset of the Adafruit BNO055 library declared by body_imu.h. The
+// BNO055 is read with BNO055Reader through I2CBusInterface; this only configures it.
+
+#include <stdint.h>
+#include "utility/imumaths.h"
+
+class Adafruit_BNO055 {
+public:
+  explicit Adafruit_BNO055(int32_t sensor_id) {}
+};
+
+#endif  // HOST_ADAFRUIT_BNO055_
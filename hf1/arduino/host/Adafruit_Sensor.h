@@ -0,0 +1,6 @@
+#ifndef HOST_ADAFRUIT_SENSOR_
+#define HOST_ADAFRUIT_SENSOR_
+
+// Host stand-in for the Adafruit Unified Sensor library, which body_imu.h includes.
+
+#endif  // HOST_ADAFRUIT_SENSOR_
@@ -0,0 +1,18 @@
+#ifndef HOST_ARDUINO_
+#define HOST_ARDUINO_
+
+// Host stand-in for the Arduino core. The firmware modules built on the host only use its
+// math functions, which the C library provides, and its pin interrupts, which never fire.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define INPUT_PULLDOWN 3
+#define RISING 3
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode) {}
+
+#endif  // HOST_ARDUINO_
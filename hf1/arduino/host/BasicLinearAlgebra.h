@@ -0,0 +1,151 @@
+#ifndef HOST_BASIC_LINEAR_ALGEBRA_
+#define HOST_BASIC_LINEAR_ALGEBRA_
+
+// Host stand-in for the subset of the BasicLinearAlgebra library (v3.7) used by the
+// firmware, so that the state estimation code can be built and benchmarked on Linux.
+// Storage is always dense and statically allocated; the memory layout template argument
+// is accepted for compatibility and ignored.
+
+#include <initializer_list>
+#include <math.h>
+
+namespace BLA {
+
+template<int kRows, int kCols = 1, class MemT = void> class Matrix {
+public:
+  Matrix() { Fill(0); }
+  Matrix(std::initializer_list<float> values) { *this = values; }
+  template<class OtherMemT> Matrix(const Matrix<kRows, kCols, OtherMemT> &other) { *this = other; }
+
+  // Assigns the values in row-major order.
+  Matrix &operator=(std::initializer_list<float> values) {
+    Fill(0);
+    int i = 0;
+    for (const float value : values) {
+      if (i >= kRows * kCols) { break; }
+      values_[i / kCols][i % kCols] = value;
+      ++i;
+    }
+    return *this;
+  }
+
+  template<class OtherMemT> Matrix &operator=(const Matrix<kRows, kCols, OtherMemT> &other) {
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        values_[i][j] = other(i, j);
+      }
+    }
+    return *this;
+  }
+
+  float &operator()(int row, int col = 0) { return values_[row][col]; }
+  float operator()(int row, int col = 0) const { return values_[row][col]; }
+
+  void Fill(float value) {
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        values_[i][j] = value;
+      }
+    }
+  }
+
+  template<int kOtherCols, class OtherMemT>
+  Matrix<kRows, kOtherCols> operator*(const Matrix<kCols, kOtherCols, OtherMemT> &other) const {
+    Matrix<kRows, kOtherCols> result;
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kOtherCols; ++j) {
+        float sum = 0;
+        for (int k = 0; k < kCols; ++k) {
+          sum += values_[i][k] * other(k, j);
+        }
+        result(i, j) = sum;
+      }
+    }
+    return result;
+  }
+
+  template<class OtherMemT> Matrix<kRows, kCols> operator+(const Matrix<kRows, kCols, OtherMemT> &other) const {
+    Matrix<kRows, kCols> result;
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        result(i, j) = values_[i][j] + other(i, j);
+      }
+    }
+    return result;
+  }
+
+  template<class OtherMemT> Matrix<kRows, kCols> operator-(const Matrix<kRows, kCols, OtherMemT> &other) const {
+    Matrix<kRows, kCols> result;
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        result(i, j) = values_[i][j] - other(i, j);
+      }
+    }
+    return result;
+  }
+
+  template<class OtherMemT> Matrix &operator+=(const Matrix<kRows, kCols, OtherMemT> &other) {
+    return *this = *this + other;
+  }
+
+  // Transpose.
+  Matrix<kCols, kRows> operator~() const {
+    Matrix<kCols, kRows> result;
+    for (int i = 0; i < kRows; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        result(j, i) = values_[i][j];
+      }
+    }
+    return result;
+  }
+
+private:
+  float values_[kRows][kCols];
+};
+
+template<int kSize> Matrix<kSize, kSize> Identity() {
+  Matrix<kSize, kSize> result;
+  for (int i = 0; i < kSize; ++i) {
+    result(i, i) = 1;
+  }
+  return result;
+}
+
+// Inverts `matrix` in place with Gauss-Jordan elimination and partial pivoting.
+// Returns false if the matrix is singular, in which case `matrix` is left undefined.
+template<int kSize, class MemT> bool Invert(Matrix<kSize, kSize, MemT> &matrix) {
+  Matrix<kSize, kSize> inverse = Identity<kSize>();
+  for (int col = 0; col < kSize; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < kSize; ++row) {
+      if (fabsf(matrix(row, col)) > fabsf(matrix(pivot, col))) { pivot = row; }
+    }
+    if (matrix(pivot, col) == 0) { return false; }
+    if (pivot != col) {
+      for (int j = 0; j < kSize; ++j) {
+        float tmp = matrix(col, j); matrix(col, j) = matrix(pivot, j); matrix(pivot, j) = tmp;
+        tmp = inverse(col, j); inverse(col, j) = inverse(pivot, j); inverse(pivot, j) = tmp;
+      }
+    }
+    const float inv_pivot = 1.0f / matrix(col, col);
+    for (int j = 0; j < kSize; ++j) {
+      matrix(col, j) *= inv_pivot;
+      inverse(col, j) *= inv_pivot;
+    }
+    for (int row = 0; row < kSize; ++row) {
+      if (row == col) { continue; }
+      const float factor = matrix(row, col);
+      if (factor == 0) { continue; }
+      for (int j = 0; j < kSize; ++j) {
+        matrix(row, j) -= factor * matrix(col, j);
+        inverse(row, j) -= factor * inverse(col, j);
+      }
+    }
+  }
+  matrix = inverse;
+  return true;
+}
+
+}  // namespace BLA
+
+#endif  // HOST_BASIC_LINEAR_ALGEBRA_
@@ -0,0 +1,43 @@
+#ifndef HOST_KALMAN_
+#define HOST_KALMAN_
+
+// Host stand-in for the subset of the Kalman library (https://github.com/rfetick/Kalman)
+// used by the firmware, so that BaseStateFilter can be built and benchmarked on Linux.
+// It implements the same predict-correct sequence on dense, statically allocated matrices.
+
+#include "BasicLinearAlgebra.h"
+
+// Memory layout of upper triangular matrices. Accepted for compatibility; storage is dense.
+template<int kSize, class T> struct TriangularSup {};
+
+template<int Nstate, int Nobs, int Ncom = 0, class MemF = void> class KALMAN {
+public:
+  BLA::Matrix<Nstate, Nstate, MemF> F;  // State transition model.
+  BLA::Matrix<Nobs, Nstate> H;          // Observation model.
+  BLA::Matrix<Nstate, Ncom> B;          // Control-input model.
+  BLA::Matrix<Nstate, Nstate> Q;        // Covariance of the process noise.
+  BLA::Matrix<Nobs, Nobs> R;            // Covariance of the observation noise.
+  BLA::Matrix<Nstate> x;                // State estimate.
+  BLA::Matrix<Nstate, Nstate> P;        // Covariance of the state estimate.
+  BLA::Matrix<Nstate, Nobs> K;          // Kalman gain.
+  BLA::Matrix<Nobs, Nobs> S;            // Covariance of the innovation.
+  int status = 0;                       // 0 if the last update succeeded, 1 if S was singular.
+
+  void update(const BLA::Matrix<Nobs> &obs, const BLA::Matrix<Ncom> &comm) {
+    // Predict.
+    x = F * x + B * comm;
+    P = F * P * ~F + Q;
+    // Correct.
+    S = H * P * ~H + R;
+    if (!BLA::Invert(S)) {
+      status = 1;
+      return;
+    }
+    status = 0;
+    K = P * ~H * S;
+    x += K * (obs - H * x);
+    P = (BLA::Identity<Nstate>() - K * H) * P;
+  }
+};
+
+#endif  // HOST_KALMAN_
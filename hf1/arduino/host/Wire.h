@@ -0,0 +1,7 @@
+#ifndef HOST_WIRE_
+#define HOST_WIRE_
+
+// Host stand-in for the Wire library. The firmware accesses the I2C bus through
+// I2CBusInterface, so nothing of it is needed on the host.
+
+#endif  // HOST_WIRE_
@@ -0,0 +1,21 @@
+#include "body_imu.h"
+
+// On the host, IMU readings come from the device behind the I2C bus passed to the robot state
+// estimator, e.g. a simulated BNO055. There is nothing to configure, and the blocking reads
+// are not used by the firmware.
+
+BodyIMU::BodyIMU() : bno_(/*sensor_id=*/55) {}
+
+void BodyIMU::Init() {}
+
+imu::Vector<3> BodyIMU::GetYawPitchRoll() {
+  return imu::Vector<3>(0, 0, 0);
+}
+
+imu::Vector<3> BodyIMU::GetLinearAccelerations() {
+  return imu::Vector<3>(0, 0, 0);
+}
+
+imu::Vector<3> BodyIMU::GetAngularVelocities() {
+  return imu::Vector<3>(0, 0, 0);
+}
@@ -0,0 +1,41 @@
+#include "encoders_host.h"
+#include "logger_interface.h"
+
+#define kMaxEncoderISRs 2
+
+static EncoderISR left_encoder_isr[kMaxEncoderISRs] = {};
+static EncoderISR right_encoder_isr[kMaxEncoderISRs] = {};
+
+void InitEncoders() {
+  for (int i = 0; i < kMaxEncoderISRs; ++i) {
+    left_encoder_isr[i] = NULL;
+    right_encoder_isr[i] = NULL;
+  }
+}
+
+void AddEncoderIsrs(EncoderISR left, EncoderISR right) {
+  for (int i = 0; i < kMaxEncoderISRs; ++i) {
+    if (left_encoder_isr[i] == NULL && right_encoder_isr[i] == NULL) {
+      left_encoder_isr[i] = left;
+      right_encoder_isr[i] = right;
+      return;
+    }
+  }
+  ASSERTM(false, "No more available encoder ISRs.");
+}
+
+static void CallIsrs(EncoderISR *isrs, TimerTicksType timer_ticks) {
+  for (int i = 0; i < kMaxEncoderISRs; ++i) {
+    if (isrs[i] != NULL) {
+      isrs[i](timer_ticks);
+    }
+  }
+}
+
+void TriggerLeftEncoderEdge(TimerTicksType timer_ticks) {
+  CallIsrs(left_encoder_isr, timer_ticks);
+}
+
+void TriggerRightEncoderEdge(TimerTicksType timer_ticks) {
+  CallIsrs(right_encoder_isr, timer_ticks);
+}
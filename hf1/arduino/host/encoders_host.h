@@ -0,0 +1,13 @@
+#ifndef ENCODERS_HOST_
+#define ENCODERS_HOST_
+
+// Host implementation of the encoder module (encoders.h). Edges are triggered by the caller,
+// e.g. a plant simulation, with the timer ticks the input capture channels would latch.
+
+#include "encoders.h"
+
+// Calls the ISRs added with AddEncoderIsrs() as if the encoder had an edge at `timer_ticks`.
+void TriggerLeftEncoderEdge(TimerTicksType timer_ticks);
+void TriggerRightEncoderEdge(TimerTicksType timer_ticks);
+
+#endif  // ENCODERS_HOST_
@@ -0,0 +1,16 @@
+#include <random>
+#include "guid_factory.h"
+
+// Host implementation of guid_factory.h. Seeded with a constant, so that host runs are
+// reproducible.
+
+static std::mt19937 guid_random(12345);
+
+GUIDFactory::GUIDFactory() {}
+
+void GUIDFactory::CreateGUID(int len, uint8_t *buffer, uint8_t max_byte_value) {
+  std::uniform_int_distribution<int> distribution(0, max_byte_value - 1);
+  for (int i = 0; i < len; ++i) {
+    buffer[i] = distribution(guid_random);
+  }
+}
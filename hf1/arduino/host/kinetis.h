@@ -0,0 +1,14 @@
+#ifndef HOST_KINETIS_
+#define HOST_KINETIS_
+
+// Host stand-in for the Teensy's register definitions. There are no interrupts to mask, and
+// the port's interrupt status flags are never set.
+
+#include <stdint.h>
+
+#define NVIC_ENABLE_IRQ(irq) ((void)(irq))
+#define NVIC_DISABLE_IRQ(irq) ((void)(irq))
+
+inline volatile uint32_t PORTD_ISFR = 0;
+
+#endif  // HOST_KINETIS_
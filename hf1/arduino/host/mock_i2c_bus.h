@@ -0,0 +1,73 @@
+#ifndef HOST_MOCK_I2C_BUS_
+#define HOST_MOCK_I2C_BUS_
+
+// Host I2C bus with a single device, whose registers are plain memory. Transfers complete
+// after a configurable number of polls, to exercise the non-blocking callers.
+
+#include <string.h>
+#include "i2c_bus_interface.h"
+
+class MockI2CBus : public I2CBusInterface {
+public:
+  MockI2CBus(uint8_t device_address) : device_address_(device_address) {
+    memset(registers_, 0, sizeof(registers_));
+  }
+
+  uint8_t *registers() { return registers_; }
+
+  // Number of Poll() calls after which a transfer ends.
+  void polls_per_transfer(int n) { polls_per_transfer_ = n; }
+  // If set, transfers never end.
+  void hang(bool h) { hang_ = h; }
+
+  int num_started_transfers() const { return num_started_transfers_; }
+  int num_aborted_transfers() const { return num_aborted_transfers_; }
+  bool transfer_in_progress() const { return buffer_ != nullptr; }
+
+  Status StartRegisterRead(uint8_t address, uint8_t first_register, uint8_t *buffer, int length) override {
+    if (buffer_ != nullptr) { return kExistsError; }
+    address_ = address;
+    first_register_ = first_register;
+    buffer_ = buffer;
+    length_ = length;
+    num_polls_ = 0;
+    ++num_started_transfers_;
+    return kSuccess;
+  }
+
+  Status Poll() override {
+    if (buffer_ == nullptr) { return kDoesNotExistError; }
+    if (hang_ || ++num_polls_ < polls_per_transfer_) { return kUnavailableError; }
+    uint8_t *buffer = buffer_;
+    buffer_ = nullptr;
+    // A missing device does not acknowledge its address.
+    if (address_ != device_address_ || first_register_ + length_ > static_cast<int>(sizeof(registers_))) {
+      return kMalformedError;
+    }
+    // Registers are sampled when the transfer ends.
+    memcpy(buffer, &registers_[first_register_], length_);
+    return kSuccess;
+  }
+
+  void Abort() override {
+    if (buffer_ == nullptr) { return; }
+    buffer_ = nullptr;
+    ++num_aborted_transfers_;
+  }
+
+private:
+  const uint8_t device_address_;
+  uint8_t registers_[256];
+  int polls_per_transfer_ = 1;
+  bool hang_ = false;
+  int num_started_transfers_ = 0;
+  int num_aborted_transfers_ = 0;
+
+  uint8_t address_;
+  uint8_t first_register_;
+  uint8_t *buffer_ = nullptr;
+  int length_;
+  int num_polls_;
+};
+
+#endif  // HOST_MOCK_I2C_BUS_
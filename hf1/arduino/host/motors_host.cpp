@@ -0,0 +1,25 @@
+#include "motors_host.h"
+
+static float left_duty_cycle = 0;
+static float right_duty_cycle = 0;
+
+void InitMotors() {
+  SetLeftMotorDutyCycle(0);
+  SetRightMotorDutyCycle(0);
+}
+
+void SetLeftMotorDutyCycle(float s) {
+  left_duty_cycle = s;
+}
+
+void SetRightMotorDutyCycle(float s) {
+  right_duty_cycle = s;
+}
+
+float GetLeftMotorDutyCycle() {
+  return left_duty_cycle;
+}
+
+float GetRightMotorDutyCycle() {
+  return right_duty_cycle;
+}
@@ -0,0 +1,12 @@
+#ifndef MOTORS_HOST_
+#define MOTORS_HOST_
+
+// Host implementation of the motor module (motors.h), which keeps the commanded duty
+// cycles for a plant simulation to read.
+
+#include "motors.h"
+
+float GetLeftMotorDutyCycle();
+float GetRightMotorDutyCycle();
+
+#endif  // MOTORS_HOST_
@@ -0,0 +1,42 @@
+#ifndef HOST_P2P_BYTE_STREAM_HOST_
+#define HOST_P2P_BYTE_STREAM_HOST_
+
+// Host byte stream over in-memory byte queues. Two streams with swapped queues are the ends
+// of a lossless link that delivers bytes as soon as they are written.
+
+#include <stdint.h>
+#include <deque>
+#include "p2p_byte_stream_interface.h"
+
+class P2PByteStreamHost : public P2PByteStreamInterface<kLittleEndian> {
+public:
+  // Does not take ownership of the queues, which must outlive this object.
+  P2PByteStreamHost(std::deque<uint8_t> *input, std::deque<uint8_t> *output)
+    : P2PByteStreamInterface<kLittleEndian>(Handler{ .object = nullptr }), input_(*input), output_(*output) {}
+
+  int Write(const void *buffer, int length) override {
+    const uint8_t *bytes = static_cast<const uint8_t *>(buffer);
+    output_.insert(output_.end(), bytes, bytes + length);
+    return length;
+  }
+
+  int Read(void *buffer, int length) override {
+    int num_read = 0;
+    uint8_t *bytes = static_cast<uint8_t *>(buffer);
+    while (num_read < length && !input_.empty()) {
+      bytes[num_read++] = input_.front();
+      input_.pop_front();
+    }
+    return num_read;
+  }
+
+  int GetBurstMaxLength() override { return 1024; }
+  int GetBurstIngestionNanosecondsPerByte() override { return 0; }
+  int GetAtomicSendMaxLength() override { return 4; }
+
+private:
+  std::deque<uint8_t> &input_;
+  std::deque<uint8_t> &output_;
+};
+
+#endif  // HOST_P2P_BYTE_STREAM_HOST_
@@ -0,0 +1,25 @@
+#include "servos_host.h"
+
+static float head_pitch_degrees = 0;
+static float head_roll_degrees = 0;
+
+void InitServos() {
+  SetHeadPitchDegrees(0);
+  SetHeadRollDegrees(0);
+}
+
+void SetHeadPitchDegrees(float angle_degrees) {
+  head_pitch_degrees = angle_degrees;
+}
+
+void SetHeadRollDegrees(float angle_degrees) {
+  head_roll_degrees = angle_degrees;
+}
+
+float GetHeadPitchDegrees() {
+  return head_pitch_degrees;
+}
+
+float GetHeadRollDegrees() {
+  return head_roll_degrees;
+}
@@ -0,0 +1,11 @@
+#ifndef SERVOS_HOST_
+#define SERVOS_HOST_
+
+// Host implementation of the servo module (servos.h), which keeps the commanded angles.
+
+#include "servos.h"
+
+float GetHeadPitchDegrees();
+float GetHeadRollDegrees();
+
+#endif  // SERVOS_HOST_
@@ -0,0 +1,71 @@
+#include "timer_host.h"
+#include "logger_interface.h"
+
+// The hardware counter is 16 bits long; ISRs are called when it overflows.
+#define kTimerCounterModulo (1ULL << 16)
+
+static TimerTicksType timer_ticks = 0;
+static TimerISR isr[kTimerMaxIsrs] = {};
+
+void InitTimer() {
+  timer_ticks = 0;
+  for (int i = 0; i < kTimerMaxIsrs; ++i) {
+    isr[i] = NULL;
+  }
+}
+
+bool PauseTimerIrq() {
+  return false;
+}
+
+void RestoreTimerIrq(bool previous_state) {}
+
+void SetTimerTicks(TimerTicksType ticks) {
+  ASSERT(ticks >= timer_ticks);
+  AdvanceTimerTicks(ticks - timer_ticks);
+}
+
+void AdvanceTimerTicks(TimerTicksType ticks) {
+  const TimerTicksType start_overflows = timer_ticks / kTimerCounterModulo;
+  timer_ticks += ticks;
+  for (TimerTicksType overflows = start_overflows; overflows < timer_ticks / kTimerCounterModulo; ++overflows) {
+    for (int i = 0; i < kTimerMaxIsrs; ++i) {
+      if (isr[i] != NULL) {
+        isr[i]();
+      }
+    }
+  }
+}
+
+TimerTicksType GetTimerTicks() {
+  return timer_ticks;
+}
+
+void AddTimerIsr(TimerISR custom_isr) {
+  for (int i = 0; i < kTimerMaxIsrs; ++i) {
+    if (isr[i] == NULL) {
+      isr[i] = custom_isr;
+      return;
+    }
+  }
+  ASSERTM(false, "No more available timer ISRs.");
+}
+
+void RemoveTimerIsr(TimerISR custom_isr) {
+  for (int i = 0; i < kTimerMaxIsrs; ++i) {
+    if (isr[i] == custom_isr) {
+      isr[i] = NULL;
+      return;
+    }
+  }
+  ASSERTM(false, "ISR not found.");
+}
+
+void SleepForNanos(TimerNanosType min_nanos) {
+  // Nobody else moves the virtual clock while sleeping.
+  AdvanceTimerTicks(TimerTicksFromNanos(min_nanos + kTimerNanosPerTick - 1));
+}
+
+void SleepForSeconds(TimerSecondsType min_seconds) {
+  SleepForNanos(min_seconds * 1e9);
+}
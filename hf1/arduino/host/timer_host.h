@@ -0,0 +1,16 @@
+#ifndef TIMER_HOST_
+#define TIMER_HOST_
+
+// Host implementation of the timer module (timer.h) on a virtual clock, which only moves
+// when told to. This makes host runs deterministic and faster than real time.
+
+#include "timer.h"
+
+// Sets the virtual clock. Time must not go backwards.
+void SetTimerTicks(TimerTicksType ticks);
+
+// Advances the virtual clock by `ticks`, calling the ISRs added with AddTimerIsr() at
+// every counter overflow, like the hardware timer.
+void AdvanceTimerTicks(TimerTicksType ticks);
+
+#endif  // TIMER_HOST_
@@ -0,0 +1,8 @@
+#ifndef HOST_IMUMATHS_
+#define HOST_IMUMATHS_
+
+// Host stand-in for the imumaths utilities of the Adafruit BNO055 library.
+
+#include "vector.h"
+
+#endif  // HOST_IMUMATHS_
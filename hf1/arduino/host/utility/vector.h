@@ -0,0 +1,32 @@
+#ifndef HOST_IMUMATHS_VECTOR_
+#define HOST_IMUMATHS_VECTOR_
+
+// Host stand-in for imu::Vector of the Adafruit BNO055 library, with the accessors the
+// firmware uses.
+
+#include <stdint.h>
+
+namespace imu {
+
+template<uint8_t N> class Vector {
+public:
+  Vector() : p_{} {}
+  Vector(double a, double b, double c) : p_{a, b, c} { static_assert(N == 3); }
+
+  double &x() { return p_[0]; }
+  double &y() { return p_[1]; }
+  double &z() { return p_[2]; }
+  double x() const { return p_[0]; }
+  double y() const { return p_[1]; }
+  double z() const { return p_[2]; }
+
+  double &operator[](int i) { return p_[i]; }
+  double operator[](int i) const { return p_[i]; }
+
+private:
+  double p_[N];
+};
+
+}  // namespace imu
+
+#endif  // HOST_IMUMATHS_VECTOR_
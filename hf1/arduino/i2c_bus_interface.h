@@ -0,0 +1,31 @@
+#ifndef I2C_BUS_INTERFACE_
+#define I2C_BUS_INTERFACE_
+
+#include <stdint.h>
+#include "status_or.h"
+
+// Non-blocking I2C master. Transfers are started with one call and then advanced with Poll(),
+// which returns immediately, so they can progress across main loop iterations.
+class I2CBusInterface {
+public:
+  virtual ~I2CBusInterface() {}
+
+  // Starts reading `length` consecutive registers of the device at the 7-bit `address`,
+  // beginning at `first_register`, into `buffer`, which must remain valid until the transfer
+  // ends. Returns kExistsError if a transfer is already in progress.
+  virtual Status StartRegisterRead(uint8_t address, uint8_t first_register, uint8_t *buffer, int length) = 0;
+
+  // Advances the transfer in progress by at most one step, i.e. one byte on the bus. The bus
+  // waits between calls, so they must come at least once per byte time (9 clock cycles,
+  // 22.5 us at 400 kHz) for the transfer to go at bus speed: polling every millisecond
+  // stretches a 20-byte register read to ~24 ms.
+  // Returns kUnavailableError while in progress, kSuccess
+  // once the transfer is completed, kMalformedError if it failed (e.g. the device did not
+  // acknowledge), and kDoesNotExistError if no transfer was started.
+  virtual Status Poll() = 0;
+
+  // Ends the transfer in progress, if any, and releases the bus.
+  virtual void Abort() = 0;
+};
+
+#endif  // I2C_BUS_INTERFACE_
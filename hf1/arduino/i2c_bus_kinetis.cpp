@@ -0,0 +1,108 @@
+#include "i2c_bus_kinetis.h"
+
+#include <Arduino.h>
+
+// See chapter 44 (Inter-Integrated Circuit) of the K20 Sub-Family Reference Manual.
+
+I2CBusKinetis::I2CBusKinetis() : state_(kIdle), buffer_(nullptr), length_(0), num_received_(0) {}
+
+Status I2CBusKinetis::StartRegisterRead(uint8_t address, uint8_t first_register, uint8_t *buffer, int length) {
+  ASSERT(length > 0);
+  if (state_ != kIdle) {
+    return kExistsError;
+  }
+  address_ = address;
+  first_register_ = first_register;
+  buffer_ = ASSERT_NOT_NULL(buffer);
+  length_ = length;
+  num_received_ = 0;
+  state_ = kWaitingForBus;
+  return kSuccess;
+}
+
+Status I2CBusKinetis::Poll() {
+  switch (state_) {
+    case kIdle:
+      return kDoesNotExistError;
+    case kWaitingForBus:
+      if (I2C0_S & I2C_S_BUSY) {
+        return kUnavailableError;
+      }
+      I2C0_S = I2C_S_IICIF | I2C_S_ARBL;
+      // Becoming master generates a start condition.
+      I2C0_C1 = I2C_C1_IICEN | I2C_C1_MST | I2C_C1_TX;
+      I2C0_D = address_ << 1;
+      state_ = kSendingWriteAddress;
+      return kUnavailableError;
+    default:
+      break;
+  }
+
+  // Take the next step if the hardware has completed the last one. A byte takes 9 clock
+  // cycles, so the next one is never complete by the end of this call.
+  if (I2C0_S & I2C_S_IICIF) {
+    const uint8_t status = I2C0_S;
+    I2C0_S = I2C_S_IICIF | (status & I2C_S_ARBL);
+    if (status & I2C_S_ARBL) {
+      // The module has already left master mode.
+      state_ = kIdle;
+      return kMalformedError;
+    }
+    switch (state_) {
+      case kSendingWriteAddress:
+        if (status & I2C_S_RXAK) { return Finish(kMalformedError); }
+        I2C0_D = first_register_;
+        state_ = kSendingRegister;
+        break;
+
+      case kSendingRegister:
+        if (status & I2C_S_RXAK) { return Finish(kMalformedError); }
+        I2C0_C1 = I2C_C1_IICEN | I2C_C1_MST | I2C_C1_TX | I2C_C1_RSTA;
+        I2C0_D = (address_ << 1) | 1;
+        state_ = kSendingReadAddress;
+        break;
+
+      case kSendingReadAddress:
+        if (status & I2C_S_RXAK) { return Finish(kMalformedError); }
+        // Do not acknowledge the last byte, so the device releases the bus.
+        I2C0_C1 = I2C_C1_IICEN | I2C_C1_MST | (length_ == 1 ? I2C_C1_TXAK : 0);
+        // Reading the data register in receive mode clocks in the next byte.
+        (void)I2C0_D;
+        state_ = kReceiving;
+        break;
+
+      case kReceiving:
+        if (num_received_ == length_ - 1) {
+          // Generate the stop condition before reading the last byte, so no more are clocked in.
+          I2C0_C1 = I2C_C1_IICEN;
+          buffer_[num_received_++] = I2C0_D;
+          state_ = kIdle;
+          return kSuccess;
+        }
+        if (num_received_ == length_ - 2) {
+          I2C0_C1 = I2C_C1_IICEN | I2C_C1_MST | I2C_C1_TXAK;
+        }
+        buffer_[num_received_++] = I2C0_D;
+        break;
+
+      default:
+        ASSERTM(false, "Unexpected I2C state.");
+        break;
+    }
+  }
+  return kUnavailableError;
+}
+
+void I2CBusKinetis::Abort() {
+  if (state_ != kIdle && state_ != kWaitingForBus) {
+    Finish(kUnavailableError);
+  }
+  state_ = kIdle;
+}
+
+Status I2CBusKinetis::Finish(Status status) {
+  // Leaving master mode generates a stop condition.
+  I2C0_C1 = I2C_C1_IICEN;
+  state_ = kIdle;
+  return status;
+}
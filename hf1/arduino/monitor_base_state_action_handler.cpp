@@ -15,9 +15,7 @@ bool MonitorBaseStateActionHandler::Run() {
       num_remaining_messages_ = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.max_updates));
       last_state_update_ns_ = 0;
       
-      char str[48];
-      sprintf(str, "monitor_base_state(max_updates=%d)", num_remaining_messages_);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatMonitorBaseState, num_remaining_messages_);
       if (num_remaining_messages_ == 1) {
         if (TrySendingReply()) { 
           --num_remaining_messages_;
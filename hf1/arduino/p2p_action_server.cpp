@@ -1,10 +1,11 @@
 #include "p2p_action_server.h"
 #include "utils.h"
 #include "logger_interface.h"
+#include "profiler.h"
 #include <cstring>
 
 P2PActionServer::P2PActionServer(P2PPacketStreamArduino *p2p_stream)
-  : p2p_stream_(*ASSERT_NOT_NULL(p2p_stream)) {
+  : p2p_stream_(*ASSERT_NOT_NULL(p2p_stream)), handlers_{} {
   p2p_stream_.other_end_started_callback(P2POtherEndStartedCallback(&P2PActionServer::OnOtherEndStarted, this));
 }
 
@@ -34,7 +35,7 @@ void P2PActionServer::RunActions() {
 void P2PActionServer::InitActionsIfNeeded() {
   for (int i = 0; i < P2PAction::kCount; ++i) {
     P2PActionHandlerBase *handler = handlers_[i];
-    if (!handler->is_initialized()) {
+    if (handler != NULL && !handler->is_initialized()) {
       handler->Init();
       handler->is_initialized(true);
     }
@@ -73,7 +74,11 @@ StatusOr<const P2PPacketView> P2PActionServer::GetRequestOrCancellation() const
   }
 
   if (app_header->stage == P2PActionStage::kRequest) {
-    ASSERT(maybe_oldest_packet_view->length() == sizeof(P2PApplicationPacketHeader) + handler->GetExpectedRequestSize());
+    if (!handler->IsRequestSizeValid(maybe_oldest_packet_view->length() - sizeof(P2PApplicationPacketHeader))) {
+      LOG_WARNING("Received request of unexpected size.");
+      p2p_stream_.input().Consume(maybe_oldest_packet_view->priority());
+      return Status::kMalformedError;
+    }
   } else {
     ASSERT(maybe_oldest_packet_view->length() == sizeof(P2PApplicationPacketHeader));
   }
@@ -82,6 +87,7 @@ StatusOr<const P2PPacketView> P2PActionServer::GetRequestOrCancellation() const
 }
 
 void P2PActionServer::Run() {
+  PROFILE_SCOPE("action_server");
   InitActionsIfNeeded();
   RunActions();
 
@@ -101,6 +107,7 @@ void P2PActionServer::Run() {
       handler->run_state(P2PActionHandlerBase::RunState::kIdle);
       // The handler can first retrieve the request directly from the input stream.
       handler->request_bytes(maybe_packet->content() + sizeof(P2PApplicationPacketHeader));
+      handler->request_size(maybe_packet->length() - sizeof(P2PApplicationPacketHeader));
       // The request determines the action's priority. This affects the reply and progress 
       // priorities, not the action's scheduling.
       handler->request_priority(maybe_packet->priority());
@@ -109,7 +116,7 @@ void P2PActionServer::Run() {
         if (handler->Run()) {
           // The action goes on. Further calls to run will operate on a copy, as the input 
           // packet must be consumed for other packets to be processed.
-          memcpy(handler->GetRequestCopyBuffer(), maybe_packet->content() + sizeof(P2PApplicationPacketHeader), handler->GetExpectedRequestSize());
+          memcpy(handler->GetRequestCopyBuffer(), maybe_packet->content() + sizeof(P2PApplicationPacketHeader), handler->request_size());
           handler->request_bytes(handler->GetRequestCopyBuffer());    
           handler->run_state(P2PActionHandlerBase::RunState::kRunning);
         }
@@ -17,6 +17,8 @@ public:
     : action_handler_(ASSERT_NOT_NULL(action_handler)), packet_view_(packet_view) {}
 
   TPacket *operator->();
+  // Shortens the payload to its first `length` bytes, for variable-length packets.
+  void payload_length(int length);
   void Commit(bool guarantee_delivery = false);
 
 protected:
@@ -31,7 +33,7 @@ public:
   typedef enum { kIdle, kRunning } RunState;
 
   P2PActionHandlerBase(P2PAction action, P2PPacketStreamArduino *p2p_stream)
-    : is_registered_(false), is_initialized_(false), action_(action), request_priority_(P2PPriority::kMedium), p2p_stream_(p2p_stream), run_state_(RunState::kIdle) {}
+    : is_registered_(false), is_initialized_(false), action_(action), request_priority_(P2PPriority::kMedium), p2p_stream_(p2p_stream), run_state_(RunState::kIdle), request_size_(0) {}
 
   bool is_registered() const { return is_registered_; }
   void is_registered(bool ir) { is_registered_ = ir; }
@@ -48,13 +50,20 @@ public:
 
   const uint8_t *request_bytes() const { return request_bytes_; }
   void request_bytes(const uint8_t *request_bytes) { request_bytes_ = request_bytes; }
+  // Size of the request that triggered the action.
+  int request_size() const { return request_size_; }
+  void request_size(int size) { request_size_ = size; }
 
   // Returns a pointer to a buffer where to copy the request when the action takes longer than a call to Run().
   virtual uint8_t *GetRequestCopyBuffer() = 0;
 
-  // Returns the expected request size.
+  // Returns the expected request size, or the maximum one for variable-length requests.
   virtual int GetExpectedRequestSize() const = 0;
 
+  // Returns whether a request of `size` bytes is well formed. Requests of other sizes are
+  // dropped. Variable-length requests must override it.
+  virtual bool IsRequestSizeValid(int size) const { return size == GetExpectedRequestSize(); }
+
   // Called once from the server's Run() before any other callbacks.
   virtual void Init() {}
 
@@ -88,6 +97,7 @@ private:
   RunState run_state_;
   P2PPacketView app_packet_view_;
   const uint8_t *request_bytes_;
+  int request_size_;
 };
 
 typedef struct {} VoidPacket;
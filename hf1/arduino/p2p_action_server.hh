@@ -8,6 +8,12 @@ TPacket *P2PActionPacketAdapter<TPacket>::operator->() {
   return reinterpret_cast<TPacket *>(packet_view_.content() + sizeof(P2PApplicationPacketHeader));
 }
 
+template<typename TPacket>
+void P2PActionPacketAdapter<TPacket>::payload_length(int length) {
+  ASSERT(length >= 0 && length <= static_cast<int>(sizeof(TPacket)));
+  packet_view_.length() = sizeof(P2PApplicationPacketHeader) + length;
+}
+
 template<typename TRequest, typename TReply, typename TProgress>
 const TRequest &P2PActionHandler<TRequest, TReply, TProgress>::GetRequest() const {
   return *reinterpret_cast<const TRequest *>(request_bytes());
@@ -1,71 +1,61 @@
 #include "periodic_runnable.h"
-#if kEnableStats
-#include "logger.h"
-#include <cstring>
-#include <stdio.h>
-#endif
-#define kPrintStatsPeriodNs 1'000'000'000
+#include <string.h>
 
 PeriodicRunnable::PeriodicRunnable(const char *name, TimerNanosType period_nanos)
   : is_first_run_(true), 
     period_nanos_(period_nanos), 
-  #if kEnableStats
-    last_call_nanos_(0), 
-    last_num_runs_(0), 
-    last_stats_printed_ns_(-1ULL) 
-  #else
-    last_call_nanos_(0)
-  #endif
-    {
-  #if kEnableStats
-      strncpy(name_, name, kMaxNameLength - 1);
-  #endif
-    }
+    last_call_nanos_(0),
+    next_run_nanos_(0),
+    num_skipped_periods_(0),
+    num_overruns_(0) {
+  strncpy(name_, name, kMaxNameLength - 1);
+  name_[kMaxNameLength - 1] = '\0';
+}
 
 PeriodicRunnable::PeriodicRunnable(const char *name, TimerSecondsType period_seconds)
   : PeriodicRunnable(name, NanosFromSeconds(period_seconds)) {}
 
-void PeriodicRunnable::Run() {
+void PeriodicRunnable::ClearStats() {
+  num_skipped_periods_ = 0;
+  num_overruns_ = 0;
+  period_error_histogram_.Clear();
+  run_histogram_.Clear();
+}
+
+bool PeriodicRunnable::Run() {
   const auto now_nanos = GetTimerNanoseconds();
   if (is_first_run_) {
     is_first_run_ = false;
     last_call_nanos_ = now_nanos;    
+    next_run_nanos_ = now_nanos + period_nanos_;
     RunFirstTime(now_nanos);
-    return;
-  }
-
-  #if kEnableStats
-  if (last_stats_printed_ns_ == -1ULL) {
-    last_stats_printed_ns_ = now_nanos;
-  } else {
-    if (now_nanos - last_stats_printed_ns_ > kPrintStatsPeriodNs) {
-      last_stats_printed_ns_ = now_nanos;
-      PrintStats();
-      last_num_runs_ = 0;
-    }
+    run_histogram_.Add(GetTimerNanoseconds() - now_nanos);
+    return true;
   }
-  #endif
 
-  const TimerNanosType nanos_since_last_call = now_nanos - last_call_nanos_;
-  if (nanos_since_last_call < period_nanos_) {
+  if (now_nanos < next_run_nanos_) {
     // Period not elapsed yet.
-    return;
+    return false;
   }
+  const TimerNanosType nanos_since_last_call = now_nanos - last_call_nanos_;
   last_call_nanos_ = now_nanos;
+  period_error_histogram_.Add(now_nanos - next_run_nanos_);
+  // Advance to the first period starting in the future. Usually that is the next one, which
+  // spares the 64-bit division the Cortex-M4 emulates in software.
+  next_run_nanos_ += period_nanos_;
+  if (now_nanos >= next_run_nanos_) {
+    const TimerNanosType num_skipped_periods = (now_nanos - next_run_nanos_) / period_nanos_ + 1;
+    next_run_nanos_ += num_skipped_periods * period_nanos_;
+    num_skipped_periods_ += num_skipped_periods;
+  }
 
   // Period elapsed.
   RunAfterPeriod(now_nanos, nanos_since_last_call);
-#if kEnableStats  
-  ++last_num_runs_;
-#endif
-}
 
-#if kEnableStats  
-void PeriodicRunnable::PrintStats() {
-  char tmp[96];
-  const float expected_freq = 1'000'000'000 / static_cast<float>(period_nanos_);
-  const float measured_freq = 1'000'000'000 * (last_num_runs_ / static_cast<float>(kPrintStatsPeriodNs));  
-  sprintf(tmp, "%s expected:%.2f Hz measured:%.2f Hz", name_, expected_freq, measured_freq);
-  LOG_INFO(tmp);
+  const TimerNanosType end_nanos = GetTimerNanoseconds();
+  run_histogram_.Add(end_nanos - now_nanos);
+  if (end_nanos > next_run_nanos_) {
+    ++num_overruns_;
+  }
+  return true;
 }
-#endif
\ No newline at end of file
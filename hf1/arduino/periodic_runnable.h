@@ -1,25 +1,55 @@
 #ifndef PERIODIC_RUNNABLE_
 #define PERIODIC_RUNNABLE_
 
-#define kEnableStats 0
-
 #define kMaxNameLength 32
 
 #include "timer.h"
+#include "log_histogram.h"
+#include "p2p_application_protocol.h"
 
-// When the Run() method is called in a busy loop, it calls the RunAfterPeriod() every
-// `period_seconds` seconds.
+// When the Run() method is called in a busy loop or by a Scheduler, it calls the
+// RunAfterPeriod() every `period_seconds` seconds.
+//
+// Periods are anchored to the first call to Run(), so a late call does not delay the
+// following ones. If a call is later than a whole period, the missed periods are skipped
+// rather than run back to back.
+//
+// Timing stats are always collected: how late every run started with respect to the start
+// of its period (period error), how long it took and how many runs overran into the next
+// period. They take a fixed amount of memory and a couple of timer reads per run.
 class PeriodicRunnable {
 public:
+  typedef LogHistogram<kP2PPeriodicRunnablePeriodErrorHistogramNumBuckets, kP2PPeriodicRunnablePeriodErrorHistogramMinBucketLog2> PeriodErrorHistogram;
+  typedef LogHistogram<kP2PPeriodicRunnableRunHistogramNumBuckets, kP2PPeriodicRunnableRunHistogramMinBucketLog2> RunHistogram;
+
   // Creates a periodic runnable with the given period.
   PeriodicRunnable(const char *name, TimerNanosType period_nanos); 
   PeriodicRunnable(const char *name, TimerSecondsType period_seconds);
 
+  const char *name() const { return name_; }
   TimerNanosType period_nanos() const { return period_nanos_; }
 
+  // Start of the next period, when Run() will call RunAfterPeriod() again.
+  // It is 0 before the first call to Run().
+  TimerNanosType next_run_nanos() const { return next_run_nanos_; }
+
+  // Number of periods skipped because Run() was called too late.
+  uint32_t num_skipped_periods() const { return num_skipped_periods_; }
+  // Number of runs that ended after the start of the next period.
+  uint32_t num_overruns() const { return num_overruns_; }
+  // Time between the start of each period and the start of its run. The first run, which
+  // starts the first period, is not included.
+  const PeriodErrorHistogram &period_error_histogram() const { return period_error_histogram_; }
+  // Duration of every run.
+  const RunHistogram &run_histogram() const { return run_histogram_; }
+
+  // Clears the timing stats.
+  void ClearStats();
+
   // Will call RunAfterPeriod() every given period.
-  // Must be called in a busy loop at a higher rate than the runnable period. 
-  void Run();
+  // Must be called at a higher rate than the runnable period. Returns true if it called
+  // RunFirstTime() or RunAfterPeriod().
+  bool Run();
 
 protected:
   // Subclasses may override this function. It is called the first time Run() is called.
@@ -33,11 +63,11 @@ private:
   bool is_first_run_;
   const TimerNanosType period_nanos_;
   TimerNanosType last_call_nanos_;
-#if kEnableStats  
-  void PrintStats();
-  int last_num_runs_;
-  TimerNanosType last_stats_printed_ns_;
-#endif
+  TimerNanosType next_run_nanos_;
+  uint32_t num_skipped_periods_;
+  uint32_t num_overruns_;
+  PeriodErrorHistogram period_error_histogram_;
+  RunHistogram run_histogram_;
 };
 
-#endif  // PERIODIC_RUNNABLE_
\ No newline at end of file
+#endif  // PERIODIC_RUNNABLE_
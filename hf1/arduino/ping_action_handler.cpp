@@ -0,0 +1,56 @@
+#include "ping_action_handler.h"
+#include <stddef.h>
+#include <string.h>
+
+#define kRequestPayloadOffset offsetof(P2PPingRequest, payload)
+#define kReplyPayloadOffset offsetof(P2PPingReply, payload)
+
+// Every byte before the payload might be a token, and double in size once escaped.
+static_assert(2 * (sizeof(P2PApplicationPacketHeader) + kReplyPayloadOffset) + kP2PMaxPingPayloadLength <= kP2PMaxContentLength);
+
+PingActionHandler::PingActionHandler(P2PPacketStreamArduino *p2p_stream, TimerInterface *system_timer)
+  : P2PActionHandler<P2PPingRequest, P2PPingReply>(P2PAction::kPing, p2p_stream),
+    system_timer_(*ASSERT_NOT_NULL(system_timer)) {}
+
+bool PingActionHandler::IsRequestSizeValid(int size) const {
+  return size >= static_cast<int>(kRequestPayloadOffset) && size <= static_cast<int>(sizeof(P2PPingRequest));
+}
+
+bool PingActionHandler::OnRequest() {
+  // The packet should still be in the input stream at this call.
+  const auto maybe_request_packet = p2p_stream().input().OldestPacket();
+  ASSERT(maybe_request_packet.ok());
+  request_reception_local_ns_ = maybe_request_packet->reception_local_time_ns();
+
+  // Payload bytes that need escaping might not fit in the reply.
+  const P2PPingRequest &request = GetRequest();
+  const int payload_length = request_size() - kRequestPayloadOffset;
+  for (int i = 0; i < payload_length; ++i) {
+    if (request.payload[i] >= kP2PLowestToken) {
+      LOG_WARNING("Ping payload with bytes above the lowest token.");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PingActionHandler::Run() {
+  auto maybe_reply = NewReply();
+  if (!maybe_reply.ok()) {
+    // Output buffer is full: keep trying. The wait counts as round trip time, not as
+    // processing time.
+    return true;
+  }
+
+  const P2PPingRequest &request = GetRequest();
+  const int payload_length = request_size() - kRequestPayloadOffset;
+  (*maybe_reply)->client_send_ns = request.client_send_ns;
+  (*maybe_reply)->server_receive_ns = LocalToNetwork<kP2PLocalEndianness>(request_reception_local_ns_);
+  memcpy((*maybe_reply)->payload, request.payload, payload_length);
+  maybe_reply->payload_length(kReplyPayloadOffset + payload_length);
+  // Stamp as late as possible, so that only the time the reply waits in the output queue
+  // is left out.
+  (*maybe_reply)->server_transmit_ns = LocalToNetwork<kP2PLocalEndianness>(system_timer_.GetLocalNanoseconds());
+  maybe_reply->Commit(request.guarantee_reply_delivery != 0);
+  return false;
+}
@@ -0,0 +1,22 @@
+#ifndef PING_ACTION_HANDLER_
+#define PING_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "timer_interface.h"
+
+// Echoes ping requests, timestamped with their reception and the reply's transmission.
+class PingActionHandler : public P2PActionHandler<P2PPingRequest, P2PPingReply> {
+public:
+  // Does not take ownsership of the pointees, which must outlive this object.
+  PingActionHandler(P2PPacketStreamArduino *p2p_stream, TimerInterface *system_timer);
+
+  bool IsRequestSizeValid(int size) const override;
+  bool OnRequest() override;
+  bool Run() override;
+
+private:
+  TimerInterface &system_timer_;
+  uint64_t request_reception_local_ns_;
+};
+
+#endif  // PING_ACTION_HANDLER_
@@ -0,0 +1,44 @@
+#include "record_base_state_events_action_handler.h"
+#include "logger_interface.h"
+
+// Events are batched to amortize the packet overhead. A batch is sent when it has this many
+// events, or when its oldest event has waited for kMaxBatchDelayNs.
+#define kMinEventsPerBatch 16
+#define kMaxBatchDelayNs 50'000'000
+
+bool RecordBaseStateEventsActionHandler::OnRequest() {
+  LOG_INFO("record_base_state_events()");
+  recorder_.Start();
+  last_progress_ns_ = GetTimerNanoseconds();
+  return true;
+}
+
+bool RecordBaseStateEventsActionHandler::Run() {
+  if (recorder_.num_pending_events() == 0) {
+    last_progress_ns_ = GetTimerNanoseconds();
+  } else if (recorder_.num_pending_events() >= kMinEventsPerBatch ||
+             GetTimerNanoseconds() - last_progress_ns_ >= kMaxBatchDelayNs) {
+    TrySendingProgress();
+  }
+  return true;  // Record until cancelled.
+}
+
+void RecordBaseStateEventsActionHandler::OnCancel() {
+  recorder_.Stop();
+}
+
+bool RecordBaseStateEventsActionHandler::TrySendingProgress() {
+  StatusOr<P2PActionPacketAdapter<P2PRecordBaseStateEventsProgress>> maybe_progress = NewProgress();
+  if (!maybe_progress.ok()) {
+    // Events keep accumulating in the recorder, which counts those that do not fit.
+    return false;
+  }
+  P2PActionPacketAdapter<P2PRecordBaseStateEventsProgress> progress = *maybe_progress;
+  BaseStateEventBatchEncoder encoder(progress.operator->());
+  recorder_.Flush(&encoder);
+  progress.payload_length(encoder.payload_length());
+  // Guarantee delivery, so that every event lost is accounted for in num_dropped_events.
+  progress.Commit(/*guarantee_delivery=*/true);
+  last_progress_ns_ = GetTimerNanoseconds();
+  return true;
+}
@@ -0,0 +1,26 @@
+#ifndef RECORD_BASE_STATE_EVENTS_ACTION_HANDLER_
+#define RECORD_BASE_STATE_EVENTS_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "base_state_event_recorder.h"
+#include "timer.h"
+
+class RecordBaseStateEventsActionHandler : public P2PActionHandler<P2PVoid, P2PVoid, P2PRecordBaseStateEventsProgress> {
+public:
+  // Does not take ownsership of the pointees, which must outlive this object.
+  RecordBaseStateEventsActionHandler(P2PPacketStreamArduino *p2p_stream, BaseStateEventRecorder *recorder)
+    : P2PActionHandler<P2PVoid, P2PVoid, P2PRecordBaseStateEventsProgress>(P2PAction::kRecordBaseStateEvents, p2p_stream),
+      recorder_(*ASSERT_NOT_NULL(recorder)) {}
+
+  bool OnRequest() override;
+  bool Run() override;
+  void OnCancel() override;
+
+private:
+  bool TrySendingProgress();
+
+  BaseStateEventRecorder &recorder_;
+  TimerNanosType last_progress_ns_;
+};
+
+#endif  // RECORD_BASE_STATE_EVENTS_ACTION_HANDLER_
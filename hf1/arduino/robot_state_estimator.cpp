@@ -3,37 +3,44 @@
 #include "timer.h"
 #include "encoders.h"
 #include "body_imu.h"
+#include "bno055_reader.h"
+#include "base_state_events.h"
 #include "base_state_filter.h"
+#include "complementary_base_state_filter.h"
+#include "robot_state_estimator.h"
 #include "logger_interface.h"
+#include "profiler.h"
 
 #define kEventRingBufferCapacity 16
-#define kMinIMUPollingPeriodNs 20'000'000
-
-typedef enum {
-  kLeftWheelTick,
-  kRightWheelTick,
-  kLeftWheelDirectionCommand,
-  kRightWheelDirectionCommand,
-  kIMUReading,
-} EventType;
-
-typedef struct {
-  EventType type;
-  TimerTicksType timer_ticks;
-  union {
-    struct {
-      bool is_forward;
-    } wheel_direction;
-    struct {  
-      float position_acceleration[3];
-      float attitude[3];
-    } imu;
-  } payload;
-} Event;
+// The BNO055 fusion outputs are updated at 100 Hz.
+#define kMinIMUPollingPeriodNs 10'000'000
+
+// Filter estimating the base state at startup. It can be changed at runtime with 
+// SetBaseStateFilterType().
+#ifndef kDefaultBaseStateFilterType
+#define kDefaultBaseStateFilterType kKalmanBaseStateFilter
+#endif
 
 static BodyIMU body_imu;
+static BNO055Reader *imu_reader = nullptr;
 static RingBuffer<Event, kEventRingBufferCapacity> event_buffer;
-static BaseStateFilter base_state_filter;
+static BaseStateFilter kalman_base_state_filter;
+static ComplementaryBaseStateFilter complementary_base_state_filter;
+static BaseStateFilterType base_state_filter_type = kDefaultBaseStateFilterType;
+static BaseStateFilterInterface *base_state_filter = nullptr;
+static BaseStateEventRecorder *base_state_event_recorder = nullptr;
+
+static BaseStateFilterInterface *GetBaseStateFilter(BaseStateFilterType type) {
+  switch (type) {
+    case kKalmanBaseStateFilter:
+      return &kalman_base_state_filter;
+    case kComplementaryBaseStateFilter:
+      return &complementary_base_state_filter;
+    default:
+      ASSERTM(false, "Unknown base state filter type.");
+      return nullptr;
+  }
+}
 
 static void LeftEncoderIsr(TimerTicksType timer_ticks) {
   // We have exclusive access to the event buffer while in the ISR.
@@ -47,25 +54,27 @@ static void RightEncoderIsr(TimerTicksType timer_ticks) {
 
 TimerNanosType last_imu_poll_time_ns;
 
-void InitRobotStateEstimator() {
+void InitRobotStateEstimator(I2CBusInterface *imu_bus) {
+  base_state_filter = GetBaseStateFilter(base_state_filter_type);
   AddEncoderIsrs(&LeftEncoderIsr, &RightEncoderIsr);
 
   last_imu_poll_time_ns = 0;
   LOG_INFO("Initializing body IMU...");
+  // Configuration is blocking, but it only happens once.
   body_imu.Init();
+  static BNO055Reader bno055_reader(imu_bus);
+  imu_reader = &bno055_reader;
 }
 
-static void RegisterIMUEvent() {  
-  const auto attitude = body_imu.GetYawPitchRoll();
-  const auto accels = body_imu.GetLinearAccelerations();
+static void RegisterIMUEvent(const BNO055Reading &reading, TimerTicksType timer_ticks) {
   NO_TIMER_IRQ {
     event_buffer.Write(Event{ 
       .type = kIMUReading, 
-      .timer_ticks = GetTimerTicks(), 
+      .timer_ticks = timer_ticks,
       .payload = {
         .imu = { 
-          .position_acceleration = { static_cast<float>(accels.x()), static_cast<float>(accels.y()), static_cast<float>(accels.z()) },
-          .attitude = { static_cast<float>(attitude.x()), static_cast<float>(attitude.y()), static_cast<float>(attitude.z()) },
+          .position_acceleration = { reading.linear_acceleration[0], reading.linear_acceleration[1], reading.linear_acceleration[2] },
+          .attitude = { reading.attitude[0], reading.attitude[1], reading.attitude[2] },
         }
       }
     });
@@ -100,19 +109,37 @@ void NotifyRightMotorDirection(TimerTicksType timer_ticks, bool forward) {
   }
 }
 
-static int CompareEventPointers(const void *p1, const void *p2) {
-  const Event * const e1 = *reinterpret_cast<const Event * const *>(p1);
-  const Event * const e2 = *reinterpret_cast<const Event * const *>(p2);
-  // Do not just subtract, as the timestamp may be of unsigned type.
-  return e1->timer_ticks < e2->timer_ticks ? -1 : (e1->timer_ticks > e2->timer_ticks ? 1 : 0);
+// Inactive filters only follow the wheel directions, so that ticks are integrated with the
+// right sign when they are switched in. The main loop queues direction commands in order,
+// so the buffer order is chronological for them.
+static void NotifyWheelDirectionsToInactiveFilters(const Event *events, int num_events) {
+  for (int type = 0; type < kNumBaseStateFilterTypes; ++type) {
+    BaseStateFilterInterface *filter = GetBaseStateFilter(static_cast<BaseStateFilterType>(type));
+    if (filter == base_state_filter) { continue; }
+    for (int i = 0; i < num_events; ++i) {
+      // As in NotifyBaseStateEvents().
+      if (events[i].type == kLeftWheelDirectionCommand) {
+        filter->NotifyLeftWheelDirection(events[i].payload.wheel_direction.is_forward);
+      } else if (events[i].type == kRightWheelDirectionCommand) {
+        filter->NotifyRightWheelDirection(events[i].payload.wheel_direction.is_forward);
+      }
+    }
+  }
 }
 
-void RunRobotStateEstimator() {
+bool RunRobotStateEstimator() {
+  PROFILE_SCOPE("state_estimator");
+  // IMU readings complete over several iterations, so they do not block the main loop.
   const TimerNanosType now_ns = GetTimerNanoseconds();
-  if (now_ns - last_imu_poll_time_ns >= kMinIMUPollingPeriodNs) {
+  if (!imu_reader->in_progress() && now_ns - last_imu_poll_time_ns >= kMinIMUPollingPeriodNs) {
     last_imu_poll_time_ns = now_ns;
-    // Poll the IMU and register event.
-    RegisterIMUEvent();
+    imu_reader->Request(GetTimerTicks());
+  }
+  const Status imu_status = imu_reader->Run();
+  if (imu_status == kSuccess) {
+    RegisterIMUEvent(imu_reader->reading(), imu_reader->reading_timer_ticks());
+  } else if (imu_status == kMalformedError) {
+    LOG_WARNING("Body IMU reading failed.");
   }
 
   // Copy all queue events to a separate buffer as processing them might take time  
@@ -126,64 +153,57 @@ void RunRobotStateEstimator() {
       events[i++] = event_buffer.Read();
     }
   }
-  if (num_events == 0) {
-    base_state_filter.EstimateState(GetTimerTicks());
-    return;
+  if (base_state_event_recorder != nullptr) {
+    base_state_event_recorder->Record(events, num_events);
   }
-  // Sort event order to process chronologically.
-  Event *event_pointers[num_events];
-  for (int i = 0; i < num_events; ++i) { event_pointers[i] = &events[i]; }
-  qsort(event_pointers, num_events, sizeof(event_pointers[0]), CompareEventPointers);
-
-  // Process events in chronological order.
-  // Serial.println("--- Processing events ---");
-  for (int i = 0; i < num_events; ++i) {
-    const Event &event = *event_pointers[i];
-    // char str[32];
-    // Uint64ToString(event.timer_ticks, str);
-    // Serial.printf("ts:%s\n", str);
-    switch (event.type) {
-      case kLeftWheelTick:
-        // Serial.printf("left wheel tick\n");
-        if (i == num_events - 1 || event_pointers[i + 1]->type != kRightWheelTick || event_pointers[i + 1]->timer_ticks != event.timer_ticks) {
-          base_state_filter.NotifyWheelTicks(event.timer_ticks, 1, 0);
-        } else {
-          // There is a tick from the other wheel at the exact same time.
-          base_state_filter.NotifyWheelTicks(event.timer_ticks, 1, 1);
-          ++i;  // The next event has been processed.
-        }
-        break;
-      case kRightWheelTick:
-        // Serial.printf("right wheel tick\n");
-        if (i == num_events - 1 || event_pointers[i + 1]->type != kLeftWheelTick || event_pointers[i + 1]->timer_ticks != event.timer_ticks) {
-          base_state_filter.NotifyWheelTicks(event.timer_ticks, 0, 1);
-        } else {
-          // There is a tick from the other wheel at the exact same time.
-          base_state_filter.NotifyWheelTicks(event.timer_ticks, 1, 1);
-          ++i;  // The next event has been processed.
-        }
-        break;
-      case kLeftWheelDirectionCommand:
-        // Serial.printf("left wheel direction command\n");
-        base_state_filter.NotifyLeftWheelDirection(event.payload.wheel_direction.is_forward);
-        break;
-      case kRightWheelDirectionCommand:
-        // Serial.printf("left wheel direction command\n");
-        base_state_filter.NotifyRightWheelDirection(event.payload.wheel_direction.is_forward);
-        break;
-      case kIMUReading:
-        // Serial.printf("IMU reading\n");
-        // Serial.printf("imu_ax:%f imu_ay:%f imu_a:%f\n", event.payload.imu.position_acceleration[0], event.payload.imu.position_acceleration[1], event.payload.imu.attitude[2]);
-        base_state_filter.NotifyIMUReading(event.timer_ticks, event.payload.imu.position_acceleration[0], event.payload.imu.position_acceleration[1], event.payload.imu.attitude[2]);
-        break;
-    }
+  if (num_events == 0) {
+    base_state_filter->EstimateState(GetTimerTicks());
+  } else {
+    NotifyBaseStateEvents(events, num_events, base_state_filter);
+    NotifyWheelDirectionsToInactiveFilters(events, num_events);
   }
+  return imu_reader->in_progress();
 }
 
 BaseState GetBaseState() {
-  return base_state_filter.state();
+  return base_state_filter->state();
 }
 
 TimerNanosType GetBaseStateUpdateNanos() {
-  return base_state_filter.state_update_nanos();
-}
\ No newline at end of file
+  return base_state_filter->state_update_nanos();
+}
+
+BaseStateFilterType GetBaseStateFilterType() {
+  return base_state_filter_type;
+}
+
+void SetBaseStateFilterType(BaseStateFilterType type) {
+  if (type == base_state_filter_type) { return; }
+  BaseStateFilterInterface *new_filter = GetBaseStateFilter(type);
+  // Continue from the last estimate, so controllers do not see a jump in the state.
+  new_filter->Reset(base_state_filter->state(), base_state_filter->state_update_timer_ticks());
+  base_state_filter = new_filter;
+  base_state_filter_type = type;
+}
+
+void SetBaseStateEventRecorder(BaseStateEventRecorder *recorder) {
+  base_state_event_recorder = recorder;
+}
+
+RingBufferStats GetEventBufferStats() {
+  RingBufferStats stats;
+  NO_TIMER_IRQ {
+    stats = event_buffer.stats();
+  }
+  return stats;
+}
+
+void ClearEventBufferStats() {
+  NO_TIMER_IRQ {
+    event_buffer.ClearStats();
+  }
+}
+
+int GetEventBufferCapacity() {
+  return event_buffer.Capacity() - 1;
+}
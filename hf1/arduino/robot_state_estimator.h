@@ -3,12 +3,37 @@
 
 #include "base_state.h"
 #include "timer.h"
+#include "p2p_application_protocol.h"
+#include "base_state_event_recorder.h"
+#include "i2c_bus_interface.h"
+#include "ring_buffer.h"
 
-void InitRobotStateEstimator();
-void RunRobotStateEstimator();
+using BaseStateFilterType = P2PBaseStateFilterType;
+
+// The body IMU is read through `imu_bus` after its initial configuration.
+// Does not take ownership of the pointee, which must outlive the estimator.
+void InitRobotStateEstimator(I2CBusInterface *imu_bus);
+// Returns true while an IMU reading is in progress: its bus transfer only advances when
+// polled, so the caller must not idle until the next interrupt.
+bool RunRobotStateEstimator();
 BaseState GetBaseState();
 TimerNanosType GetBaseStateUpdateNanos();
 void NotifyLeftMotorDirection(TimerTicksType timer_ticks, bool forward);
 void NotifyRightMotorDirection(TimerTicksType timer_ticks, bool forward);
 
+// Selects the filter fusing odometry and IMU events into the base state.
+// The new filter starts from the last estimate of the previous one.
+BaseStateFilterType GetBaseStateFilterType();
+void SetBaseStateFilterType(BaseStateFilterType type);
+
+// Passes every event consumed by the estimator to `recorder`, which only keeps them while
+// recording. Does not take ownership of the pointee, which must outlive the estimator.
+void SetBaseStateEventRecorder(BaseStateEventRecorder *recorder);
+
+// Occupancy stats of the buffer where the ISRs queue events for the estimator.
+RingBufferStats GetEventBufferStats();
+void ClearEventBufferStats();
+// Number of events the buffer can hold.
+int GetEventBufferCapacity();
+
 #endif  // ROBOT_STATE_ESTIMATOR_
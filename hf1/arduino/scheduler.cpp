@@ -0,0 +1,99 @@
+#include "scheduler.h"
+#include "logger_interface.h"
+
+void Scheduler::WaitForInterrupt(TimerNanosType until_nanos) {
+#ifdef ARDUINO
+  // The system tick interrupt wakes up the CPU every millisecond, so the wait is never much
+  // longer than that, even if no other interrupt comes.
+  asm volatile("wfi");
+#endif
+}
+
+Scheduler::Scheduler(IdleFunction idle_function)
+  : idle_function_(idle_function), num_periodic_tasks_(0), num_background_tasks_(0), num_input_tasks_(0), num_idles_(0) {}
+
+void Scheduler::AddPeriodicTask(PeriodicRunnable *task) {
+  ASSERTM(num_periodic_tasks_ < kMaxSchedulerPeriodicTasks, "Too many periodic tasks.");
+  periodic_tasks_[num_periodic_tasks_] = ASSERT_NOT_NULL(task);
+  ++num_periodic_tasks_;
+}
+
+void Scheduler::AddBackgroundTask(BackgroundFunction function, void *arg, TimerNanosType budget_nanos) {
+  ASSERTM(num_background_tasks_ < kMaxSchedulerBackgroundTasks, "Too many background tasks.");
+  background_tasks_[num_background_tasks_].function = ASSERT_NOT_NULL(function);
+  background_tasks_[num_background_tasks_].arg = arg;
+  background_tasks_[num_background_tasks_].budget_nanos = budget_nanos;
+  background_tasks_[num_background_tasks_].stats = BackgroundTaskStats{};
+  ++num_background_tasks_;
+}
+
+void Scheduler::AddInputTask(InputFunction function, void *arg) {
+  ASSERTM(num_input_tasks_ < kMaxSchedulerInputTasks, "Too many input tasks.");
+  input_tasks_[num_input_tasks_].function = ASSERT_NOT_NULL(function);
+  input_tasks_[num_input_tasks_].arg = arg;
+  ++num_input_tasks_;
+}
+
+TimerNanosType Scheduler::NextPeriodStartNanos() const {
+  TimerNanosType next_period_start_nanos = ~0ULL;
+  for (int i = 0; i < num_periodic_tasks_; ++i) {
+    if (periodic_tasks_[i]->next_run_nanos() < next_period_start_nanos) {
+      next_period_start_nanos = periodic_tasks_[i]->next_run_nanos();
+    }
+  }
+  return next_period_start_nanos;
+}
+
+void Scheduler::RunOnce() {
+  bool has_pending_work = false;
+  for (int i = 0; i < num_input_tasks_; ++i) {
+    if (input_tasks_[i].function(input_tasks_[i].arg)) {
+      has_pending_work = true;
+    }
+  }
+
+  // Earliest deadline first. Tasks whose period starts while others run are considered too,
+  // but every task runs at most once, so that background tasks are not starved if the
+  // periodic ones take longer than their periods.
+  uint32_t ran_tasks = 0;
+  static_assert(kMaxSchedulerPeriodicTasks <= 32);
+  for (;;) {
+    const TimerNanosType now_nanos = GetTimerNanoseconds();
+    int earliest_deadline_task = -1;
+    TimerNanosType earliest_deadline_nanos = 0;
+    for (int i = 0; i < num_periodic_tasks_; ++i) {
+      const PeriodicRunnable &task = *periodic_tasks_[i];
+      if ((ran_tasks & (1UL << i)) || task.next_run_nanos() > now_nanos) { continue; }
+      const TimerNanosType deadline_nanos = task.next_run_nanos() + task.period_nanos();
+      if (earliest_deadline_task < 0 || deadline_nanos < earliest_deadline_nanos) {
+        earliest_deadline_task = i;
+        earliest_deadline_nanos = deadline_nanos;
+      }
+    }
+    if (earliest_deadline_task < 0) { break; }
+    ran_tasks |= 1UL << earliest_deadline_task;
+    periodic_tasks_[earliest_deadline_task]->Run();
+  }
+
+  const TimerNanosType next_period_start_nanos = NextPeriodStartNanos();
+  for (int i = 0; i < num_background_tasks_; ++i) {
+    auto &background_task = background_tasks_[i];
+    const TimerNanosType start_nanos = GetTimerNanoseconds();
+    TimerNanosType now_nanos = start_nanos;
+    bool has_more_work;
+    do {
+      has_more_work = background_task.function(background_task.arg);
+      now_nanos = GetTimerNanoseconds();
+    } while (has_more_work && now_nanos - start_nanos < background_task.budget_nanos && now_nanos < next_period_start_nanos);
+    ++background_task.stats.num_runs;
+    if (has_more_work) {
+      ++background_task.stats.num_budget_exhaustions;
+      has_pending_work = true;
+    }
+  }
+
+  if (!has_pending_work && GetTimerNanoseconds() < NextPeriodStartNanos()) {
+    ++num_idles_;
+    idle_function_(NextPeriodStartNanos());
+  }
+}
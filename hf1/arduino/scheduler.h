@@ -0,0 +1,94 @@
+#ifndef SCHEDULER_
+#define SCHEDULER_
+
+#include "periodic_runnable.h"
+#include "timer.h"
+
+#define kMaxSchedulerPeriodicTasks 12
+#define kMaxSchedulerBackgroundTasks 4
+#define kMaxSchedulerInputTasks 2
+
+// Cooperative scheduler for the main loop.
+//
+// Every iteration of RunOnce():
+// 0. Runs the input tasks (e.g. state estimation), so that the periodic tasks act on the
+//    latest inputs. Input tasks may report pending work, e.g. a bus transfer to poll.
+// 1. Runs the periodic tasks whose period has started, earliest deadline (end of the period)
+//    first, and each at most once.
+// 2. Runs the background tasks (e.g. communications), each within its time budget and
+//    without going past the start of the next period of any periodic task.
+// 3. If no input or background task has pending work, idles until the next period starts. Interrupts
+//    may end the idle time earlier.
+class Scheduler {
+public:
+  // Called to idle until `until_nanos`, as returned by GetTimerNanoseconds(). It may return
+  // earlier. On the host, it may simply advance the virtual clock.
+  typedef void (*IdleFunction)(TimerNanosType until_nanos);
+
+  // Does a slice of background work. Returns true if more work is pending.
+  typedef bool (*BackgroundFunction)(void *arg);
+
+  // Updates the inputs of the periodic tasks. Returns true if an input is still being
+  // acquired and must be polled again without waiting for an interrupt.
+  typedef bool (*InputFunction)(void *arg);
+
+  // Waits for the next interrupt, which at least comes with the next system tick.
+  static void WaitForInterrupt(TimerNanosType until_nanos);
+
+  explicit Scheduler(IdleFunction idle_function = &WaitForInterrupt);
+
+  // Does not take ownership of the pointee, which must outlive this object.
+  void AddPeriodicTask(PeriodicRunnable *task);
+
+  // `function` is called repeatedly while it returns true, for up to `budget_nanos`, and at
+  // least once per iteration.
+  void AddBackgroundTask(BackgroundFunction function, void *arg, TimerNanosType budget_nanos);
+
+  // `function` is called once at the start of every iteration, before the periodic tasks,
+  // in the order the input tasks were added.
+  void AddInputTask(InputFunction function, void *arg);
+
+  // Runs one iteration. Must be called in a loop.
+  void RunOnce();
+
+  // Start of the earliest next period of all periodic tasks.
+  TimerNanosType NextPeriodStartNanos() const;
+
+  typedef struct {
+    uint32_t num_runs;
+    // Iterations in which the task still had pending work when its time was up.
+    uint32_t num_budget_exhaustions;
+  } BackgroundTaskStats;
+
+  int num_periodic_tasks() const { return num_periodic_tasks_; }
+  // The timing stats of the periodic tasks are their own (see PeriodicRunnable).
+  const PeriodicRunnable &periodic_task(int i) const { return *periodic_tasks_[i]; }
+  int num_background_tasks() const { return num_background_tasks_; }
+  const BackgroundTaskStats &background_task_stats(int i) const { return background_tasks_[i].stats; }
+  // Number of times the scheduler idled.
+  uint32_t num_idles() const { return num_idles_; }
+
+private:
+  IdleFunction idle_function_;
+
+  PeriodicRunnable *periodic_tasks_[kMaxSchedulerPeriodicTasks];
+  int num_periodic_tasks_;
+
+  struct {
+    BackgroundFunction function;
+    void *arg;
+    TimerNanosType budget_nanos;
+    BackgroundTaskStats stats;
+  } background_tasks_[kMaxSchedulerBackgroundTasks];
+  int num_background_tasks_;
+
+  struct {
+    InputFunction function;
+    void *arg;
+  } input_tasks_[kMaxSchedulerInputTasks];
+  int num_input_tasks_;
+
+  uint32_t num_idles_;
+};
+
+#endif  // SCHEDULER_
@@ -0,0 +1,45 @@
+#include "set_base_state_filter_action_handler.h"
+#include "robot_state_estimator.h"
+
+bool SetBaseStateFilterActionHandler::Run() {
+  switch(state_) {
+    case kProcessingRequest: {
+      const P2PSetBaseStateFilterRequest &request = GetRequest();
+      const int type = static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(request.type));
+
+      LOG_INFO_FMT(kLogFormatSetBaseStateFilter, type);
+
+      if (type < 0 || type >= kNumBaseStateFilterTypes) {
+        result_ = Status::kMalformedError;
+      } else {
+        SetBaseStateFilterType(static_cast<BaseStateFilterType>(type));
+        result_ = Status::kSuccess;
+      }
+      if (TrySendingReply()) {
+        return false; // Reply sent; do not call Run() again.
+      }
+      state_ = kSendingReply;
+      break;
+    }
+    
+    case kSendingReply: {
+      if (TrySendingReply()) {
+        state_ = kProcessingRequest;
+        return false; // Reply sent; do not call Run() again.
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+bool SetBaseStateFilterActionHandler::TrySendingReply() {
+  StatusOr<P2PActionPacketAdapter<P2PSetBaseStateFilterReply>> maybe_reply = NewReply();
+  if (!maybe_reply.ok()) {
+    return false;
+  }
+  P2PActionPacketAdapter<P2PSetBaseStateFilterReply> reply = *maybe_reply;
+  reply->status_code = LocalToNetwork<kP2PLocalEndianness>(result_);
+  reply.Commit(/*guarantee_delivery=*/true);
+  return true;
+}
@@ -0,0 +1,22 @@
+#ifndef SET_BASE_STATE_FILTER_ACTION_HANDLER_
+#define SET_BASE_STATE_FILTER_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "logger_interface.h"
+
+class SetBaseStateFilterActionHandler : public P2PActionHandler<P2PSetBaseStateFilterRequest, P2PSetBaseStateFilterReply> {
+public:
+  // Does not take ownsership of the pointee, which must outlive this object.
+  SetBaseStateFilterActionHandler(P2PPacketStreamArduino *p2p_stream)
+    : P2PActionHandler<P2PSetBaseStateFilterRequest, P2PSetBaseStateFilterReply>(P2PAction::kSetBaseStateFilter, p2p_stream) {}
+
+  bool Run() override;
+
+private:
+  bool TrySendingReply();
+
+  Status result_;
+  enum { kProcessingRequest, kSendingReply } state_ = kProcessingRequest;  
+};
+
+#endif  // SET_BASE_STATE_FILTER_ACTION_HANDLER_
@@ -6,9 +6,7 @@ bool SetHeadPoseActionHandler::Run() {
   const float pitch_radians = NetworkToLocal<kP2PLocalEndianness>(request.pitch_radians);
   const float roll_radians = NetworkToLocal<kP2PLocalEndianness>(request.roll_radians);
 
-  char str[64];
-  sprintf(str, "set_head_pose(pitch=%f, roll=%f)\n", pitch_radians, roll_radians);
-  LOG_INFO(str);
+  LOG_INFO_FMT(kLogFormatSetHeadPose, pitch_radians, roll_radians);
   
   SetHeadRollDegrees((roll_radians * 180.0f) / M_PI);
   SetHeadPitchDegrees((pitch_radians * 180.0f) / M_PI);
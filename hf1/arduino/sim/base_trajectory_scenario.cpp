@@ -0,0 +1,127 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "base_trajectory_scenario.h"
+#include "robot_state_estimator.h"
+#include "utils.h"
+
+// Granularity of the tracking and estimation error samples.
+#define kSampleSeconds 0.01
+// Granularity of the reference path that the tracking error is measured against.
+#define kReferencePathSampleSeconds 0.001
+// Time after the end of the trajectory after which the run is considered failed.
+#define kTrajectoryTimeoutSeconds 5.0
+
+#define kCircleRadius 0.5
+#define kCircleSeconds 12.0
+// With all 10 waypoints, the request has too many bytes to escape to fit in a packet.
+#define kCircleNumWaypoints 9
+#define kSquareSide 1.0
+#define kSquareSideSeconds 4.0
+
+static uint64_t WallNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ErrorStats::Add(double value) {
+  ++num_samples;
+  sum_squares += value * value;
+  max = std::max(max, fabs(value));
+}
+
+double ErrorStats::rms() const {
+  return num_samples == 0 ? 0 : sqrt(sum_squares / num_samples);
+}
+
+static BaseWaypoint MakeWaypoint(double seconds, double x, double y) {
+  return BaseWaypoint(seconds, BaseTargetState({BaseStateVars(Point(x, y), /*yaw=*/0)}));
+}
+
+static std::vector<BaseWaypoint> CircleWaypoints() {
+  std::vector<BaseWaypoint> waypoints;
+  for (int i = 0; i < kCircleNumWaypoints; ++i) {
+    const double fraction = static_cast<double>(i) / (kCircleNumWaypoints - 1);
+    const double angle = 2 * M_PI * fraction;
+    waypoints.push_back(MakeWaypoint(fraction * kCircleSeconds, kCircleRadius * sin(angle), kCircleRadius * (1 - cos(angle))));
+  }
+  return waypoints;
+}
+
+// Waypoints at the corners and at the midpoints of the sides.
+static std::vector<BaseWaypoint> SquareWaypoints() {
+  const double corners[][2] = {{0, 0}, {kSquareSide, 0}, {kSquareSide, kSquareSide}, {0, kSquareSide}, {0, 0}};
+  std::vector<BaseWaypoint> waypoints;
+  for (int i = 0; i < 4; ++i) {
+    const double seconds = i * kSquareSideSeconds;
+    waypoints.push_back(MakeWaypoint(seconds, corners[i][0], corners[i][1]));
+    waypoints.push_back(MakeWaypoint(seconds + kSquareSideSeconds / 2, (corners[i][0] + corners[i + 1][0]) / 2, (corners[i][1] + corners[i + 1][1]) / 2));
+  }
+  waypoints.push_back(MakeWaypoint(4 * kSquareSideSeconds, 0, 0));
+  return waypoints;
+}
+
+std::vector<BaseWaypoint> GetBaseTrajectoryScenario(const char *name) {
+  if (strcmp(name, "circle") == 0) {
+    return CircleWaypoints();
+  }
+  if (strcmp(name, "square") == 0) {
+    return SquareWaypoints();
+  }
+  return {};
+}
+
+static double DistanceToPath(const std::vector<Point> &path, double x, double y) {
+  double min_distance = INFINITY;
+  for (const Point &point : path) {
+    min_distance = std::min(min_distance, hypot(point.x - x, point.y - y));
+  }
+  return min_distance;
+}
+
+BaseTrajectoryRunResult RunBaseTrajectory(RobotSim &sim, const std::vector<BaseWaypoint> &waypoints) {
+  BaseTrajectoryRunResult result = {};
+
+  // The same view the firmware builds from the requests, to measure the tracking error.
+  const Trajectory<BaseTargetState, kP2PMaxNumWaypointsPerTrajectory> trajectory(waypoints.size(), waypoints.data());
+  BaseTrajectoryView reference(&trajectory);
+  reference.EnableInterpolation({ .type = InterpolationType::kCubic });
+  std::vector<Point> reference_path;
+  for (double seconds = 0; seconds <= reference.LapDuration(); seconds += kReferencePathSampleSeconds) {
+    reference_path.push_back(reference.state(seconds).location().position());
+  }
+
+  const int num_replies_before = sim.num_replies(P2PAction::kExecuteBaseTrajectoryView);
+  if (sim.SendBaseTrajectory(waypoints.data(), waypoints.size(), InterpolationType::kCubic) != kSuccess) {
+    return result;
+  }
+
+  const uint64_t start_wall_nanos = WallNanos();
+  const TimerNanosType start_nanos = GetTimerNanoseconds();
+  const double timeout_seconds = reference.LapDuration() + kTrajectoryTimeoutSeconds;
+  bool has_started = false;
+  while (SecondsFromNanos(GetTimerNanoseconds() - start_nanos) < timeout_seconds) {
+    sim.RunForSeconds(kSampleSeconds);
+    if (!sim.base_trajectory_controller().is_started()) {
+      if (has_started) {
+        break;
+      }
+      continue;
+    }
+    has_started = true;
+    const DifferentialDrivePlantState &truth = sim.true_state();
+    const BaseStateVars estimate = GetBaseState().location();
+    result.path_error.Add(DistanceToPath(reference_path, truth.x, truth.y));
+    result.position_estimation_error.Add(hypot(estimate.position().x - truth.x, estimate.position().y - truth.y));
+    result.yaw_estimation_error.Add(NormalizeRadians(estimate.yaw() - truth.yaw));
+  }
+  // Let the reply through.
+  sim.RunForSeconds(kSampleSeconds);
+
+  result.virtual_seconds = SecondsFromNanos(GetTimerNanoseconds() - start_nanos);
+  result.wall_seconds = (WallNanos() - start_wall_nanos) * 1e-9;
+  result.completed = has_started && sim.num_replies(P2PAction::kExecuteBaseTrajectoryView) > num_replies_before;
+  const BaseStateVars end = reference.state(reference.LapDuration()).location();
+  result.final_position_error = hypot(sim.true_state().x - end.position().x, sim.true_state().y - end.position().y);
+  return result;
+}
@@ -0,0 +1,43 @@
+#ifndef BASE_TRAJECTORY_SCENARIO_
+#define BASE_TRAJECTORY_SCENARIO_
+
+// Base trajectories to run on a RobotSim, and measurements of how well the motion stack
+// tracks them.
+
+#include <vector>
+#include "robot_sim.h"
+
+// Root mean square and maximum absolute value of a series of errors.
+struct ErrorStats {
+  int num_samples = 0;
+  double sum_squares = 0;
+  double max = 0;
+
+  void Add(double value);
+  double rms() const;
+};
+
+typedef struct {
+  // Whether the trajectory ran to completion and its execution was replied to.
+  bool completed;
+  // Virtual and wall time of the run.
+  double virtual_seconds;
+  double wall_seconds;
+  // Distance from the true position to the reference path [m].
+  ErrorStats path_error;
+  // Errors of the estimated pose [m, rad].
+  ErrorStats position_estimation_error;
+  ErrorStats yaw_estimation_error;
+  // Distance from the final true position to the end of the trajectory [m].
+  double final_position_error;
+} BaseTrajectoryRunResult;
+
+// Returns the waypoints of a scenario by name ("circle" or "square"), or none if the name
+// is unknown. Both start at the origin, heading along x, and turn counterclockwise.
+std::vector<BaseWaypoint> GetBaseTrajectoryScenario(const char *name);
+
+// Sends a base trajectory over P2P with cubic interpolation and runs `sim` until it
+// completes, or until a timeout after its end.
+BaseTrajectoryRunResult RunBaseTrajectory(RobotSim &sim, const std::vector<BaseWaypoint> &waypoints);
+
+#endif  // BASE_TRAJECTORY_SCENARIO_
@@ -0,0 +1,131 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "differential_drive_plant.h"
+#include "robot_model.h"
+#include "utils.h"
+
+// Wheel speed model that WheelSpeedController inverts:
+// speed = max(0, kSpeedOffset - kFactor * exp(-(duty_cycle + kDutyCycleOffset) / kTimeConstant))
+#define kSpeedModelTimeConstant 0.29
+#define kSpeedModelDutyCycleOffset -0.99
+#define kSpeedModelFactor 0.041
+#define kSpeedModelSpeedOffset 0.66
+
+// The plant is integrated in steps of at most this many timer ticks (~1 ms). Encoder edges
+// are interpolated within steps.
+#define kMaxPlantStepTicks 32
+
+// Layout of the BNO055 registers read by BNO055Reader, relative to the first Euler angle
+// register.
+#define kEulerHeadingOffset 0x00
+#define kLinearAccelerationOffset 0x0e
+#define kEulerLSBPerDegree 16.0
+#define kLinearAccelerationLSBPerMeterPerSecondSquared 100.0
+
+static void WriteInt16(uint8_t *registers, double value) {
+  const int16_t int_value = static_cast<int16_t>(lround(value));
+  registers[0] = static_cast<uint16_t>(int_value) & 0xff;
+  registers[1] = static_cast<uint16_t>(int_value) >> 8;
+}
+
+DifferentialDrivePlant::DifferentialDrivePlant(const DifferentialDrivePlantConfig &config)
+  : config_(config), state_{}, timer_ticks_(0),
+    left_wheel_{ .gain = config.left_motor_gain, .angle_since_edge = 0, .num_edges = 0, .callback = nullptr },
+    right_wheel_{ .gain = config.right_motor_gain, .angle_since_edge = 0, .num_edges = 0, .callback = nullptr },
+    callback_arg_(nullptr), imu_registers_(nullptr), next_imu_update_ticks_(0), random_(config.seed) {}
+
+void DifferentialDrivePlant::encoder_edge_callbacks(EncoderEdgeCallback left, EncoderEdgeCallback right, void *arg) {
+  left_wheel_.callback = left;
+  right_wheel_.callback = right;
+  callback_arg_ = arg;
+}
+
+double DifferentialDrivePlant::SteadyStateWheelSpeed(float duty_cycle) {
+  const double magnitude = kSpeedModelSpeedOffset - kSpeedModelFactor * exp(-(fabs(duty_cycle) + kSpeedModelDutyCycleOffset) / kSpeedModelTimeConstant);
+  if (magnitude <= 0) {
+    return 0;
+  }
+  return duty_cycle >= 0 ? magnitude : -magnitude;
+}
+
+double DifferentialDrivePlant::StepWheel(Wheel &wheel, double &speed, float duty_cycle, TimerTicksType start_ticks, int num_ticks) {
+  // Exact solution of the first order response over the step.
+  const double dt = SecondsFromTimerTicks(num_ticks);
+  const double steady_state_speed = wheel.gain * SteadyStateWheelSpeed(duty_cycle);
+  const double decay = exp(-dt / config_.motor_time_constant_seconds);
+  const double distance = steady_state_speed * dt + (speed - steady_state_speed) * config_.motor_time_constant_seconds * (1 - decay);
+  speed = steady_state_speed + (speed - steady_state_speed) * decay;
+
+  // The encoders count edges in both directions of rotation.
+  const double angle = fabs(distance) / kWheelRadius;
+  double angle_to_edge = kRadiansPerWheelTick - wheel.angle_since_edge;
+  while (angle_to_edge <= angle) {
+    const TimerTicksType edge_ticks = start_ticks + static_cast<TimerTicksType>(ceil(num_ticks * angle_to_edge / angle));
+    step_edges_.push_back({edge_ticks, &wheel});
+    angle_to_edge += kRadiansPerWheelTick;
+  }
+  wheel.angle_since_edge = angle - (angle_to_edge - kRadiansPerWheelTick);
+  return distance;
+}
+
+void DifferentialDrivePlant::Step(TimerTicksType to_ticks, float left_duty_cycle, float right_duty_cycle) {
+  while (timer_ticks_ < to_ticks) {
+    const int num_ticks = static_cast<int>(std::min<TimerTicksType>(to_ticks - timer_ticks_, kMaxPlantStepTicks));
+    const double dt = SecondsFromTimerTicks(num_ticks);
+    const double last_forward_speed = (state_.left_wheel_speed + state_.right_wheel_speed) / 2;
+    const double left_distance = StepWheel(left_wheel_, state_.left_wheel_speed, left_duty_cycle, timer_ticks_, num_ticks);
+    const double right_distance = StepWheel(right_wheel_, state_.right_wheel_speed, right_duty_cycle, timer_ticks_, num_ticks);
+    std::stable_sort(step_edges_.begin(), step_edges_.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (const auto &[edge_ticks, wheel] : step_edges_) {
+      ++wheel->num_edges;
+      if (wheel->callback != nullptr) {
+        wheel->callback(callback_arg_, edge_ticks);
+      }
+    }
+    step_edges_.clear();
+
+    // Arc between the poses at both ends of the step, approximated with its midpoint yaw.
+    const double distance = (left_distance + right_distance) / 2;
+    const double yaw_change = (right_distance - left_distance) / kRobotDistanceBetweenTireCenters;
+    const double mid_yaw = state_.yaw + yaw_change / 2;
+    state_.x += distance * cos(mid_yaw);
+    state_.y += distance * sin(mid_yaw);
+    state_.yaw = NormalizeRadians(state_.yaw + yaw_change);
+    timer_ticks_ += num_ticks;
+
+    if (timer_ticks_ >= next_imu_update_ticks_) {
+      next_imu_update_ticks_ = timer_ticks_ + static_cast<TimerTicksType>(llround(config_.imu_period_seconds * kTimerTicksPerSecond));
+      const double forward_speed = (state_.left_wheel_speed + state_.right_wheel_speed) / 2;
+      const double angular_speed = (state_.right_wheel_speed - state_.left_wheel_speed) / kRobotDistanceBetweenTireCenters;
+      UpdateIMU((forward_speed - last_forward_speed) / dt, angular_speed);
+    }
+  }
+}
+
+void DifferentialDrivePlant::UpdateIMU(double forward_acceleration, double angular_speed) {
+  if (imu_registers_ == nullptr) {
+    return;
+  }
+  std::normal_distribution<double> acceleration_noise(0.0, config_.imu_acceleration_stdev);
+  std::normal_distribution<double> yaw_noise(0.0, config_.imu_yaw_stdev);
+
+  // The BNO055 heading is clockwise in [0, 360); see BNO055Reader::ReadingFromRegisters().
+  const double yaw_degrees = DegreesFromRadians(NormalizeRadians(state_.yaw + yaw_noise(random_)));
+  const double heading_degrees = yaw_degrees <= 0 ? -yaw_degrees : 360 - yaw_degrees;
+  uint8_t *euler_registers = &imu_registers_[kEulerHeadingOffset];
+  WriteInt16(&euler_registers[0], heading_degrees * kEulerLSBPerDegree);
+  WriteInt16(&euler_registers[2], 0);  // Roll.
+  WriteInt16(&euler_registers[4], 0);  // Pitch.
+
+  const double forward_speed = (state_.left_wheel_speed + state_.right_wheel_speed) / 2;
+  const double accelerations[] = {
+    forward_acceleration + acceleration_noise(random_),
+    forward_speed * angular_speed + acceleration_noise(random_),
+    0,
+  };
+  uint8_t *acceleration_registers = &imu_registers_[kLinearAccelerationOffset];
+  for (int i = 0; i < 3; ++i) {
+    WriteInt16(&acceleration_registers[2 * i], accelerations[i] * kLinearAccelerationLSBPerMeterPerSecondSquared);
+  }
+}
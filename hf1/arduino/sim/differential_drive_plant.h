@@ -0,0 +1,92 @@
+#ifndef DIFFERENTIAL_DRIVE_PLANT_
+#define DIFFERENTIAL_DRIVE_PLANT_
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "timer.h"
+
+// Parameters of the simulated robot. The defaults match the robot geometry in robot_model.h
+// and the wheel speed model that WheelSpeedController inverts.
+typedef struct {
+  // Time constant of the first order response of the wheel speed to duty cycle changes.
+  double motor_time_constant_seconds = 0.08;
+  // Ratios between the actual steady state wheel speeds and the wheel speed model, so that
+  // the speed controllers must correct the model error.
+  double left_motor_gain = 1.0;
+  double right_motor_gain = 0.95;
+  // The BNO055 updates its fusion outputs at 100 Hz.
+  double imu_period_seconds = 0.01;
+  double imu_acceleration_stdev = 0.012;  // [m/s^2]
+  double imu_yaw_stdev = 0.001;           // [rad]
+  uint32_t seed = 1;
+} DifferentialDrivePlantConfig;
+
+// Pose and speeds of the simulated base, in the world frame of the estimator: x points to the
+// front of the robot at start, y to its left, and yaw is counterclockwise.
+typedef struct {
+  double x;
+  double y;
+  double yaw;
+  double left_wheel_speed;   // [m/s]
+  double right_wheel_speed;  // [m/s]
+} DifferentialDrivePlantState;
+
+// Differential drive base driven by the motor duty cycles, with first order motor dynamics,
+// single channel wheel encoders and a noisy BNO055 IMU.
+//
+// Step() integrates the plant over a time interval, and reports what the robot's sensors
+// would register in it: encoder edges, with the timer ticks the input capture channels latch,
+// and BNO055 fusion outputs, in the layout of its registers.
+class DifferentialDrivePlant {
+public:
+  explicit DifferentialDrivePlant(const DifferentialDrivePlantConfig &config = DifferentialDrivePlantConfig());
+
+  // Called for every encoder edge, in chronological order across both wheels.
+  typedef void (*EncoderEdgeCallback)(void *arg, TimerTicksType timer_ticks);
+  void encoder_edge_callbacks(EncoderEdgeCallback left, EncoderEdgeCallback right, void *arg);
+
+  // Registers of a BNO055, from the first Euler angle register (0x1a) on, updated at the IMU
+  // rate. May be null.
+  void imu_registers(uint8_t *registers) { imu_registers_ = registers; }
+
+  // Advances the plant from the current time to `to_ticks` with the given duty cycles,
+  // which hold over the whole interval.
+  void Step(TimerTicksType to_ticks, float left_duty_cycle, float right_duty_cycle);
+
+  const DifferentialDrivePlantState &state() const { return state_; }
+  TimerTicksType timer_ticks() const { return timer_ticks_; }
+  uint32_t num_left_encoder_edges() const { return left_wheel_.num_edges; }
+  uint32_t num_right_encoder_edges() const { return right_wheel_.num_edges; }
+
+  // Steady state wheel speed for a duty cycle, before applying the motor gain.
+  static double SteadyStateWheelSpeed(float duty_cycle);
+
+private:
+  typedef struct {
+    double gain;
+    // Wheel rotation since the last encoder edge [rad].
+    double angle_since_edge;
+    uint32_t num_edges;
+    EncoderEdgeCallback callback;
+  } Wheel;
+
+  // Integrates the speed of `wheel` over `num_ticks` from `start_ticks`, and adds its encoder
+  // edges to step_edges_. Returns the distance travelled by the wheel.
+  double StepWheel(Wheel &wheel, double &speed, float duty_cycle, TimerTicksType start_ticks, int num_ticks);
+  void UpdateIMU(double forward_acceleration, double angular_speed);
+
+  DifferentialDrivePlantConfig config_;
+  DifferentialDrivePlantState state_;
+  TimerTicksType timer_ticks_;
+  Wheel left_wheel_;
+  Wheel right_wheel_;
+  void *callback_arg_;
+  uint8_t *imu_registers_;
+  TimerTicksType next_imu_update_ticks_;
+  std::mt19937 random_;
+  // Encoder edges in the current step, as timer ticks and the wheel they belong to.
+  std::vector<std::pair<TimerTicksType, Wheel *>> step_edges_;
+};
+
+#endif  // DIFFERENTIAL_DRIVE_PLANT_
@@ -0,0 +1,74 @@
+// Runs a base trajectory on the simulated robot and reports how well the motion stack
+// tracked it, and what the firmware's control loops cost.
+//
+// Usage: hf1_sim [--scenario circle|square] [--seed <number>]
+//
+// The firmware's costs are host wall times, so they only compare changes made on the same
+// machine; the tracking and estimation errors are deterministic for a given seed. The P2P
+// profiler sections are listed twice: the companion computer's end of the link is profiled too.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "base_trajectory_scenario.h"
+#include "profiler.h"
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr, "Usage: %s [--scenario circle|square] [--seed <number>]\n", program);
+}
+
+int main(int argc, char **argv) {
+  const char *scenario = "circle";
+  RobotSimConfig config;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+      scenario = argv[++i];
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      config.plant.seed = static_cast<uint32_t>(atoi(argv[++i]));
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  const std::vector<BaseWaypoint> waypoints = GetBaseTrajectoryScenario(scenario);
+  if (waypoints.empty()) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  InitProfiler();
+  RobotSim sim(config);
+  const BaseTrajectoryRunResult result = RunBaseTrajectory(sim, waypoints);
+
+  printf("Scenario: %s, %d waypoints, %.1f s.\n", scenario, static_cast<int>(waypoints.size()), waypoints.back().seconds());
+  if (!result.completed) {
+    printf("The trajectory did not run to completion.\n");
+    return 1;
+  }
+  printf("Virtual time: %.2f s, wall time: %.3f s (%.0fx real time).\n", result.virtual_seconds, result.wall_seconds, result.virtual_seconds / result.wall_seconds);
+  printf("Firmware wall time: %.1f us per virtual second.\n", sim.firmware_wall_nanos() * 1e-3 / result.virtual_seconds);
+
+  printf("\n%-28s %10s %10s\n", "error", "rms", "max");
+  printf("%-28s %10.4f %10.4f\n", "path distance [m]", result.path_error.rms(), result.path_error.max);
+  printf("%-28s %10.4f %10.4f\n", "estimated position [m]", result.position_estimation_error.rms(), result.position_estimation_error.max);
+  printf("%-28s %10.4f %10.4f\n", "estimated yaw [rad]", result.yaw_estimation_error.rms(), result.yaw_estimation_error.max);
+  printf("%-28s %10.4f\n", "final position [m]", result.final_position_error);
+
+  const Scheduler &scheduler = sim.scheduler();
+  printf("\n%-28s %8s %8s %8s %14s\n", "periodic task", "runs", "overruns", "skipped", "max delay [us]");
+  for (int i = 0; i < scheduler.num_periodic_tasks(); ++i) {
+    const PeriodicRunnable &task = scheduler.periodic_task(i);
+    printf("%-28s %8u %8u %8u %14.0f\n", task.name(), task.run_histogram().total_count(), task.num_overruns(), task.num_skipped_periods(), task.period_error_histogram().max_value() * 1e-3);
+  }
+
+  const double nanos_per_cycle = 1e9 / GetProfilerCyclesPerSecond();
+  printf("\n%-28s %10s %12s %12s\n", "profiler section", "count", "mean [ns]", "max [ns]");
+  for (int i = 0; i < GetNumProfilerSections(); ++i) {
+    const ProfilerSection &section = GetProfilerSection(i);
+    if (section.count == 0) {
+      continue;
+    }
+    printf("%-28s %10u %12.0f %12.0f\n", section.name, section.count, section.total_cycles * nanos_per_cycle / section.count, section.max_cycles * nanos_per_cycle);
+  }
+  return 0;
+}
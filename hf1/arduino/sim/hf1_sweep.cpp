@@ -0,0 +1,262 @@
+// Runs base trajectories on the simulated robot over a grid of controller gains, trajectories
+// and noise seeds, and writes the tracking errors of every run to a CSV file, one column per
+// parameter and metric.
+//
+// Usage: hf1_sweep --output <file> [--workers <number>] [--seeds <number>]
+//                  [--scenarios circle,square] [--k1 <values>] [--k2 <values>] [--k3 <values>]
+//                  [--p <values>] [--i <values>]
+//
+// --k1, --k2 and --k3 are the BaseTrajectoryController gains, and --p and --i those of both
+// WheelSpeedControllers. Values are comma-separated; gains without values keep the firmware's
+// defaults. Runs use noise seeds 1 to --seeds.
+//
+// The firmware modules are global, so every run takes its own process. Up to --workers runs
+// (by default, one per core) go at a time, each forked as soon as a previous one ends, so the
+// sweep scales with the number of cores regardless of how long each run takes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "base_trajectory_scenario.h"
+
+typedef enum {
+  kRunPending = 0,
+  kRunCompleted,
+  // The trajectory did not run to completion.
+  kRunIncomplete,
+  // The run's process failed, e.g. with an assertion.
+  kRunCrashed,
+} SweepRunStatus;
+
+typedef struct {
+  int scenario_index;
+  uint32_t seed;
+  // The firmware's defaults, but for the gains swept.
+  BaseTrajectoryController::Gains trajectory_gains;
+  WheelSpeedController::Gains wheel_gains;
+} SweepJob;
+
+// Written by the run's process in memory shared with the parent.
+typedef struct {
+  SweepRunStatus status;
+  double path_error_rms;
+  double path_error_max;
+  double position_estimation_error_rms;
+  double yaw_estimation_error_rms;
+  double final_position_error;
+  double virtual_seconds;
+  double wall_seconds;
+} SweepRunResult;
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s --output <file> [--workers <number>] [--seeds <number>]\n"
+          "       [--scenarios circle,square] [--k1 <values>] [--k2 <values>] [--k3 <values>]\n"
+          "       [--p <values>] [--i <values>]\n", program);
+}
+
+static bool ParseNumbers(const char *text, std::vector<double> *numbers) {
+  numbers->clear();
+  const char *start = text;
+  for (;;) {
+    char *end;
+    numbers->push_back(strtod(start, &end));
+    if (end == start || (*end != ',' && *end != '\0')) {
+      return false;
+    }
+    if (*end == '\0') {
+      return true;
+    }
+    start = end + 1;
+  }
+}
+
+static std::vector<std::string> SplitNames(const char *text) {
+  std::vector<std::string> names;
+  std::string name;
+  for (const char *c = text;; ++c) {
+    if (*c == ',' || *c == '\0') {
+      names.push_back(name);
+      name.clear();
+      if (*c == '\0') {
+        return names;
+      }
+    } else {
+      name += *c;
+    }
+  }
+}
+
+static void Run(const SweepJob &job, const std::vector<BaseWaypoint> &waypoints, SweepRunResult *run_result) {
+  RobotSimConfig config;
+  config.plant.seed = job.seed;
+  RobotSim sim(config);
+  sim.base_trajectory_controller().gains(job.trajectory_gains);
+  sim.left_wheel().gains(job.wheel_gains);
+  sim.right_wheel().gains(job.wheel_gains);
+
+  const BaseTrajectoryRunResult result = RunBaseTrajectory(sim, waypoints);
+  run_result->path_error_rms = result.path_error.rms();
+  run_result->path_error_max = result.path_error.max;
+  run_result->position_estimation_error_rms = result.position_estimation_error.rms();
+  run_result->yaw_estimation_error_rms = result.yaw_estimation_error.rms();
+  run_result->final_position_error = result.final_position_error;
+  run_result->virtual_seconds = result.virtual_seconds;
+  run_result->wall_seconds = result.wall_seconds;
+  run_result->status = result.completed ? kRunCompleted : kRunIncomplete;
+}
+
+int main(int argc, char **argv) {
+  const char *output_path = nullptr;
+  int num_workers = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  int num_seeds = 1;
+  std::vector<std::string> scenarios = {"circle"};
+  std::vector<double> k1, k2, k3, p, i;
+  for (int arg = 1; arg < argc; ++arg) {
+    const bool has_value = arg + 1 < argc;
+    bool ok = has_value;
+    if (has_value && strcmp(argv[arg], "--output") == 0) {
+      output_path = argv[++arg];
+    } else if (has_value && strcmp(argv[arg], "--workers") == 0) {
+      num_workers = atoi(argv[++arg]);
+    } else if (has_value && strcmp(argv[arg], "--seeds") == 0) {
+      num_seeds = atoi(argv[++arg]);
+    } else if (has_value && strcmp(argv[arg], "--scenarios") == 0) {
+      scenarios = SplitNames(argv[++arg]);
+    } else if (has_value && strcmp(argv[arg], "--k1") == 0) {
+      ok = ParseNumbers(argv[++arg], &k1);
+    } else if (has_value && strcmp(argv[arg], "--k2") == 0) {
+      ok = ParseNumbers(argv[++arg], &k2);
+    } else if (has_value && strcmp(argv[arg], "--k3") == 0) {
+      ok = ParseNumbers(argv[++arg], &k3);
+    } else if (has_value && strcmp(argv[arg], "--p") == 0) {
+      ok = ParseNumbers(argv[++arg], &p);
+    } else if (has_value && strcmp(argv[arg], "--i") == 0) {
+      ok = ParseNumbers(argv[++arg], &i);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (output_path == nullptr || num_workers <= 0 || num_seeds <= 0) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  // Resolve the defaults here, so that the output lists the gains of the runs that crash too.
+  const BaseTrajectoryController::Gains default_trajectory_gains = BaseTrajectoryController::DefaultGains();
+  const WheelSpeedController::Gains default_wheel_gains = WheelSpeedController::DefaultGains();
+  if (k1.empty()) { k1 = {default_trajectory_gains.k1}; }
+  if (k2.empty()) { k2 = {default_trajectory_gains.k2}; }
+  if (k3.empty()) { k3 = {default_trajectory_gains.k3}; }
+  if (p.empty()) { p = {default_wheel_gains.p}; }
+  if (i.empty()) { i = {default_wheel_gains.i}; }
+  std::vector<std::vector<BaseWaypoint>> scenario_waypoints;
+  for (const std::string &scenario : scenarios) {
+    scenario_waypoints.push_back(GetBaseTrajectoryScenario(scenario.c_str()));
+    if (scenario_waypoints.back().empty()) {
+      fprintf(stderr, "Unknown scenario: %s\n", scenario.c_str());
+      return 1;
+    }
+  }
+  FILE *output = fopen(output_path, "w");
+  if (output == nullptr) {
+    perror(output_path);
+    return 1;
+  }
+
+  std::vector<SweepJob> jobs;
+  for (int scenario_index = 0; scenario_index < static_cast<int>(scenarios.size()); ++scenario_index)
+  for (double job_k1 : k1) for (double job_k2 : k2) for (double job_k3 : k3)
+  for (double job_p : p) for (double job_i : i)
+  for (int seed = 1; seed <= num_seeds; ++seed) {
+    SweepJob job = { .scenario_index = scenario_index, .seed = static_cast<uint32_t>(seed), .trajectory_gains = default_trajectory_gains, .wheel_gains = default_wheel_gains };
+    job.trajectory_gains.k1 = job_k1;
+    job.trajectory_gains.k2 = job_k2;
+    job.trajectory_gains.k3 = job_k3;
+    job.wheel_gains.p = job_p;
+    job.wheel_gains.i = job_i;
+    jobs.push_back(job);
+  }
+
+  const size_t results_length = jobs.size() * sizeof(SweepRunResult);
+  void *shared = mmap(nullptr, results_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  SweepRunResult *results = static_cast<SweepRunResult *>(shared);
+  memset(results, 0, results_length);
+
+  // Fork a process per run, keeping up to num_workers of them running.
+  std::vector<pid_t> job_pids(jobs.size(), 0);
+  size_t next_job = 0;
+  size_t num_finished = 0;
+  int num_running = 0;
+  fflush(stdout);
+  while (num_finished < jobs.size()) {
+    while (num_running < num_workers && next_job < jobs.size()) {
+      const pid_t pid = fork();
+      if (pid < 0) {
+        perror("fork");
+        return 1;
+      }
+      if (pid == 0) {
+        // The firmware's logs would drown the progress report.
+        if (freopen("/dev/null", "w", stdout) == nullptr) {
+          _exit(1);
+        }
+        Run(jobs[next_job], scenario_waypoints[jobs[next_job].scenario_index], &results[next_job]);
+        _exit(0);
+      }
+      job_pids[next_job++] = pid;
+      ++num_running;
+    }
+    int wait_status;
+    const pid_t pid = wait(&wait_status);
+    if (pid < 0) {
+      perror("wait");
+      return 1;
+    }
+    for (size_t job = 0; job < jobs.size(); ++job) {
+      if (job_pids[job] == pid) {
+        if (!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0 || results[job].status == kRunPending) {
+          results[job].status = kRunCrashed;
+        }
+        break;
+      }
+    }
+    --num_running;
+    ++num_finished;
+    fprintf(stderr, "\r%zu/%zu runs", num_finished, jobs.size());
+  }
+  fprintf(stderr, "\n");
+
+  fprintf(output, "scenario,seed,k1,k2,k3,p,i,status,path_error_rms,path_error_max,position_estimation_error_rms,yaw_estimation_error_rms,final_position_error,virtual_seconds,wall_seconds\n");
+  int num_completed = 0;
+  for (size_t job = 0; job < jobs.size(); ++job) {
+    const SweepRunResult &result = results[job];
+    static const char *status_names[] = {"pending", "completed", "incomplete", "crashed"};
+    if (result.status == kRunCompleted) {
+      ++num_completed;
+    }
+    fprintf(output, "%s,%u,%g,%g,%g,%g,%g,%s,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%.3f\n",
+            scenarios[jobs[job].scenario_index].c_str(), jobs[job].seed,
+            jobs[job].trajectory_gains.k1, jobs[job].trajectory_gains.k2, jobs[job].trajectory_gains.k3,
+            jobs[job].wheel_gains.p, jobs[job].wheel_gains.i, status_names[result.status],
+            result.path_error_rms, result.path_error_max, result.position_estimation_error_rms,
+            result.yaw_estimation_error_rms, result.final_position_error, result.virtual_seconds,
+            result.wall_seconds);
+  }
+  fclose(output);
+  munmap(shared, results_length);
+  printf("%d of %zu runs completed. Results written to %s.\n", num_completed, jobs.size(), output_path);
+  return num_completed == static_cast<int>(jobs.size()) ? 0 : 1;
+}
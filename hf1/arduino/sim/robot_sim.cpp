@@ -0,0 +1,246 @@
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "robot_sim.h"
+#include "timer_host.h"
+#include "encoders_host.h"
+#include "motors_host.h"
+#include "servos_host.h"
+#include "bno055_reader.h"
+#include "robot_state_estimator.h"
+#include "logger_interface.h"
+#include "profiler.h"
+
+// Budget of the main loop's communications, as in arduino.ino.
+#define kMaxRxTxLoopBlockingDurationNs 5'000'000
+
+// Calls to RunComms() per timer tick of virtual time, for a Teensy 3.2 processing each byte in
+// about 2 us.
+#define kCommsCallsPerTimerTick 16
+
+// Time for both ends of the P2P link to start their sessions, after which requests are
+// no longer discarded by the handshake.
+#define kLinkStartSeconds 0.1
+
+// Register of the BNO055 where BNO055Reader starts its burst reads.
+#define kBNO055FirstReadRegister 0x1a
+
+static RobotSim *robot_sim_singleton = nullptr;
+
+static uint64_t WallNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RobotSim::RobotSim(const RobotSimConfig &config)
+  : plant_(config.plant),
+    imu_bus_(kBNO055DefaultAddress),
+    arduino_byte_stream_(&companion_to_arduino_, &arduino_to_companion_),
+    companion_byte_stream_(&arduino_to_companion_, &companion_to_arduino_),
+    p2p_stream_(&arduino_byte_stream_, &timer_, guid_factory_),
+    companion_stream_(&companion_byte_stream_, &timer_, guid_factory_),
+    is_link_started_(false),
+    next_request_id_(0),
+    num_uncharged_comms_calls_(0),
+    num_replies_{},
+    num_progress_updates_{},
+    wheel_state_estimator_("WheelStateEstimator"),
+    left_wheel_("LeftWheelSpeedController", &wheel_state_estimator_.left_wheel_state_filter(), &SetLeftMotorDutyCycle),
+    right_wheel_("RightWheelSpeedController", &wheel_state_estimator_.right_wheel_state_filter(), &SetRightMotorDutyCycle),
+    base_speed_controller_(&left_wheel_, &right_wheel_),
+    base_trajectory_controller_("BaseTrajectoryController", &base_speed_controller_),
+    p2p_action_server_(&p2p_stream_),
+    set_base_velocity_action_handler_(&p2p_stream_, &base_speed_controller_),
+    set_base_state_filter_action_handler_(&p2p_stream_),
+    create_base_trajectory_action_handler_(&p2p_stream_, &trajectory_store_),
+    create_base_trajectory_view_action_handler_(&p2p_stream_, &trajectory_store_),
+    execute_base_trajectory_view_action_handler_(&p2p_stream_, &trajectory_store_, &base_trajectory_controller_),
+    scheduler_(&RobotSim::Idle),
+    end_nanos_(0),
+    firmware_wall_nanos_(0),
+    plant_wall_nanos_(0) {
+  ASSERTM(robot_sim_singleton == nullptr, "Only one RobotSim may exist at a time.");
+  robot_sim_singleton = this;
+
+  imu_bus_.polls_per_transfer(config.imu_polls_per_transfer);
+  plant_.imu_registers(&imu_bus_.registers()[kBNO055FirstReadRegister]);
+  plant_.encoder_edge_callbacks(&RobotSim::OnLeftEncoderEdge, &RobotSim::OnRightEncoderEdge, this);
+  companion_stream_.other_end_started_callback(P2POtherEndStartedCallback(&RobotSim::OnArduinoStarted, this));
+
+  // The firmware's setup(), for the motion stack.
+  InitTimer();
+  InitEncoders();
+  WheelStateEstimator::Init();
+  InitRobotStateEstimator(&imu_bus_);
+  InitMotors();
+  InitServos();
+
+  p2p_action_server_.Register(&set_base_velocity_action_handler_);
+  p2p_action_server_.Register(&set_base_state_filter_action_handler_);
+  p2p_action_server_.Register(&create_base_trajectory_action_handler_);
+  p2p_action_server_.Register(&create_base_trajectory_view_action_handler_);
+  p2p_action_server_.Register(&execute_base_trajectory_view_action_handler_);
+
+  left_wheel_.Start();
+  right_wheel_.Start();
+
+  scheduler_.AddPeriodicTask(&wheel_state_estimator_);
+  scheduler_.AddPeriodicTask(&base_trajectory_controller_);
+  scheduler_.AddPeriodicTask(&left_wheel_);
+  scheduler_.AddPeriodicTask(&right_wheel_);
+  scheduler_.AddInputTask(&RobotSim::RunStateEstimation, this);
+  scheduler_.AddBackgroundTask(&RobotSim::RunComms, this, kMaxRxTxLoopBlockingDurationNs);
+
+  RunForSeconds(kLinkStartSeconds);
+  ASSERTM(is_link_started_, "The P2P link did not start.");
+}
+
+RobotSim::~RobotSim() {
+  robot_sim_singleton = nullptr;
+}
+
+void RobotSim::RunForSeconds(double seconds) {
+  end_nanos_ = GetTimerNanoseconds() + NanosFromSeconds(seconds);
+  const uint64_t start_wall_nanos = WallNanos();
+  const uint64_t start_plant_wall_nanos = plant_wall_nanos_;
+  while (GetTimerNanoseconds() < end_nanos_) {
+    scheduler_.RunOnce();
+  }
+  firmware_wall_nanos_ += (WallNanos() - start_wall_nanos) - (plant_wall_nanos_ - start_plant_wall_nanos);
+}
+
+void RobotSim::AdvanceTo(TimerTicksType timer_ticks) {
+  if (timer_ticks <= GetTimerTicks()) {
+    return;
+  }
+  const uint64_t start_wall_nanos = WallNanos();
+  // Encoder edges move the clock to their timer ticks before calling the ISRs.
+  plant_.Step(timer_ticks, GetLeftMotorDutyCycle(), GetRightMotorDutyCycle());
+  SetTimerTicks(timer_ticks);
+  plant_wall_nanos_ += WallNanos() - start_wall_nanos;
+}
+
+void RobotSim::Idle(TimerNanosType until_nanos) {
+  RobotSim &self = *ASSERT_NOT_NULL(robot_sim_singleton);
+  // Stop at the end of the run, and wake up like the system tick interrupt would.
+  const TimerNanosType wake_up_nanos = std::min(until_nanos, self.end_nanos_);
+  self.AdvanceTo(TimerTicksFromNanos(wake_up_nanos + kTimerNanosPerTick - 1));
+  self.RunCompanion();
+}
+
+bool RobotSim::RunStateEstimation(void *self_ptr) {
+  RobotSim &self = *static_cast<RobotSim *>(self_ptr);
+  const bool is_imu_reading_in_progress = RunRobotStateEstimator();
+  NotifyLeftMotorDirection(GetTimerTicks(), !self.base_speed_controller_.left_wheel_speed_controller().is_turning_forward());
+  NotifyRightMotorDirection(GetTimerTicks(), !self.base_speed_controller_.right_wheel_speed_controller().is_turning_forward());
+  return is_imu_reading_in_progress;
+}
+
+bool RobotSim::RunComms(void *self_ptr) {
+  RobotSim &self = *static_cast<RobotSim *>(self_ptr);
+  // Only the Arduino's end is profiled, as in arduino.ino.
+  bool has_read_bytes;
+  {
+    PROFILE_SCOPE("p2p_input");
+    has_read_bytes = self.p2p_stream_.input().Run() > 0;
+  }
+  {
+    PROFILE_SCOPE("p2p_output");
+    self.p2p_stream_.output().Run();
+  }
+  self.p2p_action_server_.Run();
+  const bool has_more_work = has_read_bytes || self.p2p_stream_.output().NumCommittedPackets() > 0;
+  // The other end answers right away, e.g. with acknowledgements.
+  self.RunCompanion();
+  // Virtual time only advances when idling otherwise: charge the time that the Teensy takes
+  // to process a byte, so that timeouts and retransmissions can happen.
+  if (has_more_work && ++self.num_uncharged_comms_calls_ >= kCommsCallsPerTimerTick) {
+    self.num_uncharged_comms_calls_ = 0;
+    self.AdvanceTo(GetTimerTicks() + 1);
+  }
+  return has_more_work;
+}
+
+void RobotSim::RunCompanion() {
+  companion_stream_.input().Run();
+  companion_stream_.output().Run();
+  for (;;) {
+    const auto maybe_packet = companion_stream_.input().OldestPacket();
+    if (!maybe_packet.ok()) {
+      break;
+    }
+    const auto *header = reinterpret_cast<const P2PApplicationPacketHeader *>(maybe_packet->content());
+    if (header->action < P2PAction::kCount) {
+      if (header->stage == P2PActionStage::kReply) {
+        ++num_replies_[header->action];
+      } else if (header->stage == P2PActionStage::kProgress) {
+        ++num_progress_updates_[header->action];
+      }
+    }
+    companion_stream_.input().Consume(maybe_packet->priority());
+  }
+}
+
+Status RobotSim::SendRequest(P2PAction action, const void *request, int request_length) {
+  auto maybe_packet = companion_stream_.output().NewPacket(P2PPriority::kMedium);
+  if (!maybe_packet.ok()) {
+    return maybe_packet.status();
+  }
+  ASSERT(sizeof(P2PApplicationPacketHeader) + request_length <= kP2PMaxContentLength);
+  auto *header = reinterpret_cast<P2PApplicationPacketHeader *>(maybe_packet->content());
+  header->action = action;
+  header->stage = P2PActionStage::kRequest;
+  header->request_id = next_request_id_++;
+  memcpy(maybe_packet->content() + sizeof(P2PApplicationPacketHeader), request, request_length);
+  maybe_packet->length() = sizeof(P2PApplicationPacketHeader) + request_length;
+  if (!companion_stream_.output().Commit(P2PPriority::kMedium, /*guarantee_delivery=*/true)) {
+    // The content does not fit in a packet once its tokens are escaped.
+    return kMalformedError;
+  }
+  return kSuccess;
+}
+
+void RobotSim::OnArduinoStarted(void *self) {
+  static_cast<RobotSim *>(self)->is_link_started_ = true;
+}
+
+void RobotSim::OnLeftEncoderEdge(void *self, TimerTicksType timer_ticks) {
+  SetTimerTicks(std::max(timer_ticks, GetTimerTicks()));
+  TriggerLeftEncoderEdge(timer_ticks);
+}
+
+void RobotSim::OnRightEncoderEdge(void *self, TimerTicksType timer_ticks) {
+  SetTimerTicks(std::max(timer_ticks, GetTimerTicks()));
+  TriggerRightEncoderEdge(timer_ticks);
+}
+
+Status RobotSim::SendBaseTrajectory(const BaseWaypoint *waypoints, int num_waypoints, InterpolationType interpolation) {
+  ASSERT(num_waypoints <= kP2PMaxNumWaypointsPerTrajectory);
+  P2PCreateBaseTrajectoryRequest trajectory_request = {};
+  trajectory_request.id = 0;
+  trajectory_request.trajectory.num_waypoints = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint32_t>(num_waypoints));
+  for (int i = 0; i < num_waypoints; ++i) {
+    P2PBaseWaypoint &waypoint = trajectory_request.trajectory.waypoints[i];
+    const BaseStateVars &location = waypoints[i].state().location();
+    waypoint.seconds = LocalToNetwork<kP2PLocalEndianness>(static_cast<float>(waypoints[i].seconds()));
+    waypoint.target_state.location.x_meters = LocalToNetwork<kP2PLocalEndianness>(location.position().x);
+    waypoint.target_state.location.y_meters = LocalToNetwork<kP2PLocalEndianness>(location.position().y);
+    waypoint.target_state.location.yaw_radians = LocalToNetwork<kP2PLocalEndianness>(location.yaw());
+  }
+  P2PCreateBaseTrajectoryViewRequest view_request = {};
+  view_request.id = 0;
+  view_request.trajectory_view.trajectory_id = 0;
+  view_request.trajectory_view.loop_after_seconds = LocalToNetwork<kP2PLocalEndianness>(-1.0f);
+  view_request.trajectory_view.interpolation_config.type = interpolation;
+  P2PExecuteBaseTrajectoryViewRequest execute_request = {};
+  execute_request.trajectory_view_id.id = 0;
+  execute_request.trajectory_view_id.type = kPlain;
+
+  Status status = SendRequest(P2PAction::kCreateBaseTrajectory, &trajectory_request, sizeof(trajectory_request));
+  if (status == kSuccess) {
+    status = SendRequest(P2PAction::kCreateBaseTrajectoryView, &view_request, sizeof(view_request));
+  }
+  if (status == kSuccess) {
+    status = SendRequest(P2PAction::kExecuteBaseTrajectoryView, &execute_request, sizeof(execute_request));
+  }
+  return status;
+}
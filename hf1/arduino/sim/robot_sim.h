@@ -0,0 +1,134 @@
+#ifndef ROBOT_SIM_
+#define ROBOT_SIM_
+
+// Closed-loop simulation of the robot's motion stack on the host.
+//
+// The firmware modules run unmodified, wired as in arduino.ino: the wheel state estimator,
+// the wheel, base speed and base trajectory controllers, the robot state estimator and the
+// P2P action server, all in the cooperative scheduler. The hardware modules are the host
+// stand-ins in host/, driven by a DifferentialDrivePlant: the motors' duty cycles move the
+// plant, whose encoder edges call the encoder ISRs, and whose IMU fills the registers of a
+// BNO055 behind a mock I2C bus. The P2P link ends in an in-process packet stream, standing
+// for the companion computer.
+//
+// Time is virtual: it advances when the scheduler idles, so simulations are deterministic
+// and run much faster than real time. The firmware's CPU time is measured separately in
+// wall time, as is the profiler's.
+
+#include <deque>
+#include "differential_drive_plant.h"
+#include "mock_i2c_bus.h"
+#include "p2p_byte_stream_host.h"
+#include "guid_factory.h"
+#include "timer_arduino.h"
+#include "p2p_packet_stream_arduino.h"
+#include "p2p_action_server.h"
+#include "scheduler.h"
+#include "wheel_state_estimator.h"
+#include "wheel_controller.h"
+#include "base_controller.h"
+#include "trajectory_store.h"
+#include "base_trajectory.h"
+#include "set_base_velocity_action_handler.h"
+#include "set_base_state_filter_action_handler.h"
+#include "create_base_trajectory_action_handler.h"
+#include "create_base_trajectory_view_action_handler.h"
+#include "execute_base_trajectory_view_action_handler.h"
+
+// Packet capacity of the companion computer's end of the link.
+#define kRobotSimCompanionCapacity 16
+
+typedef struct {
+  DifferentialDrivePlantConfig plant;
+  // Polls of the I2C bus that every BNO055 reading takes.
+  int imu_polls_per_transfer = 2;
+} RobotSimConfig;
+
+class RobotSim {
+public:
+  // Only one RobotSim may exist per process, as the firmware modules it runs are global.
+  // Returns once the P2P link has started.
+  explicit RobotSim(const RobotSimConfig &config = RobotSimConfig());
+  ~RobotSim();
+
+  // Runs the firmware and the plant for `seconds` of virtual time.
+  void RunForSeconds(double seconds);
+
+  // Sends an action request from the companion computer's end. Fails if its output stream
+  // is full, or if the request does not fit in a packet once escaped.
+  Status SendRequest(P2PAction action, const void *request, int request_length);
+
+  // Sends the requests that create a base trajectory with `waypoints` and a plain view of it
+  // with `interpolation` and without looping, both with ID 0, and execute it.
+  Status SendBaseTrajectory(const BaseWaypoint *waypoints, int num_waypoints, InterpolationType interpolation);
+
+  // Replies and progress updates the companion computer's end received for `action`.
+  int num_replies(P2PAction action) const { return num_replies_[action]; }
+  int num_progress_updates(P2PAction action) const { return num_progress_updates_[action]; }
+
+  const DifferentialDrivePlant &plant() const { return plant_; }
+  // The simulated robot starts at rest, at the origin.
+  const DifferentialDrivePlantState &true_state() const { return plant_.state(); }
+
+  WheelSpeedController &left_wheel() { return left_wheel_; }
+  WheelSpeedController &right_wheel() { return right_wheel_; }
+  BaseSpeedController &base_speed_controller() { return base_speed_controller_; }
+  BaseTrajectoryController &base_trajectory_controller() { return base_trajectory_controller_; }
+  Scheduler &scheduler() { return scheduler_; }
+
+  // Wall time spent in the firmware's main loop, excluding the plant simulation.
+  uint64_t firmware_wall_nanos() const { return firmware_wall_nanos_; }
+
+private:
+  using P2PPacketStreamCompanion = P2PPacketStream<kRobotSimCompanionCapacity, kRobotSimCompanionCapacity, kLittleEndian>;
+
+  // Moves the virtual time and the plant to `timer_ticks`.
+  void AdvanceTo(TimerTicksType timer_ticks);
+  void RunCompanion();
+
+  static void Idle(TimerNanosType until_nanos);
+  static bool RunStateEstimation(void *self);
+  static bool RunComms(void *self);
+  static void OnArduinoStarted(void *self);
+  static void OnLeftEncoderEdge(void *self, TimerTicksType timer_ticks);
+  static void OnRightEncoderEdge(void *self, TimerTicksType timer_ticks);
+
+  DifferentialDrivePlant plant_;
+  MockI2CBus imu_bus_;
+
+  // Bytes in flight from the Arduino to the companion computer, and vice versa.
+  std::deque<uint8_t> arduino_to_companion_;
+  std::deque<uint8_t> companion_to_arduino_;
+  P2PByteStreamHost arduino_byte_stream_;
+  P2PByteStreamHost companion_byte_stream_;
+  TimerArduino timer_;
+  GUIDFactory guid_factory_;
+  P2PPacketStreamArduino p2p_stream_;
+  P2PPacketStreamCompanion companion_stream_;
+  bool is_link_started_;
+  P2PActionRequestID next_request_id_;
+  int num_uncharged_comms_calls_;
+  int num_replies_[P2PAction::kCount];
+  int num_progress_updates_[P2PAction::kCount];
+
+  WheelStateEstimator wheel_state_estimator_;
+  WheelSpeedController left_wheel_;
+  WheelSpeedController right_wheel_;
+  BaseSpeedController base_speed_controller_;
+  BaseTrajectoryController base_trajectory_controller_;
+
+  TrajectoryStore trajectory_store_;
+  P2PActionServer p2p_action_server_;
+  SetBaseVelocityActionHandler set_base_velocity_action_handler_;
+  SetBaseStateFilterActionHandler set_base_state_filter_action_handler_;
+  CreateBaseTrajectoryActionHandler create_base_trajectory_action_handler_;
+  CreateBaseTrajectoryViewActionHandler create_base_trajectory_view_action_handler_;
+  ExecuteBaseTrajectoryViewActionHandler execute_base_trajectory_view_action_handler_;
+  Scheduler scheduler_;
+
+  TimerNanosType end_nanos_;
+  uint64_t firmware_wall_nanos_;
+  uint64_t plant_wall_nanos_;
+};
+
+#endif  // ROBOT_SIM_
@@ -0,0 +1,54 @@
+#include "stream_logs_action_handler.h"
+
+// Records are batched to amortize the packet overhead. A batch is sent when it has this many
+// bytes, or when its oldest record has waited for kMaxBatchDelayNs.
+#define kMinBytesPerBatch 96
+#define kMaxBatchDelayNs 100'000'000
+
+static_assert(kMaxDeferredLogRecordLength <= kP2PMaxLogRecordsLength);
+static_assert(sizeof(P2PApplicationPacketHeader) + sizeof(P2PStreamLogsProgress) <= kP2PMaxContentLength);
+
+bool StreamLogsActionHandler::OnRequest() {
+  is_streaming_ = true;
+  last_progress_ns_ = GetTimerNanoseconds();
+  return true;
+}
+
+bool StreamLogsActionHandler::Run() {
+  DeferredLogRing &ring = logger_.ring();
+  if (ring.empty()) {
+    last_progress_ns_ = GetTimerNanoseconds();
+  } else if (ring.size() >= kMinBytesPerBatch || GetTimerNanoseconds() - last_progress_ns_ >= kMaxBatchDelayNs) {
+    TrySendingProgress();
+  }
+  return true;  // Stream until cancelled.
+}
+
+void StreamLogsActionHandler::OnCancel() {
+  is_streaming_ = false;
+}
+
+bool StreamLogsActionHandler::TrySendingProgress() {
+  StatusOr<P2PActionPacketAdapter<P2PStreamLogsProgress>> maybe_progress = NewProgress();
+  if (!maybe_progress.ok()) {
+    // Records keep accumulating in the ring, which counts those that do not fit.
+    return false;
+  }
+  P2PActionPacketAdapter<P2PStreamLogsProgress> progress = *maybe_progress;
+  DeferredLogRing &ring = logger_.ring();
+  const uint32_t num_dropped_records = ring.TakeNumDroppedRecords();
+  progress->num_dropped_records = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint16_t>(num_dropped_records < 0xffff ? num_dropped_records : 0xffff));
+  int records_length = 0;
+  for (;;) {
+    const int length = ring.Read(&progress->records[records_length], kP2PMaxLogRecordsLength - records_length);
+    if (length == 0) {
+      break;
+    }
+    records_length += length;
+  }
+  progress.payload_length(sizeof(P2PStreamLogsProgress) - kP2PMaxLogRecordsLength + records_length);
+  // Logs are best effort: do not retransmit them at the expense of other packets.
+  progress.Commit(/*guarantee_delivery=*/false);
+  last_progress_ns_ = GetTimerNanoseconds();
+  return true;
+}
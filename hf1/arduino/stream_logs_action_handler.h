@@ -0,0 +1,30 @@
+#ifndef STREAM_LOGS_ACTION_HANDLER_
+#define STREAM_LOGS_ACTION_HANDLER_
+
+#include "p2p_action_server.h"
+#include "deferred_logger.h"
+#include "timer.h"
+
+class StreamLogsActionHandler : public P2PActionHandler<P2PVoid, P2PVoid, P2PStreamLogsProgress> {
+public:
+  // Does not take ownsership of the pointees, which must outlive this object.
+  StreamLogsActionHandler(P2PPacketStreamArduino *p2p_stream, DeferredLogger *logger)
+    : P2PActionHandler<P2PVoid, P2PVoid, P2PStreamLogsProgress>(P2PAction::kStreamLogs, p2p_stream),
+      logger_(*ASSERT_NOT_NULL(logger)), is_streaming_(false) {}
+
+  bool OnRequest() override;
+  bool Run() override;
+  void OnCancel() override;
+
+  // True while the log records are sent to the other end, rather than to the base logger.
+  bool is_streaming() const { return is_streaming_; }
+
+private:
+  bool TrySendingProgress();
+
+  DeferredLogger &logger_;
+  bool is_streaming_;
+  TimerNanosType last_progress_ns_;
+};
+
+#endif  // STREAM_LOGS_ACTION_HANDLER_
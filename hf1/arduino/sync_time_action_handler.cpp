@@ -13,6 +13,10 @@ SyncTimeActionHandler::SyncTimeActionHandler(P2PPacketStreamArduino *p2p_stream,
   time_sync_server_singleton = this;  
 }
 
+SyncTimeActionHandler::~SyncTimeActionHandler() {
+  time_sync_server_singleton = nullptr;
+}
+
 void SyncTimeActionHandler::Init() {
   last_edge_detect_local_timestamp_ns_ = -1ULL;
   state_ = WAIT_FOR_TIME_SYNC_REQUEST;
@@ -27,6 +31,12 @@ void SyncTimeActionHandler::NotifyEdgeDetected() {
 }
 
 bool SyncTimeActionHandler::OnRequest() {
+  const P2PSyncTimeRequest &time_sync_request = GetRequest();
+  mode_ = static_cast<P2PTimeSyncMode>(time_sync_request.mode);
+  if (mode_ == kTimeSyncTwoWay) {
+    return OnTwoWayRequest();
+  }
+
   // Disable the IRQ, as we should not get any other edge on the pin until after
   // sending the reply. This should filter any spurious edges.
   NVIC_DISABLE_IRQ(digitalPinToInterrupt(kTimeSyncServerInputPin));
@@ -52,16 +62,24 @@ bool SyncTimeActionHandler::OnRequest() {
 
   // Got a sync signal and a posterior detection timestamp from the other end:
   // update global time offset if necessary.
-  const P2PSyncTimeRequest &time_sync_request = GetRequest();
   uint64_t last_edge_detect_remote_timestamp_ns = NetworkToLocal<kP2PLocalEndianness>(time_sync_request.sync_edge_local_timestamp_ns);
   if (last_edge_detect_remote_timestamp_ns > last_edge_detect_local_timestamp_ns_) {
       system_timer_.global_offset_nanoseconds() = last_edge_detect_remote_timestamp_ns - last_edge_detect_local_timestamp_ns_;
-      char tmp[24];
-      Uint64ToString(system_timer_.global_offset_nanoseconds(), tmp);
-      char str[48];
-      sprintf(str, "Global timer +%s ns", tmp);
-      LOG_INFO(str);
+      LOG_INFO_FMT(kLogFormatGlobalTimerOffset, system_timer_.global_offset_nanoseconds());
+  }
+  return true;
+}
+
+bool SyncTimeActionHandler::OnTwoWayRequest() {
+  const uint64_t advance_global_ns = NetworkToLocal<kP2PLocalEndianness>(GetRequest().advance_global_ns);
+  if (advance_global_ns > 0) {
+    system_timer_.global_offset_nanoseconds() += advance_global_ns;
+    LOG_INFO_FMT(kLogFormatGlobalTimerAdvance, advance_global_ns);
   }
+  // The packet should still be in the input stream at this call.
+  const auto maybe_request_packet = p2p_stream().input().OldestPacket();
+  ASSERT(maybe_request_packet.ok());
+  request_reception_global_ns_ = system_timer_.LocalToGlobalNanoseconds(maybe_request_packet->reception_local_time_ns());
   return true;
 }
 
@@ -72,8 +90,21 @@ bool SyncTimeActionHandler::Run() {
     return true;
   }
 
+  if (mode_ == kTimeSyncTwoWay) {
+    (*maybe_reply)->sync_edge_local_timestamp_ns = 0;
+    (*maybe_reply)->request_reception_global_ns = LocalToNetwork<kP2PLocalEndianness>(request_reception_global_ns_);
+    // Stamp as late as possible, so that only the time the reply waits in the output queue
+    // counts as delay.
+    (*maybe_reply)->reply_transmission_global_ns = LocalToNetwork<kP2PLocalEndianness>(system_timer_.GetGlobalNanoseconds());
+    // Lost replies only cost an exchange, which the client retries.
+    maybe_reply->Commit(/*guarantee_delivery=*/false);
+    return false;
+  }
+
   // The edge detection latency on this computer is negligible compared to that on the Linux.
   (*maybe_reply)->sync_edge_local_timestamp_ns = LocalToNetwork<kP2PLocalEndianness>(last_edge_detect_local_timestamp_ns_);
+  (*maybe_reply)->request_reception_global_ns = 0;
+  (*maybe_reply)->reply_transmission_global_ns = 0;
 
   // No need to guarantee reply delivery: if it is not delivered, the client will just retry the time sync action
   // at a later time, and this packet will not hold back other unguaranteed packets of equal priority or less.
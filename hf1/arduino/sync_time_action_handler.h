@@ -7,6 +7,7 @@ class SyncTimeActionHandler : public P2PActionHandler<P2PSyncTimeRequest, P2PSyn
 public:
   // Does not take ownsership of the pointees, which must outlive this object.
   SyncTimeActionHandler(P2PPacketStreamArduino *p2p_stream, TimerInterface *system_timer);
+  ~SyncTimeActionHandler();
 
   bool OnRequest() override;
   void Init() override;
@@ -16,7 +17,11 @@ public:
   static void NotifyEdgeDetected();
 
 private:
+  bool OnTwoWayRequest();
+
   TimerInterface &system_timer_;
+  P2PTimeSyncMode mode_;
+  uint64_t request_reception_global_ns_;
   enum { WAIT_FOR_TIME_SYNC_REQUEST, SEND_TIME_SYNC_REPLY } state_;
   uint64_t last_edge_detect_local_timestamp_ns_;
 };
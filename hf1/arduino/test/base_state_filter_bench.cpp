@@ -0,0 +1,465 @@
+// Replays event sequences through the base state filters on the host, and reports the
+// cost of every filter update, heap allocations and accuracy versus ground truth.
+//
+// Usage: base_state_filter_bench [--events <file.csv> | --log <file>] [--loop_hz <rate>] [--seed <seed>]
+//
+// Without --events or --log, synthetic sequences are generated from a differential drive model with
+// the robot geometry in robot_model.h. Recorded sequences are CSV files with one event per
+// line: timer_ticks,type,v0,v1,v2,v3,v4,v5, where type is an EventType; v0 is the payload
+// of wheel direction commands; and v0-v2 the accelerations and v3-v5 the attitude of IMU
+// readings. Lines starting with '#' are ignored. --log replays a binary log recorded from the
+// robot with the kRecordBaseStateEvents action. Recorded sequences have no ground truth.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "base_state_event_log.h"
+#include "base_state_events.h"
+#include "base_state_filter.h"
+#include "complementary_base_state_filter.h"
+#include "robot_model.h"
+#include "utils.h"
+
+// Rate at which the firmware main loop feeds events to the filter. The filters are tuned
+// for this rate.
+#define kDefaultLoopRate 160.0
+#define kIMUPeriodSeconds 0.02
+#define kStdevIMUAccel 0.012  // [m/s^2]
+#define kStdevIMUYaw 0.001    // [rad]
+// The firmware starts estimating after initialization.
+#define kStartSeconds 3.0
+
+// --- Heap allocation accounting ---
+
+static size_t num_allocations = 0;
+static size_t num_allocated_bytes = 0;
+
+void *operator new(size_t size) {
+  ++num_allocations;
+  num_allocated_bytes += size;
+  void *p = malloc(size);
+  if (p == nullptr) { throw std::bad_alloc(); }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t size) noexcept { free(p); }
+
+// --- Timing ---
+
+static int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Cost of the timing itself, subtracted from every measurement.
+static int64_t GetTimingOverheadNanos() {
+  constexpr int kNumSamples = 100'000;
+  const int64_t start = NowNanos();
+  for (int i = 0; i < kNumSamples; ++i) {
+    NowNanos();
+  }
+  return (NowNanos() - start) / kNumSamples;
+}
+
+class CallStats {
+public:
+  void Add(int64_t nanos) { ++calls_; total_nanos_ += nanos; }
+  int64_t calls() const { return calls_; }
+  double nanos_per_call() const { return calls_ == 0 ? 0.0 : static_cast<double>(total_nanos_) / calls_; }
+
+private:
+  int64_t calls_ = 0;
+  int64_t total_nanos_ = 0;
+};
+
+// Forwards all calls to another filter, measuring their cost.
+class ProfiledBaseStateFilter : public BaseStateFilterInterface {
+public:
+  ProfiledBaseStateFilter(BaseStateFilterInterface *filter, int64_t timing_overhead_nanos)
+    : filter_(*filter), timing_overhead_nanos_(timing_overhead_nanos) {}
+
+  void NotifyWheelTicks(TimerTicksType timer_ticks, int left_ticks_inc, int right_ticks_inc) override {
+    const int64_t start = NowNanos();
+    filter_.NotifyWheelTicks(timer_ticks, left_ticks_inc, right_ticks_inc);
+    wheel_ticks_.Add(NowNanos() - start - timing_overhead_nanos_);
+  }
+  void NotifyLeftWheelDirection(bool backward) override { filter_.NotifyLeftWheelDirection(backward); }
+  void NotifyRightWheelDirection(bool backward) override { filter_.NotifyRightWheelDirection(backward); }
+  void NotifyIMUReading(TimerTicksType timer_ticks, float accel_x, float accel_y, float yaw) override {
+    const int64_t start = NowNanos();
+    filter_.NotifyIMUReading(timer_ticks, accel_x, accel_y, yaw);
+    imu_readings_.Add(NowNanos() - start - timing_overhead_nanos_);
+  }
+  void EstimateState(TimerTicksType timer_ticks) override {
+    const int64_t start = NowNanos();
+    filter_.EstimateState(timer_ticks);
+    estimates_.Add(NowNanos() - start - timing_overhead_nanos_);
+  }
+  void Reset(const BaseState &state, TimerTicksType timer_ticks) override { filter_.Reset(state, timer_ticks); }
+  BaseState state() const override { return filter_.state(); }
+  TimerTicksType state_update_timer_ticks() const override { return filter_.state_update_timer_ticks(); }
+
+  const CallStats &wheel_ticks() const { return wheel_ticks_; }
+  const CallStats &imu_readings() const { return imu_readings_; }
+  const CallStats &estimates() const { return estimates_; }
+
+private:
+  BaseStateFilterInterface &filter_;
+  const int64_t timing_overhead_nanos_;
+  CallStats wheel_ticks_;
+  CallStats imu_readings_;
+  CallStats estimates_;
+};
+
+// --- Event sequences ---
+
+struct Pose {
+  double x;
+  double y;
+  double yaw;
+};
+
+struct EventSequence {
+  std::string name;
+  std::vector<Event> events;  // In chronological order.
+  TimerTicksType start_ticks;
+  TimerTicksType end_ticks;
+  // Returns the true pose at the given time. Empty if unknown.
+  std::function<Pose(TimerTicksType)> ground_truth;
+};
+
+static TimerTicksType TicksFromSeconds(double seconds) {
+  return static_cast<TimerTicksType>(llround(seconds * kTimerTicksPerSecond));
+}
+
+static Event WheelTickEvent(EventType type, TimerTicksType timer_ticks) {
+  Event event = {};
+  event.type = type;
+  event.timer_ticks = timer_ticks;
+  return event;
+}
+
+static Event WheelDirectionEvent(EventType type, TimerTicksType timer_ticks, bool backward) {
+  Event event = WheelTickEvent(type, timer_ticks);
+  // As in the firmware loop, this field carries whether the wheel turns backward.
+  event.payload.wheel_direction.is_forward = backward;
+  return event;
+}
+
+// Base speed commands at a given time since the start of a motion.
+using MotionFunction = std::function<void(double seconds, double *linear_speed, double *angular_speed)>;
+
+// Simulates a differential drive base following `motion`, and returns the sequence of
+// events the firmware would register: encoder edges, wheel direction changes and noisy IMU
+// readings.
+static EventSequence GenerateSequence(const char *name, double duration_seconds, const MotionFunction &motion, unsigned int seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> accel_noise(0.0, kStdevIMUAccel);
+  std::normal_distribution<double> yaw_noise(0.0, kStdevIMUYaw);
+
+  EventSequence sequence;
+  sequence.name = name;
+  sequence.start_ticks = TicksFromSeconds(kStartSeconds);
+  sequence.end_ticks = TicksFromSeconds(kStartSeconds + duration_seconds);
+  auto poses = std::make_shared<std::vector<Pose>>();
+
+  const double dt = 1.0 / kTimerTicksPerSecond;
+  Pose pose = { 0, 0, 0 };
+  double wheel_angles[2] = { 0, 0 };
+  double last_tick_wheel_angles[2] = { 0, 0 };
+  bool wheel_backward[2] = { false, false };
+  double last_linear_speed = 0;
+  TimerTicksType next_imu_ticks = sequence.start_ticks;
+  for (TimerTicksType ticks = sequence.start_ticks; ticks <= sequence.end_ticks; ++ticks) {
+    poses->push_back(pose);
+    double linear_speed, angular_speed;
+    motion((ticks - sequence.start_ticks) * dt, &linear_speed, &angular_speed);
+    const double wheel_speeds[2] = {
+      (linear_speed - 0.5 * angular_speed * kRobotDistanceBetweenTireCenters) / kWheelRadius,
+      (linear_speed + 0.5 * angular_speed * kRobotDistanceBetweenTireCenters) / kWheelRadius,
+    };
+    const EventType tick_types[2] = { kLeftWheelTick, kRightWheelTick };
+    const EventType direction_types[2] = { kLeftWheelDirectionCommand, kRightWheelDirectionCommand };
+    for (int wheel = 0; wheel < 2; ++wheel) {
+      if (wheel_speeds[wheel] != 0 && (wheel_speeds[wheel] < 0) != wheel_backward[wheel]) {
+        wheel_backward[wheel] = wheel_speeds[wheel] < 0;
+        sequence.events.push_back(WheelDirectionEvent(direction_types[wheel], ticks, wheel_backward[wheel]));
+      }
+      wheel_angles[wheel] += wheel_speeds[wheel] * dt;
+      if (fabs(wheel_angles[wheel] - last_tick_wheel_angles[wheel]) >= kRadiansPerWheelTick) {
+        last_tick_wheel_angles[wheel] += (wheel_angles[wheel] > last_tick_wheel_angles[wheel] ? 1 : -1) * kRadiansPerWheelTick;
+        sequence.events.push_back(WheelTickEvent(tick_types[wheel], ticks));
+      }
+    }
+    if (ticks >= next_imu_ticks) {
+      next_imu_ticks += TicksFromSeconds(kIMUPeriodSeconds);
+      Event event = WheelTickEvent(kIMUReading, ticks);
+      event.payload.imu.position_acceleration[0] = (linear_speed - last_linear_speed) / dt + accel_noise(rng);
+      event.payload.imu.position_acceleration[1] = linear_speed * angular_speed + accel_noise(rng);
+      event.payload.imu.position_acceleration[2] = 0;
+      event.payload.imu.attitude[0] = 0;
+      event.payload.imu.attitude[1] = 0;
+      event.payload.imu.attitude[2] = NormalizeRadians(pose.yaw + yaw_noise(rng));
+      sequence.events.push_back(event);
+    }
+    last_linear_speed = linear_speed;
+    pose.x += linear_speed * cos(pose.yaw) * dt;
+    pose.y += linear_speed * sin(pose.yaw) * dt;
+    pose.yaw += angular_speed * dt;
+  }
+  const TimerTicksType start_ticks = sequence.start_ticks;
+  sequence.ground_truth = [poses, start_ticks](TimerTicksType ticks) {
+    const size_t index = std::min<size_t>(ticks - start_ticks, poses->size() - 1);
+    return (*poses)[index];
+  };
+  return sequence;
+}
+
+static std::vector<EventSequence> GenerateSyntheticSequences(unsigned int seed) {
+  std::vector<EventSequence> sequences;
+  sequences.push_back(GenerateSequence("straight", 6, [](double t, double *v, double *w) {
+    *v = 0.3 * std::min(1.0, t / 0.5);
+    *w = 0;
+  }, seed));
+  sequences.push_back(GenerateSequence("circle", 10, [](double t, double *v, double *w) {
+    *v = 0.2;
+    *w = 0.8;
+  }, seed));
+  sequences.push_back(GenerateSequence("figure_eight", 14, [](double t, double *v, double *w) {
+    *v = 0.2;
+    *w = 0.9 * sin(2 * M_PI * t / 14);
+  }, seed));
+  sequences.push_back(GenerateSequence("spin", 6, [](double t, double *v, double *w) {
+    *v = 0;
+    *w = t < 3 ? 2.0 : -2.0;
+  }, seed));
+  sequences.push_back(GenerateSequence("back_and_forth", 12, [](double t, double *v, double *w) {
+    *v = 0.25 * sin(2 * M_PI * t / 4);
+    *w = 0.3;
+  }, seed));
+  return sequences;
+}
+
+// Sorts the events of a recorded sequence and sets its time span.
+static bool FinishRecordedSequence(const char *filename, EventSequence *sequence) {
+  if (sequence->events.empty()) {
+    fprintf(stderr, "%s: no events\n", filename);
+    return false;
+  }
+  std::stable_sort(sequence->events.begin(), sequence->events.end(), [](const Event &a, const Event &b) {
+    return a.timer_ticks < b.timer_ticks;
+  });
+  sequence->start_ticks = sequence->events.front().timer_ticks;
+  sequence->end_ticks = sequence->events.back().timer_ticks;
+  return true;
+}
+
+static bool LoadRecordedSequence(const char *filename, EventSequence *sequence) {
+  FILE *file = fopen(filename, "r");
+  if (file == nullptr) {
+    fprintf(stderr, "Cannot open %s\n", filename);
+    return false;
+  }
+  sequence->name = filename;
+  char line[256];
+  int line_number = 0;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    ++line_number;
+    if (line[0] == '#' || line[0] == '\n') { continue; }
+    unsigned long long timer_ticks;
+    int type;
+    float v[6] = {};
+    if (sscanf(line, "%llu,%d,%f,%f,%f,%f,%f,%f", &timer_ticks, &type, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) < 2 ||
+        type < kLeftWheelTick || type > kIMUReading) {
+      fprintf(stderr, "%s:%d: malformed event\n", filename, line_number);
+      fclose(file);
+      return false;
+    }
+    Event event = WheelTickEvent(static_cast<EventType>(type), timer_ticks);
+    if (type == kIMUReading) {
+      memcpy(event.payload.imu.position_acceleration, &v[0], 3 * sizeof(float));
+      memcpy(event.payload.imu.attitude, &v[3], 3 * sizeof(float));
+    } else {
+      event.payload.wheel_direction.is_forward = v[0] != 0;
+    }
+    sequence->events.push_back(event);
+  }
+  fclose(file);
+  return FinishRecordedSequence(filename, sequence);
+}
+
+static bool LoadLoggedSequence(const char *filename, EventSequence *sequence) {
+  BaseStateEventLogReader reader;
+  if (reader.Open(filename) != kSuccess) {
+    fprintf(stderr, "Cannot open %s as a base state event log\n", filename);
+    return false;
+  }
+  sequence->name = filename;
+  int num_batches = 0;
+  int num_dropped_events = 0;
+  P2PRecordBaseStateEventsProgress batch;
+  int payload_length;
+  Status status;
+  while ((status = reader.Read(&batch, &payload_length)) == kSuccess) {
+    ++num_batches;
+    BaseStateEventBatchDecoder decoder(&batch, payload_length);
+    num_dropped_events += decoder.num_dropped_events();
+    BaseStateEventRecord record;
+    while ((status = decoder.Next(&record)) == kSuccess) {
+      sequence->events.push_back(EventFromBaseStateEventRecord(record));
+    }
+    if (status != kDoesNotExistError) {
+      fprintf(stderr, "%s: malformed batch %d\n", filename, num_batches);
+      return false;
+    }
+  }
+  if (status != kDoesNotExistError) {
+    fprintf(stderr, "%s: truncated after batch %d\n", filename, num_batches);
+    return false;
+  }
+  if (num_dropped_events > 0) {
+    fprintf(stderr, "%s: %d events were dropped while recording\n", filename, num_dropped_events);
+  }
+  return FinishRecordedSequence(filename, sequence);
+}
+
+// --- Replay ---
+
+struct ReplayResult {
+  CallStats wheel_ticks;
+  CallStats imu_readings;
+  CallStats estimates;
+  size_t num_allocations;
+  size_t num_allocated_bytes;
+  double position_rms_error;
+  double position_max_error;
+  double yaw_rms_error;
+  BaseState final_state;
+};
+
+// Feeds the events to the filter in batches, one per main loop iteration, as the firmware does.
+static ReplayResult Replay(const EventSequence &sequence, BaseStateFilterInterface *filter, double loop_rate, int64_t timing_overhead_nanos) {
+  ProfiledBaseStateFilter profiled_filter(filter, timing_overhead_nanos);
+  const TimerTicksType loop_period_ticks = std::max<TimerTicksType>(1, TicksFromSeconds(1.0 / loop_rate));
+  std::vector<Event> batch;
+  batch.reserve(sequence.events.size());
+  double position_squared_error_sum = 0;
+  double position_max_error = 0;
+  double yaw_squared_error_sum = 0;
+  int num_samples = 0;
+
+  const size_t start_num_allocations = num_allocations;
+  const size_t start_num_allocated_bytes = num_allocated_bytes;
+  size_t next_event = 0;
+  for (TimerTicksType loop_ticks = sequence.start_ticks; loop_ticks <= sequence.end_ticks + loop_period_ticks; loop_ticks += loop_period_ticks) {
+    batch.clear();
+    while (next_event < sequence.events.size() && sequence.events[next_event].timer_ticks <= loop_ticks) {
+      batch.push_back(sequence.events[next_event++]);
+    }
+    if (batch.empty()) {
+      profiled_filter.EstimateState(loop_ticks);
+    } else {
+      NotifyBaseStateEvents(batch.data(), batch.size(), &profiled_filter);
+    }
+    if (sequence.ground_truth) {
+      const Pose truth = sequence.ground_truth(loop_ticks);
+      const BaseState estimate = profiled_filter.state();
+      const double position_error = hypot(estimate.location().position().x - truth.x, estimate.location().position().y - truth.y);
+      const double yaw_error = NormalizeRadians(estimate.location().yaw() - truth.yaw);
+      position_squared_error_sum += position_error * position_error;
+      position_max_error = std::max(position_max_error, position_error);
+      yaw_squared_error_sum += yaw_error * yaw_error;
+      ++num_samples;
+    }
+  }
+
+  ReplayResult result;
+  result.wheel_ticks = profiled_filter.wheel_ticks();
+  result.imu_readings = profiled_filter.imu_readings();
+  result.estimates = profiled_filter.estimates();
+  result.num_allocations = num_allocations - start_num_allocations;
+  result.num_allocated_bytes = num_allocated_bytes - start_num_allocated_bytes;
+  result.position_rms_error = num_samples == 0 ? NAN : sqrt(position_squared_error_sum / num_samples);
+  result.position_max_error = num_samples == 0 ? NAN : position_max_error;
+  result.yaw_rms_error = num_samples == 0 ? NAN : sqrt(yaw_squared_error_sum / num_samples);
+  result.final_state = profiled_filter.state();
+  return result;
+}
+
+static void PrintHeader() {
+  printf("%-16s %-14s %7s %10s %10s %10s %7s %10s %10s %10s %11s\n",
+         "sequence", "filter", "events", "wheel_ns", "imu_ns", "estim_ns", "allocs", "alloc_B",
+         "pos_rms_mm", "pos_max_mm", "yaw_rms_deg");
+}
+
+static void PrintResult(const EventSequence &sequence, const char *filter_name, const ReplayResult &result) {
+  printf("%-16s %-14s %7zu %10.1f %10.1f %10.1f %7zu %10zu %10.2f %10.2f %11.3f\n",
+         sequence.name.c_str(), filter_name, sequence.events.size(),
+         result.wheel_ticks.nanos_per_call(), result.imu_readings.nanos_per_call(), result.estimates.nanos_per_call(),
+         result.num_allocations, result.num_allocated_bytes,
+         1e3 * result.position_rms_error, 1e3 * result.position_max_error, DegreesFromRadians(result.yaw_rms_error));
+  if (!sequence.ground_truth) {
+    printf("  final state: x=%.3f m, y=%.3f m, yaw=%.2f deg\n",
+           result.final_state.location().position().x, result.final_state.location().position().y,
+           DegreesFromRadians(result.final_state.location().yaw()));
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *events_filename = nullptr;
+  const char *log_filename = nullptr;
+  double loop_rate = kDefaultLoopRate;
+  unsigned int seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--events") == 0 && i + 1 < argc) {
+      events_filename = argv[++i];
+    } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+      log_filename = argv[++i];
+    } else if (strcmp(argv[i], "--loop_hz") == 0 && i + 1 < argc) {
+      loop_rate = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = static_cast<unsigned int>(atoi(argv[++i]));
+    } else {
+      fprintf(stderr, "Usage: %s [--events <file.csv> | --log <file>] [--loop_hz <rate>] [--seed <seed>]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (loop_rate <= 0) {
+    fprintf(stderr, "--loop_hz must be positive.\n");
+    return 1;
+  }
+
+  std::vector<EventSequence> sequences;
+  if (events_filename != nullptr) {
+    EventSequence sequence;
+    if (!LoadRecordedSequence(events_filename, &sequence)) { return 1; }
+    sequences.push_back(std::move(sequence));
+  } else if (log_filename != nullptr) {
+    EventSequence sequence;
+    if (!LoadLoggedSequence(log_filename, &sequence)) { return 1; }
+    sequences.push_back(std::move(sequence));
+  } else {
+    sequences = GenerateSyntheticSequences(seed);
+  }
+
+  const int64_t timing_overhead_nanos = GetTimingOverheadNanos();
+  printf("Loop rate: %.1f Hz. Timing overhead subtracted: %lld ns.\n", loop_rate, static_cast<long long>(timing_overhead_nanos));
+  PrintHeader();
+  for (const EventSequence &sequence : sequences) {
+    // Filters are created for every sequence, so they all start from the same state.
+    BaseStateFilter kalman_filter;
+    PrintResult(sequence, "kalman", Replay(sequence, &kalman_filter, loop_rate, timing_overhead_nanos));
+    ComplementaryBaseStateFilter complementary_filter;
+    PrintResult(sequence, "complementary", Replay(sequence, &complementary_filter, loop_rate, timing_overhead_nanos));
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "bno055_reader.h"
+#include "mock_i2c_bus.h"
+#include "timer_host.h"
+
+static void SetInt16(uint8_t *registers, int16_t value) {
+  registers[0] = static_cast<uint16_t>(value) & 0xff;
+  registers[1] = static_cast<uint16_t>(value) >> 8;
+}
+
+TEST(BNO055ReaderTest, RunWithoutRequestDoesNothing) {
+  MockI2CBus bus(kBNO055DefaultAddress);
+  BNO055Reader reader(&bus);
+
+  EXPECT_EQ(reader.Run(), kDoesNotExistError);
+  EXPECT_EQ(bus.num_started_transfers(), 0);
+}
+
+TEST(BNO055ReaderTest, ReadingCompletesAcrossRuns) {
+  MockI2CBus bus(kBNO055DefaultAddress);
+  bus.polls_per_transfer(3);
+  BNO055Reader reader(&bus);
+
+  ASSERT_EQ(reader.Request(/*timer_ticks=*/1234), kSuccess);
+  EXPECT_EQ(reader.Request(/*timer_ticks=*/1235), kExistsError);
+  EXPECT_EQ(reader.Run(), kUnavailableError);
+  EXPECT_EQ(reader.Run(), kUnavailableError);
+  EXPECT_EQ(reader.Run(), kSuccess);
+  EXPECT_EQ(reader.reading_timer_ticks(), 1234);
+  EXPECT_FALSE(reader.in_progress());
+  EXPECT_EQ(reader.Run(), kDoesNotExistError);
+  // The Euler angles and linear accelerations are read in one transfer.
+  EXPECT_EQ(bus.num_started_transfers(), 1);
+}
+
+TEST(BNO055ReaderTest, ConvertsRegistersToRobotFrame) {
+  MockI2CBus bus(kBNO055DefaultAddress);
+  uint8_t *registers = bus.registers();
+  SetInt16(&registers[0x1a], 90 * 16);   // Heading [deg].
+  SetInt16(&registers[0x1c], -10 * 16);  // Roll [deg].
+  SetInt16(&registers[0x1e], 20 * 16);   // Pitch [deg].
+  SetInt16(&registers[0x28], 150);       // Linear acceleration x [cm/s^2].
+  SetInt16(&registers[0x2a], -25);
+  SetInt16(&registers[0x2c], 981);
+  BNO055Reader reader(&bus);
+
+  ASSERT_EQ(reader.Request(0), kSuccess);
+  ASSERT_EQ(reader.Run(), kSuccess);
+
+  const BNO055Reading &reading = reader.reading();
+  EXPECT_FLOAT_EQ(reading.attitude[0], -20 * M_PI / 180);
+  EXPECT_FLOAT_EQ(reading.attitude[1], 10 * M_PI / 180);
+  // Clockwise headings are negative yaws.
+  EXPECT_FLOAT_EQ(reading.attitude[2], -M_PI / 2);
+  EXPECT_FLOAT_EQ(reading.linear_acceleration[0], 1.5f);
+  EXPECT_FLOAT_EQ(reading.linear_acceleration[1], -0.25f);
+  EXPECT_FLOAT_EQ(reading.linear_acceleration[2], 9.81f);
+}
+
+TEST(BNO055ReaderTest, YawIsSymmetric) {
+  uint8_t registers[20] = {};
+  SetInt16(&registers[0], 270 * 16);
+
+  EXPECT_FLOAT_EQ(BNO055Reader::ReadingFromRegisters(registers).attitude[2], M_PI / 2);
+}
+
+TEST(BNO055ReaderTest, MissingDeviceFailsReading) {
+  MockI2CBus bus(/*device_address=*/0x29);
+  BNO055Reader reader(&bus);
+
+  ASSERT_EQ(reader.Request(0), kSuccess);
+  EXPECT_EQ(reader.Run(), kMalformedError);
+  EXPECT_FALSE(reader.in_progress());
+  EXPECT_EQ(reader.Request(0), kSuccess);
+}
+
+TEST(BNO055ReaderTest, HungTransferTimesOut) {
+  MockI2CBus bus(kBNO055DefaultAddress);
+  bus.hang(true);
+  BNO055Reader reader(&bus);
+
+  ASSERT_EQ(reader.Request(0), kSuccess);
+  EXPECT_EQ(reader.Run(), kUnavailableError);
+  AdvanceTimerTicks(kTimerTicksPerSecond / 100);
+  EXPECT_EQ(reader.Run(), kMalformedError);
+  EXPECT_EQ(bus.num_aborted_transfers(), 1);
+  EXPECT_FALSE(bus.transfer_in_progress());
+}
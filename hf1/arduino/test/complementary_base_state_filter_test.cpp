@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "complementary_base_state_filter.h"
+#include "robot_model.h"
+#include "timer.h"
+
+// Yaw increment of a single right wheel tick.
+#define kYawPerRightWheelTick (kRadiansPerWheelTick * kWheelRadius / kRobotDistanceBetweenTireCenters)
+
+class ComplementaryBaseStateFilterTest : public ::testing::Test {
+protected:
+  static TimerTicksType TimerTicksFromMillis(int millis) {
+    return millis * kTimerTicksPerSecond / 1000;
+  }
+
+  float yaw() const {
+    return filter_.state().location().yaw();
+  }
+
+  // Sends IMU readings every 10 ms up to `end_millis`, turning at `yaw_velocity` radians per
+  // second, with a straight wheel tick between readings.
+  void TurnWithIMU(int start_millis, int end_millis, float yaw_velocity) {
+    for (int millis = start_millis; millis <= end_millis; millis += 10) {
+      filter_.NotifyIMUReading(TimerTicksFromMillis(millis), 0, 0, yaw_velocity * millis * 1e-3f);
+      filter_.NotifyWheelTicks(TimerTicksFromMillis(millis + 5), 1, 1);
+    }
+  }
+
+  ComplementaryBaseStateFilter filter_;
+};
+
+TEST_F(ComplementaryBaseStateFilterTest, FollowsOdometryBeforeTheFirstIMUReading) {
+  for (int i = 1; i <= 10; ++i) {
+    filter_.NotifyWheelTicks(TimerTicksFromMillis(10 * i), 0, 1);
+  }
+  EXPECT_NEAR(yaw(), 10 * kYawPerRightWheelTick, 1e-5);
+}
+
+TEST_F(ComplementaryBaseStateFilterTest, BlendsTheExtrapolatedIMUYawBetweenReadings) {
+  TurnWithIMU(0, 100, 1.0f);
+  // The last wheel tick came 5 ms after the last reading, at 0.1 rad.
+  EXPECT_NEAR(yaw(), 0.105f, 1e-3);
+}
+
+TEST_F(ComplementaryBaseStateFilterTest, FollowsOdometryOnceIMUReadingsStop) {
+  TurnWithIMU(0, 100, 1.0f);
+  for (int millis = 110; millis <= 200; millis += 10) {
+    filter_.NotifyWheelTicks(TimerTicksFromMillis(millis), 1, 1);
+  }
+  const float stalled_yaw = yaw();
+  // The extrapolation stopped within a few IMU periods.
+  EXPECT_NEAR(stalled_yaw, 0.1f, 0.06f);
+
+  // Going straight keeps the yaw, rather than extrapolating the last IMU turn.
+  for (int millis = 210; millis <= 1000; millis += 10) {
+    filter_.NotifyWheelTicks(TimerTicksFromMillis(millis), 1, 1);
+  }
+  EXPECT_FLOAT_EQ(yaw(), stalled_yaw);
+  filter_.NotifyWheelTicks(TimerTicksFromMillis(1010), 0, 1);
+  EXPECT_NEAR(yaw(), stalled_yaw + kYawPerRightWheelTick, 1e-5);
+
+  // A new reading is blended, but not extrapolated from the stale one.
+  filter_.NotifyIMUReading(TimerTicksFromMillis(1020), 0, 0, 0.5f);
+  filter_.NotifyWheelTicks(TimerTicksFromMillis(1030), 1, 1);
+  EXPECT_NEAR(yaw(), 0.5f, 1e-3);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+#include "differential_drive_plant.h"
+#include "bno055_reader.h"
+#include "robot_model.h"
+#include "utils.h"
+
+// Registers from the first Euler angle register to the end of the linear accelerations.
+#define kIMURegistersLength 0x14
+
+static void RecordEdge(void *arg, TimerTicksType timer_ticks) {
+  static_cast<std::vector<TimerTicksType> *>(arg)->push_back(timer_ticks);
+}
+
+TEST(DifferentialDrivePlantTest, StartsAtRest) {
+  DifferentialDrivePlant plant;
+  plant.Step(kTimerTicksPerSecond, 0, 0);
+
+  EXPECT_EQ(plant.timer_ticks(), kTimerTicksPerSecond);
+  EXPECT_EQ(plant.state().x, 0);
+  EXPECT_EQ(plant.state().y, 0);
+  EXPECT_EQ(plant.num_left_encoder_edges(), 0);
+  EXPECT_EQ(plant.num_right_encoder_edges(), 0);
+}
+
+TEST(DifferentialDrivePlantTest, ReachesSteadyStateSpeed) {
+  DifferentialDrivePlantConfig config;
+  config.left_motor_gain = 1.0;
+  config.right_motor_gain = 1.0;
+  DifferentialDrivePlant plant(config);
+  const float duty_cycle = 0.6;
+  const double speed = DifferentialDrivePlant::SteadyStateWheelSpeed(duty_cycle);
+  ASSERT_GT(speed, 0);
+
+  // After 10 time constants, the robot goes straight at the steady state speed.
+  plant.Step(kTimerTicksPerSecond, duty_cycle, duty_cycle);
+  EXPECT_NEAR(plant.state().left_wheel_speed, speed, 1e-4 * speed);
+  EXPECT_NEAR(plant.state().right_wheel_speed, speed, 1e-4 * speed);
+  EXPECT_NEAR(plant.state().y, 0, 1e-9);
+  EXPECT_NEAR(plant.state().yaw, 0, 1e-9);
+
+  // The first order response lags the step by one time constant.
+  EXPECT_NEAR(plant.state().x, speed * (1 - config.motor_time_constant_seconds), 1e-3);
+}
+
+TEST(DifferentialDrivePlantTest, EncoderEdgesMatchWheelRotation) {
+  DifferentialDrivePlantConfig config;
+  config.left_motor_gain = 1.0;
+  config.right_motor_gain = 1.0;
+  DifferentialDrivePlant plant(config);
+  std::vector<TimerTicksType> edges[2];
+  plant.encoder_edge_callbacks(
+    [](void *arg, TimerTicksType ticks) { RecordEdge(&static_cast<std::vector<TimerTicksType> *>(arg)[0], ticks); },
+    [](void *arg, TimerTicksType ticks) { RecordEdge(&static_cast<std::vector<TimerTicksType> *>(arg)[1], ticks); },
+    edges);
+
+  // Backwards, as the encoders count edges in both directions.
+  plant.Step(2 * kTimerTicksPerSecond, -0.6, -0.6);
+
+  const double meters_per_edge = kRadiansPerWheelTick * kWheelRadius;
+  const size_t expected_num_edges = static_cast<size_t>(-plant.state().x / meters_per_edge);
+  EXPECT_LT(plant.state().x, 0);
+  for (const auto &wheel_edges : edges) {
+    ASSERT_NEAR(wheel_edges.size(), expected_num_edges, 1);
+    for (size_t i = 1; i < wheel_edges.size(); ++i) {
+      EXPECT_LE(wheel_edges[i - 1], wheel_edges[i]);
+    }
+    EXPECT_LE(wheel_edges.back(), plant.timer_ticks());
+  }
+  EXPECT_EQ(edges[0].size(), plant.num_left_encoder_edges());
+  EXPECT_EQ(edges[1].size(), plant.num_right_encoder_edges());
+  // At steady state, edges are evenly spaced.
+  const double edge_period_ticks = meters_per_edge / fabs(plant.state().left_wheel_speed) * kTimerTicksPerSecond;
+  const auto &left_edges = edges[0];
+  EXPECT_NEAR(left_edges.back() - left_edges[left_edges.size() - 2], edge_period_ticks, 1);
+}
+
+TEST(DifferentialDrivePlantTest, IMURegistersDecodeToPlantState) {
+  DifferentialDrivePlantConfig config;
+  config.imu_acceleration_stdev = 0;
+  config.imu_yaw_stdev = 0;
+  // Update the registers in every integration step, so they hold the final state.
+  config.imu_period_seconds = 0;
+  DifferentialDrivePlant plant(config);
+  uint8_t registers[kIMURegistersLength] = {};
+  plant.imu_registers(registers);
+
+  // Turn counterclockwise while accelerating.
+  plant.Step(kTimerTicksPerSecond / 10, 0.5, 0.9);
+  const BNO055Reading reading = BNO055Reader::ReadingFromRegisters(registers);
+  EXPECT_GT(plant.state().yaw, 0);
+  // Heading has a resolution of 1/16 degrees.
+  EXPECT_NEAR(reading.attitude[2], plant.state().yaw, RadiansFromDegrees(1.0 / 16));
+  EXPECT_GT(reading.linear_acceleration[0], 0);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "periodic_runnable.h"
+#include "timer_host.h"
+
+#define kTicksPerMs (kTimerTicksPerSecond / 1000)
+
+// Takes `work_ticks` of virtual time in each run.
+class BusyRunnable : public PeriodicRunnable {
+public:
+  BusyRunnable(TimerNanosType period_nanos) : PeriodicRunnable("BusyRunnable", period_nanos), work_ticks_(0) {}
+
+  void work_ticks(TimerTicksType ticks) { work_ticks_ = ticks; }
+
+protected:
+  void RunAfterPeriod(TimerNanosType now_nanos, TimerNanosType nanos_since_last_call) override {
+    AdvanceTimerTicks(work_ticks_);
+  }
+
+private:
+  TimerTicksType work_ticks_;
+};
+
+TEST(PeriodicRunnableTest, RecordsPeriodErrorAndRunTime) {
+  BusyRunnable runnable(5'000'000);
+  runnable.work_ticks(kTicksPerMs);
+  ASSERT_TRUE(runnable.Run());
+
+  // Called 2 ms late in every period.
+  for (int i = 0; i < 10; ++i) {
+    SetTimerTicks((runnable.next_run_nanos() + 2'000'000) * kTimerTicksPerSecond / 1'000'000'000);
+    ASSERT_TRUE(runnable.Run());
+  }
+
+  EXPECT_EQ(runnable.period_error_histogram().total_count(), 10);
+  EXPECT_EQ(runnable.period_error_histogram().BucketForValue(runnable.period_error_histogram().max_value()), 
+            runnable.period_error_histogram().BucketForValue(2'000'000));
+  EXPECT_EQ(runnable.run_histogram().total_count(), 11);
+  EXPECT_GT(runnable.run_histogram().max_value(), 900'000);
+  EXPECT_EQ(runnable.num_overruns(), 0);
+  EXPECT_EQ(runnable.num_skipped_periods(), 0);
+  EXPECT_STREQ(runnable.name(), "BusyRunnable");
+}
+
+TEST(PeriodicRunnableTest, CountsOverrunsAndClearsStats) {
+  BusyRunnable runnable(5'000'000);
+  ASSERT_TRUE(runnable.Run());
+  runnable.work_ticks(6 * kTicksPerMs);
+  SetTimerTicks((runnable.next_run_nanos() * kTimerTicksPerSecond + 999'999'999) / 1'000'000'000);
+  ASSERT_TRUE(runnable.Run());
+  EXPECT_EQ(runnable.num_overruns(), 1);
+
+  runnable.ClearStats();
+
+  EXPECT_EQ(runnable.num_overruns(), 0);
+  EXPECT_EQ(runnable.run_histogram().total_count(), 0);
+  EXPECT_EQ(runnable.period_error_histogram().total_count(), 0);
+}
+
+TEST(PeriodicRunnableTest, SkipsPeriodsThatElapsedDuringALateCall) {
+  BusyRunnable runnable(5'000'000);
+  ASSERT_TRUE(runnable.Run());
+  const TimerNanosType first_run_nanos = runnable.next_run_nanos() - 5'000'000;
+
+  // Late by less than a period: the next run stays on the schedule.
+  SetTimerTicks((runnable.next_run_nanos() + 4'000'000) * kTimerTicksPerSecond / 1'000'000'000);
+  ASSERT_TRUE(runnable.Run());
+  EXPECT_EQ(runnable.next_run_nanos(), first_run_nanos + 10'000'000);
+  EXPECT_EQ(runnable.num_skipped_periods(), 0);
+
+  // Late by 2.4 periods: the periods starting meanwhile are skipped.
+  SetTimerTicks((runnable.next_run_nanos() + 12'000'000) * kTimerTicksPerSecond / 1'000'000'000);
+  ASSERT_TRUE(runnable.Run());
+  EXPECT_EQ(runnable.next_run_nanos(), first_run_nanos + 25'000'000);
+  EXPECT_EQ(runnable.num_skipped_periods(), 2);
+}
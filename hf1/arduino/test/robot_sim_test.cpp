@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "robot_sim.h"
+#include "robot_state_estimator.h"
+
+// The firmware modules are global, so all checks share one simulation.
+TEST(RobotSimTest, FollowsBaseTrajectoryRequestedOverP2P) {
+  RobotSim sim;
+  EXPECT_EQ(sim.true_state().x, 0);
+
+  // Half a circle of radius 0.5 m, counterclockwise.
+  BaseWaypoint waypoints[5];
+  for (int i = 0; i < 5; ++i) {
+    const double angle = M_PI * i / 4;
+    waypoints[i] = BaseWaypoint(1.5 * i, BaseTargetState({BaseStateVars(Point(0.5 * sin(angle), 0.5 * (1 - cos(angle))), /*yaw=*/0)}));
+  }
+  ASSERT_EQ(sim.SendBaseTrajectory(waypoints, 5, InterpolationType::kCubic), kSuccess);
+  sim.RunForSeconds(8);
+
+  EXPECT_EQ(sim.num_replies(P2PAction::kCreateBaseTrajectory), 1);
+  EXPECT_EQ(sim.num_replies(P2PAction::kCreateBaseTrajectoryView), 1);
+  EXPECT_EQ(sim.num_replies(P2PAction::kExecuteBaseTrajectoryView), 1);
+  EXPECT_GT(sim.num_progress_updates(P2PAction::kExecuteBaseTrajectoryView), 0);
+  EXPECT_FALSE(sim.base_trajectory_controller().is_started());
+
+  // The robot ends near the last waypoint, turned around.
+  const DifferentialDrivePlantState &state = sim.true_state();
+  EXPECT_NEAR(state.x, 0, 0.2);
+  EXPECT_NEAR(state.y, 1, 0.2);
+  EXPECT_GT(fabs(state.yaw), 0.75 * M_PI);
+
+  // The estimator tracks the true pose.
+  const BaseStateVars estimate = GetBaseState().location();
+  EXPECT_NEAR(estimate.position().x, state.x, 0.1);
+  EXPECT_NEAR(estimate.position().y, state.y, 0.1);
+  EXPECT_NEAR(NormalizeRadians(estimate.yaw() - state.yaw), 0, 0.05);
+
+  // No control loop missed its period.
+  for (int i = 0; i < sim.scheduler().num_periodic_tasks(); ++i) {
+    EXPECT_EQ(sim.scheduler().periodic_task(i).num_skipped_periods(), 0) << sim.scheduler().periodic_task(i).name();
+  }
+}
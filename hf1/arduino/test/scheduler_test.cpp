@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "scheduler.h"
+#include "timer_host.h"
+
+#define kTicksPerMs (kTimerTicksPerSecond / 1000)
+
+// Records its runs and takes `work_ticks` of virtual time in each.
+class TestTask : public PeriodicRunnable {
+public:
+  TestTask(TimerNanosType period_nanos, TimerTicksType work_ticks = 0, std::vector<TestTask *> *run_order = nullptr)
+    : PeriodicRunnable("TestTask", period_nanos), work_ticks_(work_ticks), run_order_(run_order) {}
+
+  int num_runs() const { return num_runs_; }
+
+protected:
+  void RunFirstTime(TimerNanosType now_nanos) override { RunAfterPeriod(now_nanos, 0); }
+  void RunAfterPeriod(TimerNanosType now_nanos, TimerNanosType nanos_since_last_call) override {
+    ++num_runs_;
+    if (run_order_ != nullptr) { run_order_->push_back(this); }
+    AdvanceTimerTicks(work_ticks_);
+  }
+
+private:
+  const TimerTicksType work_ticks_;
+  std::vector<TestTask *> *run_order_;
+  int num_runs_ = 0;
+};
+
+static TimerTicksType idle_lateness_ticks = 0;
+static int num_idle_calls = 0;
+static TimerNanosType last_idle_until_nanos = 0;
+
+// Wakes up `idle_lateness_ticks` after the requested time.
+static void IdleOnVirtualClock(TimerNanosType until_nanos) {
+  ++num_idle_calls;
+  last_idle_until_nanos = until_nanos;
+  if (until_nanos == ~0ULL) { return; }
+  const TimerTicksType until_ticks = (until_nanos * kTimerTicksPerSecond + 999'999'999ULL) / 1'000'000'000ULL;
+  SetTimerTicks(std::max(GetTimerTicks(), until_ticks + idle_lateness_ticks));
+}
+
+class SchedulerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // The virtual clock cannot go backwards, so every test starts where the last one ended.
+    AdvanceTimerTicks(kTimerTicksPerSecond);
+    idle_lateness_ticks = 0;
+    num_idle_calls = 0;
+    last_idle_until_nanos = 0;
+  }
+};
+
+TEST_F(SchedulerTest, LateWakeUpsDoNotDrift) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(10'000'000);
+  scheduler.AddPeriodicTask(&task);
+  idle_lateness_ticks = 2 * kTicksPerMs;
+  const TimerNanosType start_nanos = GetTimerNanoseconds();
+
+  while (GetTimerNanoseconds() - start_nanos < 1'000'000'000ULL) {
+    scheduler.RunOnce();
+  }
+
+  // One run at the start, and then one every period. The late wakeup for the last one is
+  // already past the end of the second.
+  EXPECT_EQ(task.num_runs(), 100);
+  EXPECT_EQ(task.next_run_nanos(), start_nanos + 100 * 10'000'000ULL);
+  EXPECT_EQ(task.num_skipped_periods(), 0);
+  EXPECT_EQ(task.num_overruns(), 0);
+  EXPECT_GE(task.period_error_histogram().max_value(), 2'000'000ULL);
+}
+
+TEST_F(SchedulerTest, EarliestDeadlineRunsFirst) {
+  std::vector<TestTask *> run_order;
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask slow_task(30'000'000, 0, &run_order);
+  TestTask fast_task(5'000'000, 0, &run_order);
+  scheduler.AddPeriodicTask(&slow_task);
+  scheduler.AddPeriodicTask(&fast_task);
+  scheduler.RunOnce();
+  run_order.clear();
+
+  // Both tasks are due after 30 ms; the one whose period ends first goes first.
+  while (slow_task.num_runs() < 2) {
+    scheduler.RunOnce();
+  }
+
+  ASSERT_GE(run_order.size(), 2);
+  EXPECT_EQ(run_order[run_order.size() - 2], &fast_task);
+  EXPECT_EQ(run_order.back(), &slow_task);
+}
+
+TEST_F(SchedulerTest, CountsOverrunsAndSkippedPeriods) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(5'000'000, /*work_ticks=*/7 * kTicksPerMs);
+  scheduler.AddPeriodicTask(&task);
+
+  for (int i = 0; i < 10; ++i) {
+    scheduler.RunOnce();
+  }
+
+  EXPECT_EQ(task.run_histogram().total_count(), task.num_runs());
+  EXPECT_GT(task.num_overruns(), 0);
+  EXPECT_GT(task.num_skipped_periods(), 0);
+  EXPECT_GT(task.run_histogram().max_value(), 5'000'000ULL);
+}
+
+static int num_background_calls = 0;
+
+// Always has more work, and takes 1 ms per call.
+static bool BusyBackgroundTask(void *) {
+  ++num_background_calls;
+  AdvanceTimerTicks(kTicksPerMs);
+  return true;
+}
+
+TEST_F(SchedulerTest, BackgroundTasksKeepToTheirBudget) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(100'000'000);
+  scheduler.AddPeriodicTask(&task);
+  scheduler.AddBackgroundTask(&BusyBackgroundTask, nullptr, /*budget_nanos=*/3'000'000);
+  num_background_calls = 0;
+
+  scheduler.RunOnce();
+
+  // The 32 us timer resolution may round the elapsed time down, so allow for one more call.
+  EXPECT_GE(num_background_calls, 3);
+  EXPECT_LE(num_background_calls, 4);
+  EXPECT_EQ(scheduler.background_task_stats(0).num_budget_exhaustions, 1);
+  // Pending work prevents idling.
+  EXPECT_EQ(num_idle_calls, 0);
+}
+
+TEST_F(SchedulerTest, BackgroundTasksYieldToTheNextPeriod) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(2'000'000);
+  scheduler.AddPeriodicTask(&task);
+  scheduler.AddBackgroundTask(&BusyBackgroundTask, nullptr, /*budget_nanos=*/50'000'000);
+  num_background_calls = 0;
+
+  scheduler.RunOnce();
+
+  EXPECT_LE(num_background_calls, 3);
+  EXPECT_GE(GetTimerNanoseconds(), task.next_run_nanos());
+}
+
+static bool IdleBackgroundTask(void *) {
+  ++num_background_calls;
+  return false;
+}
+
+TEST_F(SchedulerTest, IdlesUntilTheNextPeriod) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask fast_task(5'000'000);
+  TestTask slow_task(20'000'000);
+  scheduler.AddPeriodicTask(&slow_task);
+  scheduler.AddPeriodicTask(&fast_task);
+  scheduler.AddBackgroundTask(&IdleBackgroundTask, nullptr, /*budget_nanos=*/1'000'000);
+  num_background_calls = 0;
+
+  scheduler.RunOnce();
+
+  EXPECT_EQ(num_background_calls, 1);
+  EXPECT_EQ(num_idle_calls, 1);
+  EXPECT_EQ(scheduler.num_idles(), 1);
+  EXPECT_EQ(last_idle_until_nanos, fast_task.next_run_nanos());
+}
+
+// Records its call in the run order of a TestTask, as a null entry.
+static bool RecordingInputTask(void *run_order) {
+  static_cast<std::vector<TestTask *> *>(run_order)->push_back(nullptr);
+  return false;
+}
+
+TEST_F(SchedulerTest, InputTasksRunBeforeThePeriodicTasks) {
+  std::vector<TestTask *> run_order;
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(5'000'000, 0, &run_order);
+  scheduler.AddPeriodicTask(&task);
+  scheduler.AddInputTask(&RecordingInputTask, &run_order);
+
+  for (int i = 0; i < 3; ++i) {
+    scheduler.RunOnce();
+  }
+
+  // Once per iteration, whether a period started or not.
+  ASSERT_EQ(run_order.size(), 3 + task.num_runs());
+  EXPECT_EQ(run_order[0], nullptr);
+  EXPECT_EQ(run_order[1], &task);
+  for (size_t i = 1; i < run_order.size(); ++i) {
+    if (run_order[i] == &task) {
+      EXPECT_EQ(run_order[i - 1], nullptr);
+    }
+  }
+}
+
+// Reports pending input while `*num_pending_polls` is positive, and counts it down.
+static bool PollingInputTask(void *num_pending_polls) {
+  int &num_polls = *static_cast<int *>(num_pending_polls);
+  if (num_polls > 0) { --num_polls; }
+  return num_polls > 0;
+}
+
+TEST_F(SchedulerTest, DoesNotIdleWhileInputIsPending) {
+  Scheduler scheduler(&IdleOnVirtualClock);
+  TestTask task(5'000'000);
+  scheduler.AddPeriodicTask(&task);
+  int num_pending_polls = 3;
+  scheduler.AddInputTask(&PollingInputTask, &num_pending_polls);
+
+  // The input is polled without waiting for the next period.
+  scheduler.RunOnce();
+  scheduler.RunOnce();
+  EXPECT_EQ(num_idle_calls, 0);
+  EXPECT_EQ(scheduler.num_idles(), 0);
+
+  scheduler.RunOnce();
+  EXPECT_EQ(num_pending_polls, 0);
+  EXPECT_EQ(num_idle_calls, 1);
+  EXPECT_EQ(last_idle_until_nanos, task.next_run_nanos());
+}
@@ -0,0 +1,86 @@
+// Compares the cost of the timer tick reads and conversions on the host with that of their
+// previous implementations, which divided 64-bit integers.
+//
+// Usage: timer_bench [--calls <number>]
+//
+// Host timings only rank the implementations: the Cortex-M4 has no 64-bit divide
+// instruction, so the gap is much larger on the robot.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "timer.h"
+#include "timer_ticks_reader.h"
+
+#define kDefaultNumCalls 10'000'000
+
+static int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Previous conversions. The divisors are read through a volatile to keep the compiler from
+// turning the divisions into multiplications, as the ARM compiler does not.
+static volatile uint64_t ticks_per_second = kTimerTicksPerSecond;
+static volatile uint64_t nanos_per_tick = kTimerNanosPerTick;
+
+static TimerNanosType DividingNanosFromTimerTicks(TimerTicksType ticks) {
+  return ((ticks * 500000ULL) / ticks_per_second) * 2000ULL;
+}
+
+static TimerTicksType DividingTimerTicksFromNanos(TimerNanosType nanos) {
+  return nanos / nanos_per_tick;
+}
+
+// Registers in memory, as an upper bound of the cost of the lock-free read without the bus
+// latency of the peripheral.
+typedef struct {
+  uint32_t num_overflows() const { return num_overflows_; }
+  bool overflow_pending() const { return overflow_pending_; }
+  uint16_t counter() const { return counter_; }
+
+  volatile uint32_t num_overflows_;
+  volatile bool overflow_pending_;
+  volatile uint16_t counter_;
+} MemoryTimerRegisters;
+
+// Returns the average nanoseconds per call of `fn`, passing it a different value each call.
+template<typename TFunction> double TimeCalls(int num_calls, TFunction fn) {
+  volatile uint64_t sink = 0;
+  const int64_t start_nanos = NowNanos();
+  for (int i = 0; i < num_calls; ++i) {
+    sink = sink + fn(i * 7919ULL);
+  }
+  return static_cast<double>(NowNanos() - start_nanos) / num_calls;
+}
+
+int main(int argc, char **argv) {
+  int num_calls = kDefaultNumCalls;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc) {
+      num_calls = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--calls <number>]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (num_calls <= 0) {
+    fprintf(stderr, "--calls must be positive.\n");
+    return 1;
+  }
+
+  MemoryTimerRegisters registers = {};
+  registers.num_overflows_ = 1234;
+  const double overhead_nanos = TimeCalls(num_calls, [](uint64_t x) { return x; });
+  printf("%-20s %10s\n", "benchmark", "ns/call");
+  printf("%-20s %10.2f\n", "ticks->ns div", TimeCalls(num_calls, DividingNanosFromTimerTicks) - overhead_nanos);
+  printf("%-20s %10.2f\n", "ticks->ns mul", TimeCalls(num_calls, NanosFromTimerTicks) - overhead_nanos);
+  printf("%-20s %10.2f\n", "ns->ticks div", TimeCalls(num_calls, DividingTimerTicksFromNanos) - overhead_nanos);
+  printf("%-20s %10.2f\n", "ns->ticks mulshift", TimeCalls(num_calls, TimerTicksFromNanos) - overhead_nanos);
+  printf("%-20s %10.2f\n", "read ticks", TimeCalls(num_calls, [&registers](uint64_t x) {
+    registers.counter_ = x;
+    return ReadTimerTicks(registers);
+  }) - overhead_nanos);
+  printf("Call overhead subtracted: %.2f ns.\n", overhead_nanos);
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include "timer.h"
+#include "timer_ticks_reader.h"
+
+// Timer registers whose state changes at given register reads, as if the counter or the
+// ISR had run at those points.
+class FakeTimerRegisters {
+public:
+  // The counter is at `counter`, with `num_overflows` counted by the ISR.
+  FakeTimerRegisters(uint32_t num_overflows, uint16_t counter)
+    : num_overflows_(num_overflows), overflow_pending_(false), counter_(counter),
+      num_reads_(0) {}
+
+  enum Event { kTick, kOverflow, kIsr };
+
+  // Runs `event` right before the register read with index `read_index`, counting from the
+  // construction.
+  void ScheduleEvent(int read_index, Event event) {
+    events_[read_index] = event;
+  }
+
+  // Only the ISR counts overflows.
+  void Overflow() {
+    counter_ = 0;
+    overflow_pending_ = true;
+  }
+  void RunIsr() {
+    if (overflow_pending_) {
+      ++num_overflows_;
+      overflow_pending_ = false;
+    }
+  }
+
+  uint32_t num_overflows() const { Read(); return num_overflows_; }
+  bool overflow_pending() const { Read(); return overflow_pending_; }
+  uint16_t counter() const { Read(); return counter_; }
+
+  int num_reads() const { return num_reads_; }
+
+private:
+  void Read() const {
+    auto *self = const_cast<FakeTimerRegisters *>(this);
+    const auto event = events_.find(self->num_reads_++);
+    if (event == events_.end()) {
+      return;
+    }
+    switch (event->second) {
+      case kTick:
+        if (++self->counter_ == 0) {
+          self->overflow_pending_ = true;
+        }
+        break;
+      case kOverflow:
+        self->Overflow();
+        break;
+      case kIsr:
+        self->RunIsr();
+        break;
+    }
+  }
+
+  uint32_t num_overflows_;
+  bool overflow_pending_;
+  uint16_t counter_;
+  int num_reads_;
+  std::map<int, Event> events_;
+};
+
+TEST(TimerTest, ReadsCountsWithoutEvents) {
+  FakeTimerRegisters registers(/*num_overflows=*/3, /*counter=*/0x1234);
+  EXPECT_EQ(ReadTimerTicks(registers), 0x31234);
+  EXPECT_EQ(registers.num_reads(), 5);
+}
+
+TEST(TimerTest, AddsOverflowNotCountedYet) {
+  FakeTimerRegisters registers(/*num_overflows=*/3, /*counter=*/0xffff);
+  registers.Overflow();
+  EXPECT_EQ(ReadTimerTicks(registers), 0x40000);
+  registers.RunIsr();
+  EXPECT_EQ(ReadTimerTicks(registers), 0x40000);
+}
+
+TEST(TimerTest, ConsistentWhenCounterOverflowsDuringRead) {
+  for (int read_index = 0; read_index < 5; ++read_index) {
+    SCOPED_TRACE(read_index);
+    FakeTimerRegisters registers(/*num_overflows=*/3, /*counter=*/0xffff);
+    registers.ScheduleEvent(read_index, FakeTimerRegisters::kTick);
+    const TimerTicksType ticks = ReadTimerTicks(registers);
+    // Either before or after the overflow, never 0x30000 nor 0x4ffff.
+    EXPECT_TRUE(ticks == 0x3ffff || ticks == 0x40000) << std::hex << ticks;
+  }
+}
+
+TEST(TimerTest, ConsistentWhenIsrRunsDuringRead) {
+  for (int read_index = 0; read_index < 5; ++read_index) {
+    SCOPED_TRACE(read_index);
+    FakeTimerRegisters registers(/*num_overflows=*/3, /*counter=*/0);
+    registers.Overflow();
+    registers.ScheduleEvent(read_index, FakeTimerRegisters::kIsr);
+    EXPECT_EQ(ReadTimerTicks(registers), 0x40000);
+  }
+}
+
+TEST(TimerTest, ConsistentWhenOverflowAndIsrInterleave) {
+  for (int overflow_index = 0; overflow_index < 10; ++overflow_index) {
+    for (int isr_index = overflow_index + 1; isr_index < 12; ++isr_index) {
+      SCOPED_TRACE(testing::Message() << overflow_index << " " << isr_index);
+      FakeTimerRegisters registers(/*num_overflows=*/3, /*counter=*/0xffff);
+      registers.ScheduleEvent(overflow_index, FakeTimerRegisters::kOverflow);
+      registers.ScheduleEvent(isr_index, FakeTimerRegisters::kIsr);
+      // Reads may complete before the events: the second one sees the rest.
+      const TimerTicksType ticks = ReadTimerTicks(registers);
+      EXPECT_TRUE(ticks == 0x3ffff || ticks == 0x40000) << std::hex << ticks;
+      const TimerTicksType later_ticks = ReadTimerTicks(registers);
+      EXPECT_TRUE(later_ticks == 0x3ffff || later_ticks == 0x40000) << std::hex << later_ticks;
+      EXPECT_GE(later_ticks, ticks);
+    }
+  }
+}
+
+TEST(TimerTest, ConvertsTicksToNanosExactly) {
+  EXPECT_EQ(NanosFromTimerTicks(0), 0);
+  EXPECT_EQ(NanosFromTimerTicks(1), 32000);
+  EXPECT_EQ(NanosFromTimerTicks(kTimerTicksPerSecond), 1'000'000'000ULL);
+  // 48 bits of ticks, the range of the timer.
+  const TimerTicksType max_ticks = (1ULL << 48) - 1;
+  EXPECT_EQ(NanosFromTimerTicks(max_ticks), max_ticks * 32000);
+}
+
+TEST(TimerTest, ConvertsNanosToTicksLikeDivision) {
+  const TimerNanosType edge_cases[] = {
+    0, 1, 31999, 32000, 32001, 63999, 64000, 1'000'000'000ULL,
+    (1ULL << 56) - 1, (1ULL << 56) - 32000, ((1ULL << 56) / 32000) * 32000,
+  };
+  for (const TimerNanosType nanos : edge_cases) {
+    EXPECT_EQ(TimerTicksFromNanos(nanos), nanos / kTimerNanosPerTick) << nanos;
+  }
+  std::mt19937_64 random(1234);
+  std::uniform_int_distribution<TimerNanosType> distribution(0, (1ULL << 56) - 1);
+  for (int i = 0; i < 100000; ++i) {
+    const TimerNanosType nanos = distribution(random);
+    ASSERT_EQ(TimerTicksFromNanos(nanos), nanos / kTimerNanosPerTick) << nanos;
+  }
+}
+
+TEST(TimerTest, ConvertsTicksToSeconds) {
+  EXPECT_DOUBLE_EQ(SecondsFromTimerTicks(kTimerTicksPerSecond), 1.0);
+  EXPECT_DOUBLE_EQ(SecondsFromTimerTicks(3 * kTimerTicksPerSecond / 2), 1.5);
+  const TimerTicksType ticks = 123'456'789;
+  EXPECT_NEAR(SecondsFromTimerTicks(ticks), NanosFromTimerTicks(ticks) * 1e-9, 1e-12);
+}
+
+TEST(TimerTest, MultipliesHigh64) {
+  EXPECT_EQ(MultiplyHigh64(0, ~0ULL), 0);
+  EXPECT_EQ(MultiplyHigh64(1ULL << 32, 1ULL << 32), 1);
+  EXPECT_EQ(MultiplyHigh64(~0ULL, ~0ULL), ~0ULL - 1);
+  std::mt19937_64 random(5678);
+  for (int i = 0; i < 10000; ++i) {
+    const uint64_t a = random(), b = random();
+    ASSERT_EQ(MultiplyHigh64(a, b), static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64));
+  }
+}
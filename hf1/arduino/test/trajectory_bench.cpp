@@ -0,0 +1,262 @@
+// Measures the cost of evaluating trajectory views on the host, under Google Benchmark.
+//
+// Usage: trajectory_bench [Google Benchmark flags, e.g. --benchmark_filter=Mixed]
+//
+// Covers TrajectoryView::GetWaypoint() by interpolation, looping and size up to the store's
+// maximum, derivative() of orders 1 and 2, BaseModulatedTrajectoryView, BaseMixedTrajectoryView
+// nested 1-4 deep, and a whole BaseTrajectoryController::Update().
+//
+// Besides the time per call, every benchmark reports the views evaluated per call, counted
+// in a separate untimed pass:
+//   evals       GetWaypoint() calls of the benchmarked view, e.g. 7 per Update().
+//   leaf_evals  GetWaypoint() calls of the TrajectoryViews under it, which do the
+//               interpolation.
+//   leaf_eval   Time per leaf evaluation.
+
+#include <math.h>
+#include <benchmark/benchmark.h>
+#include "base_controller.h"
+#include "base_trajectory.h"
+#include "bno055_reader.h"
+#include "envelope_trajectory.h"
+#include "mock_i2c_bus.h"
+#include "motors.h"
+#include "robot_state_estimator.h"
+#include "timer.h"
+#include "wheel_controller.h"
+#include "wheel_state_estimator.h"
+
+// As in base_controller.cpp.
+#define kControllerPeriodSeconds 0.03f
+#define kWaypointPeriodSeconds 1.0f
+#define kLoopAfterSeconds 1.0f
+#define kCircleRadius 0.5f
+#define kMaxMixDepth 4
+// Calls of the untimed pass that counts evaluations.
+#define kNumCountedCalls 100
+
+using BaseTrajectory = Trajectory<BaseTargetState, kP2PMaxNumWaypointsPerTrajectory>;
+using EnvelopeTrajectory = Trajectory<EnvelopeTargetState, kP2PMaxNumWaypointsPerTrajectory>;
+
+static int64_t num_evaluations = 0;
+static int64_t num_leaf_evaluations = 0;
+
+// Counts the evaluations of the views over it: they search the trajectory once per
+// GetWaypoint().
+template<typename TState>
+class CountingTrajectory : public TrajectoryInterface<TState> {
+public:
+  explicit CountingTrajectory(const TrajectoryInterface<TState> *trajectory) : trajectory_(trajectory) {}
+
+  int size() const override { return trajectory_->size(); }
+  const Waypoint<TState> &operator[](int i) const override { return (*trajectory_)[i]; }
+  int FindWaypointAtOrBeforeSeconds(TimerSecondsType seconds) const override {
+    ++num_leaf_evaluations;
+    return trajectory_->FindWaypointAtOrBeforeSeconds(seconds);
+  }
+
+private:
+  const TrajectoryInterface<TState> *trajectory_;
+};
+
+class CountingView : public TrajectoryViewInterface<BaseTargetState> {
+public:
+  explicit CountingView(const TrajectoryViewInterface<BaseTargetState> *view) : view_(view) {}
+
+  BaseWaypoint GetWaypoint(float seconds) const override {
+    ++num_evaluations;
+    return view_->GetWaypoint(seconds);
+  }
+  bool IsLoopingEnabled() const override { return view_->IsLoopingEnabled(); }
+  float LapDuration() const override { return view_->LapDuration(); }
+
+private:
+  const TrajectoryViewInterface<BaseTargetState> *view_;
+};
+
+typedef struct {
+  int size = kP2PMaxNumWaypointsPerTrajectory;
+  InterpolationType interpolation = InterpolationType::kCubic;
+  bool looping = true;
+} ViewsConfig;
+
+// Views of every kind, over waypoints evenly spread over a circle. The leaves of the
+// modulated and mixed views are all like the TrajectoryView.
+class BenchViews {
+public:
+  enum Kind { kView = 0, kModulated, kMixed1, kMixed2, kMixed3, kMixed4 };
+
+  BenchViews(const ViewsConfig &config, bool counting)
+    : counting_base_trajectory_(&base_trajectory_), counting_envelope_trajectory_(&envelope_trajectory_) {
+    for (int i = 0; i < config.size; ++i) {
+      const float angle = 2 * M_PI * i / config.size;
+      base_trajectory_.Insert(BaseWaypoint(i * kWaypointPeriodSeconds, BaseTargetState({ BaseStateVars(Point(kCircleRadius * cosf(angle), kCircleRadius * sinf(angle)), /*yaw=*/0) })));
+    }
+    envelope_trajectory_.Insert(EnvelopeWaypoint(0, EnvelopeTargetState({ EnvelopeStateVars(0) })));
+    envelope_trajectory_.Insert(EnvelopeWaypoint((config.size - 1) * kWaypointPeriodSeconds, EnvelopeTargetState({ EnvelopeStateVars(1) })));
+
+    const TrajectoryInterface<BaseTargetState> *base_trajectory = counting ? static_cast<const TrajectoryInterface<BaseTargetState> *>(&counting_base_trajectory_) : &base_trajectory_;
+    const TrajectoryInterface<EnvelopeTargetState> *envelope_trajectory = counting ? static_cast<const TrajectoryInterface<EnvelopeTargetState> *>(&counting_envelope_trajectory_) : &envelope_trajectory_;
+    for (BaseTrajectoryView &leaf : leaves_) {
+      leaf = BaseTrajectoryView(base_trajectory);
+      leaf.EnableInterpolation({ .type = config.interpolation });
+      if (config.looping) {
+        leaf.EnableLooping(kLoopAfterSeconds);
+      }
+    }
+    envelope_ = EnvelopeTrajectoryView(envelope_trajectory);
+    envelope_.EnableInterpolation({ .type = InterpolationType::kLinear }).EnableLooping(kLoopAfterSeconds);
+
+    modulated_.carrier(&leaves_[0]).modulator(&leaves_[1]).envelope(&envelope_);
+    for (int depth = 0; depth < kMaxMixDepth; ++depth) {
+      mixed_[depth].trajectory1(depth == 0 ? &leaves_[0] : static_cast<const TrajectoryViewInterface<BaseTargetState> *>(&mixed_[depth - 1]))
+                   .trajectory2(&leaves_[depth + 1])
+                   .alpha(&envelope_);
+    }
+  }
+  BenchViews(const BenchViews &) = delete;
+  BenchViews &operator=(const BenchViews &) = delete;
+
+  const TrajectoryViewInterface<BaseTargetState> &view(Kind kind) const {
+    switch (kind) {
+      case kView: return leaves_[0];
+      case kModulated: return modulated_;
+      default: return mixed_[kind - kMixed1];
+    }
+  }
+
+  // Time span to evaluate the views over: a lap, and past it, as the controller does.
+  float span_seconds() const { return 2 * leaves_[0].LapDuration() + kLoopAfterSeconds; }
+
+private:
+  BaseTrajectory base_trajectory_;
+  EnvelopeTrajectory envelope_trajectory_;
+  CountingTrajectory<BaseTargetState> counting_base_trajectory_;
+  CountingTrajectory<EnvelopeTargetState> counting_envelope_trajectory_;
+  BaseTrajectoryView leaves_[kMaxMixDepth + 1];
+  EnvelopeTrajectoryView envelope_;
+  BaseModulatedTrajectoryView modulated_;
+  BaseMixedTrajectoryView mixed_[kMaxMixDepth];
+};
+
+// Returns the time of the view's `call`-th evaluation: controller periods, wrapping over
+// the span.
+static float CallSeconds(const BenchViews &views, int64_t call) {
+  const int num_calls_per_span = static_cast<int>(views.span_seconds() / kControllerPeriodSeconds);
+  return (call % num_calls_per_span) * kControllerPeriodSeconds;
+}
+
+// Runs `evaluate(view, seconds)` once per iteration, and reports the evaluations per call.
+template<typename TEvaluate>
+static void RunViewBenchmark(benchmark::State &state, const ViewsConfig &config, BenchViews::Kind kind, TEvaluate evaluate) {
+  {
+    const BenchViews views(config, /*counting=*/true);
+    const CountingView view(&views.view(kind));
+    num_evaluations = 0;
+    num_leaf_evaluations = 0;
+    for (int call = 0; call < kNumCountedCalls; ++call) {
+      evaluate(view, CallSeconds(views, call));
+    }
+  }
+  const BenchViews views(config, /*counting=*/false);
+  const TrajectoryViewInterface<BaseTargetState> &view = views.view(kind);
+  int64_t call = 0;
+  for (auto _ : state) {
+    evaluate(view, CallSeconds(views, call++));
+  }
+  const double leaf_evals_per_call = static_cast<double>(num_leaf_evaluations) / kNumCountedCalls;
+  state.counters["evals"] = static_cast<double>(num_evaluations) / kNumCountedCalls;
+  state.counters["leaf_evals"] = leaf_evals_per_call;
+  state.counters["leaf_eval"] = benchmark::Counter(state.iterations() * leaf_evals_per_call, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void BM_GetWaypoint(benchmark::State &state) {
+  ViewsConfig config;
+  config.interpolation = static_cast<InterpolationType>(state.range(0));
+  config.looping = state.range(1);
+  config.size = state.range(2);
+  RunViewBenchmark(state, config, BenchViews::kView, [](const TrajectoryViewInterface<BaseTargetState> &view, float seconds) {
+    benchmark::DoNotOptimize(view.GetWaypoint(seconds));
+  });
+}
+BENCHMARK(BM_GetWaypoint)
+  ->ArgsProduct({ { kNone, kLinear, kCubic }, { 0, 1 }, { 2, 4, 6, 8, kP2PMaxNumWaypointsPerTrajectory } })
+  ->ArgNames({ "interpolation", "looping", "size" });
+
+static void BM_Derivative(benchmark::State &state) {
+  ViewsConfig config;
+  config.interpolation = static_cast<InterpolationType>(state.range(1));
+  const int order = state.range(0);
+  RunViewBenchmark(state, config, BenchViews::kView, [order](const TrajectoryViewInterface<BaseTargetState> &view, float seconds) {
+    benchmark::DoNotOptimize(view.derivative(order, seconds, kControllerPeriodSeconds));
+  });
+}
+BENCHMARK(BM_Derivative)
+  ->ArgsProduct({ { 1, 2 }, { kNone, kLinear, kCubic } })
+  ->ArgNames({ "order", "interpolation" });
+
+static void BM_ModulatedView(benchmark::State &state) {
+  RunViewBenchmark(state, ViewsConfig(), BenchViews::kModulated, [](const TrajectoryViewInterface<BaseTargetState> &view, float seconds) {
+    benchmark::DoNotOptimize(view.GetWaypoint(seconds));
+  });
+}
+BENCHMARK(BM_ModulatedView);
+
+static void BM_MixedView(benchmark::State &state) {
+  const auto kind = static_cast<BenchViews::Kind>(BenchViews::kMixed1 + state.range(0) - 1);
+  RunViewBenchmark(state, ViewsConfig(), kind, [](const TrajectoryViewInterface<BaseTargetState> &view, float seconds) {
+    benchmark::DoNotOptimize(view.GetWaypoint(seconds));
+  });
+}
+BENCHMARK(BM_MixedView)->DenseRange(1, kMaxMixDepth)->ArgName("depth");
+
+// Exposes Update(), which the scheduler calls on the robot.
+class BenchBaseTrajectoryController : public BaseTrajectoryController {
+public:
+  using BaseTrajectoryController::BaseTrajectoryController;
+  using BaseTrajectoryController::Update;
+};
+
+// Returns the controller, over the motion stack of arduino.ino. Built once, as
+// WheelStateEstimator is a singleton.
+static BenchBaseTrajectoryController &GetController() {
+  static WheelStateEstimator wheel_state_estimator("WheelStateEstimator");
+  static WheelSpeedController left_wheel("LeftWheelSpeedController", &wheel_state_estimator.left_wheel_state_filter(), &SetLeftMotorDutyCycle);
+  static WheelSpeedController right_wheel("RightWheelSpeedController", &wheel_state_estimator.right_wheel_state_filter(), &SetRightMotorDutyCycle);
+  static BaseSpeedController base_speed_controller(&left_wheel, &right_wheel);
+  static BenchBaseTrajectoryController controller("BaseTrajectoryController", &base_speed_controller);
+  return controller;
+}
+
+static void BM_ControllerUpdate(benchmark::State &state) {
+  BenchBaseTrajectoryController &controller = GetController();
+  // The counting and the timed passes evaluate different views.
+  const TrajectoryViewInterface<BaseTargetState> *started_view = nullptr;
+  RunViewBenchmark(state, ViewsConfig(), static_cast<BenchViews::Kind>(state.range(0)), [&](const TrajectoryViewInterface<BaseTargetState> &view, float seconds) {
+    if (started_view != &view) {
+      controller.trajectory(&view);
+      controller.Start();
+      started_view = &view;
+    }
+    controller.Update(seconds);
+  });
+  static const char *const kKindNames[] = { "view", "modulated", "mixed1", "mixed2", "mixed3", "mixed4" };
+  state.SetLabel(kKindNames[state.range(0)]);
+}
+BENCHMARK(BM_ControllerUpdate)
+  ->Arg(BenchViews::kView)->Arg(BenchViews::kModulated)->Arg(BenchViews::kMixed1)->Arg(BenchViews::kMixed4)
+  ->ArgName("view");
+
+int main(int argc, char **argv) {
+  InitTimer();
+  // The controller reads the base state.
+  static MockI2CBus imu_bus(kBNO055DefaultAddress);
+  InitRobotStateEstimator(&imu_bus);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "kinetis.h"
 #include "wiring.h"
 #include "timer.h"
+#include "timer_ticks_reader.h"
 #include "logger_interface.h"
 
 #define kMaxIsrs 4
@@ -9,7 +10,7 @@ bool timer_initialized = false;
 
 // This effectively makes the count 48 bits long. At 31250 ticks per seconds, it does not
 // roll over for more than 285 years.
-uint32_t timer_num_overflows;
+volatile uint32_t timer_num_overflows;
 
 TimerISR isr[kMaxIsrs];
 
@@ -78,37 +79,17 @@ void ftm2_isr(void) {
   }
 }
 
-TimerTicksType GetTimerTicks() {
-  NO_TIMER_IRQ {
-    if (FTM2_SC & FTM_SC_TOF) {
-      // The timer overflowed after we disabled the IRQ, and the ISR has not run yet to 
-      // update the overflow count. Update the count here and clear the flag so that the IRQ
-      // does not get triggered for that reason and increases the overflow count again. 
-      // Without this, for instance, SleepForNanos() exits its busy wait too early.
-      ++timer_num_overflows;
-      FTM2_SC &= ~FTM_SC_TOF;
-    }
-    return (static_cast<TimerTicksType>(timer_num_overflows) << 16) | (FTM2_CNT & 0xffff);
-  }
-  return 0; // Gets rid of "control reaches end of non-voic function..." warning.
-}
-
-TimerNanosType NanosFromTimerTicks(TimerTicksType ticks) {
-  // This is valid for 37 years.
-  // NanosFromTimerTicks(ticks) - NanosFromTimerTicks(ticks - 1) = 32000 nanos = 1 tick.
-  return ((ticks * 500000ULL) / kTimerTicksPerSecond) * 2000ULL;
-}
-
-TimerNanosType GetTimerNanoseconds() {
-  return NanosFromTimerTicks(GetTimerTicks());
-}
+// FTM2 state, for ReadTimerTicks().
+typedef struct {
+  uint32_t num_overflows() const { return timer_num_overflows; }
+  bool overflow_pending() const { return FTM2_SC & FTM_SC_TOF; }
+  uint16_t counter() const { return FTM2_CNT; }
+} FTM2TimerRegisters;
 
-TimerSecondsType SecondsFromTimerTicks(TimerTicksType ticks) {
-  return NanosFromTimerTicks(ticks) * 1e-9;
-}
-
-TimerSecondsType GetTimerSeconds() {
-  return GetTimerNanoseconds() * 1e-9;
+TimerTicksType GetTimerTicks() {
+  // Called often, also from ISRs: disabling the timer IRQ would delay it, and cost as much
+  // as the read itself.
+  return ReadTimerTicks(FTM2TimerRegisters());
 }
 
 static int FindIsr(TimerISR isr_to_find) {
@@ -146,13 +127,3 @@ void SleepForNanos(TimerNanosType min_nanos) {
 void SleepForSeconds(TimerSecondsType min_seconds) {
   SleepForNanos(min_seconds * 1e9);
 }
-
-TimerNanosType NanosFromSeconds(TimerSecondsType seconds) {
-  return seconds * 1e9;
-}
-
-TimerSecondsType SecondsFromNanos(TimerNanosType nanos) {
-  return nanos * 1e-9;
-}
-
-
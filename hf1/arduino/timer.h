@@ -4,6 +4,9 @@ Timer module.
 Maintains a clock, and offers timing services.
 */
 
+#ifndef TIMER_
+#define TIMER_
+
 #include <stdint.h>
 #include "utils.h"
 
@@ -37,25 +40,65 @@ typedef double TimerSecondsType;
 // The tick count increments at a rate of kTimerTicksPerSecond.
 TimerTicksType GetTimerTicks();
 
+// Conversions are inline and avoid 64-bit divisions, which the Cortex-M4 emulates in
+// software: they are called many times per loop.
+
+// Exact, as kTimerTicksPerSecond divides 1e9.
+#define kTimerNanosPerTick (1'000'000'000 / kTimerTicksPerSecond)
+static_assert(1'000'000'000 % kTimerTicksPerSecond == 0, "Ticks must be a whole number of nanoseconds.");
+#define kTimerSecondsPerTick (1.0 / kTimerTicksPerSecond)
+
 // Converts timer ticks to nanoseconds.
-TimerNanosType NanosFromTimerTicks(TimerTicksType ticks);
+inline TimerNanosType NanosFromTimerTicks(TimerTicksType ticks) {
+  return ticks * kTimerNanosPerTick;
+}
+
+// Returns the high 64 bits of the 128-bit product a * b, with 32x32->64 bit multiplications,
+// which the Cortex-M4 does in a single instruction.
+inline uint64_t MultiplyHigh64(uint64_t a, uint64_t b) {
+  const uint64_t a_low = static_cast<uint32_t>(a), a_high = a >> 32;
+  const uint64_t b_low = static_cast<uint32_t>(b), b_high = b >> 32;
+  const uint64_t low_low = a_low * b_low;
+  const uint64_t low_high = a_low * b_high;
+  const uint64_t high_low = a_high * b_low;
+  const uint64_t middle = (low_low >> 32) + static_cast<uint32_t>(low_high) + static_cast<uint32_t>(high_low);
+  return a_high * b_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+}
+
+// Converts nanoseconds to timer ticks, rounding down. Valid for up to 2^56 ns (2.2 years).
+inline TimerTicksType TimerTicksFromNanos(TimerNanosType nanos) {
+  // nanos / 32000 = (nanos / 2^8) / 125, and x / 125 = (x * ceil(2^70 / 125)) / 2^70 for
+  // x < 2^56, of which only the high 64 bits of the product are needed.
+  static_assert(kTimerNanosPerTick == 32000, "Recompute the multiplier for the new tick rate.");
+  return MultiplyHigh64(nanos >> 8, 9444732965739290428ULL) >> 6;
+}
 
 // Converts seconds to nanoseconds.
-TimerNanosType NanosFromSeconds(TimerSecondsType seconds);
-
-// Returns the number of nanoseconds since the CPU started, with a resolution of
-// (1e9 / kTimerTicksPerSecond) nanoseconds.
-TimerNanosType GetTimerNanoseconds();
+inline TimerNanosType NanosFromSeconds(TimerSecondsType seconds) {
+  return seconds * 1e9;
+}
 
 // Converts timer ticks to seconds.
-TimerSecondsType SecondsFromTimerTicks(TimerTicksType ticks);
+inline TimerSecondsType SecondsFromTimerTicks(TimerTicksType ticks) {
+  return ticks * kTimerSecondsPerTick;
+}
 
 // Converts nanoseconds to seconds.
-TimerSecondsType SecondsFromNanos(TimerNanosType nanos);
+inline TimerSecondsType SecondsFromNanos(TimerNanosType nanos) {
+  return nanos * 1e-9;
+}
+
+// Returns the number of nanoseconds since the CPU started, with a resolution of
+// (1e9 / kTimerTicksPerSecond) nanoseconds.
+inline TimerNanosType GetTimerNanoseconds() {
+  return NanosFromTimerTicks(GetTimerTicks());
+}
 
 // Returns the number of seconds since the CPU started, with a resolution of
 // (1.0 / kTimerTicksPerSecond) seconds.
-TimerSecondsType GetTimerSeconds();
+inline TimerSecondsType GetTimerSeconds() {
+  return SecondsFromTimerTicks(GetTimerTicks());
+}
 
 // Returns after a minimum number of nanoseconds.
 // The actual sleep time may be higher because the timer resolution is higher than 1 ns.
@@ -81,4 +124,6 @@ void RemoveTimerIsr(TimerISR custom_isr);
 // NO_TIMER_IRQ {
 //   ...stuff...
 // }  
-#define NO_TIMER_IRQ PUSH_POP_WRAPPER(bool, PauseTimerIrq, RestoreTimerIrq)
\ No newline at end of file
+#define NO_TIMER_IRQ PUSH_POP_WRAPPER(bool, PauseTimerIrq, RestoreTimerIrq)
+
+#endif  // TIMER_
@@ -0,0 +1,31 @@
+#ifndef TIMER_TICKS_READER_
+#define TIMER_TICKS_READER_
+
+#include <stdint.h>
+#include "timer.h"
+
+// Reads the 48-bit tick count made of a 16-bit hardware counter and a 32-bit count of its
+// overflows, which the timer ISR maintains, without disabling the ISR.
+//
+// TRegisters gives access to the timer state, so that it can be faked in host tests:
+//   uint32_t num_overflows() const;   // Overflows counted by the ISR.
+//   bool overflow_pending() const;    // The counter overflowed, and the ISR has not run yet.
+//   uint16_t counter() const;         // The hardware counter.
+//
+// The counter is bracketed by two reads of the overflow state; if the ISR ran or the counter
+// overflowed in between, the reads are inconsistent and are retried. A pending overflow the
+// ISR has not counted yet, e.g. because the caller is an ISR of the same priority, is added.
+//
+// The ISR must not be preempted by the caller while updating its state.
+template<typename TRegisters> TimerTicksType ReadTimerTicks(const TRegisters &registers) {
+  for (;;) {
+    const uint32_t num_overflows = registers.num_overflows();
+    const bool overflow_pending = registers.overflow_pending();
+    const uint16_t counter = registers.counter();
+    if (registers.overflow_pending() == overflow_pending && registers.num_overflows() == num_overflows) {
+      return (static_cast<TimerTicksType>(num_overflows + (overflow_pending ? 1 : 0)) << 16) | counter;
+    }
+  }
+}
+
+#endif  // TIMER_TICKS_READER_
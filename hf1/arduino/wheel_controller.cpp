@@ -3,6 +3,7 @@
 #include "robot_model.h"
 #include "utils.h"
 #include "logger_interface.h"
+#include "profiler.h"
 #include <algorithm>
 
 #define kControlLoopPeriodSeconds 0.005
@@ -39,9 +40,19 @@ WheelSpeedController::WheelSpeedController(
     target_speed_(0),
     initial_target_speed_(0),
     target_speed_slope_(0),
+    gains_(DefaultGains()),
     pid_(kP, kI, kD) {
 }
 
+WheelSpeedController::Gains WheelSpeedController::DefaultGains() {
+  return Gains{ .p = kP, .i = kI, .ramp_extra_seconds_per_unit_speed_increment = kSpeedTargetRampExtraSecondsPerUnitSpeedIncrement, .ramp_extra_seconds_per_unit_speed_increment_reverse = kSpeedTargetRampExtraSecondsPerUnitSpeedIncrementReverse };
+}
+
+void WheelSpeedController::gains(const Gains &gains) {
+  gains_ = gains;
+  pid_.setParameters(gains.p, gains.i, kD);
+}
+
 float WheelSpeedController::DutyCycleFromLinearSpeed(float meters_per_second) const {
   // The wheel speed model was extracted experimentally here:
   // https://docs.google.com/spreadsheets/d/1u54eKSRv8ef7i6d9K4IdrqnENu4u1ELPQnM7t2nn1fk
@@ -73,7 +84,7 @@ void WheelSpeedController::SetLinearSpeed(float meters_per_second) {
   time_start_ = GetTimerSeconds();
   target_speed_ = meters_per_second;
   initial_target_speed_ = pid_.target();
-  const float ramp_extra_seconds = meters_per_second >= 0 ? kSpeedTargetRampExtraSecondsPerUnitSpeedIncrement : kSpeedTargetRampExtraSecondsPerUnitSpeedIncrementReverse;
+  const float ramp_extra_seconds = meters_per_second >= 0 ? gains_.ramp_extra_seconds_per_unit_speed_increment : gains_.ramp_extra_seconds_per_unit_speed_increment_reverse;
   target_speed_slope_ = 1 / (kControlLoopPeriodSeconds + ramp_extra_seconds * abs(meters_per_second - initial_target_speed_));
   if (meters_per_second < 0) {
     target_speed_slope_ = -target_speed_slope_;
@@ -85,6 +96,7 @@ void WheelSpeedController::SetAngularSpeed(float radians_per_second) {
 }
 
 void WheelSpeedController::Update(TimerSecondsType seconds_since_start) {
+  PROFILE_SCOPE("wheel_speed_ctrl");
   // Ramp up or down the speed target.
   const float current_target = initial_target_speed_ + seconds_since_start * target_speed_slope_;
   pid_.target(target_speed_ >= 0 ? std::min(target_speed_, current_target) : std::max(target_speed_, current_target));
@@ -11,6 +11,16 @@ typedef void (DutyCycleSetter)(float duty_cycle);
 
 class WheelSpeedController : public Controller {
 public:
+  typedef struct {
+    // Gains of the PID on the speed error.
+    float p;
+    float i;
+    // Extra seconds per unit of target speed increment that the speed target ramps take,
+    // forward and in reverse. See SetLinearSpeed().
+    float ramp_extra_seconds_per_unit_speed_increment;
+    float ramp_extra_seconds_per_unit_speed_increment_reverse;
+  } Gains;
+
   // No ownership of the pointee is taken by this object.
   WheelSpeedController(const char *name, const WheelStateFilter * const wheel_state_filter_, DutyCycleSetter * const duty_cycle_setter);
 
@@ -35,6 +45,11 @@ public:
 
   bool is_turning_forward() const { return is_turning_forward_; }
 
+  // The defaults are tuned on the robot. Other gains are meant for tuning in simulation.
+  static Gains DefaultGains();
+  const Gains &gains() const { return gains_; }
+  void gains(const Gains &gains);
+
 protected:
   // Periodically updates the speed controller.
   void Update(TimerSecondsType now_seconds) override;
@@ -53,6 +68,7 @@ private:
   float initial_target_speed_;
   float target_speed_slope_;
   
+  Gains gains_;
   PID pid_;
 };
 
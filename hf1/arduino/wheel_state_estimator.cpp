@@ -4,6 +4,7 @@
 #include "utils.h"
 #include "robot_model.h"
 #include "logger_interface.h"
+#include "profiler.h"
 
 // Approximate rate at which the state estimation is updated.
 #define kUpdatePeriodSeconds (1/160.0)
@@ -37,6 +38,7 @@ void WheelStateEstimator::Init() {
 }
 
 void WheelStateEstimator::RunAfterPeriod(TimerNanosType now_nanos, TimerNanosType nanos_since_last_call) {
+  PROFILE_SCOPE("wheel_state_est");
   left_wheel_state_filter_.UpdateState();
   right_wheel_state_filter_.UpdateState();  
 }
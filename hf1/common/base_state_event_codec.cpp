@@ -0,0 +1,169 @@
+#include <stddef.h>
+#include <string.h>
+#include "base_state_event_codec.h"
+#include "p2p_packet_protocol.h"
+
+static_assert(sizeof(P2PApplicationPacketHeader) + sizeof(P2PRecordBaseStateEventsProgress) <= kP2PMaxContentLength,
+              "P2PRecordBaseStateEventsProgress does not fit in a P2P packet.");
+
+#define kBatchHeaderLength offsetof(P2PRecordBaseStateEventsProgress, events)
+#define kIsForwardBit 0x08
+#define kTypeMask 0x07
+#define kNumIMUFloats 6
+// Maximum encoded length of a 64-bit varint.
+#define kMaxVarintLength 10
+
+static int WriteVarint(uint64_t value, uint8_t *buffer) {
+  int length = 0;
+  while (value >= 0x80) {
+    buffer[length++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  buffer[length++] = static_cast<uint8_t>(value);
+  return length;
+}
+
+// Returns the number of bytes read, or 0 if the varint does not end within `max_length` bytes.
+static int ReadVarint(const uint8_t *buffer, int max_length, uint64_t *value) {
+  *value = 0;
+  for (int i = 0; i < max_length && i < kMaxVarintLength; ++i) {
+    *value |= static_cast<uint64_t>(buffer[i] & 0x7f) << (7 * i);
+    if ((buffer[i] & 0x80) == 0) { return i + 1; }
+  }
+  return 0;
+}
+
+// Maps small signed differences to small unsigned values: 0, -1, 1, -2, 2...
+static uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static void WriteLittleEndian(uint64_t value, int num_bytes, uint8_t *buffer) {
+  for (int i = 0; i < num_bytes; ++i) {
+    buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+static uint64_t ReadLittleEndian(const uint8_t *buffer, int num_bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < num_bytes; ++i) {
+    value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+  }
+  return value;
+}
+
+static void WriteFloat(float value, uint8_t *buffer) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  WriteLittleEndian(bits, sizeof(bits), buffer);
+}
+
+static float ReadFloat(const uint8_t *buffer) {
+  const uint32_t bits = static_cast<uint32_t>(ReadLittleEndian(buffer, sizeof(bits)));
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+BaseStateEventBatchEncoder::BaseStateEventBatchEncoder(P2PRecordBaseStateEventsProgress *batch)
+  : batch_(*ASSERT_NOT_NULL(batch)), events_length_(0), last_timer_ticks_(0) {
+  WriteLittleEndian(0, sizeof(batch_.first_timer_ticks), reinterpret_cast<uint8_t *>(&batch_.first_timer_ticks));
+  batch_.num_events = 0;
+  batch_.num_dropped_events = 0;
+}
+
+bool BaseStateEventBatchEncoder::Append(const BaseStateEventRecord &record) {
+  ASSERT(record.type >= 0 && record.type < kNumBaseStateEventTypes);
+  if (batch_.num_events == UINT8_MAX) { return false; }
+  if (batch_.num_events == 0) {
+    WriteLittleEndian(record.timer_ticks, sizeof(batch_.first_timer_ticks), reinterpret_cast<uint8_t *>(&batch_.first_timer_ticks));
+    last_timer_ticks_ = record.timer_ticks;
+  }
+
+  uint8_t buffer[1 + kMaxVarintLength + kNumIMUFloats * sizeof(float)];
+  int length = 0;
+  buffer[length++] = static_cast<uint8_t>(record.type) | (record.is_forward ? kIsForwardBit : 0);
+  length += WriteVarint(ZigZagEncode(static_cast<int64_t>(record.timer_ticks - last_timer_ticks_)), &buffer[length]);
+  if (record.type == kBaseStateEventIMUReading) {
+    for (int i = 0; i < 3; ++i, length += sizeof(float)) {
+      WriteFloat(record.position_acceleration[i], &buffer[length]);
+    }
+    for (int i = 0; i < 3; ++i, length += sizeof(float)) {
+      WriteFloat(record.attitude[i], &buffer[length]);
+    }
+  }
+  if (events_length_ + length > kP2PMaxBaseStateEventBatchLength) { return false; }
+
+  memcpy(&batch_.events[events_length_], buffer, length);
+  events_length_ += length;
+  last_timer_ticks_ = record.timer_ticks;
+  ++batch_.num_events;
+  return true;
+}
+
+void BaseStateEventBatchEncoder::num_dropped_events(int n) {
+  batch_.num_dropped_events = n > UINT8_MAX ? UINT8_MAX : static_cast<uint8_t>(n);
+}
+
+int BaseStateEventBatchEncoder::payload_length() const {
+  return kBatchHeaderLength + events_length_;
+}
+
+BaseStateEventBatchDecoder::BaseStateEventBatchDecoder(const P2PRecordBaseStateEventsProgress *batch, int payload_length)
+  : batch_(*ASSERT_NOT_NULL(batch)),
+    events_length_(payload_length - static_cast<int>(kBatchHeaderLength)),
+    status_(kSuccess),
+    offset_(0),
+    num_decoded_events_(0) {
+  if (events_length_ < 0 || events_length_ > kP2PMaxBaseStateEventBatchLength) {
+    status_ = kMalformedError;
+    events_length_ = 0;
+    last_timer_ticks_ = 0;
+    return;
+  }
+  last_timer_ticks_ = first_timer_ticks();
+}
+
+uint64_t BaseStateEventBatchDecoder::first_timer_ticks() const {
+  return ReadLittleEndian(reinterpret_cast<const uint8_t *>(&batch_.first_timer_ticks), sizeof(batch_.first_timer_ticks));
+}
+
+Status BaseStateEventBatchDecoder::Next(BaseStateEventRecord *record) {
+  if (status_ != kSuccess) { return status_; }
+  if (num_decoded_events_ == batch_.num_events) {
+    // Trailing bytes mean that the number of events is wrong.
+    return offset_ == events_length_ ? kDoesNotExistError : kMalformedError;
+  }
+  if (offset_ >= events_length_) { return status_ = kMalformedError; }
+
+  const uint8_t type_byte = batch_.events[offset_++];
+  const int type = type_byte & kTypeMask;
+  if (type >= kNumBaseStateEventTypes || (type_byte & ~(kTypeMask | kIsForwardBit)) != 0) {
+    return status_ = kMalformedError;
+  }
+  uint64_t zigzag_ticks_inc;
+  const int varint_length = ReadVarint(&batch_.events[offset_], events_length_ - offset_, &zigzag_ticks_inc);
+  if (varint_length == 0) { return status_ = kMalformedError; }
+  offset_ += varint_length;
+
+  memset(record, 0, sizeof(*record));
+  record->type = static_cast<P2PBaseStateEventType>(type);
+  record->timer_ticks = last_timer_ticks_ + static_cast<uint64_t>(ZigZagDecode(zigzag_ticks_inc));
+  record->is_forward = (type_byte & kIsForwardBit) != 0;
+  if (type == kBaseStateEventIMUReading) {
+    if (events_length_ - offset_ < static_cast<int>(kNumIMUFloats * sizeof(float))) { return status_ = kMalformedError; }
+    for (int i = 0; i < 3; ++i, offset_ += sizeof(float)) {
+      record->position_acceleration[i] = ReadFloat(&batch_.events[offset_]);
+    }
+    for (int i = 0; i < 3; ++i, offset_ += sizeof(float)) {
+      record->attitude[i] = ReadFloat(&batch_.events[offset_]);
+    }
+  }
+  last_timer_ticks_ = record->timer_ticks;
+  ++num_decoded_events_;
+  return kSuccess;
+}
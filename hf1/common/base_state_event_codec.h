@@ -0,0 +1,74 @@
+#ifndef BASE_STATE_EVENT_CODEC_
+#define BASE_STATE_EVENT_CODEC_
+
+#include <stdint.h>
+#include "p2p_application_protocol.h"
+#include "status_or.h"
+
+// Platform-independent copy of an event consumed by the base state estimator.
+typedef struct {
+  P2PBaseStateEventType type;
+  uint64_t timer_ticks;
+  // Wheel direction events only. Carries the firmware's event payload verbatim.
+  bool is_forward;
+  // IMU readings only.
+  float position_acceleration[3];
+  float attitude[3];
+} BaseStateEventRecord;
+
+// Encodes events in the events area of a P2PRecordBaseStateEventsProgress.
+//
+// Every event takes a type byte, followed by the zigzag varint difference between its timer
+// ticks and those of the previous event (so slightly out of order events are fine), and the
+// six IMU floats only for IMU readings. Wheel ticks, which make most of the events, take two
+// or three bytes.
+// All multi-byte values are little-endian, regardless of the local endianness.
+class BaseStateEventBatchEncoder {
+public:
+  // Starts an empty batch in `batch`.
+  // Does not take ownership of the pointee, which must outlive this object.
+  explicit BaseStateEventBatchEncoder(P2PRecordBaseStateEventsProgress *batch);
+
+  // Appends `record` to the batch. Returns false, leaving the batch untouched, if it does not fit.
+  bool Append(const BaseStateEventRecord &record);
+
+  void num_dropped_events(int n);
+
+  int num_events() const { return batch_.num_events; }
+  // Number of bytes of the progress payload in use.
+  int payload_length() const;
+
+private:
+  P2PRecordBaseStateEventsProgress &batch_;
+  int events_length_;
+  uint64_t last_timer_ticks_;
+};
+
+// Decodes the events of a P2PRecordBaseStateEventsProgress.
+class BaseStateEventBatchDecoder {
+public:
+  // `payload_length` is the number of bytes of the received progress payload.
+  // Does not take ownership of the pointee, which must outlive this object.
+  BaseStateEventBatchDecoder(const P2PRecordBaseStateEventsProgress *batch, int payload_length);
+
+  // Returns kMalformedError if the payload is too short to hold the batch header.
+  Status status() const { return status_; }
+
+  uint64_t first_timer_ticks() const;
+  int num_events() const { return batch_.num_events; }
+  int num_dropped_events() const { return batch_.num_dropped_events; }
+
+  // Decodes the next event into `record`. Returns kDoesNotExistError after the last event,
+  // and kMalformedError if the batch is corrupt.
+  Status Next(BaseStateEventRecord *record);
+
+private:
+  const P2PRecordBaseStateEventsProgress &batch_;
+  int events_length_;
+  Status status_;
+  int offset_;
+  int num_decoded_events_;
+  uint64_t last_timer_ticks_;
+};
+
+#endif  // BASE_STATE_EVENT_CODEC_
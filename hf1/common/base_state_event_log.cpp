@@ -0,0 +1,69 @@
+#ifndef ARDUINO
+
+#include <string.h>
+#include "base_state_event_log.h"
+
+static const uint8_t kMagic[] = { 'H', 'F', '1', 'E' };
+#define kVersion 1
+
+Status BaseStateEventLogWriter::Open(const char *filename) {
+  Close();
+  file_ = fopen(filename, "wb");
+  if (file_ == nullptr) { return kUnavailableError; }
+  const uint8_t version = kVersion;
+  if (fwrite(kMagic, sizeof(kMagic), 1, file_) != 1 || fwrite(&version, sizeof(version), 1, file_) != 1) {
+    Close();
+    return kUnavailableError;
+  }
+  return kSuccess;
+}
+
+void BaseStateEventLogWriter::Close() {
+  if (file_ == nullptr) { return; }
+  fclose(file_);
+  file_ = nullptr;
+}
+
+Status BaseStateEventLogWriter::Write(const P2PRecordBaseStateEventsProgress &batch, int payload_length) {
+  if (file_ == nullptr) { return kDoesNotExistError; }
+  if (payload_length <= 0 || payload_length > static_cast<int>(sizeof(batch))) { return kMalformedError; }
+  const uint8_t length = static_cast<uint8_t>(payload_length);
+  if (fwrite(&length, sizeof(length), 1, file_) != 1 || fwrite(&batch, payload_length, 1, file_) != 1) {
+    return kUnavailableError;
+  }
+  return kSuccess;
+}
+
+Status BaseStateEventLogReader::Open(const char *filename) {
+  Close();
+  file_ = fopen(filename, "rb");
+  if (file_ == nullptr) { return kDoesNotExistError; }
+  uint8_t header[sizeof(kMagic) + 1];
+  if (fread(header, sizeof(header), 1, file_) != 1 || memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      header[sizeof(kMagic)] != kVersion) {
+    Close();
+    return kMalformedError;
+  }
+  return kSuccess;
+}
+
+void BaseStateEventLogReader::Close() {
+  if (file_ == nullptr) { return; }
+  fclose(file_);
+  file_ = nullptr;
+}
+
+Status BaseStateEventLogReader::Read(P2PRecordBaseStateEventsProgress *batch, int *payload_length) {
+  if (file_ == nullptr) { return kDoesNotExistError; }
+  uint8_t length;
+  if (fread(&length, sizeof(length), 1, file_) != 1) {
+    return feof(file_) ? kDoesNotExistError : kMalformedError;
+  }
+  if (length == 0 || length > sizeof(*batch) || fread(batch, length, 1, file_) != 1) {
+    return kMalformedError;
+  }
+  *payload_length = length;
+  return kSuccess;
+}
+
+#endif  // ARDUINO
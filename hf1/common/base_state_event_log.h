@@ -0,0 +1,53 @@
+#ifndef BASE_STATE_EVENT_LOG_
+#define BASE_STATE_EVENT_LOG_
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include "p2p_application_protocol.h"
+#include "status_or.h"
+
+// Binary log of base state event batches, as streamed by the kRecordBaseStateEvents action.
+//
+// The file starts with the 4-byte magic "HF1E" and a version byte. Every batch follows as
+// a length byte and the P2PRecordBaseStateEventsProgress payload as received, so events
+// keep the compact encoding of BaseStateEventBatchEncoder.
+
+class BaseStateEventLogWriter {
+public:
+  BaseStateEventLogWriter() : file_(nullptr) {}
+  ~BaseStateEventLogWriter() { Close(); }
+
+  // Creates or truncates `filename`. Returns kUnavailableError if it cannot be written.
+  Status Open(const char *filename);
+  void Close();
+  bool is_open() const { return file_ != nullptr; }
+
+  // Appends the first `payload_length` bytes of `batch`.
+  Status Write(const P2PRecordBaseStateEventsProgress &batch, int payload_length);
+
+private:
+  FILE *file_;
+};
+
+class BaseStateEventLogReader {
+public:
+  BaseStateEventLogReader() : file_(nullptr) {}
+  ~BaseStateEventLogReader() { Close(); }
+
+  // Returns kDoesNotExistError if `filename` cannot be read, and kMalformedError if it is not
+  // a base state event log.
+  Status Open(const char *filename);
+  void Close();
+
+  // Reads the next batch into `batch` and its length into `payload_length`. Returns
+  // kDoesNotExistError at the end of the log, and kMalformedError if it is truncated.
+  Status Read(P2PRecordBaseStateEventsProgress *batch, int *payload_length);
+
+private:
+  FILE *file_;
+};
+
+#endif  // ARDUINO
+
+#endif  // BASE_STATE_EVENT_LOG_
@@ -0,0 +1,173 @@
+#include "deferred_logger.h"
+#include <stdio.h>
+#include <string.h>
+
+#define kIndexMask (kDeferredLogCapacity - 1)
+
+static_assert(kMaxDeferredLogTextLength <= 255);
+static_assert(kMaxLogArgWords * 4 <= kMaxDeferredLogTextLength);
+
+static void EncodeLittleEndian(uint64_t value, int num_bytes, uint8_t *data) {
+  for (int i = 0; i < num_bytes; ++i) {
+    data[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+static uint64_t DecodeLittleEndian(const uint8_t *data, int num_bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < num_bytes; ++i) {
+    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+int DecodeDeferredLogRecord(const uint8_t *data, int length, DeferredLogRecord *record) {
+  if (length < kDeferredLogRecordHeaderLength) {
+    return 0;
+  }
+  const int payload_length = data[0];
+  const int record_length = kDeferredLogRecordHeaderLength + payload_length;
+  if (record_length > length || data[1] > kLogError) {
+    return 0;
+  }
+  record->level = static_cast<LogLevel>(data[1]);
+  record->format_id = static_cast<int>(DecodeLittleEndian(&data[2], 2));
+  record->timestamp_ns = DecodeLittleEndian(&data[4], 8);
+  const uint8_t *payload = &data[kDeferredLogRecordHeaderLength];
+  if (record->format_id == kLogFormatText) {
+    if (payload_length > kMaxDeferredLogTextLength) {
+      return 0;
+    }
+    memcpy(record->text, payload, payload_length);
+    record->text[payload_length] = '\0';
+  } else {
+    if (payload_length % 4 != 0 || payload_length / 4 > kMaxLogArgWords) {
+      return 0;
+    }
+    record->args.num_words = payload_length / 4;
+    for (int i = 0; i < record->args.num_words; ++i) {
+      record->args.words[i] = static_cast<uint32_t>(DecodeLittleEndian(&payload[4 * i], 4));
+    }
+  }
+  return record_length;
+}
+
+int FormatDeferredLogRecord(const DeferredLogRecord &record, char *buffer, int buffer_size) {
+  if (record.format_id == kLogFormatText) {
+    return snprintf(buffer, buffer_size, "%s", record.text);
+  }
+  return FormatLogMessage(record.format_id, record.args, buffer, buffer_size);
+}
+
+bool DeferredLogRing::Write(LogLevel level, int format_id, uint64_t timestamp_ns, const void *payload, int payload_length) {
+  const uint32_t write_index = write_index_.load(std::memory_order_relaxed);
+  const uint32_t read_index = read_index_.load(std::memory_order_acquire);
+  const int record_length = kDeferredLogRecordHeaderLength + payload_length;
+  if (payload_length > kMaxDeferredLogTextLength || record_length > kDeferredLogCapacity - static_cast<int>(write_index - read_index)) {
+    num_dropped_records_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  uint8_t header[kDeferredLogRecordHeaderLength];
+  header[0] = static_cast<uint8_t>(payload_length);
+  header[1] = static_cast<uint8_t>(level);
+  EncodeLittleEndian(format_id, 2, &header[2]);
+  EncodeLittleEndian(timestamp_ns, 8, &header[4]);
+  for (int i = 0; i < kDeferredLogRecordHeaderLength; ++i) {
+    buffer_[(write_index + i) & kIndexMask] = header[i];
+  }
+  const uint8_t *payload_bytes = static_cast<const uint8_t *>(payload);
+  for (int i = 0; i < payload_length; ++i) {
+    buffer_[(write_index + kDeferredLogRecordHeaderLength + i) & kIndexMask] = payload_bytes[i];
+  }
+  // Publish the record once it is complete.
+  write_index_.store(write_index + record_length, std::memory_order_release);
+  return true;
+}
+
+int DeferredLogRing::OldestRecordLength() const {
+  const uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+  if (write_index_.load(std::memory_order_acquire) == read_index) {
+    return 0;
+  }
+  return kDeferredLogRecordHeaderLength + buffer_[read_index & kIndexMask];
+}
+
+int DeferredLogRing::Read(uint8_t *buffer, int length) {
+  const int record_length = OldestRecordLength();
+  if (record_length == 0 || record_length > length) {
+    return 0;
+  }
+  const uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+  for (int i = 0; i < record_length; ++i) {
+    buffer[i] = buffer_[(read_index + i) & kIndexMask];
+  }
+  // Release the space once the record is copied.
+  read_index_.store(read_index + record_length, std::memory_order_release);
+  return record_length;
+}
+
+void DeferredLogger::Text(LogLevel level, const char *msg) {
+  const int length = msg == nullptr ? 0 : strnlen(msg, kMaxDeferredLogTextLength);
+  ring_.Write(level, kLogFormatText, timer_.GetLocalNanoseconds(), msg, length);
+}
+
+void DeferredLogger::Info(const char *file_name, int line, const char *msg) {
+  Text(kLogInfo, msg);
+}
+
+void DeferredLogger::Warning(const char *file_name, int line, const char *msg) {
+  Text(kLogWarning, msg);
+}
+
+void DeferredLogger::Error(const char *file_name, int line, const char *msg) {
+  Text(kLogError, msg);
+}
+
+void DeferredLogger::Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args) {
+  uint8_t payload[kMaxLogArgWords * 4];
+  for (int i = 0; i < args.num_words; ++i) {
+    EncodeLittleEndian(args.words[i], 4, &payload[4 * i]);
+  }
+  ring_.Write(level, format_id, timer_.GetLocalNanoseconds(), payload, 4 * args.num_words);
+}
+
+void DeferredLogger::Fatal(const char *expr, const char *file_name, int line, const char *msg) {
+  // Show what happened before the error.
+  while (DrainToBaseLogger(/*max_records=*/16)) {}
+  base_logger_->Fatal(expr, file_name, line, msg);
+}
+
+bool DeferredLogger::DrainToBaseLogger(int max_records) {
+  const uint32_t num_dropped_records = ring_.TakeNumDroppedRecords();
+  if (num_dropped_records > 0) {
+    char msg[48];
+    snprintf(msg, sizeof(msg), "%u log messages dropped.", static_cast<unsigned int>(num_dropped_records));
+    base_logger_->Warning("deferred", 0, msg);
+  }
+  for (int i = 0; i < max_records; ++i) {
+    uint8_t data[kMaxDeferredLogRecordLength];
+    const int length = ring_.Read(data, sizeof(data));
+    if (length == 0) {
+      break;
+    }
+    DeferredLogRecord record;
+    if (DecodeDeferredLogRecord(data, length, &record) == 0) {
+      continue;
+    }
+    char msg[kMaxFormattedLogMessageLength];
+    FormatDeferredLogRecord(record, msg, sizeof(msg));
+    switch (record.level) {
+      case kLogWarning:
+        base_logger_->Warning("deferred", 0, msg);
+        break;
+      case kLogError:
+        base_logger_->Error("deferred", 0, msg);
+        break;
+      default:
+        base_logger_->Info("deferred", 0, msg);
+        break;
+    }
+  }
+  return !ring_.empty();
+}
@@ -0,0 +1,107 @@
+#ifndef DEFERRED_LOGGER_
+#define DEFERRED_LOGGER_
+
+#include <stdint.h>
+#include <atomic>
+#include "logger_interface.h"
+#include "timer_interface.h"
+
+// Capacity of the record ring, in bytes. Must be a power of 2.
+#define kDeferredLogCapacity 2048
+// Plain text messages longer than this are truncated.
+#define kMaxDeferredLogTextLength 96
+
+// Log records are encoded as:
+//   uint8_t payload_length;
+//   uint8_t level;            // LogLevel.
+//   uint16_t format_id;       // LogFormatID.
+//   uint64_t timestamp_ns;    // Local time of the logging end.
+//   uint8_t payload[payload_length];
+// Integers are little-endian. The payload of kLogFormatText records is the text, without
+// the null terminator; that of the other records, the argument words.
+// The encoding is the same in the ring and in P2P packets.
+#define kDeferredLogRecordHeaderLength 12
+#define kMaxDeferredLogRecordLength (kDeferredLogRecordHeaderLength + kMaxDeferredLogTextLength)
+
+typedef struct {
+  LogLevel level;
+  int format_id;
+  uint64_t timestamp_ns;
+  LogArgs args;                                 // If format_id != kLogFormatText.
+  char text[kMaxDeferredLogTextLength + 1];     // If format_id == kLogFormatText.
+} DeferredLogRecord;
+
+// Decodes a record at `data`. Returns its encoded length, or 0 if it is malformed or
+// longer than `length`.
+int DecodeDeferredLogRecord(const uint8_t *data, int length, DeferredLogRecord *record);
+
+// Formats the message of `record`, always null-terminated. Returns its length.
+int FormatDeferredLogRecord(const DeferredLogRecord &record, char *buffer, int buffer_size);
+
+// Lock-free, single-producer single-consumer ring of encoded log records.
+class DeferredLogRing {
+public:
+  static_assert((kDeferredLogCapacity & (kDeferredLogCapacity - 1)) == 0);
+
+  DeferredLogRing() : write_index_(0), read_index_(0), num_dropped_records_(0) {}
+
+  // Appends a record, whose payload must not be longer than kMaxDeferredLogTextLength.
+  // If it does not fit, it is dropped and counted. Returns true if it was appended.
+  bool Write(LogLevel level, int format_id, uint64_t timestamp_ns, const void *payload, int payload_length);
+
+  bool empty() const { return write_index_.load(std::memory_order_acquire) == read_index_.load(std::memory_order_relaxed); }
+  // Number of bytes in the ring.
+  int size() const { return write_index_.load(std::memory_order_acquire) - read_index_.load(std::memory_order_relaxed); }
+
+  // Encoded length of the oldest record, or 0 if the ring is empty.
+  int OldestRecordLength() const;
+  // Copies the oldest record to `buffer`, of `length` bytes, and removes it from the ring.
+  // Returns its encoded length, or 0 if the ring is empty or the record is longer than
+  // `length`, in which case it stays in the ring.
+  int Read(uint8_t *buffer, int length);
+
+  // Returns the number of records dropped since the previous call, and resets it.
+  uint32_t TakeNumDroppedRecords() { return num_dropped_records_.exchange(0); }
+
+private:
+  uint8_t buffer_[kDeferredLogCapacity];
+  // Free-running byte indices; only their lower bits index the buffer.
+  std::atomic<uint32_t> write_index_;
+  std::atomic<uint32_t> read_index_;
+  std::atomic<uint32_t> num_dropped_records_;
+};
+
+// Logger that records messages in a ring, and formats them later in the background or on
+// the other end of the P2P link. Recording a formatted message costs a copy of its argument
+// words; plain text messages, a copy of their text.
+//
+// Messages must not be logged from interrupt handlers, as the ring supports a single
+// producer. Fatal errors are not deferred: the pending messages and the error are written
+// to the base logger right away.
+class DeferredLogger : public LoggerInterface {
+public:
+  // Does not take ownership of the pointees, which must outlive this object.
+  DeferredLogger(const TimerInterface *timer, LoggerInterface *base_logger)
+    : timer_(*ASSERT_NOT_NULL(timer)), base_logger_(ASSERT_NOT_NULL(base_logger)) {}
+
+  void Info(const char *file_name, int line, const char *msg) override;
+  void Warning(const char *file_name, int line, const char *msg) override;
+  void Error(const char *file_name, int line, const char *msg) override;
+  void Fatal(const char *expr, const char *file_name, int line, const char *msg) override;
+  void Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args) override;
+
+  DeferredLogRing &ring() { return ring_; }
+
+  // Formats up to `max_records` pending records and writes them to the base logger.
+  // Returns true if records remain.
+  bool DrainToBaseLogger(int max_records);
+
+private:
+  void Text(LogLevel level, const char *msg);
+
+  const TimerInterface &timer_;
+  LoggerInterface *base_logger_;
+  DeferredLogRing ring_;
+};
+
+#endif  // DEFERRED_LOGGER_
@@ -0,0 +1,115 @@
+#include "log_formats.h"
+#include <stdio.h>
+
+#define kMaxConversionSpecLength 16
+
+static const char *const log_formats[] = {
+#define LOG_FORMAT_STRING_ENTRY(id, format) format,
+  LOG_FORMATS(LOG_FORMAT_STRING_ENTRY)
+#undef LOG_FORMAT_STRING_ENTRY
+};
+static_assert(sizeof(log_formats) / sizeof(log_formats[0]) == kNumLogFormats);
+
+const char *GetLogFormat(int format_id) {
+  if (format_id < 0 || format_id >= kNumLogFormats) {
+    return nullptr;
+  }
+  return log_formats[format_id];
+}
+
+int FormatLogMessage(int format_id, const LogArgs &args, char *buffer, int buffer_size) {
+  if (buffer_size <= 0) {
+    return 0;
+  }
+  const char *format = GetLogFormat(format_id);
+  if (format == nullptr || format_id == kLogFormatText) {
+    return snprintf(buffer, buffer_size, "<unknown log format %d>", format_id);
+  }
+
+  int length = 0;
+  int next_word = 0;
+  // Appends the output of snprintf(), which returns the length it would have written.
+  auto append = [&](int n) {
+    if (n > 0) { length += n; }
+    if (length >= buffer_size) { length = buffer_size - 1; }
+  };
+  const char *c = format;
+  while (*c != '\0' && length < buffer_size - 1) {
+    if (*c != '%') {
+      buffer[length++] = *c++;
+      continue;
+    }
+    if (c[1] == '%') {
+      buffer[length++] = '%';
+      c += 2;
+      continue;
+    }
+
+    // Copy the conversion specification, without its length modifiers, which are
+    // implied by the type passed to snprintf() below.
+    char spec[kMaxConversionSpecLength];
+    int spec_length = 0;
+    int num_long_modifiers = 0;
+    spec[spec_length++] = *c++;
+    while (*c != '\0' && strchr("diuxXocfeEgG", *c) == nullptr) {
+      if (*c == 'l') {
+        ++num_long_modifiers;
+      } else if (spec_length < kMaxConversionSpecLength - 3) {
+        spec[spec_length++] = *c;
+      }
+      ++c;
+    }
+    if (*c == '\0') {
+      break;
+    }
+    const char conversion = *c++;
+    const bool is_64_bit = num_long_modifiers >= 2;
+    const int num_words = is_64_bit ? 2 : 1;
+    if (next_word + num_words > args.num_words) {
+      append(snprintf(buffer + length, buffer_size - length, "?"));
+      continue;
+    }
+    const uint32_t low_word = args.words[next_word];
+    const uint64_t word64 = is_64_bit ? (static_cast<uint64_t>(args.words[next_word + 1]) << 32) | low_word : low_word;
+    next_word += num_words;
+
+    if (is_64_bit) {
+      spec[spec_length++] = 'l';
+      spec[spec_length++] = 'l';
+    }
+    spec[spec_length++] = conversion;
+    spec[spec_length] = '\0';
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        if (is_64_bit) {
+          append(snprintf(buffer + length, buffer_size - length, spec, static_cast<long long>(word64)));
+        } else {
+          append(snprintf(buffer + length, buffer_size - length, spec, static_cast<int>(static_cast<int32_t>(low_word))));
+        }
+        break;
+      case 'c':
+        append(snprintf(buffer + length, buffer_size - length, spec, static_cast<int>(low_word)));
+        break;
+      case 'f':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G': {
+        float value;
+        memcpy(&value, &low_word, sizeof(value));
+        append(snprintf(buffer + length, buffer_size - length, spec, static_cast<double>(value)));
+        break;
+      }
+      default:  // Unsigned conversions.
+        if (is_64_bit) {
+          append(snprintf(buffer + length, buffer_size - length, spec, static_cast<unsigned long long>(word64)));
+        } else {
+          append(snprintf(buffer + length, buffer_size - length, spec, static_cast<unsigned int>(low_word)));
+        }
+        break;
+    }
+  }
+  buffer[length] = '\0';
+  return length;
+}
@@ -0,0 +1,103 @@
+#ifndef LOG_FORMATS_
+#define LOG_FORMATS_
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Catalog of the printf-like formats of the messages logged with LOG_INFO_FMT() and friends.
+//
+// Call sites pass a format ID and the raw arguments, which loggers may record as they are
+// and format later, possibly on the other end of the P2P link. Hence:
+// - IDs go across the P2P link: append new formats at the end, and never reorder them.
+// - Arguments are packed in 32-bit words. Formats support the d, i, u, x, X, o, c, f, e
+//   and g conversions, with the ll length modifier for 64-bit integers. They do not
+//   support strings (%s) or arguments passed by address.
+#define LOG_FORMATS(X) \
+  X(kLogFormatText, "%s") /* Plain text messages; not for LOG_*_FMT(). */ \
+  X(kLogFormatCreateBaseTrajectory, "create_base_trajectory(id=%d, num_waypoints=%d)") \
+  X(kLogFormatCreateHeadTrajectory, "create_head_trajectory(id=%d, num_waypoints=%d)") \
+  X(kLogFormatCreateEnvelopeTrajectory, "create_envelope_trajectory(id=%d, num_waypoints=%d)") \
+  X(kLogFormatCreateBaseTrajectoryView, "create_base_trajectory_view(id=%d, trajectory_id=%d, loop_after_seconds=%f, interpolation_config={type=%d})") \
+  X(kLogFormatCreateHeadTrajectoryView, "create_head_trajectory_view(id=%d, trajectory_id=%d, loop_after_seconds=%f, interpolation_config={type=%d})") \
+  X(kLogFormatCreateEnvelopeTrajectoryView, "create_envelope_trajectory_view(id=%d, trajectory_id=%d, loop_after_seconds=%f, interpolation_config={type=%d})") \
+  X(kLogFormatCreateBaseModulatedTrajectoryView, "create_base_modulated_trajectory_view(id=%d, carrier_trajectory_view_id=%d:%d, modulator_trajectory_view_id=%d:%d, envelope_trajectory_view_id=%d)") \
+  X(kLogFormatCreateHeadModulatedTrajectoryView, "create_head_modulated_trajectory_view(id=%d, carrier_trajectory_view_id=%d:%d, modulator_trajectory_view_id=%d:%d, envelope_trajectory_view_id=%d)") \
+  X(kLogFormatCreateBaseMixedTrajectoryView, "create_base_mixed_trajectory_view(id=%d, first_trajectory_view_id=%d:%d, second_trajectory_view_id=%d:%d, alpha_trajectory_view_id=%d)") \
+  X(kLogFormatCreateHeadMixedTrajectoryView, "create_head_mixed_trajectory_view(id=%d, first_trajectory_view_id=%d:%d, second_trajectory_view_id=%d:%d, alpha_trajectory_view_id=%d)") \
+  X(kLogFormatExecuteBaseTrajectoryView, "execute_base_trajectory_view(trajectory_view_type=%d, trajectory_view_id=%d)") \
+  X(kLogFormatExecuteHeadTrajectoryView, "execute_head_trajectory_view(trajectory_view_type=%d, trajectory_view_id=%d)") \
+  X(kLogFormatMonitorBaseState, "monitor_base_state(max_updates=%d)") \
+  X(kLogFormatSetBaseStateFilter, "set_base_state_filter(type=%d)") \
+  X(kLogFormatSetHeadPose, "set_head_pose(pitch=%f, roll=%f)") \
+  X(kLogFormatGlobalTimerOffset, "Global timer +%llu ns") \
+  X(kLogFormatUnknownAction, "Unknown action %d.") \
+  X(kLogFormatNoActionHandler, "No handler installed for action %d.") \
+  X(kLogFormatUnsupportedActionStage, "Unsupported stage %d for action %d.") \
+  X(kLogFormatGlobalTimerAdvance, "Global timer advanced %llu ns")
+
+typedef enum {
+#define LOG_FORMAT_ENUM_ENTRY(id, format) id,
+  LOG_FORMATS(LOG_FORMAT_ENUM_ENTRY)
+#undef LOG_FORMAT_ENUM_ENTRY
+  kNumLogFormats
+} LogFormatID;
+
+typedef enum {
+  kLogInfo = 0,
+  kLogWarning,
+  kLogError
+} LogLevel;
+
+// Returns the format with the given ID, or nullptr if there is none.
+const char *GetLogFormat(int format_id);
+
+#define kMaxLogArgWords 8
+
+// Longest formatted message, including the null terminator. Longer ones are truncated.
+#define kMaxFormattedLogMessageLength 192
+
+// Arguments of a formatted message, packed in 32-bit words.
+typedef struct {
+  uint8_t num_words;
+  uint32_t words[kMaxLogArgWords];
+} LogArgs;
+
+inline void AppendLogArgWord(LogArgs *args, uint32_t word) {
+  if (args->num_words < kMaxLogArgWords) { 
+    args->words[args->num_words++] = word; 
+  }
+}
+
+inline void AppendLogArgs(LogArgs *args) {}
+
+template<typename T, typename... Rest> void AppendLogArgs(LogArgs *args, T value, Rest... rest) {
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Unsupported log argument type.");
+  if constexpr (std::is_floating_point<T>::value) {
+    // Logged as floats, whatever their precision.
+    const float f = static_cast<float>(value);
+    uint32_t word;
+    memcpy(&word, &f, sizeof(word));
+    AppendLogArgWord(args, word);
+  } else if constexpr (sizeof(T) > sizeof(uint32_t)) {
+    AppendLogArgWord(args, static_cast<uint32_t>(static_cast<uint64_t>(value)));
+    AppendLogArgWord(args, static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32));
+  } else {
+    AppendLogArgWord(args, static_cast<uint32_t>(value));
+  }
+  AppendLogArgs(args, rest...);
+}
+
+// Packs `values` for a formatted message. Arguments that do not fit are dropped.
+template<typename... T> LogArgs MakeLogArgs(T... values) {
+  LogArgs args;
+  args.num_words = 0;
+  AppendLogArgs(&args, values...);
+  return args;
+}
+
+// Writes the message with the given format and arguments to `buffer`, always null-terminated.
+// Conversions without arguments are written as "?". Returns the message length.
+int FormatLogMessage(int format_id, const LogArgs &args, char *buffer, int buffer_size);
+
+#endif  // LOG_FORMATS_
@@ -0,0 +1,183 @@
+#ifndef LOG_HISTOGRAM_
+#define LOG_HISTOGRAM_
+
+#include <stdint.h>
+
+// Fixed-size histogram of non-negative values, with buckets of exponentially increasing width.
+//
+// Bucket 0 holds the values below 2^kMinBucketLog2. Bucket i > 0 holds the values in
+// [2^(kMinBucketLog2 + i - 1), 2^(kMinBucketLog2 + i)), except the last one, which holds
+// every value above its lower bound too.
+// Adding a value takes a count-leading-zeros and an increment, so it is cheap enough for
+// the control loops.
+template<int kNumBuckets, int kMinBucketLog2> class LogHistogram {
+public:
+  static_assert(kNumBuckets > 1 && kMinBucketLog2 + kNumBuckets <= 64);
+
+  LogHistogram() { Clear(); }
+
+  // Builds a histogram from bucket counts, e.g. received from the other end.
+  static LogHistogram FromCounts(const uint32_t counts[kNumBuckets], uint64_t max_value) {
+    LogHistogram histogram;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      histogram.counts_[i] = counts[i];
+      histogram.total_count_ += counts[i];
+    }
+    histogram.max_value_ = max_value;
+    return histogram;
+  }
+
+  void Clear() {
+    for (int i = 0; i < kNumBuckets; ++i) {
+      counts_[i] = 0;
+    }
+    total_count_ = 0;
+    max_value_ = 0;
+  }
+
+  void Add(uint64_t value) {
+    ++counts_[BucketForValue(value)];
+    ++total_count_;
+    if (value > max_value_) {
+      max_value_ = value;
+    }
+  }
+
+  static constexpr int num_buckets() { return kNumBuckets; }
+
+  static int BucketForValue(uint64_t value) {
+    if (value < (1ULL << kMinBucketLog2)) {
+      return 0;
+    }
+    const int bucket = 64 - __builtin_clzll(value) - kMinBucketLog2;
+    return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+  }
+
+  // Smallest value in `bucket`.
+  static uint64_t BucketLowerBound(int bucket) {
+    return bucket == 0 ? 0 : 1ULL << (kMinBucketLog2 + bucket - 1);
+  }
+
+  // Smallest value above `bucket`. The last bucket has no upper bound.
+  static uint64_t BucketUpperBound(int bucket) {
+    return bucket == kNumBuckets - 1 ? ~0ULL : 1ULL << (kMinBucketLog2 + bucket);
+  }
+
+  uint32_t count(int bucket) const { return counts_[bucket]; }
+  const uint32_t *counts() const { return counts_; }
+  uint32_t total_count() const { return total_count_; }
+  uint64_t max_value() const { return max_value_; }
+
+  // Returns an upper bound of the smallest value above `fraction` of the values, e.g. 0.99
+  // for the 99th percentile. It is the upper bound of the bucket of the percentile, or the
+  // maximum value if lower. Returns 0 if the histogram is empty.
+  uint64_t Percentile(float fraction) const {
+    if (total_count_ == 0) {
+      return 0;
+    }
+    const uint64_t rank = static_cast<uint64_t>(fraction * total_count_ + 0.5f);
+    uint64_t num_values = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      num_values += counts_[i];
+      if (num_values >= rank && num_values > 0) {
+        return BucketUpperBound(i) < max_value_ ? BucketUpperBound(i) : max_value_;
+      }
+    }
+    return max_value_;
+  }
+
+private:
+  uint32_t counts_[kNumBuckets];
+  uint32_t total_count_;
+  uint64_t max_value_;
+};
+
+// Fixed-size histogram of non-negative values with log-linear buckets, as in HDR histograms:
+// every power of two range is split in 2^kSubBucketsLog2 buckets of equal width, so that the
+// relative error of percentiles stays below 2^-kSubBucketsLog2 over the whole range.
+//
+// Bucket 0 holds the values below 2^kMinBucketLog2, and the last one, every value above its
+// lower bound. Counts are of type TCount, and saturate, so that histograms of small counts
+// fit in little memory. The maximum value is kept exactly, up to 2^32 - 1.
+template<int kNumBuckets, int kMinBucketLog2, int kSubBucketsLog2, typename TCount> class LogLinearHistogram {
+public:
+  static_assert(kNumBuckets > 1 && kSubBucketsLog2 <= kMinBucketLog2);
+  static_assert(kMinBucketLog2 + ((kNumBuckets - 2) >> kSubBucketsLog2) < 63);
+
+  LogLinearHistogram() { Clear(); }
+
+  void Clear() {
+    for (int i = 0; i < kNumBuckets; ++i) {
+      counts_[i] = 0;
+    }
+    total_count_ = 0;
+    max_value_ = 0;
+  }
+
+  void Add(uint64_t value) {
+    TCount &count = counts_[BucketForValue(value)];
+    if (count != static_cast<TCount>(~static_cast<TCount>(0))) {
+      ++count;
+      ++total_count_;
+    }
+    const uint32_t clamped_value = value < 0xffffffffULL ? value : 0xffffffffUL;
+    if (clamped_value > max_value_) {
+      max_value_ = clamped_value;
+    }
+  }
+
+  static int num_buckets() { return kNumBuckets; }
+
+  static int BucketForValue(uint64_t value) {
+    if (value < (1ULL << kMinBucketLog2)) {
+      return 0;
+    }
+    const int log2 = 63 - __builtin_clzll(value);
+    const int sub_bucket = (value >> (log2 - kSubBucketsLog2)) & ((1 << kSubBucketsLog2) - 1);
+    const int bucket = 1 + ((log2 - kMinBucketLog2) << kSubBucketsLog2) + sub_bucket;
+    return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+  }
+
+  // Smallest value in `bucket`.
+  static uint64_t BucketLowerBound(int bucket) {
+    if (bucket == 0) {
+      return 0;
+    }
+    const int octave = (bucket - 1) >> kSubBucketsLog2;
+    const uint64_t sub_bucket = (bucket - 1) & ((1 << kSubBucketsLog2) - 1);
+    return ((1ULL << kSubBucketsLog2) + sub_bucket) << (kMinBucketLog2 + octave - kSubBucketsLog2);
+  }
+
+  // Smallest value above `bucket`. The last bucket has no upper bound.
+  static uint64_t BucketUpperBound(int bucket) {
+    return bucket == kNumBuckets - 1 ? ~0ULL : BucketLowerBound(bucket + 1);
+  }
+
+  TCount count(int bucket) const { return counts_[bucket]; }
+  uint32_t total_count() const { return total_count_; }
+  uint32_t max_value() const { return max_value_; }
+
+  // Returns an upper bound of the smallest value above `fraction` of the values, e.g. 0.99
+  // for the 99th percentile, as LogHistogram::Percentile().
+  uint64_t Percentile(float fraction) const {
+    if (total_count_ == 0) {
+      return 0;
+    }
+    const uint64_t rank = static_cast<uint64_t>(fraction * total_count_ + 0.5f);
+    uint64_t num_values = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      num_values += counts_[i];
+      if (num_values >= rank && num_values > 0) {
+        return BucketUpperBound(i) < max_value_ ? BucketUpperBound(i) : max_value_;
+      }
+    }
+    return max_value_;
+  }
+
+private:
+  TCount counts_[kNumBuckets];
+  uint32_t total_count_;
+  uint32_t max_value_;
+};
+
+#endif  // LOG_HISTOGRAM_
@@ -22,6 +22,22 @@ LoggerInterface *GetLogger() {
   return logger_;
 }
 
+void LoggerInterface::Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args) {
+  char msg[kMaxFormattedLogMessageLength];
+  FormatLogMessage(format_id, args, msg, sizeof(msg));
+  switch (level) {
+    case kLogWarning:
+      Warning(file_name, line, msg);
+      break;
+    case kLogError:
+      Error(file_name, line, msg);
+      break;
+    default:
+      Info(file_name, line, msg);
+      break;
+  }
+}
+
 void DefaultLogger::Fatal(const char *expr, const char *file_name, int line, const char *msg) {
 #ifdef ARDUINO
   Serial.printf("[FATAL] %s:%d: %s is false", file_name, line, expr);
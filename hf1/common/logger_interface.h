@@ -2,6 +2,7 @@
 #define LOGGER_INTERFACE_
 
 #include <string.h>
+#include "log_formats.h"
 
 class LoggerInterface {
 public:
@@ -9,6 +10,11 @@ public:
   virtual void Warning(const char *file_name, int line, const char *msg) = 0;
   virtual void Error(const char *file_name, int line, const char *msg) = 0;
   virtual void Fatal(const char *expr, const char *file_name, int line, const char *msg) = 0;
+
+  // Logs a message with a format of the catalog in log_formats.h.
+  // This implementation formats the message right away and passes it to Info(), Warning()
+  // or Error(). Loggers may override it to defer formatting.
+  virtual void Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args);
 };
 
 class DefaultLogger : public LoggerInterface {
@@ -31,6 +37,14 @@ LoggerInterface *GetLogger();
 #define LOG_WARNING(m) (GetLogger()->Warning(__FILENAME__, __LINE__, m))
 #define LOG_ERROR(m) (GetLogger()->Error(__FILENAME__, __LINE__, m))
 
+// Log a message of the catalog in log_formats.h, e.g.:
+//   LOG_INFO_FMT(kLogFormatSetBaseStateFilter, type);
+// Prefer these to sprintf() and LOG_INFO() in time-critical code, as loggers may defer the
+// formatting.
+#define LOG_INFO_FMT(format_id, ...) (GetLogger()->Formatted(kLogInfo, __FILENAME__, __LINE__, format_id, MakeLogArgs(__VA_ARGS__)))
+#define LOG_WARNING_FMT(format_id, ...) (GetLogger()->Formatted(kLogWarning, __FILENAME__, __LINE__, format_id, MakeLogArgs(__VA_ARGS__)))
+#define LOG_ERROR_FMT(format_id, ...) (GetLogger()->Formatted(kLogError, __FILENAME__, __LINE__, format_id, MakeLogArgs(__VA_ARGS__)))
+
 #define ASSERT(x) if (!(x)) { GetLogger()->Fatal(#x, __FILENAME__, __LINE__, nullptr); }
 #define ASSERTM(x, m) if (!(x)) { GetLogger()->Fatal(#x, __FILENAME__, __LINE__, m); }
 
@@ -37,6 +37,12 @@ typedef enum {
   kCreateHeadMixedTrajectoryView,
   kExecuteBaseTrajectoryView,
   kExecuteHeadTrajectoryView,
+  kSetBaseStateFilter,
+  kRecordBaseStateEvents,
+  kGetPeriodicRunnableStats,
+  kGetProfilerSections,
+  kStreamLogs,
+  kGetRingBufferStats,
 
   kCount  // Must be the last entry in the enum.
 } P2PAction;
@@ -70,13 +76,56 @@ typedef struct {
 // --- Void action ---
 typedef struct {} P2PVoid;
 
+// --- Ping ---
+// Echoes the request payload back, along with the times at which the server received the
+// request and sent the reply, to measure the round trip time of the link. Requests and
+// replies are variable length: only the used payload bytes are sent.
+// Payload bytes must be below kP2PLowestToken, so that they need no escaping and the reply
+// fits in a packet whatever its timestamps.
+#define kP2PMaxPingPayloadLength 112
+
+typedef struct {
+    // Opaque to the server, which echoes it; the client's send time, in the client's clock.
+    uint64_t client_send_ns;
+    // If non-zero, the server guarantees the delivery of the reply.
+    uint8_t guarantee_reply_delivery;
+    uint8_t payload[kP2PMaxPingPayloadLength];
+} P2PPingRequest;
+
+typedef struct {
+    uint64_t client_send_ns;
+    // In the server's local clock. The reply is sent when it is committed to the output
+    // stream, so the difference is the server's processing time, without the queueing.
+    uint64_t server_receive_ns;
+    uint64_t server_transmit_ns;
+    uint8_t payload[kP2PMaxPingPayloadLength];
+} P2PPingReply;
+
 // --- Time synchronization ---
+typedef enum {
+  // The client raises a GPIO line wired to both computers, and sends the local time at which
+  // it did. The server replies with the local time at which it detected the edge.
+  kTimeSyncGPIOEdge = 0,
+  // NTP-like exchange of timestamped packets, over the P2P link alone. The server replies
+  // with the global times at which it received the request and sent the reply.
+  kTimeSyncTwoWay
+} P2PTimeSyncMode;
+
 typedef struct {
+    // kTimeSyncGPIOEdge only.
     uint64_t sync_edge_local_timestamp_ns;
+    // kTimeSyncTwoWay only: time by which the server must advance its global time before
+    // replying, so that the client's global time never needs to go backwards.
+    uint64_t advance_global_ns;
+    uint8_t mode;  // P2PTimeSyncMode.
 } P2PSyncTimeRequest;
 
 typedef struct {
+    // kTimeSyncGPIOEdge only.
     uint64_t sync_edge_local_timestamp_ns;
+    // kTimeSyncTwoWay only.
+    uint64_t request_reception_global_ns;
+    uint64_t reply_transmission_global_ns;
 } P2PSyncTimeReply;
 
 // --- Set head pose ---
@@ -385,6 +434,154 @@ typedef struct {
   uint8_t status_code;
 } P2PExecuteHeadTrajectoryViewReply;
 
+// --- Set base state filter ---
+typedef enum {
+  kKalmanBaseStateFilter = 0,
+  kComplementaryBaseStateFilter,  // Blends IMU yaw with odometry; much cheaper than Kalman.
+
+  kNumBaseStateFilterTypes
+} P2PBaseStateFilterType;
+
+typedef struct {
+  uint8_t type;  // P2PBaseStateFilterType
+} P2PSetBaseStateFilterRequest;
+
+typedef struct {
+  uint8_t status_code;
+} P2PSetBaseStateFilterReply;
+
+// --- Record base state events ---
+// Streams the events consumed by the base state estimator until the action is cancelled, so
+// that they can be logged and replayed offline. The request is P2PVoid and there is no reply.
+typedef enum {
+  kBaseStateEventLeftWheelTick = 0,
+  kBaseStateEventRightWheelTick,
+  kBaseStateEventLeftWheelDirection,
+  kBaseStateEventRightWheelDirection,
+  kBaseStateEventIMUReading,
+
+  kNumBaseStateEventTypes
+} P2PBaseStateEventType;
+
+// Size of the encoded events area, so that the progress packet fits in a P2P packet.
+#define kP2PMaxBaseStateEventBatchLength 150
+
+typedef struct {
+  uint64_t first_timer_ticks;  // Timer ticks of the first event in the batch.
+  uint8_t num_events;
+  // Events not recorded since the previous batch, because the robot's buffer was full.
+  // Saturates at 255.
+  uint8_t num_dropped_events;
+  // Events encoded with BaseStateEventBatchEncoder. Only the used bytes are sent.
+  uint8_t events[kP2PMaxBaseStateEventBatchLength];
+} P2PRecordBaseStateEventsProgress;
+
+// --- Get periodic runnable stats ---
+// Snapshot of the timing stats of one of the instrumented periodic runnables (controllers,
+// estimators) of the Arduino. Request them by index, from 0 to num_runnables - 1.
+// Histogram bucket 0 counts durations below 2^kMinBucketLog2 nanoseconds; bucket i > 0,
+// those up to 2^(kMinBucketLog2 + i), and the last one, any longer duration (see
+// LogHistogram). Run times start at ~1 us, as controllers take from tens of nanoseconds to
+// a few microseconds; period errors go past the 5 ms period of the wheel controllers.
+#define kP2PPeriodicRunnableRunHistogramNumBuckets 12
+#define kP2PPeriodicRunnableRunHistogramMinBucketLog2 10  // ~1 us; the last bucket from ~1 ms.
+#define kP2PPeriodicRunnablePeriodErrorHistogramNumBuckets 14
+#define kP2PPeriodicRunnablePeriodErrorHistogramMinBucketLog2 10  // ~1 us; the last bucket from ~4 ms.
+#define kP2PMaxPeriodicRunnableNameLength 32
+
+typedef struct {
+  uint8_t index;
+  // If non-zero, the stats of the runnable are cleared after taking the snapshot.
+  uint8_t reset;
+} P2PGetPeriodicRunnableStatsRequest;
+
+typedef struct {
+  // kDoesNotExistError if there is no runnable with the requested index.
+  uint8_t status_code;
+  uint8_t num_runnables;
+  char name[kP2PMaxPeriodicRunnableNameLength];  // Null-terminated.
+  uint32_t period_nanos;
+  uint32_t num_runs;
+  // Runs that ended after the start of the next period.
+  uint32_t num_overruns;
+  // Periods without a run, because Run() was called too late.
+  uint32_t num_skipped_periods;
+  // Period error is the time between the start of a period and the start of its run.
+  uint32_t max_period_error_nanos;
+  uint32_t max_run_nanos;
+  uint32_t period_error_histogram[kP2PPeriodicRunnablePeriodErrorHistogramNumBuckets];
+  uint32_t run_histogram[kP2PPeriodicRunnableRunHistogramNumBuckets];
+} P2PGetPeriodicRunnableStatsReply;
+
+// --- Get profiler sections ---
+// Returns the aggregated durations of up to kP2PMaxProfilerSectionsPerReply consecutive
+// sections of the Arduino's profiler (see PROFILE_SCOPE), starting at `first_index`.
+#define kP2PMaxProfilerSectionsPerReply 4
+#define kP2PMaxProfilerSectionNameLength 20
+
+typedef struct {
+  uint8_t first_index;
+  // If non-zero, the returned sections are cleared after taking the snapshot.
+  uint8_t reset;
+} P2PGetProfilerSectionsRequest;
+
+typedef struct {
+  char name[kP2PMaxProfilerSectionNameLength];  // Null-terminated; may be truncated.
+  uint32_t count;
+  uint32_t min_cycles;
+  uint32_t max_cycles;
+  uint64_t total_cycles;
+} P2PProfilerSection;
+
+typedef struct {
+  // kDoesNotExistError if `first_index` is not lower than num_sections.
+  uint8_t status_code;
+  uint8_t num_sections;  // In the profiler.
+  uint8_t num_returned_sections;
+  uint32_t cycles_per_second;
+  P2PProfilerSection sections[kP2PMaxProfilerSectionsPerReply];
+} P2PGetProfilerSectionsReply;
+
+// --- Stream logs ---
+// Streams the messages logged in the Arduino with its DeferredLogger, until the action is
+// cancelled. Meanwhile, the Arduino does not write them to its USB serial port. The request
+// is P2PVoid and there is no reply.
+#define kP2PMaxLogRecordsLength 160
+
+typedef struct {
+  // Messages not logged since the previous progress, because the Arduino's buffer was full.
+  uint16_t num_dropped_records;
+  // Records encoded as described in deferred_logger.h. Only the used bytes are sent.
+  uint8_t records[kP2PMaxLogRecordsLength];
+} P2PStreamLogsProgress;
+
+// --- Get ring buffer stats ---
+// Occupancy stats of one of the fixed-size buffers of the Arduino (see RingBufferStats), to
+// size them from measurements. Request them by index, from 0 to num_buffers - 1.
+#define kP2PMaxRingBufferNameLength 24
+
+typedef struct {
+  uint8_t index;
+  // If non-zero, the stats of the buffer are cleared after taking the snapshot.
+  uint8_t reset;
+} P2PGetRingBufferStatsRequest;
+
+typedef struct {
+  // kDoesNotExistError if there is no buffer with the requested index.
+  uint8_t status_code;
+  uint8_t num_buffers;
+  char name[kP2PMaxRingBufferNameLength];  // Null-terminated.
+  // Number of values the buffer can hold, i.e. its kCapacity - 1.
+  uint8_t capacity;
+  uint8_t high_water_mark;
+  // Values overwritten before being read, because the buffer was full.
+  uint32_t num_overwrites;
+  uint32_t cycles_per_second;
+  // The time-weighted average occupancy is occupancy_cycles / elapsed_cycles.
+  uint64_t occupancy_cycles;
+  uint64_t elapsed_cycles;
+} P2PGetRingBufferStatsReply;
+
 #pragma pack(pop)
 
 const char *GetTrajectoryViewTypeName(P2PTrajectoryViewType type);
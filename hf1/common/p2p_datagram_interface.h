@@ -0,0 +1,27 @@
+#ifndef P2P_DATAGRAM_INTERFACE_
+#define P2P_DATAGRAM_INTERFACE_
+
+#include "p2p_packet_protocol.h"
+
+// A P2P packet in datagram mode: its header and raw content, without escaping nor footer.
+#define kP2PMaxDatagramLength (sizeof(P2PHeader) + kP2PMaxContentLength)
+// Time a guaranteed-delivery packet waits for its ACK before it is sent again.
+#define kP2PDatagramRetransmissionTimeoutNs 10'000'000ULL
+
+// Interface to send and receive datagrams over a point-to-point transport that preserves
+// message boundaries and integrity, e.g. a Unix datagram socket to a simulator, a USB bulk
+// endpoint or a UDP tunnel on localhost. Packet streams created on it map each packet to a
+// datagram, skipping the escaping, checksums and byte-level synchronization that a serial
+// line needs. Must be implemented on each platform.
+class P2PDatagramInterface {
+public:
+  // Sends the `length` bytes of `datagram` at once, and returns true; or returns false, if
+  // they cannot be sent without blocking. This call never blocks.
+  virtual bool Send(const void *datagram, int length) = 0;
+
+  // Receives the next datagram in `buffer`, and returns its length; or returns 0, if there
+  // is none. Datagrams longer than `max_length` are truncated. This call never blocks.
+  virtual int Receive(void *buffer, int max_length) = 0;
+};
+
+#endif  // P2P_DATAGRAM_INTERFACE_
@@ -14,9 +14,6 @@ P2PChecksumType P2PPacket::CalculateChecksum() const {
 }
 
 bool P2PPacket::PrepareToRead() {
-  if (CalculateChecksum() != checksum()) {
-    return false;
-  }
   int read_index = 0;
   int write_index = 0;
   if (length() == 0) {
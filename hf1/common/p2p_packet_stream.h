@@ -7,11 +7,14 @@
 
 #include "p2p_packet_protocol.h"
 #include "p2p_byte_stream_interface.h"
+#include "p2p_datagram_interface.h"
 #include "priority_ring_buffer.h"
 #include "status_or.h"
 #include "timer_interface.h"
 #include "guid_factory_interface.h"
 #include "logger_interface.h"
+#include "log_histogram.h"
+#include <string.h>
 
 // Represents the priority of a packet.
 // The higher the priority, the lower the latency, as higher priority packets
@@ -63,7 +66,8 @@ public:
 
   // Decodes the content in place and updates the length accordingly. 
   // Returns true if success, or false if error.
-  // An error will occur if the encoded content is malformed.
+  // An error will occur if the encoded content is malformed. The checksum is not checked:
+  // call HasValidChecksum() before.
   bool PrepareToRead();
 
   // Encodes the content in place and updates the length and checksum accordingly.
@@ -80,6 +84,9 @@ public:
   bool &counted_in_stats() { return counted_in_stats_; };
   bool counted_in_stats() const { return counted_in_stats_; };
 
+  // Returns true if the checksum matches the header and the encoded content.
+  bool HasValidChecksum() const { return CalculateChecksum() == checksum(); }
+
 protected:
   P2PChecksumType CalculateChecksum() const; 
 
@@ -215,6 +222,122 @@ public:
   }
 };
 
+// Points in the lifetime of a packet that P2PPacketTracer reports.
+typedef enum {
+  // Output stream events.
+  kP2PPacketCommitted = 0,
+  // The first byte of an original transmission got in the byte stream.
+  kP2PPacketFirstByteSent,
+  // The transmission was interrupted for a higher priority packet...
+  kP2PPacketPreempted,
+  // ...and resumed afterwards.
+  kP2PPacketContinued,
+  kP2PPacketLastByteSent,
+  // The first byte of a retransmission got in the byte stream.
+  kP2PPacketRetransmitted,
+  // The other end acknowledged the packet, which leaves the output stream.
+  kP2PPacketAckReceived,
+  // Input stream events.
+  // The packet was fully received, and is available in the input stream.
+  kP2PPacketReceived,
+  // OldestPacket() returned the packet for the first time.
+  kP2PPacketDelivered,
+  kP2PPacketConsumed,
+  kP2PPacketNumTraceEvents
+} P2PPacketTraceEvent;
+
+// Receives the lifetime events of the packets of a stream, with the stream's timer time in
+// nanoseconds. Packets are identified by their priority and sequence number; ACKs take the
+// sequence number of the packet they acknowledge. It is called from the stream functions
+// that produce the events, so it must return quickly.
+class P2PPacketTracer : public P2PCallback<void (*)(P2PPacketTraceEvent, const P2PPacket &, uint64_t, void *), void *> {
+public:
+  P2PPacketTracer() : P2PCallback<void (*)(P2PPacketTraceEvent, const P2PPacket &, uint64_t, void *), void *>() {}
+  P2PPacketTracer(void (*fn)(P2PPacketTraceEvent, const P2PPacket &, uint64_t, void *), void *args) 
+    : P2PCallback<void (*)(P2PPacketTraceEvent, const P2PPacket &, uint64_t, void *), void *>(fn, args) {}
+
+  bool is_enabled() const { return function() != NULL; }
+
+  // Reports `event` for `packet`, timestamped with `timer`. Untraced streams only pay for
+  // the check.
+  void operator()(P2PPacketTraceEvent event, const P2PPacket &packet, TimerInterface &timer) {
+    if (function() != NULL) {
+      function()(event, packet, timer.GetLocalNanoseconds(), arg());
+    }
+  }
+};
+
+// Latency histograms of the streams, in nanoseconds. Buckets are half an octave wide, from
+// 2^kP2PLatencyHistogramMinBucketLog2 ns (~33 us) to ~23 ms, and the maximum is exact.
+#define kP2PLatencyHistogramNumBuckets 20
+#define kP2PLatencyHistogramMinBucketLog2 15
+#define kP2PLatencyHistogramSubBucketsLog2 1
+typedef LogLinearHistogram<kP2PLatencyHistogramNumBuckets, kP2PLatencyHistogramMinBucketLog2, kP2PLatencyHistogramSubBucketsLog2, uint16_t> P2PLatencyHistogram;
+
+// Latency histograms of a stream, per metric and priority level. The stream adds the
+// samples; other threads may take snapshots and reset the histograms at any time.
+//
+// Snapshots are consistent thanks to a sequence lock: the stream makes the sequence odd while
+// it updates the histograms, and readers retry their copy until they find the same even
+// sequence before and after it, so that the stream never waits. Readers must not preempt the
+// stream, e.g. from an interrupt, or they would wait forever. Resets are only requested by
+// readers: the stream clears the histograms before its next sample.
+template<int kNumMetrics> class P2PLatencyHistograms {
+public:
+  typedef struct {
+    P2PLatencyHistogram histograms[kNumMetrics][P2PPriority::kNumLevels];
+  } Snapshot;
+
+  P2PLatencyHistograms() : sequence_(0), is_reset_requested_(false) {}
+
+  // Called by the stream only.
+  void Add(int metric, P2PPriority priority, uint64_t nanoseconds) {
+    const uint32_t sequence = sequence_;
+    __atomic_store_n(&sequence_, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (__atomic_load_n(&is_reset_requested_, __ATOMIC_RELAXED)) {
+      for (int i = 0; i < kNumMetrics; ++i) {
+        for (int j = 0; j < P2PPriority::kNumLevels; ++j) {
+          data_.histograms[i][j].Clear();
+        }
+      }
+      __atomic_store_n(&is_reset_requested_, false, __ATOMIC_RELAXED);
+    }
+    data_.histograms[metric][priority].Add(nanoseconds);
+    __atomic_store_n(&sequence_, sequence + 2, __ATOMIC_RELEASE);
+  }
+
+  // Copies the current histograms to `snapshot`.
+  void Read(Snapshot *snapshot) const {
+    for (;;) {
+      const uint32_t sequence = __atomic_load_n(&sequence_, __ATOMIC_ACQUIRE);
+      if (sequence & 1) {
+        continue;
+      }
+      memcpy(snapshot, &data_, sizeof(data_));
+      const bool is_reset_requested = __atomic_load_n(&is_reset_requested_, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&sequence_, __ATOMIC_RELAXED) != sequence) {
+        continue;
+      }
+      if (is_reset_requested) {
+        // The stream has not cleared the histograms yet.
+        *snapshot = Snapshot();
+      }
+      return;
+    }
+  }
+
+  // Clears the histograms. Samples that the stream adds between a Read() and a Reset() in
+  // another thread are lost.
+  void Reset() { __atomic_store_n(&is_reset_requested_, true, __ATOMIC_RELEASE); }
+
+private:
+  Snapshot data_;
+  uint32_t sequence_;
+  bool is_reset_requested_;
+};
+
 // Represents a buffered input stream of best-effort packets with priorities. 
 // Higher-priority packets are received and delivered to the caller earlier than lower-priority 
 // ones thanks to a preemption and continuation mechanism.
@@ -228,7 +351,13 @@ public:
   // Does not take ownership of the byte stream or timer, which must outlive this object.
   // Only one packet stream can be associated to each byte stream at a time.
   P2PPacketInputStream(P2PByteStreamInterface<LocalEndianness> *byte_stream, TimerInterface *timer)
-    : byte_stream_(*byte_stream), timer_(*timer) {
+    : byte_stream_(ASSERT_NOT_NULL(byte_stream)), datagrams_(NULL), timer_(*timer) {
+      Reset();
+    }
+
+  // Same, in datagram mode: every datagram is a packet (see P2PDatagramInterface).
+  P2PPacketInputStream(P2PDatagramInterface *datagrams, TimerInterface *timer)
+    : byte_stream_(NULL), datagrams_(ASSERT_NOT_NULL(datagrams)), timer_(*timer) {
       Reset();
     }
 
@@ -236,26 +365,32 @@ public:
   void Reset();
 
   // Returns the number of times that Consume() can be called without OldestPacket() returning NULL.
-  int NumAvailablePackets(P2PPriority priority) const { return packet_buffer_[priority].Size(); }
+  int NumAvailablePackets(P2PPriority priority) const { return packet_buffer_.Size(priority); }
 
   // Returns a view to the oldest packet in the stream, or kUnavailableError if empty.
   StatusOr<const P2PPacketView> OldestPacket();
 
   // Consumes the oldest packet with highest priority in the stream. Afterwards, OldestPacket() returns a new
   // value. Returns false, if there is no packet to consume.
-  bool Consume(P2PPriority priority) { return packet_buffer_.Consume(priority); }
+  bool Consume(P2PPriority priority);
 
   // Not all platforms support lambdas.
   void packet_filter(const P2PPacketFilter &filter) { packet_filter_ = filter; }
   const P2PPacketFilter &packet_filter() { return packet_filter_; }
 
+  // Reports the input events of every packet. Disabled by default.
+  void packet_tracer(const P2PPacketTracer &tracer) { packet_tracer_ = tracer; }
+  const P2PPacketTracer &packet_tracer() const { return packet_tracer_; }
+
   // Runs the stream logic. Must be called from a run loop continuously, or when there is
   // data available in the byte stream. Returns the number of bytes read and processed.
+  // In datagram mode, each call processes a datagram at most.
   int Run();
 
   // Reception statistics.
   class Stats {
     friend class P2PPacketInputStream;
+    template<int IC, int OC, Endianness LE> friend class P2PPacketStream;
   public:
     Stats() { 
       for (int i = 0; i < P2PPriority::kNumLevels; ++i) { 
@@ -263,6 +398,19 @@ public:
         total_packet_delay_ns_[i] = 0;
         total_packet_delay_per_byte_ns_[i] = 0;
       }
+      num_skipped_bytes_ = 0;
+      num_malformed_headers_ = 0;
+      num_interrupted_packets_ = 0;
+      num_orphaned_continuations_ = 0;
+      num_mismatched_continuations_ = 0;
+      num_malformed_footers_ = 0;
+      num_checksum_errors_ = 0;
+      num_malformed_contents_ = 0;
+      num_dropped_packets_ = 0;
+      num_evicted_packets_ = 0;
+      num_duplicate_packets_ = 0;
+      num_unacknowledgeable_packets_ = 0;
+      num_packets_before_handshake_ = 0;
     }
     
     // Total number of packets received per priority level.
@@ -282,28 +430,104 @@ public:
       return total_packets_[priority] > 0 ? total_packet_delay_per_byte_ns_[priority] / total_packets_[priority] : -1;
     }
 
+    // Link quality counters, for all priorities. Each one counts an outcome after which the
+    // state machine drops what it was reading and resynchronizes with the next start token,
+    // unless stated otherwise.
+
+    // Bytes read while waiting for a start token, e.g. line noise or the rest of a packet
+    // after a resynchronization.
+    uint32_t num_skipped_bytes() const { return num_skipped_bytes_; }
+    // Headers with an invalid priority or a special token. In datagram mode, datagrams with
+    // an invalid priority, a continuation flag, or a length other than their header's.
+    uint32_t num_malformed_headers() const { return num_malformed_headers_; }
+    // Start tokens in a header or footer, where preemption is not legal, so that the other
+    // end must have restarted the packet. Reading goes on with the new packet.
+    uint32_t num_interrupted_packets() const { return num_interrupted_packets_; }
+    // Continuations of packets that were not being received.
+    uint32_t num_orphaned_continuations() const { return num_orphaned_continuations_; }
+    // Continuations whose sequence number or offset do not match the packet being received.
+    uint32_t num_mismatched_continuations() const { return num_mismatched_continuations_; }
+    // Footers with a special token.
+    uint32_t num_malformed_footers() const { return num_malformed_footers_; }
+    // Fully received packets with a wrong checksum.
+    uint32_t num_checksum_errors() const { return num_checksum_errors_; }
+    // Fully received packets with a valid checksum, but a malformed token escaping.
+    uint32_t num_malformed_contents() const { return num_malformed_contents_; }
+    // Packets received but dropped because the input buffer of their priority was full.
+    // Guaranteed-delivery packets are dropped without ACK, so the other end retransmits them.
+    uint32_t num_dropped_packets() const { return num_dropped_packets_; }
+    // Best-effort packets removed from a full input buffer to make room for a
+    // guaranteed-delivery one, before the caller consumed them.
+    uint32_t num_evicted_packets() const { return num_evicted_packets_; }
+    // Retransmissions of guaranteed-delivery packets that had been received already, e.g.
+    // because their ACK was lost or late. They are ACKed again, and filtered.
+    uint32_t num_duplicate_packets() const { return num_duplicate_packets_; }
+    // Guaranteed-delivery packets filtered because there was no room for their ACK in the
+    // output buffer, so that the other end retransmits them.
+    uint32_t num_unacknowledgeable_packets() const { return num_unacknowledgeable_packets_; }
+    // Packets filtered because they came before the handshake.
+    uint32_t num_packets_before_handshake() const { return num_packets_before_handshake_; }
+
     private:
       uint64_t total_packets_[P2PPriority::kNumLevels];
       uint64_t total_packet_delay_ns_[P2PPriority::kNumLevels];
       uint64_t total_packet_delay_per_byte_ns_[P2PPriority::kNumLevels];
+      uint32_t num_skipped_bytes_;
+      uint32_t num_malformed_headers_;
+      uint32_t num_interrupted_packets_;
+      uint32_t num_orphaned_continuations_;
+      uint32_t num_mismatched_continuations_;
+      uint32_t num_malformed_footers_;
+      uint32_t num_checksum_errors_;
+      uint32_t num_malformed_contents_;
+      uint32_t num_dropped_packets_;
+      uint32_t num_evicted_packets_;
+      uint32_t num_duplicate_packets_;
+      uint32_t num_unacknowledgeable_packets_;
+      uint32_t num_packets_before_handshake_;
   };
 
   const Stats &stats() const { return stats_; }
 
+  // Latency distributions, per priority level.
+  enum LatencyMetric {
+    // From a packet being fully received to OldestPacket() returning it for the first time.
+    kRetrievalDelay = 0,
+    kNumLatencyMetrics
+  };
+  typedef P2PLatencyHistograms<kNumLatencyMetrics> LatencyHistograms;
+  // Can be read and reset from any thread.
+  LatencyHistograms &latency_histograms() { return latency_histograms_; }
+
+  // Occupancy of the packet buffer of each priority level (see RingBufferStats).
+  RingBufferStats buffer_stats(P2PPriority priority) const { return packet_buffer_.stats(priority); }
+  void ClearBufferStats(P2PPriority priority) { packet_buffer_.ClearStats(priority); }
+
 private:
+  int RunDatagram();
+  // Returns the slot where to receive a new packet with `header`, making room for it if it
+  // requires an ACK, or discarded_packet_placeholder_ if there is none.
+  P2PPacket *NewIncomingPacket(const P2PHeader &header);
+  // Makes a fully received, decoded packet available, if the filter accepts it.
+  void CommitIncomingPacket(P2PPacket &packet);
+
   PriorityRingBuffer<P2PPacket, kCapacity, P2PPriority> packet_buffer_;
-  P2PByteStreamInterface<LocalEndianness> &byte_stream_;
+  // Only one of them is set.
+  P2PByteStreamInterface<LocalEndianness> *byte_stream_;
+  P2PDatagramInterface *datagrams_;
   TimerInterface &timer_;
   unsigned int current_field_read_bytes_;
   enum State { kWaitingForPacket, kReadingHeader, kReadingContent, kDisambiguatingStartTokenInContent, kReadingFooter } state_;
   P2PHeader incoming_header_;
   P2PPacket *incoming_packet_[P2PPriority::kNumLevels];
   P2PPacketFilter packet_filter_;
+  P2PPacketTracer packet_tracer_;
   uint8_t write_offset_before_break_[P2PPriority::kNumLevels];
   uint64_t current_sequence_number_[P2PPriority::kNumLevels];
   P2PPacket discarded_packet_placeholder_;
 
   Stats stats_;
+  LatencyHistograms latency_histograms_;
 };
 
 // Represents a buffered output stream of best-effort packets. 
@@ -317,7 +541,14 @@ public:
   // Does not take ownership of the byte stream or timer, which must outlive this object.
   // Only one packet stream can be associated to each byte stream at a time.
   P2PPacketOutputStream(P2PByteStreamInterface<LocalEndianness> *byte_stream, TimerInterface *timer)
-    : byte_stream_(*byte_stream), timer_(*timer) {
+    : byte_stream_(ASSERT_NOT_NULL(byte_stream)), datagrams_(NULL), timer_(*timer) {
+      Reset();
+    }
+
+  // Same, in datagram mode: every packet is sent whole in a datagram, so there is no
+  // preemption (see P2PDatagramInterface).
+  P2PPacketOutputStream(P2PDatagramInterface *datagrams, TimerInterface *timer)
+    : byte_stream_(NULL), datagrams_(ASSERT_NOT_NULL(datagrams)), timer_(*timer) {
       Reset();
     }
 
@@ -360,9 +591,14 @@ public:
   void packet_filter(const P2PPacketFilter &filter) { packet_filter_ = filter; }
   const P2PPacketFilter &packet_filter() { return packet_filter_; }
 
-  // Runs the stream and returns the minimum number of microseconds the caller may wait
-  // until calling Run() again. Multi-threaded platforms can use this value to yield time
-  // to other threads.
+  // Reports the output events of every packet. Disabled by default.
+  void packet_tracer(const P2PPacketTracer &tracer) { packet_tracer_ = tracer; }
+  const P2PPacketTracer &packet_tracer() const { return packet_tracer_; }
+
+  // Runs the stream and returns the minimum number of nanoseconds the caller may wait
+  // until calling Run() again, e.g. until a burst is ingested or, in datagram mode, until an
+  // unACKed packet is due for retransmission. Multi-threaded platforms can use this value
+  // to yield time to other threads.
   uint64_t Run();
 
   // Transmission statistics.
@@ -408,9 +644,41 @@ public:
 
   const Stats &stats() const { return stats_; }
 
+  // Latency distributions, per priority level. Retransmissions are not included.
+  //
+  // There is no end-to-end delay, from the commit to the reception at the other end. The
+  // local clocks of both ends are unrelated, and stamping the global time in every packet
+  // would more than double the size of small ones. For guaranteed-delivery packets,
+  // kAckDelay bounds it from above.
+  enum LatencyMetric {
+    // From a packet's commit to its first byte getting in the byte stream.
+    kQueueingDelay = 0,
+    // From the first to the last byte of a packet getting in the byte stream, including the
+    // time it was preempted.
+    kWireTime,
+    // From the commit of a guaranteed-delivery packet to the reception of its ACK.
+    kAckDelay,
+    kNumLatencyMetrics
+  };
+  typedef P2PLatencyHistograms<kNumLatencyMetrics> LatencyHistograms;
+  // Can be read and reset from any thread.
+  LatencyHistograms &latency_histograms() { return latency_histograms_; }
+
+  // Occupancy of the packet buffer of each priority level (see RingBufferStats).
+  RingBufferStats buffer_stats(P2PPriority priority) const { return packet_buffer_.stats(priority); }
+  void ClearBufferStats(P2PPriority priority) { packet_buffer_.ClearStats(priority); }
+
 private:
+  uint64_t RunDatagram();
+  // Update the stats and traces when the first and the last byte of current_packet_ are
+  // sent.
+  void OnTransmissionStart(uint64_t timestamp_ns);
+  void OnTransmissionEnd(uint64_t timestamp_ns);
+
   PriorityRingBuffer<P2PPacket, kCapacity, P2PPriority> packet_buffer_;
-  P2PByteStreamInterface<LocalEndianness> &byte_stream_;
+  // Only one of them is set.
+  P2PByteStreamInterface<LocalEndianness> *byte_stream_;
+  P2PDatagramInterface *datagrams_;
   TimerInterface &timer_;
   P2PPacket *current_packet_;
   int total_packet_bytes_[P2PPriority::kNumLevels];
@@ -420,11 +688,18 @@ private:
   uint64_t after_burst_wait_end_timestamp_ns_;
   uint64_t current_sequence_number_[P2PPriority::kNumLevels];
   uint64_t last_sent_sequence_number_[P2PPriority::kNumLevels];
+  // Datagram mode only: the last guaranteed-delivery packet sent at each priority, and when.
+  uint64_t last_datagram_sequence_number_[P2PPriority::kNumLevels];
+  uint64_t last_datagram_send_ns_[P2PPriority::kNumLevels];
+  // When the first byte of the packet in transmission at each priority was sent.
+  uint64_t transmission_start_ns_[P2PPriority::kNumLevels];
   enum State { kGettingNextPacket, kSendingHeaderBurst, kWaitingForHeaderBurstIngestion, kSendingBurst, kWaitingForBurstIngestion, kWaitingForPartialBurstIngestionBeforeHigherPriorityPacket } state_;  
   P2PPacketFilter packet_filter_;
   P2PPacketCommittedCallback packet_committed_callback_;
+  P2PPacketTracer packet_tracer_;
 
   Stats stats_;
+  LatencyHistograms latency_histograms_;
 };
 
 class P2POtherEndStartedCallback : public P2PCallback<void (*)(void *), void *> {
@@ -445,8 +720,14 @@ public:
 // Reliable packets are retransmitted until the other end acknowledges them.
 template<int kInputCapacity, int kOutputCapacity, Endianness LocalEndianness> class P2PPacketStream {
 public:
+  typedef P2PPacketInputStream<kInputCapacity, LocalEndianness> InputStream;
+  typedef P2PPacketOutputStream<kOutputCapacity, LocalEndianness> OutputStream;
+
   // Does not take ownership of the streams, which must outlive this object.
   P2PPacketStream(P2PByteStreamInterface<LocalEndianness> *byte_stream, TimerInterface *timer, GUIDFactoryInterface &guid_factory);
+  // Same, in datagram mode (see P2PDatagramInterface). Priorities, guaranteed delivery and
+  // the handshake work as with a byte stream. Both ends must use the same mode.
+  P2PPacketStream(P2PDatagramInterface *datagrams, TimerInterface *timer, GUIDFactoryInterface &guid_factory);
 
   P2PPacketInputStream<kInputCapacity, LocalEndianness> &input() { return input_; }
   P2PPacketOutputStream<kOutputCapacity, LocalEndianness> &output() { return output_; }
@@ -461,7 +742,16 @@ public:
     return other_end_started_callback_;
   }
 
+  // Reports the lifetime events of the packets in both directions, including ACKs and
+  // handshakes. Disabled by default.
+  void packet_tracer(const P2PPacketTracer &tracer) {
+    input_.packet_tracer(tracer);
+    output_.packet_tracer(tracer);
+  }
+
 protected:
+  // Schedules the handshake.
+  void Init();
   void ResetInput();
   void ResetOutputSession(const P2PPacket &handshake_request);
 
@@ -23,17 +23,33 @@ StatusOr<const P2PPacketView> P2PPacketInputStream<kCapacity, LocalEndianness>::
     stats_.total_packet_delay_per_byte_ns_[packet->header()->priority] += delay_ns / (sizeof(P2PHeader) + packet->length() + sizeof(P2PFooter));
     // Mute stats update as this function may be called multiple times for a packet.
     packet->counted_in_stats() = true;
+    latency_histograms_.Add(kRetrievalDelay, packet->header()->priority, delay_ns);
+    packet_tracer_(kP2PPacketDelivered, *packet, timer_);
   }
   return P2PPacketView(packet);
 }
 
+template<int kCapacity, Endianness LocalEndianness>
+bool P2PPacketInputStream<kCapacity, LocalEndianness>::Consume(P2PPriority priority) {
+  if (packet_tracer_.is_enabled()) {
+    const P2PPacket *packet = packet_buffer_.OldestValue(priority);
+    if (packet != NULL) {
+      packet_tracer_(kP2PPacketConsumed, *packet, timer_);
+    }
+  }
+  return packet_buffer_.Consume(priority);
+}
+
 template<int kCapacity, Endianness LocalEndianness>
 void P2PPacketOutputStream<kCapacity, LocalEndianness>::Reset() {
   packet_buffer_.Clear();
   for (int i = 0; i < P2PPriority::kNumLevels; ++i) {
     current_sequence_number_[i] = 0;
     last_sent_sequence_number_[i] = -1ULL;
+    last_datagram_sequence_number_[i] = -1ULL;
+    last_datagram_send_ns_[i] = 0;
     total_packet_bytes_[i] = -1;
+    transmission_start_ns_[i] = 0;
   }
   state_ = kGettingNextPacket;
 }
@@ -64,17 +80,20 @@ bool P2PPacketOutputStream<kCapacity, LocalEndianness>::Commit(P2PPriority prior
   } else {
     packet.sequence_number() = seq_number;
   }
-  if (!packet.PrepareToSend()) { return false; }
-  // Fix endianness.
-  packet.checksum() = LocalToNetwork<LocalEndianness>(packet.checksum());
+  if (datagrams_ == NULL) {
+    if (!packet.PrepareToSend()) { return false; }
+    // Fix endianness.
+    packet.checksum() = LocalToNetwork<LocalEndianness>(packet.checksum());
+  }
   packet.length() = LocalToNetwork<LocalEndianness>(packet.length());
 
   packet.counted_in_stats() = false;
   packet.commit_time_ns() = timer_.GetLocalNanoseconds();
   packet_buffer_.Commit(priority);
+  packet_tracer_(kP2PPacketCommitted, packet, timer_);
 
   if (seq_number == -1ULL) {
-    ++current_sequence_number_[priority];
+    current_sequence_number_[priority] = P2PSequenceNumberType::Next(current_sequence_number_[priority]);
   }
 
   packet_committed_callback_(packet);
@@ -82,17 +101,89 @@ bool P2PPacketOutputStream<kCapacity, LocalEndianness>::Commit(P2PPriority prior
   return true;
 }
 
+template<int kCapacity, Endianness LocalEndianness>
+P2PPacket *P2PPacketInputStream<kCapacity, LocalEndianness>::NewIncomingPacket(const P2PHeader &header) {
+  if (!packet_buffer_.IsFull(header.priority)) {
+    // There is buffer space: get the next empty slot.
+    return &packet_buffer_.NewValue(header.priority);
+  }
+  // No space available.
+  if (!header.requires_ack) {
+    // It's a regular packet: finish receiving it without writing it in the input queue.
+    return &discarded_packet_placeholder_;
+  }
+  // It's a guaranteed-delivery packet: discard one regular packet to make room.
+  for (int i = 0; i < packet_buffer_.Size(header.priority); ++i) {
+    if (!packet_buffer_.OldestValue(header.priority, i)->header()->requires_ack) {
+      packet_buffer_.Consume(header.priority, i);
+      ++stats_.num_evicted_packets_;
+      break;
+    }
+  }
+  if (!packet_buffer_.IsFull(header.priority)) {
+    // We were able to discard one regular packet: use the new room for the
+    // guaranteed-delivery packet.
+    return &packet_buffer_.NewValue(header.priority);
+  }
+  // There were no regular packets to discard: finish reading the packet, but store it in
+  // bogus location to still react to inconsistencies. The other end should keep resending it
+  // until we have input buffer space to receive it.
+  return &discarded_packet_placeholder_;
+}
+
+template<int kCapacity, Endianness LocalEndianness>
+void P2PPacketInputStream<kCapacity, LocalEndianness>::CommitIncomingPacket(P2PPacket &packet) {
+  if (&packet == &discarded_packet_placeholder_ && !packet.header()->is_ack && !packet.header()->is_init) {
+    // No room in the input buffer. Do not let the filter ACK it, so that the other end
+    // retransmits it if it requires delivery. ACKs and handshakes are never buffered,
+    // so the filter still processes them.
+    ++stats_.num_dropped_packets_;
+  } else if (packet_filter_(packet) && &packet != &discarded_packet_placeholder_) {
+    packet.counted_in_stats() = false;
+    packet.commit_time_ns() = timer_.GetLocalNanoseconds();
+    packet_buffer_.Commit(packet.header()->priority);
+    packet_tracer_(kP2PPacketReceived, packet, timer_);
+  }
+}
+
+template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCapacity, LocalEndianness>::RunDatagram() {
+  // Receive in the placeholder, as the slot depends on the header.
+  P2PPacket &datagram = discarded_packet_placeholder_;
+  const int length = datagrams_->Receive(datagram.header(), kP2PMaxDatagramLength);
+  if (length <= 0) {
+    return 0;
+  }
+  const P2PHeader &header = *datagram.header();
+  if (length < static_cast<int>(sizeof(P2PHeader)) || header.priority >= P2PPriority::kNumLevels ||
+      header.is_continuation || NetworkToLocal<LocalEndianness>(header.length) != length - static_cast<int>(sizeof(P2PHeader))) {
+    ++stats_.num_malformed_headers_;
+    return length;
+  }
+  P2PPacket *packet = NewIncomingPacket(header);
+  if (packet != &discarded_packet_placeholder_) {
+    memcpy(packet->header(), datagram.header(), length);
+  }
+  packet->length() = NetworkToLocal<LocalEndianness>(packet->length());
+  CommitIncomingPacket(*packet);
+  return length;
+}
+
 template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCapacity, LocalEndianness>::Run() {
+  if (datagrams_ != NULL) {
+    return RunDatagram();
+  }
   int num_bytes_read = 0;
   switch (state_) {
     case kWaitingForPacket:
       {
-        if ((num_bytes_read = byte_stream_.Read(&incoming_header_.start_token, 1)) < 1) {
+        if ((num_bytes_read = byte_stream_->Read(&incoming_header_.start_token, 1)) < 1) {
           break;
         }
         if (incoming_header_.start_token == kP2PStartToken) {
           state_ = kReadingHeader;
           current_field_read_bytes_ = 1;
+        } else {
+          ++stats_.num_skipped_bytes_;
         }
         break;
       }
@@ -105,42 +196,14 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
           // there.
           if (incoming_header_.priority >= P2PPriority::kNumLevels) {
             // Invalid priority level.
+            ++stats_.num_malformed_headers_;
             state_ = kWaitingForPacket;
             break;
           }
 
           if (!incoming_header_.is_continuation) {
             // New packet.
-
-            if (!packet_buffer_.IsFull(incoming_header_.priority)) {
-              // There is buffer space: get the next empty slot.
-              incoming_packet_[incoming_header_.priority] = &packet_buffer_.NewValue(incoming_header_.priority);
-            } else {
-              // No space available.
-              if (!incoming_header_.requires_ack) {
-                // It's a regular packet: finish receiving it without writing it in the 
-                // input queue.
-                incoming_packet_[incoming_header_.priority] = &discarded_packet_placeholder_;
-              } else {
-                // It's a guaranteed-delivery packet: discard one regular packet to make room.
-                for (int i = 0; i < packet_buffer_.Size(incoming_header_.priority); ++i) {
-                  if (!packet_buffer_.OldestValue(incoming_header_.priority, i)->header()->requires_ack) {
-                    packet_buffer_.Consume(incoming_header_.priority, i);
-                    break;
-                  }
-                }
-                if (!packet_buffer_.IsFull(incoming_header_.priority)) {
-                  // We were able to discard one regular packet: use the new room for the 
-                  // guaranteed-delivery packet.
-                  incoming_packet_[incoming_header_.priority] = &packet_buffer_.NewValue(incoming_header_.priority);
-                } else {
-                  // There were no regular packets to discard: finish reading the packet, but
-                  // store it in bogus location to still react to inconsistencies. The other
-                  // end should keep resending it until we have input buffer space to receive it.
-                  incoming_packet_[incoming_header_.priority] = &discarded_packet_placeholder_;
-                }
-              }              
-            }
+            incoming_packet_[incoming_header_.priority] = NewIncomingPacket(incoming_header_);
 
             P2PPacket &packet = *incoming_packet_[incoming_header_.priority];
             for (unsigned int i = 0; i < sizeof(P2PHeader); ++i) {
@@ -155,6 +218,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
 
             if (incoming_packet_[incoming_header_.priority] == nullptr) {
               // This packet was not being tracked. Ignore as it could just be noise resembling a packet.
+              ++stats_.num_orphaned_continuations_;
               state_ = kWaitingForPacket;
               break;
             }
@@ -168,6 +232,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
               // continuation offset is not where we left off (could be a continuation from a
               // different retransmission). There must have been a link interruption: reset the
               // state machine.
+              ++stats_.num_mismatched_continuations_;
               state_ = kWaitingForPacket;
               break;
             }
@@ -178,7 +243,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
           break;
         }
         uint8_t *current_byte = &reinterpret_cast<uint8_t *>(&incoming_header_)[current_field_read_bytes_];
-        num_bytes_read = byte_stream_.Read(current_byte, 1);
+        num_bytes_read = byte_stream_->Read(current_byte, 1);
         if (num_bytes_read < 1) {
           break;
         }
@@ -186,6 +251,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
         if (*current_byte == kP2PStartToken) {
           // Must be a new packet after a link interruption because priority takeover is
           // not legal mid-header.
+          ++stats_.num_interrupted_packets_;
           state_ = kReadingHeader;
           incoming_header_.start_token = kP2PStartToken;
           current_field_read_bytes_ = 1;
@@ -193,6 +259,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
         }
         if (*current_byte == kP2PSpecialToken) {
           // Malformed packet.
+          ++stats_.num_malformed_headers_;
           state_ = kWaitingForPacket;
         }
         break;
@@ -208,7 +275,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
           break;
         }
         uint8_t *next_content_byte = &packet.content()[current_field_read_bytes_];
-        num_bytes_read = byte_stream_.Read(next_content_byte, 1);
+        num_bytes_read = byte_stream_->Read(next_content_byte, 1);
         if (num_bytes_read < 1) {
           break;
         }
@@ -238,7 +305,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
         // Read next byte and check if it's a special token.
         // No need to check if we reached the content length here, as a content byte matching the start token should always be followed by a special token.
         uint8_t *next_content_byte = &packet.content()[current_field_read_bytes_];
-        num_bytes_read = byte_stream_.Read(next_content_byte, 1);
+        num_bytes_read = byte_stream_->Read(next_content_byte, 1);
         if (num_bytes_read < 1) {
           break;
         }
@@ -276,7 +343,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
           break;
         }
         uint8_t *current_byte = packet.content() + packet.length() + current_field_read_bytes_;
-        num_bytes_read = byte_stream_.Read(current_byte, 1);
+        num_bytes_read = byte_stream_->Read(current_byte, 1);
         if (num_bytes_read < 1) {
           break;
         }
@@ -284,6 +351,7 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
 
         if (*current_byte == kP2PStartToken) {
           // New packet after interrupts, as no priority takeover is allowed mid-footer.
+          ++stats_.num_interrupted_packets_;
           write_offset_before_break_[incoming_header_.priority] = packet.length();
           state_ = kReadingHeader;
           incoming_header_.start_token = kP2PStartToken;
@@ -292,18 +360,20 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
         }
         if (*current_byte == kP2PSpecialToken) {
           // Malformed packet.
+          ++stats_.num_malformed_footers_;
           state_ = kWaitingForPacket;
+          break;
         }
 
         if (current_field_read_bytes_ >= sizeof(P2PFooter)) {
           // Adapt endianness of footer fields.
           packet.checksum() = NetworkToLocal<LocalEndianness>(packet.checksum());
-          if (packet.PrepareToRead()) {
-            if (packet_filter_(packet)) {
-              packet.counted_in_stats() = false;
-              packet.commit_time_ns() = timer_.GetLocalNanoseconds();
-              packet_buffer_.Commit(incoming_header_.priority);
-            }
+          if (!packet.HasValidChecksum()) {
+            ++stats_.num_checksum_errors_;
+          } else if (!packet.PrepareToRead()) {
+            ++stats_.num_malformed_contents_;
+          } else {
+            CommitIncomingPacket(packet);
           }
           state_ = kWaitingForPacket;
         }
@@ -313,7 +383,88 @@ template<int kCapacity, Endianness LocalEndianness> int P2PPacketInputStream<kCa
   return num_bytes_read;
 }
 
+template<int kCapacity, Endianness LocalEndianness>
+void P2PPacketOutputStream<kCapacity, LocalEndianness>::OnTransmissionStart(uint64_t timestamp_ns) {
+  const P2PPriority priority = current_packet_->header()->priority;
+  if (current_packet_->header()->is_continuation) {
+    packet_tracer_(kP2PPacketContinued, *current_packet_, timer_);
+  } else if (!current_packet_->header()->is_init && last_sent_sequence_number_[priority] != -1ULL &&
+             !current_packet_->sequence_number().IsAfter(last_sent_sequence_number_[priority])) {
+    // The same criterion as the retransmission stats.
+    packet_tracer_(kP2PPacketRetransmitted, *current_packet_, timer_);
+  } else {
+    transmission_start_ns_[priority] = timestamp_ns;
+    latency_histograms_.Add(kQueueingDelay, priority, timestamp_ns - current_packet_->commit_time_ns());
+    packet_tracer_(kP2PPacketFirstByteSent, *current_packet_, timer_);
+  }
+}
+
+template<int kCapacity, Endianness LocalEndianness>
+void P2PPacketOutputStream<kCapacity, LocalEndianness>::OnTransmissionEnd(uint64_t timestamp_ns) {
+  const P2PPriority priority = current_packet_->header()->priority;
+  packet_tracer_(kP2PPacketLastByteSent, *current_packet_, timer_);
+  if (!current_packet_->header()->is_init) {
+    // is_init is filtered to avoid confusing all following packets with retransmissions,
+    // as is_init packets have a random sequence number.
+    if (last_sent_sequence_number_[priority] == -1ULL || 
+      current_packet_->sequence_number().IsAfter(last_sent_sequence_number_[priority])) {
+      last_sent_sequence_number_[priority] = current_packet_->sequence_number();
+      // Not a retransmission: update latency stats.
+      const uint64_t packet_delay = timestamp_ns - current_packet_->commit_time_ns();
+      ++stats_.total_packets_[priority];
+      stats_.total_packet_delay_ns_[priority] += packet_delay;
+      stats_.total_packet_delay_per_byte_ns_[priority] += packet_delay / total_packet_bytes_[priority];
+      latency_histograms_.Add(kWireTime, priority, timestamp_ns - transmission_start_ns_[priority]);
+      if (current_packet_->header()->requires_ack) {
+        ++stats_.total_reliable_packets_[priority];
+      }
+    } else {
+      // Update retransmission stats.
+      ++stats_.total_retransmissions_[priority];
+    }
+  }
+
+  if (packet_filter_(*current_packet_)) {
+    packet_buffer_.Consume(current_packet_->header()->priority);
+  }
+}
+
+template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStream<kCapacity, LocalEndianness>::RunDatagram() {
+  current_packet_ = packet_buffer_.OldestValue();
+  if (current_packet_ == NULL) {
+    return 0;
+  }
+  const P2PPriority priority = current_packet_->header()->priority;
+  const bool requires_ack = current_packet_->header()->requires_ack;
+  const uint64_t timestamp_ns = timer_.GetLocalNanoseconds();
+  if (requires_ack && current_packet_->sequence_number() == last_datagram_sequence_number_[priority]) {
+    // Sent already and not ACKed yet. Unlike a byte stream, the transport does not pace the
+    // retransmissions: give the ACK time to arrive. Packets of lower priority wait too, as
+    // they do behind the retransmissions over a byte stream.
+    const uint64_t retransmission_ns = last_datagram_send_ns_[priority] + kP2PDatagramRetransmissionTimeoutNs;
+    if (timestamp_ns < retransmission_ns) {
+      return retransmission_ns - timestamp_ns;
+    }
+  }
+  const int length = sizeof(P2PHeader) + NetworkToLocal<LocalEndianness>(current_packet_->length());
+  if (!datagrams_->Send(current_packet_->header(), length)) {
+    // The transport is full: retry in the next call.
+    return 0;
+  }
+  if (requires_ack) {
+    last_datagram_sequence_number_[priority] = current_packet_->sequence_number();
+    last_datagram_send_ns_[priority] = timestamp_ns;
+  }
+  total_packet_bytes_[priority] = length;
+  OnTransmissionStart(timestamp_ns);
+  OnTransmissionEnd(timestamp_ns);
+  return 0;
+}
+
 template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStream<kCapacity, LocalEndianness>::Run() {
+  if (datagrams_ != NULL) {
+    return RunDatagram();
+  }
   uint64_t time_until_next_event = 0;
   switch (state_) {
     case kGettingNextPacket:
@@ -336,28 +487,33 @@ template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStre
         pending_packet_bytes_ = sizeof(P2PHeader);
 
         state_ = kSendingHeaderBurst;
-        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_.GetBurstMaxLength());
+        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_->GetBurstMaxLength());
         pending_burst_bytes_ = total_burst_bytes_;
         break;
       }
 
     case kSendingHeaderBurst: {
-      const int written_bytes = byte_stream_.Write(
+      const bool is_transmission_start = pending_packet_bytes_ == sizeof(P2PHeader);
+      const int written_bytes = byte_stream_->Write(
         &reinterpret_cast<const uint8_t *>(current_packet_->header())[sizeof(P2PHeader) - pending_packet_bytes_],
         pending_burst_bytes_);
       pending_packet_bytes_ -= written_bytes;
       pending_burst_bytes_ -= written_bytes;
 
       const uint64_t timestamp_ns = timer_.GetLocalNanoseconds();
+      if (is_transmission_start && written_bytes > 0) {
+        OnTransmissionStart(timestamp_ns);
+      }
+
       if (pending_packet_bytes_ <= 0) { 
-        after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_.GetBurstIngestionNanosecondsPerByte();
+        after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_->GetBurstIngestionNanosecondsPerByte();
         state_ = kWaitingForHeaderBurstIngestion;
         break;
       }
 
       if (pending_burst_bytes_ <= 0) {
         // Burst fully sent: calculate when to start the next burst.
-        after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_.GetBurstIngestionNanosecondsPerByte();
+        after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_->GetBurstIngestionNanosecondsPerByte();
         state_ = kWaitingForHeaderBurstIngestion;
         break;
       }
@@ -383,59 +539,36 @@ template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStre
           }
 
           state_ = kSendingBurst;
-          total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_.GetBurstMaxLength());
+          total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_->GetBurstMaxLength());
           pending_burst_bytes_ = total_burst_bytes_;
           break;
         }
 
         state_ = kSendingHeaderBurst;
-        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_.GetBurstMaxLength());
+        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_->GetBurstMaxLength());
         pending_burst_bytes_ = total_burst_bytes_;
       }
 
     case kSendingBurst:
       {
         P2PPriority priority = current_packet_->header()->priority;
-        const int written_bytes = byte_stream_.Write(
+        const int written_bytes = byte_stream_->Write(
           &reinterpret_cast<const uint8_t *>(current_packet_->header())[total_packet_bytes_[priority] - pending_packet_bytes_],
-          std::min(byte_stream_.GetAtomicSendMaxLength(), pending_burst_bytes_));
+          std::min(byte_stream_->GetAtomicSendMaxLength(), pending_burst_bytes_));
         pending_packet_bytes_ -= written_bytes;
         pending_burst_bytes_ -= written_bytes;
 
         const uint64_t timestamp_ns = timer_.GetLocalNanoseconds();
         if (pending_packet_bytes_ <= 0) {
-          if (!current_packet_->header()->is_init) {
-            // is_init is filtered to avoid confusing all following packets with retransmissions,
-            // as is_init packets have a random sequence number.
-            if (last_sent_sequence_number_[priority] == -1ULL || 
-              current_packet_->sequence_number() > last_sent_sequence_number_[priority]) {
-              last_sent_sequence_number_[priority] = current_packet_->sequence_number();
-              // Not a retransmission: update latency stats.
-              const uint64_t packet_delay = timestamp_ns - current_packet_->commit_time_ns();
-              ++stats_.total_packets_[priority];
-              stats_.total_packet_delay_ns_[priority] += packet_delay;
-              stats_.total_packet_delay_per_byte_ns_[priority] += packet_delay / total_packet_bytes_[priority];
-              if (current_packet_->header()->requires_ack) {
-                ++stats_.total_reliable_packets_[priority];
-              }
-            } else {
-              // Update retransmission stats.
-              ++stats_.total_retransmissions_[priority];
-            }
-          }
-
-          if (packet_filter_(*current_packet_)) {
-            packet_buffer_.Consume(current_packet_->header()->priority);
-          }
-
-          after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_.GetBurstIngestionNanosecondsPerByte();
+          OnTransmissionEnd(timestamp_ns);
+          after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_->GetBurstIngestionNanosecondsPerByte();
           state_ = kWaitingForBurstIngestion;
           break;
         }
 
         if (pending_burst_bytes_ <= 0) {
           // Burst fully sent: calculate when to start the next burst.
-          after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_.GetBurstIngestionNanosecondsPerByte();
+          after_burst_wait_end_timestamp_ns_ = timestamp_ns + total_burst_bytes_ * byte_stream_->GetBurstIngestionNanosecondsPerByte();
           state_ = kWaitingForBurstIngestion;
           break;
         }
@@ -448,7 +581,8 @@ template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStre
           // continuation.
           current_packet_->header()->is_continuation = 1;
           current_packet_->length() = LocalToNetwork<LocalEndianness>(pending_packet_bytes_ - sizeof(P2PFooter));
-          after_burst_wait_end_timestamp_ns_ = timestamp_ns + (total_burst_bytes_ - pending_burst_bytes_) * byte_stream_.GetBurstIngestionNanosecondsPerByte();
+          packet_tracer_(kP2PPacketPreempted, *current_packet_, timer_);
+          after_burst_wait_end_timestamp_ns_ = timestamp_ns + (total_burst_bytes_ - pending_burst_bytes_) * byte_stream_->GetBurstIngestionNanosecondsPerByte();
           state_ = kWaitingForPartialBurstIngestionBeforeHigherPriorityPacket;
         }
 
@@ -472,7 +606,7 @@ template<int kCapacity, Endianness LocalEndianness> uint64_t P2PPacketOutputStre
         }
 
         state_ = kSendingBurst;
-        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_.GetBurstMaxLength());
+        total_burst_bytes_ = std::min(pending_packet_bytes_, byte_stream_->GetBurstMaxLength());
         pending_burst_bytes_ = total_burst_bytes_;
 
         break;
@@ -507,6 +641,18 @@ template<int kInputCapacity, int kOutputCapacity, Endianness LocalEndianness>
 P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::P2PPacketStream(P2PByteStreamInterface<LocalEndianness> *byte_stream, TimerInterface *timer, GUIDFactoryInterface &guid_factory)
     : input_(byte_stream, timer), output_(byte_stream, timer), 
       handshake_id_(guid_factory.CreateGUID<kSequenceNumberNumBytes, kP2PLowestToken>()), handshake_done_(false) {
+  Init();
+}
+
+template<int kInputCapacity, int kOutputCapacity, Endianness LocalEndianness>
+P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::P2PPacketStream(P2PDatagramInterface *datagrams, TimerInterface *timer, GUIDFactoryInterface &guid_factory)
+    : input_(datagrams, timer), output_(datagrams, timer),
+      handshake_id_(guid_factory.CreateGUID<kSequenceNumberNumBytes, kP2PLowestToken>()), handshake_done_(false) {
+  Init();
+}
+
+template<int kInputCapacity, int kOutputCapacity, Endianness LocalEndianness>
+void P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::Init() {
   for (int i = 0; i < P2PPriority::kNumLevels; ++i) {
     last_init_sequence_number_[i] = -1ULL;
   }
@@ -604,6 +750,7 @@ bool P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::ShouldCo
       // Reject all packets until handshake. This ensures that any old ACKs or continuation in
       // the other end's serial output byte buffer won't be processed, as they could have a
       // valid sequence number.
+      ++self.input_.stats_.num_packets_before_handshake_;
       return false;
     }
     if (last_rx_packet.header()->is_ack &&
@@ -651,6 +798,8 @@ bool P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::ShouldCo
     // previous ACK.      
     if (retransmitting_packet != NULL && retransmitting_packet->header()->requires_ack &&
         last_rx_packet.sequence_number() == retransmitting_packet->sequence_number()) {
+      self.output_.latency_histograms_.Add(P2PPacketOutputStream<kOutputCapacity, LocalEndianness>::kAckDelay, data_packet_priority, self.output_.timer_.GetLocalNanoseconds() - retransmitting_packet->commit_time_ns());
+      self.output_.packet_tracer_(kP2PPacketAckReceived, *retransmitting_packet, self.output_.timer_);
       self.output_.packet_buffer_.Consume(data_packet_priority);
     }
 
@@ -665,13 +814,15 @@ bool P2PPacketStream<kInputCapacity, kOutputCapacity, LocalEndianness>::ShouldCo
     if (!self.ScheduleACKWithThrottling(last_rx_packet)) {
       // No space for the ACK packet: let the other end retransmit until we can guarantee the
       // ACK is sent.
+      ++self.input_.stats_.num_unacknowledgeable_packets_;
       return false;
     }
 
     const P2PPriority priority = last_rx_packet.header()->priority;
     if (self.last_rx_sequence_number_[priority] != -1ULL &&
-        last_rx_packet.sequence_number() <= self.last_rx_sequence_number_[priority]) {
+        !last_rx_packet.sequence_number().IsAfter(self.last_rx_sequence_number_[priority])) {
       // This packet had been received already: filter it.
+      ++self.input_.stats_.num_duplicate_packets_;
       return false;
     }
     self.last_rx_sequence_number_[priority] = last_rx_packet.sequence_number();
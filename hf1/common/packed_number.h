@@ -3,35 +3,82 @@
 
 #include <stdint.h>
 
+// Weight of the digit at `index`, i.e. base^index. Computed in 64 bits, to check that
+// values fit in 32.
+constexpr uint64_t PackedIntegerPlaceValue(int base, int index) {
+  return index == 0 ? 1 : base * PackedIntegerPlaceValue(base, index - 1);
+}
+
+// Unsigned integer in base kMaxValuePerByte, least significant digit first, so that no byte
+// reaches kMaxValuePerByte. Values wrap around modulo kNumValues.
+//
+// Encoding and decoding use 32-bit arithmetic with compile-time constants, which compilers
+// turn into multiplications: there is no division by a variable nor 64-bit division, which
+// the Teensy does in software.
 template<int kNumBytes, int kMaxValuePerByte> struct PackedInteger {
 #pragma pack(push, 1)
   uint8_t bytes[kNumBytes];
 #pragma pack(pop)
 
-  PackedInteger(uint64_t n) { *this = n; }
+  static constexpr uint64_t kNumValues = PackedIntegerPlaceValue(kMaxValuePerByte, kNumBytes);
+  static_assert(kNumBytes > 0 && kMaxValuePerByte > 1 && kMaxValuePerByte <= 256);
+  static_assert(kNumValues <= (1ULL << 32), "Values must fit in 32 bits.");
+
+  explicit PackedInteger(uint64_t n) { *this = n; }
   PackedInteger() : PackedInteger(0) {}
 
-  operator uint64_t() const {
-    uint64_t n = 0;
-    uint64_t multiplier = 1;
+  uint32_t value() const {
+    uint32_t n = 0;
     for (int i = 0; i < kNumBytes; ++i) {
-      n += bytes[i] * multiplier;
-      multiplier *= kMaxValuePerByte;
+      n += bytes[i] * static_cast<uint32_t>(PackedIntegerPlaceValue(kMaxValuePerByte, i));
     }
     return n;
   }
 
-  PackedInteger &operator=(uint64_t n) {    
+  operator uint64_t() const { return value(); }
+
+  // Values of kNumValues or more wrap around. Keeping them below, e.g. with Next(), takes the
+  // fast path.
+  PackedInteger &operator=(uint64_t n) {
+    uint32_t remainder = n < kNumValues ? static_cast<uint32_t>(n) : static_cast<uint32_t>(n % kNumValues);
     for (int i = 0; i < kNumBytes; ++i) {
-      bytes[i] = n % kMaxValuePerByte;
-      n /= kMaxValuePerByte;
+      const uint32_t quotient = remainder / kMaxValuePerByte;
+      bytes[i] = remainder - quotient * kMaxValuePerByte;
+      remainder = quotient;
     }
     return *this;
   }
 
+  // The encoding is unique, so equal values have equal bytes.
+  bool operator==(const PackedInteger &other) const {
+    for (int i = 0; i < kNumBytes; ++i) {
+      if (bytes[i] != other.bytes[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const PackedInteger &other) const { return !(*this == other); }
+
+  // Serial number arithmetic (RFC 1982): the value follows `other` if it is less than half
+  // the range of values ahead of it, wrapping around. Counters compared this way keep their
+  // order across the wraparound, as long as the values compared are close. `other` must be
+  // lower than kNumValues.
+  bool IsAfter(uint64_t other) const {
+    const uint32_t n = value();
+    const uint32_t m = static_cast<uint32_t>(other);
+    const uint32_t distance = n >= m ? n - m : static_cast<uint32_t>(kNumValues - m + n);
+    return distance != 0 && distance < kNumValues / 2;
+  }
+
+  // The value after `n`, which must be lower than kNumValues.
+  static uint32_t Next(uint64_t n) {
+    return n + 1 == kNumValues ? 0 : static_cast<uint32_t>(n + 1);
+  }
+
   const uint8_t *operator&() const {
     return bytes;
   }
 };
 
-#endif  // PACKED_NUMBER_
\ No newline at end of file
+#endif  // PACKED_NUMBER_
@@ -0,0 +1,230 @@
+#include "primitives_benchmarks.h"
+#include "network.h"
+#include "p2p_packet_stream.h"
+#include "priority_ring_buffer.h"
+#include "profiler.h"
+#include "ring_buffer.h"
+#include <string.h>
+
+// Long enough for a payload made only of tokens to fit once encoded.
+#define kPayloadLength (kP2PMaxContentLength / 2)
+// As the Arduino's P2P input buffers.
+#define kRingBufferCapacity 4
+#define kNumRepetitions 5
+
+// Percentage of the payload bytes that are tokens and must be escaped. Uniformly random
+// bytes have about 1%.
+static const int kTokenPercents[] = { 0, 1, 10, 50, 100 };
+#define kNumTokenDensities (sizeof(kTokenPercents) / sizeof(kTokenPercents[0]))
+
+namespace {
+
+typedef struct {
+  RingBuffer<uint32_t, kRingBufferCapacity> words;
+  PriorityRingBuffer<P2PPacket, kRingBufferCapacity, P2PPriority> packets;
+  // Payloads of every token density, before and after PrepareToSend().
+  P2PPacket decoded[kNumTokenDensities];
+  P2PPacket encoded[kNumTokenDensities];
+  // Packet the kernels work on.
+  P2PPacket packet;
+} BenchState;
+
+// Constructed on first use, so that the firmware does not pay for it unless the benchmarks
+// run.
+BenchState &GetState() {
+  static BenchState state;
+  return state;
+}
+
+void CopyPacket(const P2PPacket &from, P2PPacket *to) {
+  *to->header() = *from.header();
+  memcpy(to->content(), from.content(), from.length());
+}
+
+void SetUpNothing() {}
+
+uint32_t RunCallOverhead(uint32_t call) {
+  return call;
+}
+
+void SetUpRingBuffers() {
+  BenchState &state = GetState();
+  state.words.Clear();
+  state.packets.Clear();
+}
+
+uint32_t RunRingBufferWriteRead(uint32_t call) {
+  BenchState &state = GetState();
+  state.words.Write(call);
+  return state.words.Read();
+}
+
+// Low priority packets are the slowest to find, as OldestValue() looks at the higher
+// priorities first.
+uint32_t RunPriorityRingBufferCommitConsume(uint32_t call) {
+  BenchState &state = GetState();
+  state.packets.NewValue(P2PPriority::kLow).length() = call;
+  state.packets.Commit(P2PPriority::kLow);
+  const uint32_t length = state.packets.OldestValue()->length();
+  state.packets.Consume(P2PPriority::kLow);
+  return length;
+}
+
+template<int kDensityIndex> void SetUpPayloads() {
+  BenchState &state = GetState();
+  P2PPacket &decoded = state.decoded[kDensityIndex];
+  // Deterministic, so that all runs measure the same payloads.
+  uint32_t random = 12345;
+  int num_tokens = 0;
+  for (int i = 0; i < kPayloadLength; ++i) {
+    random = random * 1103515245 + 12345;
+    if (static_cast<int>((random >> 16) % 100) < kTokenPercents[kDensityIndex]) {
+      decoded.content()[i] = (num_tokens++ % 2 == 0) ? kP2PStartToken : kP2PSpecialToken;
+    } else {
+      decoded.content()[i] = (random >> 16) % kP2PLowestToken;
+    }
+  }
+  decoded.length() = kPayloadLength;
+  CopyPacket(decoded, &state.encoded[kDensityIndex]);
+  ASSERT(state.encoded[kDensityIndex].PrepareToSend());
+  CopyPacket(state.encoded[kDensityIndex], &state.packet);
+  ASSERT(state.packet.PrepareToRead() && state.packet.length() == kPayloadLength);
+}
+
+// The packets are encoded and decoded in place, so the kernels include copying them first:
+// see "packet_copy".
+template<int kDensityIndex> uint32_t RunPrepareToSend(uint32_t call) {
+  BenchState &state = GetState();
+  CopyPacket(state.decoded[kDensityIndex], &state.packet);
+  state.packet.PrepareToSend();
+  return state.packet.checksum() + call;
+}
+
+template<int kDensityIndex> uint32_t RunPrepareToRead(uint32_t call) {
+  BenchState &state = GetState();
+  CopyPacket(state.encoded[kDensityIndex], &state.packet);
+  return state.packet.PrepareToRead() + state.packet.length() + call;
+}
+
+uint32_t RunPacketCopy(uint32_t call) {
+  BenchState &state = GetState();
+  CopyPacket(state.decoded[0], &state.packet);
+  return state.packet.content()[kPayloadLength - 1] + call;
+}
+
+void SetUpChecksum() {
+  BenchState &state = GetState();
+  for (int i = 0; i < kP2PMaxContentLength; ++i) {
+    state.packet.content()[i] = i % kP2PLowestToken;
+  }
+  state.packet.length() = kP2PMaxContentLength;
+}
+
+uint32_t RunChecksum(uint32_t call) {
+  BenchState &state = GetState();
+  state.packet.content()[0] = call % kP2PLowestToken;
+  return state.packet.HasValidChecksum();
+}
+
+uint32_t RunPackedIntegerEncode(uint32_t call) {
+  const P2PSequenceNumberType packed(call);
+  uint32_t sum = 0;
+  for (int i = 0; i < kSequenceNumberNumBytes; ++i) {
+    sum += packed.bytes[i];
+  }
+  return sum;
+}
+
+uint32_t RunPackedIntegerDecode(uint32_t call) {
+  P2PSequenceNumberType packed;
+  for (int i = 0; i < kSequenceNumberNumBytes; ++i) {
+    packed.bytes[i] = (call >> (8 * i)) % kP2PLowestToken;
+  }
+  return static_cast<uint64_t>(packed);
+}
+
+// As the duplicate and retransmission checks of the packet streams.
+uint32_t RunPackedIntegerIsAfter(uint32_t call) {
+  const P2PSequenceNumberType packed(call);
+  return packed.IsAfter(P2PSequenceNumberType::Next(call % static_cast<uint32_t>(P2PSequenceNumberType::kNumValues)));
+}
+
+// The Arduino and Linux endpoints are both little endian, so NetworkToLocal() and
+// LocalToNetwork() are no-ops between them: the swapped kernels measure a big endian peer.
+uint32_t RunNetworkToLocalNative(uint32_t call) {
+  return NetworkToLocal<kLittleEndian>(static_cast<uint64_t>(call) << 24);
+}
+
+uint32_t RunNetworkToLocalSwapped16(uint32_t call) {
+  return NetworkToLocal<kBigEndian>(static_cast<uint16_t>(call));
+}
+
+uint32_t RunNetworkToLocalSwapped32(uint32_t call) {
+  return NetworkToLocal<kBigEndian>(call);
+}
+
+uint32_t RunNetworkToLocalSwapped64(uint32_t call) {
+  return NetworkToLocal<kBigEndian>(static_cast<uint64_t>(call) << 24) >> 24;
+}
+
+uint32_t RunLocalToNetworkSwapped64(uint32_t call) {
+  return LocalToNetwork<kBigEndian>(static_cast<uint64_t>(call) << 24) >> 24;
+}
+
+const PrimitivesBenchmark kBenchmarks[] = {
+  { "call_overhead", 0, &SetUpNothing, &RunCallOverhead },
+  { "ring_buffer_write_read", sizeof(uint32_t), &SetUpRingBuffers, &RunRingBufferWriteRead },
+  { "priority_ring_buffer_commit_consume", 0, &SetUpRingBuffers, &RunPriorityRingBufferCommitConsume },
+  { "packet_copy", kPayloadLength, &SetUpPayloads<0>, &RunPacketCopy },
+  { "prepare_to_send/tokens:0%", kPayloadLength, &SetUpPayloads<0>, &RunPrepareToSend<0> },
+  { "prepare_to_send/tokens:1%", kPayloadLength, &SetUpPayloads<1>, &RunPrepareToSend<1> },
+  { "prepare_to_send/tokens:10%", kPayloadLength, &SetUpPayloads<2>, &RunPrepareToSend<2> },
+  { "prepare_to_send/tokens:50%", kPayloadLength, &SetUpPayloads<3>, &RunPrepareToSend<3> },
+  { "prepare_to_send/tokens:100%", kPayloadLength, &SetUpPayloads<4>, &RunPrepareToSend<4> },
+  { "prepare_to_read/tokens:0%", kPayloadLength, &SetUpPayloads<0>, &RunPrepareToRead<0> },
+  { "prepare_to_read/tokens:1%", kPayloadLength, &SetUpPayloads<1>, &RunPrepareToRead<1> },
+  { "prepare_to_read/tokens:10%", kPayloadLength, &SetUpPayloads<2>, &RunPrepareToRead<2> },
+  { "prepare_to_read/tokens:50%", kPayloadLength, &SetUpPayloads<3>, &RunPrepareToRead<3> },
+  { "prepare_to_read/tokens:100%", kPayloadLength, &SetUpPayloads<4>, &RunPrepareToRead<4> },
+  { "checksum", kP2PMaxContentLength, &SetUpChecksum, &RunChecksum },
+  { "packed_integer_encode", 0, &SetUpNothing, &RunPackedIntegerEncode },
+  { "packed_integer_decode", 0, &SetUpNothing, &RunPackedIntegerDecode },
+  { "packed_integer_is_after", 0, &SetUpNothing, &RunPackedIntegerIsAfter },
+  { "network_to_local_native_u64", sizeof(uint64_t), &SetUpNothing, &RunNetworkToLocalNative },
+  { "network_to_local_swapped_u16", sizeof(uint16_t), &SetUpNothing, &RunNetworkToLocalSwapped16 },
+  { "network_to_local_swapped_u32", sizeof(uint32_t), &SetUpNothing, &RunNetworkToLocalSwapped32 },
+  { "network_to_local_swapped_u64", sizeof(uint64_t), &SetUpNothing, &RunNetworkToLocalSwapped64 },
+  { "local_to_network_swapped_u64", sizeof(uint64_t), &SetUpNothing, &RunLocalToNetworkSwapped64 },
+};
+
+static_assert(kNumTokenDensities == 5, "Update the prepare_to_send and prepare_to_read kernels.");
+
+}  // namespace
+
+int GetNumPrimitivesBenchmarks() {
+  return sizeof(kBenchmarks) / sizeof(kBenchmarks[0]);
+}
+
+const PrimitivesBenchmark &GetPrimitivesBenchmark(int index) {
+  ASSERT(index >= 0 && index < GetNumPrimitivesBenchmarks());
+  return kBenchmarks[index];
+}
+
+float MeasurePrimitivesBenchmarkCycles(int index, int num_calls) {
+  const PrimitivesBenchmark &benchmark = GetPrimitivesBenchmark(index);
+  benchmark.set_up();
+  // Read through a volatile, so that the calls are not optimized away.
+  volatile uint32_t sink = 0;
+  float min_cycles_per_call = 0;
+  for (int repetition = 0; repetition < kNumRepetitions; ++repetition) {
+    const ProfilerCyclesType start_cycles = GetProfilerCycles();
+    for (int call = 0; call < num_calls; ++call) {
+      sink = sink + benchmark.run(call);
+    }
+    const float cycles_per_call = static_cast<float>(GetProfilerCycles() - start_cycles) / num_calls;
+    if (repetition == 0 || cycles_per_call < min_cycles_per_call) {
+      min_cycles_per_call = cycles_per_call;
+    }
+  }
+  return min_cycles_per_call;
+}
@@ -0,0 +1,36 @@
+#ifndef PRIMITIVES_BENCHMARKS_
+#define PRIMITIVES_BENCHMARKS_
+
+// Microbenchmarks of the inner loops of the P2P link: ring buffers, packet encoding and
+// decoding across token densities, checksums, packed integers and byte order conversions.
+//
+// The same kernels run on the host, under Google Benchmark (see
+// common/test/primitives_bench.cpp), and on the Teensy, where arduino.ino prints their
+// cycle counts to the debug serial port at startup when built with
+// kRunPrimitivesBenchmarks set to 1.
+//
+// Kernels are called through a function pointer in both modes, so every measurement includes
+// the cost of a call: the "call_overhead" kernel measures it alone.
+
+#include <stdint.h>
+
+typedef struct {
+  const char *name;
+  // Bytes processed per call, to report throughputs, or 0.
+  int bytes_per_call;
+  // Prepares the data the kernel works on. Called before measuring.
+  void (*set_up)();
+  // Runs the kernel once. `call` is different in every call, and the result depends on the
+  // work done, so that the compiler can't skip it.
+  uint32_t (*run)(uint32_t call);
+} PrimitivesBenchmark;
+
+int GetNumPrimitivesBenchmarks();
+const PrimitivesBenchmark &GetPrimitivesBenchmark(int index);
+
+// Returns the mean cycles per call of the benchmark over `num_calls` calls, as measured with
+// the profiler's cycle counter. The lowest mean of a few repetitions is returned, to discard
+// those disturbed by interrupts. InitProfiler() must be called before.
+float MeasurePrimitivesBenchmarkCycles(int index, int num_calls);
+
+#endif  // PRIMITIVES_BENCHMARKS_
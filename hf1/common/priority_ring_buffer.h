@@ -70,6 +70,21 @@ public:
     }
   }
 
+  // Occupancy stats of the buffer of a priority level (see RingBufferStats).
+  RingBufferStats stats(PriorityType priority) const {
+    return buffer_[priority].stats();
+  }
+
+  void ClearStats(PriorityType priority) {
+    buffer_[priority].ClearStats();
+  }
+
+  void ClearStats() {
+    for (int i = 0; i < PriorityType::kNumLevels; ++i) {
+      buffer_[i].ClearStats();
+    }
+  }
+
 private:
   RingBuffer<ValueType, kCapacity> buffer_[PriorityType::kNumLevels];
 };
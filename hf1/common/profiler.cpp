@@ -0,0 +1,92 @@
+#include "profiler.h"
+#include "logger_interface.h"
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <mutex>
+#include <time.h>
+#endif
+
+// Time during which the TSC is compared to the monotonic clock to calibrate it.
+#define kTSCCalibrationNs 20'000'000ULL
+
+static ProfilerSection sections[kMaxProfilerSections];
+static int num_sections = 0;
+static uint32_t cycles_per_second = 0;
+
+#ifndef ARDUINO
+// Sections of different threads may be registered at the same time.
+static std::mutex registration_mutex;
+
+static uint64_t GetMonotonicNanoseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ULL + now.tv_nsec;
+}
+#endif
+
+void InitProfiler() {
+#if defined(ARDUINO)
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+  cycles_per_second = F_CPU;
+#elif defined(kProfilerUsesTSC)
+  const uint64_t start_ns = GetMonotonicNanoseconds();
+  const uint64_t start_cycles = GetProfilerCycles();
+  uint64_t now_ns;
+  do {
+    now_ns = GetMonotonicNanoseconds();
+  } while (now_ns - start_ns < kTSCCalibrationNs);
+  const uint64_t elapsed_cycles = GetProfilerCycles() - start_cycles;
+  cycles_per_second = static_cast<uint32_t>(elapsed_cycles * 1'000'000'000ULL / (now_ns - start_ns));
+#else
+  cycles_per_second = 1'000'000'000;
+#endif
+}
+
+uint32_t GetProfilerCyclesPerSecond() {
+  ASSERTM(cycles_per_second != 0, "InitProfiler() not called.");
+  return cycles_per_second;
+}
+
+int RegisterProfilerSection(const char *name) {
+#ifndef ARDUINO
+  std::lock_guard<std::mutex> guard(registration_mutex);
+#endif
+  ASSERTM(num_sections < kMaxProfilerSections, "Too many profiler sections.");
+  const int index = num_sections;
+  sections[index].name = ASSERT_NOT_NULL(name);
+  ClearProfilerSection(index);
+  // Publish the section once it is initialized.
+  num_sections = index + 1;
+  return index;
+}
+
+int GetNumProfilerSections() {
+  return num_sections;
+}
+
+const ProfilerSection &GetProfilerSection(int index) {
+  ASSERT(index >= 0 && index < num_sections);
+  return sections[index];
+}
+
+void ClearProfilerSection(int index) {
+  ProfilerSection &section = sections[index];
+  section.count = 0;
+  section.min_cycles = static_cast<ProfilerCyclesType>(~0ULL);
+  section.max_cycles = 0;
+  section.total_cycles = 0;
+}
+
+void RecordProfilerSection(int index, ProfilerCyclesType cycles) {
+  ProfilerSection &section = sections[index];
+  ++section.count;
+  section.total_cycles += cycles;
+  if (cycles < section.min_cycles) {
+    section.min_cycles = cycles;
+  }
+  if (cycles > section.max_cycles) {
+    section.max_cycles = cycles;
+  }
+}
@@ -0,0 +1,105 @@
+#ifndef PROFILER_
+#define PROFILER_
+
+// Scoped section profiler for hot code paths.
+//
+// Usage:
+//   void KalmanUpdate() {
+//     PROFILE_SCOPE("kalman_update");
+//     ...
+//   }
+//
+// Every section aggregates the count, minimum, maximum and total duration of its scopes, in
+// CPU cycles. The section is registered in a fixed table the first time its scope runs;
+// after that, a scope costs two cycle counter reads and a few additions, without any
+// allocation or formatting.
+//
+// The cycle counter is the DWT CYCCNT on the Teensy, the TSC on x86 Linux, and
+// clock_gettime(CLOCK_MONOTONIC) elsewhere.
+//
+// Sections are not synchronized: a section must only be used from a single thread.
+
+#include <stdint.h>
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define kProfilerUsesTSC 1
+#elif !defined(ARDUINO)
+#include <time.h>
+#endif
+
+// Set to 0 to compile out all PROFILE_SCOPEs.
+#ifndef kEnableProfiler
+#define kEnableProfiler 1
+#endif
+
+#define kMaxProfilerSections 32
+
+#ifdef ARDUINO
+// 32 bits suffice for durations; the counter wraps every 44 s at 96 MHz.
+typedef uint32_t ProfilerCyclesType;
+#else
+typedef uint64_t ProfilerCyclesType;
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t count;
+  ProfilerCyclesType min_cycles;
+  ProfilerCyclesType max_cycles;
+  uint64_t total_cycles;
+} ProfilerSection;
+
+// Enables the cycle counter and calibrates it, if needed. Must be called before profiling.
+void InitProfiler();
+
+// Frequency of the cycle counter.
+uint32_t GetProfilerCyclesPerSecond();
+
+#ifdef ARDUINO
+// Core debug and DWT registers of the Cortex-M4; see ARM DDI 0403 C1.6 and C1.8.
+#define kProfilerDWTCycleCounter (*reinterpret_cast<volatile uint32_t *>(0xE0001004))
+#endif
+
+inline ProfilerCyclesType GetProfilerCycles() {
+#if defined(ARDUINO)
+  return kProfilerDWTCycleCounter;
+#elif defined(kProfilerUsesTSC)
+  return __rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ULL + now.tv_nsec;
+#endif
+}
+
+// Returns the index of a new section with the given name, which must be a string literal
+// or otherwise outlive the profiler. Fails if the table is full.
+int RegisterProfilerSection(const char *name);
+
+int GetNumProfilerSections();
+const ProfilerSection &GetProfilerSection(int index);
+void ClearProfilerSection(int index);
+void RecordProfilerSection(int index, ProfilerCyclesType cycles);
+
+class ProfilerScope {
+public:
+  ProfilerScope(int section_index) : section_index_(section_index), start_cycles_(GetProfilerCycles()) {}
+  ~ProfilerScope() { RecordProfilerSection(section_index_, GetProfilerCycles() - start_cycles_); }
+
+private:
+  const int section_index_;
+  const ProfilerCyclesType start_cycles_;
+};
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#if kEnableProfiler
+#define PROFILE_SCOPE(name) \
+  static const int PROFILER_CONCAT(profiler_section_, __LINE__) = RegisterProfilerSection(name); \
+  ProfilerScope PROFILER_CONCAT(profiler_scope_, __LINE__)(PROFILER_CONCAT(profiler_section_, __LINE__))
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+#endif  // PROFILER_
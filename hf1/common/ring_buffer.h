@@ -4,6 +4,31 @@
 #include <stddef.h>
 #include "utils.h"
 #include "logger_interface.h"
+#include "profiler.h"
+
+// Set to 0 to compile out the occupancy stats of the ring buffers.
+#ifndef kEnableRingBufferStats
+#define kEnableRingBufferStats 1
+#endif
+
+// Occupancy stats of a RingBuffer since they were last cleared, to size the buffer from
+// measurements. Time is measured with the profiler's cycle counter (see GetProfilerCycles()).
+// On the Teensy, the counter wraps every 44 s, so periods longer than that without any
+// change in size are undercounted.
+typedef struct {
+  // Largest Size() reached.
+  int high_water_mark;
+  // Commits that overwrote the oldest value, because the buffer was full.
+  uint32_t num_overwrites;
+  // Integral of Size() over time.
+  uint64_t occupancy_cycles;
+  uint64_t elapsed_cycles;
+} RingBufferStats;
+
+// Returns the time-weighted average of Size() over the stats' period.
+inline float GetRingBufferMeanOccupancy(const RingBufferStats &stats) {
+  return stats.elapsed_cycles == 0 ? 0 : static_cast<float>(stats.occupancy_cycles) / stats.elapsed_cycles;
+}
 
 // A zero-copy ring buffer.
 // Values are read and written in place.
@@ -13,7 +38,10 @@ template<typename ValueType, int kCapacity> class RingBuffer {
   public:
     static_assert(kCapacity > 1);
 
-    RingBuffer() { Clear(); }
+    RingBuffer() : size_(0) { 
+      ClearStats();
+      Clear(); 
+    }
 
     inline int Capacity() const {
       return kCapacity;
@@ -37,6 +65,7 @@ template<typename ValueType, int kCapacity> class RingBuffer {
     // Empties the buffer.
     // Invalidates pointers obtained with OldestValue() and NewValue().
     void Clear() {
+      AccumulateOccupancy();
       read_index_ = 0;
       write_index_ = 0;
       size_ = 0;
@@ -69,6 +98,7 @@ template<typename ValueType, int kCapacity> class RingBuffer {
       for (int k = 0, j = (read_index_ + i) % kCapacity; k < i; ++k, j = IndexMod(j - 1, kCapacity)) {
         indices_[j] = indices_[IndexMod(j - 1, kCapacity)];
       }
+      AccumulateOccupancy();
       IncReadIndex();
       --size_;
       return true;
@@ -83,9 +113,17 @@ template<typename ValueType, int kCapacity> class RingBuffer {
 
     // Makes the the newest value visible to readers.
     void Commit() {
+      AccumulateOccupancy();
       IncWriteIndex();
       if (size_ < kCapacity - 1) {
         ++size_;
+#if kEnableRingBufferStats
+        if (size_ > stats_.high_water_mark) {
+          stats_.high_water_mark = size_;
+        }
+      } else {
+        ++stats_.num_overwrites;
+#endif
       }
       if (write_index_ == read_index_) {
         // Claim oldest unread slot for writing
@@ -106,6 +144,26 @@ template<typename ValueType, int kCapacity> class RingBuffer {
       return value;
     }
 
+    // Returns the occupancy stats, up to now. All zeros if kEnableRingBufferStats is 0.
+    RingBufferStats stats() const {
+      RingBufferStats stats = stats_;
+#if kEnableRingBufferStats
+      const ProfilerCyclesType elapsed_cycles = GetProfilerCycles() - stats_update_cycles_;
+      stats.occupancy_cycles += static_cast<uint64_t>(elapsed_cycles) * size_;
+      stats.elapsed_cycles += elapsed_cycles;
+#endif
+      return stats;
+    }
+
+    // Restarts the stats from the current size.
+    void ClearStats() {
+      stats_ = RingBufferStats{};
+#if kEnableRingBufferStats
+      stats_.high_water_mark = size_;
+      stats_update_cycles_ = GetProfilerCycles();
+#endif
+    }
+
   protected:
     inline void IncReadIndex() {
       read_index_ = (read_index_ + 1) % kCapacity;
@@ -116,11 +174,27 @@ template<typename ValueType, int kCapacity> class RingBuffer {
     }
 
   private:
+    // Adds the occupancy since the last change in size to the stats. Must be called before
+    // every change.
+    inline void AccumulateOccupancy() {
+#if kEnableRingBufferStats
+      const ProfilerCyclesType now_cycles = GetProfilerCycles();
+      const ProfilerCyclesType elapsed_cycles = now_cycles - stats_update_cycles_;
+      stats_.occupancy_cycles += static_cast<uint64_t>(elapsed_cycles) * size_;
+      stats_.elapsed_cycles += elapsed_cycles;
+      stats_update_cycles_ = now_cycles;
+#endif
+    }
+
     ValueType values_[kCapacity];
     int indices_[kCapacity];
     int read_index_;
     int write_index_;
     volatile int size_;
+    RingBufferStats stats_;
+#if kEnableRingBufferStats
+    ProfilerCyclesType stats_update_cycles_;
+#endif
 };
 
 #endif  // RING_BUFFER__
\ No newline at end of file
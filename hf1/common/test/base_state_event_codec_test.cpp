@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "base_state_event_codec.h"
+#include "base_state_event_log.h"
+
+static BaseStateEventRecord WheelTick(uint64_t timer_ticks) {
+  BaseStateEventRecord record = {};
+  record.type = kBaseStateEventLeftWheelTick;
+  record.timer_ticks = timer_ticks;
+  return record;
+}
+
+static BaseStateEventRecord IMUReading(uint64_t timer_ticks, float yaw) {
+  BaseStateEventRecord record = {};
+  record.type = kBaseStateEventIMUReading;
+  record.timer_ticks = timer_ticks;
+  record.position_acceleration[0] = 0.25f;
+  record.position_acceleration[1] = -1.5f;
+  record.position_acceleration[2] = 9.81f;
+  record.attitude[2] = yaw;
+  return record;
+}
+
+TEST(BaseStateEventCodecTest, EmptyBatchHasNoEvents) {
+  P2PRecordBaseStateEventsProgress batch;
+  BaseStateEventBatchEncoder encoder(&batch);
+
+  BaseStateEventBatchDecoder decoder(&batch, encoder.payload_length());
+  BaseStateEventRecord record;
+  EXPECT_EQ(decoder.status(), kSuccess);
+  EXPECT_EQ(decoder.Next(&record), kDoesNotExistError);
+}
+
+TEST(BaseStateEventCodecTest, DecodesEncodedEvents) {
+  BaseStateEventRecord records[4] = {
+    WheelTick(1'000'000'000ULL),
+    IMUReading(1'000'000'100ULL, 1.25f),
+    // Events may be slightly out of order.
+    WheelTick(1'000'000'050ULL),
+    WheelTick(1'000'000'050ULL),
+  };
+  records[2].type = kBaseStateEventRightWheelDirection;
+  records[2].is_forward = true;
+  P2PRecordBaseStateEventsProgress batch;
+  BaseStateEventBatchEncoder encoder(&batch);
+  for (const auto &record : records) {
+    ASSERT_TRUE(encoder.Append(record));
+  }
+  encoder.num_dropped_events(300);
+
+  BaseStateEventBatchDecoder decoder(&batch, encoder.payload_length());
+  EXPECT_EQ(decoder.first_timer_ticks(), 1'000'000'000ULL);
+  EXPECT_EQ(decoder.num_events(), 4);
+  EXPECT_EQ(decoder.num_dropped_events(), 255);
+  for (const auto &expected : records) {
+    BaseStateEventRecord record;
+    ASSERT_EQ(decoder.Next(&record), kSuccess);
+    EXPECT_EQ(record.type, expected.type);
+    EXPECT_EQ(record.timer_ticks, expected.timer_ticks);
+    EXPECT_EQ(record.is_forward, expected.is_forward);
+    EXPECT_EQ(memcmp(record.position_acceleration, expected.position_acceleration, sizeof(expected.position_acceleration)), 0);
+    EXPECT_EQ(memcmp(record.attitude, expected.attitude, sizeof(expected.attitude)), 0);
+  }
+  BaseStateEventRecord record;
+  EXPECT_EQ(decoder.Next(&record), kDoesNotExistError);
+}
+
+TEST(BaseStateEventCodecTest, WheelTicksAreCompact) {
+  P2PRecordBaseStateEventsProgress batch;
+  BaseStateEventBatchEncoder encoder(&batch);
+  const int empty_length = encoder.payload_length();
+  ASSERT_TRUE(encoder.Append(WheelTick(1000)));
+  ASSERT_TRUE(encoder.Append(WheelTick(9000)));
+
+  EXPECT_EQ(encoder.payload_length() - empty_length, 2 + 3);
+}
+
+TEST(BaseStateEventCodecTest, AppendFailsWhenBatchIsFull) {
+  P2PRecordBaseStateEventsProgress batch;
+  BaseStateEventBatchEncoder encoder(&batch);
+  int num_appended = 0;
+  while (encoder.Append(IMUReading(num_appended * 1000, 0.0f))) {
+    ++num_appended;
+  }
+  const int full_length = encoder.payload_length();
+
+  EXPECT_GT(num_appended, 0);
+  EXPECT_EQ(encoder.num_events(), num_appended);
+  EXPECT_LE(full_length, static_cast<int>(sizeof(batch)));
+  // A rejected event leaves the batch intact.
+  BaseStateEventBatchDecoder decoder(&batch, full_length);
+  BaseStateEventRecord record;
+  for (int i = 0; i < num_appended; ++i) {
+    ASSERT_EQ(decoder.Next(&record), kSuccess);
+  }
+  EXPECT_EQ(decoder.Next(&record), kDoesNotExistError);
+}
+
+TEST(BaseStateEventCodecTest, TruncatedBatchIsMalformed) {
+  P2PRecordBaseStateEventsProgress batch;
+  BaseStateEventBatchEncoder encoder(&batch);
+  ASSERT_TRUE(encoder.Append(IMUReading(1000, 0.5f)));
+
+  BaseStateEventBatchDecoder decoder(&batch, encoder.payload_length() - 1);
+  BaseStateEventRecord record;
+  EXPECT_EQ(decoder.Next(&record), kMalformedError);
+
+  BaseStateEventBatchDecoder short_decoder(&batch, 3);
+  EXPECT_EQ(short_decoder.status(), kMalformedError);
+}
+
+TEST(BaseStateEventLogTest, ReadsWrittenBatches) {
+  char filename[] = "/tmp/base_state_event_log_testXXXXXX";
+  const int fd = mkstemp(filename);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  P2PRecordBaseStateEventsProgress batches[2];
+  int payload_lengths[2];
+  for (int i = 0; i < 2; ++i) {
+    BaseStateEventBatchEncoder encoder(&batches[i]);
+    ASSERT_TRUE(encoder.Append(WheelTick(1000 * (i + 1))));
+    payload_lengths[i] = encoder.payload_length();
+  }
+  BaseStateEventLogWriter writer;
+  ASSERT_EQ(writer.Open(filename), kSuccess);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(writer.Write(batches[i], payload_lengths[i]), kSuccess);
+  }
+  writer.Close();
+
+  BaseStateEventLogReader reader;
+  ASSERT_EQ(reader.Open(filename), kSuccess);
+  for (int i = 0; i < 2; ++i) {
+    P2PRecordBaseStateEventsProgress batch;
+    int payload_length;
+    ASSERT_EQ(reader.Read(&batch, &payload_length), kSuccess);
+    ASSERT_EQ(payload_length, payload_lengths[i]);
+    EXPECT_EQ(memcmp(&batch, &batches[i], payload_length), 0);
+  }
+  P2PRecordBaseStateEventsProgress batch;
+  int payload_length;
+  EXPECT_EQ(reader.Read(&batch, &payload_length), kDoesNotExistError);
+  remove(filename);
+}
+
+TEST(BaseStateEventLogTest, RejectsOtherFiles) {
+  BaseStateEventLogReader reader;
+  EXPECT_EQ(reader.Open("/nonexistent/base_state_events.log"), kDoesNotExistError);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "deferred_logger.h"
+#include <string>
+#include <vector>
+
+class FakeTimer : public TimerInterface {
+public:
+  uint64_t GetLocalNanoseconds() const override { return now_ns; }
+  uint64_t now_ns = 0;
+};
+
+class CapturingLogger : public LoggerInterface {
+public:
+  void Info(const char *file_name, int line, const char *msg) override { messages.push_back(std::string("I ") + msg); }
+  void Warning(const char *file_name, int line, const char *msg) override { messages.push_back(std::string("W ") + msg); }
+  void Error(const char *file_name, int line, const char *msg) override { messages.push_back(std::string("E ") + msg); }
+  void Fatal(const char *expr, const char *file_name, int line, const char *msg) override { messages.push_back(std::string("F ") + msg); }
+  std::vector<std::string> messages;
+};
+
+static std::string Format(int format_id, const LogArgs &args) {
+  char buffer[kMaxFormattedLogMessageLength];
+  FormatLogMessage(format_id, args, buffer, sizeof(buffer));
+  return buffer;
+}
+
+TEST(LogFormatsTest, FormatsIntegersAndFloats) {
+  EXPECT_EQ(Format(kLogFormatCreateBaseTrajectory, MakeLogArgs(3, -4)), "create_base_trajectory(id=3, num_waypoints=-4)");
+  EXPECT_EQ(Format(kLogFormatSetHeadPose, MakeLogArgs(0.5f, -1.25)), "set_head_pose(pitch=0.500000, roll=-1.250000)");
+}
+
+TEST(LogFormatsTest, Formats64BitIntegers) {
+  EXPECT_EQ(Format(kLogFormatGlobalTimerOffset, MakeLogArgs(uint64_t{12345678901234ULL})), "Global timer +12345678901234 ns");
+}
+
+TEST(LogFormatsTest, MissingArgumentsAreMarked) {
+  EXPECT_EQ(Format(kLogFormatCreateBaseTrajectory, MakeLogArgs(3)), "create_base_trajectory(id=3, num_waypoints=?)");
+}
+
+TEST(LogFormatsTest, TruncatesToBuffer) {
+  char buffer[10];
+  EXPECT_EQ(FormatLogMessage(kLogFormatMonitorBaseState, MakeLogArgs(1), buffer, sizeof(buffer)), 9);
+  EXPECT_STREQ(buffer, "monitor_b");
+}
+
+TEST(DeferredLogRingTest, RoundTripsRecords) {
+  DeferredLogRing ring;
+  const LogArgs args = MakeLogArgs(7, 2);
+  ASSERT_TRUE(ring.Write(kLogWarning, kLogFormatCreateHeadTrajectory, 42, args.words, 8));
+  EXPECT_EQ(ring.OldestRecordLength(), kDeferredLogRecordHeaderLength + 8);
+
+  uint8_t data[kMaxDeferredLogRecordLength];
+  const int length = ring.Read(data, sizeof(data));
+  ASSERT_EQ(length, kDeferredLogRecordHeaderLength + 8);
+  EXPECT_TRUE(ring.empty());
+
+  DeferredLogRecord record;
+  ASSERT_EQ(DecodeDeferredLogRecord(data, length, &record), length);
+  EXPECT_EQ(record.level, kLogWarning);
+  EXPECT_EQ(record.format_id, kLogFormatCreateHeadTrajectory);
+  EXPECT_EQ(record.timestamp_ns, 42);
+  ASSERT_EQ(record.args.num_words, 2);
+  EXPECT_EQ(record.args.words[0], 7);
+  EXPECT_EQ(record.args.words[1], 2);
+}
+
+TEST(DeferredLogRingTest, WrapsAroundAndCountsDrops) {
+  DeferredLogRing ring;
+  const char text[] = "0123456789abcdef0123456789abcdef";
+  const int record_length = kDeferredLogRecordHeaderLength + 32;
+  const int capacity_in_records = kDeferredLogCapacity / record_length;
+  for (int i = 0; i < capacity_in_records; ++i) {
+    ASSERT_TRUE(ring.Write(kLogInfo, kLogFormatText, i, text, 32));
+  }
+  EXPECT_FALSE(ring.Write(kLogInfo, kLogFormatText, 0, text, 32));
+  EXPECT_EQ(ring.TakeNumDroppedRecords(), 1);
+  EXPECT_EQ(ring.TakeNumDroppedRecords(), 0);
+
+  // Records written after some are read straddle the end of the buffer.
+  uint8_t data[kMaxDeferredLogRecordLength];
+  for (int round = 0; round < 3 * capacity_in_records; ++round) {
+    const int length = ring.Read(data, sizeof(data));
+    ASSERT_EQ(length, record_length);
+    DeferredLogRecord record;
+    ASSERT_EQ(DecodeDeferredLogRecord(data, length, &record), length);
+    EXPECT_STREQ(record.text, text);
+    ASSERT_TRUE(ring.Write(kLogInfo, kLogFormatText, round, text, 32));
+  }
+}
+
+TEST(DeferredLogRingTest, KeepsRecordsLongerThanTheReadBuffer) {
+  DeferredLogRing ring;
+  ASSERT_TRUE(ring.Write(kLogInfo, kLogFormatText, 0, "hello", 5));
+  uint8_t data[kDeferredLogRecordHeaderLength + 4];
+  EXPECT_EQ(ring.Read(data, sizeof(data)), 0);
+  EXPECT_FALSE(ring.empty());
+}
+
+TEST(DeferredLoggerTest, DrainsFormattedAndTextMessages) {
+  FakeTimer timer;
+  CapturingLogger base_logger;
+  DeferredLogger logger(&timer, &base_logger);
+
+  logger.Formatted(kLogInfo, __FILE__, __LINE__, kLogFormatMonitorBaseState, MakeLogArgs(10));
+  logger.Error(__FILE__, __LINE__, "Something failed.");
+  EXPECT_TRUE(base_logger.messages.empty());
+
+  EXPECT_TRUE(logger.DrainToBaseLogger(/*max_records=*/1));
+  EXPECT_FALSE(logger.DrainToBaseLogger(/*max_records=*/1));
+  ASSERT_EQ(base_logger.messages.size(), 2);
+  EXPECT_EQ(base_logger.messages[0], "I monitor_base_state(max_updates=10)");
+  EXPECT_EQ(base_logger.messages[1], "E Something failed.");
+}
+
+TEST(DeferredLoggerTest, TruncatesLongText) {
+  FakeTimer timer;
+  CapturingLogger base_logger;
+  DeferredLogger logger(&timer, &base_logger);
+
+  const std::string long_text(2 * kMaxDeferredLogTextLength, 'x');
+  logger.Info(__FILE__, __LINE__, long_text.c_str());
+  logger.DrainToBaseLogger(/*max_records=*/1);
+  ASSERT_EQ(base_logger.messages.size(), 1);
+  EXPECT_EQ(base_logger.messages[0], "I " + long_text.substr(0, kMaxDeferredLogTextLength));
+}
+
+TEST(DeferredLoggerTest, ReportsDroppedMessages) {
+  FakeTimer timer;
+  CapturingLogger base_logger;
+  DeferredLogger logger(&timer, &base_logger);
+
+  const int num_messages = kDeferredLogCapacity / kDeferredLogRecordHeaderLength + 5;
+  for (int i = 0; i < num_messages; ++i) {
+    logger.Formatted(kLogInfo, __FILE__, __LINE__, kLogFormatSetBaseStateFilter, LogArgs{});
+  }
+  logger.DrainToBaseLogger(/*max_records=*/0);
+  ASSERT_EQ(base_logger.messages.size(), 1);
+  EXPECT_EQ(base_logger.messages[0], "W " + std::to_string(num_messages - kDeferredLogCapacity / kDeferredLogRecordHeaderLength) + " log messages dropped.");
+}
+
+TEST(DeferredLoggerTest, FatalFlushesPendingMessages) {
+  FakeTimer timer;
+  CapturingLogger base_logger;
+  DeferredLogger logger(&timer, &base_logger);
+
+  logger.Warning(__FILE__, __LINE__, "Before.");
+  logger.Fatal("false", __FILE__, __LINE__, "Boom.");
+  ASSERT_EQ(base_logger.messages.size(), 2);
+  EXPECT_EQ(base_logger.messages[0], "W Before.");
+  EXPECT_EQ(base_logger.messages[1], "F Boom.");
+}
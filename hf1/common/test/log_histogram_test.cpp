@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "log_histogram.h"
+
+typedef LogHistogram<8, 4> TestHistogram;
+
+TEST(LogHistogramTest, BucketsGrowExponentially) {
+  EXPECT_EQ(TestHistogram::BucketForValue(0), 0);
+  EXPECT_EQ(TestHistogram::BucketForValue(15), 0);
+  EXPECT_EQ(TestHistogram::BucketForValue(16), 1);
+  EXPECT_EQ(TestHistogram::BucketForValue(31), 1);
+  EXPECT_EQ(TestHistogram::BucketForValue(32), 2);
+  EXPECT_EQ(TestHistogram::BucketForValue(1023), 6);
+  EXPECT_EQ(TestHistogram::BucketForValue(1024), 7);
+  // The last bucket has no upper bound.
+  EXPECT_EQ(TestHistogram::BucketForValue(~0ULL), 7);
+
+  for (int i = 0; i < TestHistogram::num_buckets(); ++i) {
+    EXPECT_EQ(TestHistogram::BucketForValue(TestHistogram::BucketLowerBound(i)), i);
+    if (i < TestHistogram::num_buckets() - 1) {
+      EXPECT_EQ(TestHistogram::BucketForValue(TestHistogram::BucketUpperBound(i) - 1), i);
+    }
+  }
+}
+
+TEST(LogHistogramTest, AddsAndClears) {
+  TestHistogram histogram;
+  histogram.Add(3);
+  histogram.Add(20);
+  histogram.Add(25);
+  histogram.Add(5000);
+
+  EXPECT_EQ(histogram.count(0), 1);
+  EXPECT_EQ(histogram.count(1), 2);
+  EXPECT_EQ(histogram.count(7), 1);
+  EXPECT_EQ(histogram.total_count(), 4);
+  EXPECT_EQ(histogram.max_value(), 5000);
+
+  histogram.Clear();
+  EXPECT_EQ(histogram.total_count(), 0);
+  EXPECT_EQ(histogram.max_value(), 0);
+  EXPECT_EQ(histogram.count(1), 0);
+}
+
+TEST(LogHistogramTest, PercentilesAreBucketUpperBounds) {
+  TestHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(0.5f), 0);
+  for (int i = 0; i < 98; ++i) {
+    histogram.Add(20);
+  }
+  histogram.Add(100);
+  histogram.Add(700);
+
+  EXPECT_EQ(histogram.Percentile(0.5f), 32);
+  EXPECT_EQ(histogram.Percentile(0.99f), 128);
+  // Never above the maximum.
+  EXPECT_EQ(histogram.Percentile(1.0f), 700);
+}
+
+TEST(LogHistogramTest, RebuildsFromCounts) {
+  TestHistogram histogram;
+  histogram.Add(1);
+  histogram.Add(40);
+  histogram.Add(40);
+
+  const TestHistogram copy = TestHistogram::FromCounts(histogram.counts(), histogram.max_value());
+
+  EXPECT_EQ(copy.total_count(), 3);
+  EXPECT_EQ(copy.count(2), 2);
+  EXPECT_EQ(copy.Percentile(0.5f), histogram.Percentile(0.5f));
+}
+
+typedef LogLinearHistogram<10, 4, 1, uint8_t> TestLogLinearHistogram;
+
+TEST(LogLinearHistogramTest, SplitsOctavesLinearly) {
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(15), 0);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(16), 1);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(23), 1);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(24), 2);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(32), 3);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(48), 4);
+  EXPECT_EQ(TestLogLinearHistogram::BucketForValue(~0ULL), 9);
+
+  for (int i = 0; i < TestLogLinearHistogram::num_buckets(); ++i) {
+    EXPECT_EQ(TestLogLinearHistogram::BucketForValue(TestLogLinearHistogram::BucketLowerBound(i)), i);
+    if (i < TestLogLinearHistogram::num_buckets() - 1) {
+      EXPECT_EQ(TestLogLinearHistogram::BucketForValue(TestLogLinearHistogram::BucketUpperBound(i) - 1), i);
+    }
+  }
+}
+
+TEST(LogLinearHistogramTest, PercentilesAreBucketUpperBounds) {
+  TestLogLinearHistogram histogram;
+  for (int i = 0; i < 98; ++i) {
+    histogram.Add(20);
+  }
+  histogram.Add(100);
+  histogram.Add(5000);
+
+  EXPECT_EQ(histogram.Percentile(0.5f), 24);
+  EXPECT_EQ(histogram.Percentile(0.99f), 128);
+  EXPECT_EQ(histogram.Percentile(1.0f), 5000);
+  EXPECT_EQ(histogram.max_value(), 5000);
+}
+
+TEST(LogLinearHistogramTest, CountsSaturate) {
+  TestLogLinearHistogram histogram;
+  for (int i = 0; i < 300; ++i) {
+    histogram.Add(20);
+  }
+  histogram.Add(40);
+
+  EXPECT_EQ(histogram.count(1), 255);
+  EXPECT_EQ(histogram.total_count(), 256);
+  EXPECT_EQ(histogram.Percentile(1.0f), 40);
+
+  histogram.Clear();
+  EXPECT_EQ(histogram.total_count(), 0);
+  EXPECT_EQ(histogram.max_value(), 0);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "packed_number.h"
+#include "p2p_packet_protocol.h"
+
+typedef PackedInteger<3, 169> Packed;
+
+// The encoding of the original implementation.
+static void EncodeReference(uint64_t n, uint8_t bytes[3]) {
+  for (int i = 0; i < 3; ++i) {
+    bytes[i] = n % 169;
+    n /= 169;
+  }
+}
+
+TEST(PackedIntegerTest, NumValues) {
+  EXPECT_EQ(Packed::kNumValues, 169ULL * 169 * 169);
+}
+
+TEST(PackedIntegerTest, EncodesAsBefore) {
+  const uint64_t values[] = { 0, 1, 168, 169, 28560, 28561, 123456, Packed::kNumValues - 1, Packed::kNumValues,
+                              Packed::kNumValues + 5, 0xffffffffULL, 0x123456789abULL };
+  for (uint64_t n : values) {
+    const Packed packed(n);
+    uint8_t expected[3];
+    EncodeReference(n, expected);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(packed.bytes[i], expected[i]) << n;
+    }
+    EXPECT_EQ(packed.value(), n % Packed::kNumValues);
+  }
+}
+
+TEST(PackedIntegerTest, RoundTripsAllValues) {
+  Packed packed;
+  for (uint32_t n = 0; n < Packed::kNumValues; n += 7) {
+    packed = n;
+    ASSERT_LT(packed.bytes[0], 169);
+    ASSERT_LT(packed.bytes[1], 169);
+    ASSERT_LT(packed.bytes[2], 169);
+    ASSERT_EQ(static_cast<uint64_t>(packed), n);
+  }
+}
+
+TEST(PackedIntegerTest, ComparesBytes) {
+  EXPECT_EQ(Packed(1234), Packed(1234));
+  EXPECT_NE(Packed(1234), Packed(1235));
+  EXPECT_NE(Packed(169), Packed(1));
+  EXPECT_EQ(Packed(Packed::kNumValues + 3), Packed(3));
+  // Comparisons with integers go through the value.
+  EXPECT_TRUE(Packed(1234) == 1234ULL);
+  EXPECT_TRUE(Packed(0) != -1ULL);
+}
+
+TEST(PackedIntegerTest, NextWrapsAround) {
+  EXPECT_EQ(Packed::Next(0), 1);
+  EXPECT_EQ(Packed::Next(Packed::kNumValues - 2), Packed::kNumValues - 1);
+  EXPECT_EQ(Packed::Next(Packed::kNumValues - 1), 0);
+}
+
+TEST(PackedIntegerTest, SerialNumberOrder) {
+  EXPECT_TRUE(Packed(11).IsAfter(10));
+  EXPECT_FALSE(Packed(10).IsAfter(11));
+  EXPECT_FALSE(Packed(10).IsAfter(10));
+  // Across the wraparound.
+  EXPECT_TRUE(Packed(0).IsAfter(Packed::kNumValues - 1));
+  EXPECT_TRUE(Packed(5).IsAfter(Packed::kNumValues - 5));
+  EXPECT_FALSE(Packed(Packed::kNumValues - 1).IsAfter(0));
+  // Up to half the range ahead.
+  const uint64_t half = Packed::kNumValues / 2;
+  EXPECT_TRUE(Packed(half - 1).IsAfter(0));
+  EXPECT_FALSE(Packed(half).IsAfter(0));
+  EXPECT_FALSE(Packed(0).IsAfter(half + 1));
+  EXPECT_TRUE(Packed(0).IsAfter(half + 2));
+}
+
+TEST(PackedIntegerTest, SequenceNumbersFollowEachOther) {
+  uint64_t n = P2PSequenceNumberType::kNumValues - 100;
+  for (int i = 0; i < 200; ++i) {
+    const uint64_t next = P2PSequenceNumberType::Next(n);
+    EXPECT_TRUE(P2PSequenceNumberType(next).IsAfter(n));
+    EXPECT_FALSE(P2PSequenceNumberType(n).IsAfter(next));
+    n = next;
+  }
+  EXPECT_EQ(n, 100);
+}
@@ -0,0 +1,34 @@
+// Runs the microbenchmarks of primitives_benchmarks.h on the host, under Google Benchmark.
+//
+// Usage: primitives_bench [Google Benchmark flags, e.g. --benchmark_filter=prepare_to]
+//
+// Host timings only rank the kernels and track regressions: on the Teensy, build the
+// firmware with kRunPrimitivesBenchmarks set to 1 to get the cycle counts.
+
+#include <benchmark/benchmark.h>
+#include "primitives_benchmarks.h"
+
+static void RunPrimitivesBenchmark(benchmark::State &state, const PrimitivesBenchmark *primitives_benchmark) {
+  primitives_benchmark->set_up();
+  uint32_t call = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(primitives_benchmark->run(call++));
+  }
+  if (primitives_benchmark->bytes_per_call > 0) {
+    state.SetBytesProcessed(state.iterations() * primitives_benchmark->bytes_per_call);
+  }
+}
+
+int main(int argc, char **argv) {
+  for (int i = 0; i < GetNumPrimitivesBenchmarks(); ++i) {
+    const PrimitivesBenchmark &primitives_benchmark = GetPrimitivesBenchmark(i);
+    benchmark::RegisterBenchmark(primitives_benchmark.name, &RunPrimitivesBenchmark, &primitives_benchmark);
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "profiler.h"
+
+static int ProfiledFunction() {
+  PROFILE_SCOPE("profiled_function");
+  volatile int sum = 0;
+  for (int i = 0; i < 1000; ++i) {
+    sum += i;
+  }
+  return sum;
+}
+
+static int FindSection(const char *name) {
+  for (int i = 0; i < GetNumProfilerSections(); ++i) {
+    if (strcmp(GetProfilerSection(i).name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+TEST(ProfilerTest, ScopesAreRegisteredOnce) {
+  ProfiledFunction();
+  const int num_sections = GetNumProfilerSections();
+  ProfiledFunction();
+
+  EXPECT_EQ(GetNumProfilerSections(), num_sections);
+  const int index = FindSection("profiled_function");
+  ASSERT_GE(index, 0);
+  EXPECT_GE(GetProfilerSection(index).count, 2);
+}
+
+TEST(ProfilerTest, AggregatesDurations) {
+  const int index = RegisterProfilerSection("manual");
+  RecordProfilerSection(index, 10);
+  RecordProfilerSection(index, 30);
+  RecordProfilerSection(index, 20);
+
+  const ProfilerSection &section = GetProfilerSection(index);
+  EXPECT_STREQ(section.name, "manual");
+  EXPECT_EQ(section.count, 3);
+  EXPECT_EQ(section.min_cycles, 10);
+  EXPECT_EQ(section.max_cycles, 30);
+  EXPECT_EQ(section.total_cycles, 60);
+
+  ClearProfilerSection(index);
+  EXPECT_EQ(section.count, 0);
+  EXPECT_EQ(section.total_cycles, 0);
+}
+
+TEST(ProfilerTest, CyclesMatchTheClock) {
+  InitProfiler();
+  const ProfilerCyclesType start_cycles = GetProfilerCycles();
+  struct timespec delay = { 0, 10'000'000 };
+  nanosleep(&delay, nullptr);
+  const double elapsed_seconds = static_cast<double>(GetProfilerCycles() - start_cycles) / GetProfilerCyclesPerSecond();
+
+  EXPECT_GE(elapsed_seconds, 0.009);
+  EXPECT_LT(elapsed_seconds, 0.5);
+}
@@ -229,3 +229,60 @@ TEST(RingBuffer, IsFullReturnsTrueAfterRollover) {
 
   EXPECT_TRUE(buffer.IsFull());
 }
+
+#if kEnableRingBufferStats
+// Busy-waits for at least `cycles` profiler cycles.
+static void WaitProfilerCycles(uint64_t cycles) {
+  const ProfilerCyclesType start = GetProfilerCycles();
+  while (GetProfilerCycles() - start < cycles) {}
+}
+
+TEST(RingBuffer, StatsCountHighWaterMarkAndOverwrites) {
+  RingBuffer<int, /*kCapacity=*/4> buffer;
+  buffer.Write(52);
+  buffer.Write(53);
+  buffer.Read();
+  EXPECT_EQ(buffer.stats().high_water_mark, 2);
+  EXPECT_EQ(buffer.stats().num_overwrites, 0);
+
+  buffer.Write(54);
+  buffer.Write(55);
+  buffer.Write(56);
+  buffer.Write(57);
+
+  EXPECT_EQ(buffer.stats().high_water_mark, 3);
+  EXPECT_EQ(buffer.stats().num_overwrites, 2);
+}
+
+TEST(RingBuffer, StatsAverageOccupancyOverTime) {
+  RingBuffer<int, /*kCapacity=*/4> buffer;
+  buffer.Write(52);
+  buffer.Write(53);
+  buffer.ClearStats();
+  WaitProfilerCycles(10000);
+  EXPECT_FLOAT_EQ(GetRingBufferMeanOccupancy(buffer.stats()), 2);
+
+  // Empty for at least as long as it held two values.
+  const uint64_t full_cycles = buffer.stats().elapsed_cycles;
+  buffer.Clear();
+  WaitProfilerCycles(full_cycles);
+  const RingBufferStats stats = buffer.stats();
+  EXPECT_GT(GetRingBufferMeanOccupancy(stats), 0);
+  EXPECT_LE(GetRingBufferMeanOccupancy(stats), 1);
+  EXPECT_GE(stats.occupancy_cycles, 2 * full_cycles);
+}
+
+TEST(RingBuffer, ClearStatsStartsFromCurrentSize) {
+  RingBuffer<int, /*kCapacity=*/4> buffer;
+  buffer.Write(52);
+  buffer.Write(53);
+  buffer.Write(54);
+  buffer.Write(55);
+  buffer.Read();
+  buffer.ClearStats();
+
+  const RingBufferStats stats = buffer.stats();
+  EXPECT_EQ(stats.high_water_mark, 2);
+  EXPECT_EQ(stats.num_overwrites, 0);
+}
+#endif  // kEnableRingBufferStats
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "time_sync_estimator.h"
+#include <random>
+
+// Simulates exchanges with a remote clock that runs `skew` faster than the local one and is
+// `offset_ns` ahead at local time 0.
+class TimeSyncEstimatorTest : public ::testing::Test {
+protected:
+  uint64_t Remote(uint64_t local_ns) const {
+    return local_ns + offset_ns_ + static_cast<int64_t>(skew_ * static_cast<double>(local_ns));
+  }
+
+  // Exchange starting at `local_ns`, whose request and reply take the given times in flight.
+  TimeSyncExchange Exchange(uint64_t local_ns, uint64_t request_delay_ns, uint64_t reply_delay_ns) const {
+    constexpr uint64_t kProcessingNs = 50'000;
+    TimeSyncExchange exchange;
+    exchange.request_transmission_local_ns = local_ns;
+    exchange.request_reception_remote_ns = Remote(local_ns + request_delay_ns);
+    exchange.reply_transmission_remote_ns = Remote(local_ns + request_delay_ns + kProcessingNs);
+    exchange.reply_reception_local_ns = local_ns + request_delay_ns + kProcessingNs + reply_delay_ns;
+    return exchange;
+  }
+
+  int64_t offset_ns_ = 3'000'000'000;
+  double skew_ = 0;
+};
+
+TEST_F(TimeSyncEstimatorTest, SymmetricDelaysGiveExactOffset) {
+  TimeSyncEstimator estimator;
+  EXPECT_FALSE(estimator.has_model());
+  ASSERT_EQ(estimator.AddExchange(Exchange(1'000'000'000, 200'000, 200'000)), kSuccess);
+  ASSERT_EQ(estimator.EndRound(), kSuccess);
+  ASSERT_TRUE(estimator.has_model());
+  EXPECT_EQ(estimator.skew(), 0);
+  EXPECT_NEAR(estimator.OffsetAt(1'000'000'000), offset_ns_, 1);
+  EXPECT_EQ(estimator.last_delay_ns(), 400'000);
+}
+
+TEST_F(TimeSyncEstimatorTest, KeepsMinimumDelayExchange) {
+  TimeSyncEstimator estimator;
+  // Queueing delays the requests of the first exchanges, which biases their offsets.
+  ASSERT_EQ(estimator.AddExchange(Exchange(1'000'000'000, 5'000'000, 200'000)), kSuccess);
+  ASSERT_EQ(estimator.AddExchange(Exchange(1'010'000'000, 200'000, 200'000)), kSuccess);
+  ASSERT_EQ(estimator.AddExchange(Exchange(1'020'000'000, 200'000, 3'000'000)), kSuccess);
+  ASSERT_EQ(estimator.EndRound(), kSuccess);
+  EXPECT_NEAR(estimator.OffsetAt(1'010'000'000), offset_ns_, 1);
+  EXPECT_EQ(estimator.last_delay_ns(), 400'000);
+}
+
+TEST_F(TimeSyncEstimatorTest, RejectsInconsistentExchanges) {
+  TimeSyncEstimator estimator;
+  TimeSyncExchange exchange = Exchange(1'000'000'000, 200'000, 200'000);
+  // The remote end took longer than the round trip.
+  exchange.reply_transmission_remote_ns += 1'000'000;
+  EXPECT_EQ(estimator.AddExchange(exchange), kMalformedError);
+  EXPECT_EQ(estimator.EndRound(), kUnavailableError);
+}
+
+TEST_F(TimeSyncEstimatorTest, EstimatesSkewFromNoisyRounds) {
+  skew_ = 40e-6;
+  std::mt19937 random(7);
+  std::exponential_distribution<double> queueing(1.0 / 500'000);
+  TimeSyncEstimator estimator;
+  // One round every 10 seconds.
+  uint64_t local_ns = 0;
+  for (int round = 0; round < 12; ++round) {
+    local_ns = 10'000'000'000ULL * (round + 1);
+    for (int i = 0; i < 8; ++i) {
+      const uint64_t request_delay_ns = 150'000 + static_cast<uint64_t>(queueing(random));
+      const uint64_t reply_delay_ns = 150'000 + static_cast<uint64_t>(queueing(random));
+      ASSERT_EQ(estimator.AddExchange(Exchange(local_ns, request_delay_ns, reply_delay_ns)), kSuccess);
+      local_ns += 2'000'000;
+    }
+    ASSERT_EQ(estimator.EndRound(), kSuccess);
+  }
+  EXPECT_EQ(estimator.num_samples(), kTimeSyncWindowSize);
+  EXPECT_NEAR(estimator.skew(), skew_, 2e-6);
+  // The model stays accurate until the next synchronization.
+  for (uint64_t later_ns : { 0ULL, 10'000'000'000ULL }) {
+    const uint64_t at_ns = local_ns + later_ns;
+    EXPECT_NEAR(static_cast<double>(estimator.LocalToRemoteNanoseconds(at_ns)), static_cast<double>(Remote(at_ns)), 50'000);
+  }
+}
+
+TEST_F(TimeSyncEstimatorTest, ResetForgetsModel) {
+  TimeSyncEstimator estimator;
+  ASSERT_EQ(estimator.AddExchange(Exchange(1'000'000'000, 200'000, 200'000)), kSuccess);
+  ASSERT_EQ(estimator.EndRound(), kSuccess);
+  estimator.Reset();
+  EXPECT_FALSE(estimator.has_model());
+  EXPECT_EQ(estimator.OffsetAt(1'000'000'000), 0);
+}
@@ -0,0 +1,88 @@
+#ifndef ARDUINO
+
+#include "time_sync_estimator.h"
+
+void TimeSyncEstimator::Reset() {
+  has_round_sample_ = false;
+  num_samples_ = 0;
+  next_sample_ = 0;
+  offset_ns_ = 0;
+  skew_ = 0;
+  reference_local_ns_ = 0;
+  last_delay_ns_ = 0;
+}
+
+Status TimeSyncEstimator::AddExchange(const TimeSyncExchange &exchange) {
+  const int64_t round_trip_ns = static_cast<int64_t>(exchange.reply_reception_local_ns - exchange.request_transmission_local_ns);
+  const int64_t remote_ns = static_cast<int64_t>(exchange.reply_transmission_remote_ns - exchange.request_reception_remote_ns);
+  if (round_trip_ns < 0 || remote_ns < 0 || remote_ns > round_trip_ns) {
+    return kMalformedError;
+  }
+  const uint64_t delay_ns = round_trip_ns - remote_ns;
+  if (has_round_sample_ && delay_ns >= round_delay_ns_) {
+    return kSuccess;
+  }
+
+  // The request and the reply are assumed to take the same time in flight.
+  const int64_t request_offset_ns = static_cast<int64_t>(exchange.request_reception_remote_ns - exchange.request_transmission_local_ns);
+  const int64_t reply_offset_ns = static_cast<int64_t>(exchange.reply_transmission_remote_ns - exchange.reply_reception_local_ns);
+  round_sample_.local_ns = exchange.request_transmission_local_ns + round_trip_ns / 2;
+  round_sample_.offset_ns = request_offset_ns / 2 + reply_offset_ns / 2;
+  round_delay_ns_ = delay_ns;
+  has_round_sample_ = true;
+  return kSuccess;
+}
+
+Status TimeSyncEstimator::EndRound() {
+  if (!has_round_sample_) {
+    return kUnavailableError;
+  }
+  samples_[next_sample_] = round_sample_;
+  next_sample_ = (next_sample_ + 1) % kTimeSyncWindowSize;
+  if (num_samples_ < kTimeSyncWindowSize) {
+    ++num_samples_;
+  }
+  last_delay_ns_ = round_delay_ns_;
+  has_round_sample_ = false;
+  Fit();
+  return kSuccess;
+}
+
+void TimeSyncEstimator::Fit() {
+  // Fit around the newest sample, where the model is used, and in relative units, so that
+  // doubles keep nanosecond precision.
+  const Sample &newest = samples_[(next_sample_ + kTimeSyncWindowSize - 1) % kTimeSyncWindowSize];
+  reference_local_ns_ = newest.local_ns;
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  double min_x = 0;
+  for (int i = 0; i < num_samples_; ++i) {
+    const double x = static_cast<double>(static_cast<int64_t>(samples_[i].local_ns - reference_local_ns_));
+    const double y = static_cast<double>(samples_[i].offset_ns - newest.offset_ns);
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+    if (x < min_x) {
+      min_x = x;
+    }
+  }
+
+  const double n = num_samples_;
+  const double variance_x = sum_xx - sum_x * sum_x / n;
+  if (num_samples_ < 2 || -min_x < kMinTimeSyncSkewSpanNs || variance_x <= 0) {
+    skew_ = 0;
+    offset_ns_ = newest.offset_ns;
+    return;
+  }
+  skew_ = (sum_xy - sum_x * sum_y / n) / variance_x;
+  if (skew_ > kMaxTimeSyncSkew) {
+    skew_ = kMaxTimeSyncSkew;
+  } else if (skew_ < -kMaxTimeSyncSkew) {
+    skew_ = -kMaxTimeSyncSkew;
+  }
+  // The fitted line goes through the centroid of the samples.
+  const double intercept = (sum_y - skew_ * sum_x) / n;
+  offset_ns_ = newest.offset_ns + static_cast<int64_t>(intercept);
+}
+
+#endif  // ARDUINO
@@ -0,0 +1,93 @@
+#ifndef TIME_SYNC_ESTIMATOR_
+#define TIME_SYNC_ESTIMATOR_
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include "status_or.h"
+
+// Exchanges whose minimum-delay samples are kept to fit the clock model.
+#define kTimeSyncWindowSize 8
+// Minimum time spanned by the window to estimate the skew. Below it, the skew is assumed
+// to be zero, as timestamp noise would dominate.
+#define kMinTimeSyncSkewSpanNs 2'000'000'000LL
+// Crystals are rated to a few tens of ppm: larger skews are measurement errors.
+#define kMaxTimeSyncSkew 500e-6
+
+// Timestamps of an NTP-like exchange between the local end and the remote end.
+typedef struct {
+  uint64_t request_transmission_local_ns;   // t1
+  uint64_t request_reception_remote_ns;     // t2
+  uint64_t reply_transmission_remote_ns;    // t3
+  uint64_t reply_reception_local_ns;        // t4
+} TimeSyncExchange;
+
+// Estimates the remote clock as a linear function of the local clock:
+//   remote = local + offset + skew * (local - reference_local)
+//
+// Exchanges are grouped in rounds. Queueing only ever adds delay, so the exchange of each
+// round with the smallest round-trip delay is the least perturbed one; it alone is kept, as
+// a sample of the offset at the midpoint of its round trip. The offset and skew are the
+// least-squares fit of the last kTimeSyncWindowSize samples.
+//
+// Asymmetric link delays bias the offset by up to half the round-trip delay.
+class TimeSyncEstimator {
+public:
+  TimeSyncEstimator() { Reset(); }
+
+  // Forgets all exchanges and the model.
+  void Reset();
+
+  // Adds an exchange to the current round. Returns kMalformedError if its timestamps are
+  // inconsistent, i.e., it spent less time in flight than in the remote end.
+  Status AddExchange(const TimeSyncExchange &exchange);
+
+  // Keeps the best exchange of the current round and refits the model.
+  // Returns kUnavailableError if the round has no exchanges.
+  Status EndRound();
+
+  // True once a round has ended.
+  bool has_model() const { return num_samples_ > 0; }
+  int num_samples() const { return num_samples_; }
+
+  int64_t offset_ns() const { return offset_ns_; }
+  double skew() const { return skew_; }
+  uint64_t reference_local_ns() const { return reference_local_ns_; }
+
+  // Offset of the remote clock at the given local time.
+  int64_t OffsetAt(uint64_t local_ns) const {
+    return offset_ns_ + static_cast<int64_t>(skew_ * static_cast<double>(static_cast<int64_t>(local_ns - reference_local_ns_)));
+  }
+  uint64_t LocalToRemoteNanoseconds(uint64_t local_ns) const { return local_ns + OffsetAt(local_ns); }
+
+  // Round-trip delay of the exchange kept in the last round, excluding the time spent in the
+  // remote end.
+  uint64_t last_delay_ns() const { return last_delay_ns_; }
+
+private:
+  typedef struct {
+    uint64_t local_ns;
+    int64_t offset_ns;
+  } Sample;
+
+  void Fit();
+
+  // Best exchange of the current round.
+  bool has_round_sample_;
+  Sample round_sample_;
+  uint64_t round_delay_ns_;
+
+  // Ring of the samples kept from the last rounds.
+  Sample samples_[kTimeSyncWindowSize];
+  int num_samples_;
+  int next_sample_;
+
+  int64_t offset_ns_;
+  double skew_;
+  uint64_t reference_local_ns_;
+  uint64_t last_delay_ns_;
+};
+
+#endif  // ARDUINO
+
+#endif  // TIME_SYNC_ESTIMATOR_
@@ -7,6 +7,8 @@
 // Must be implemented on each platform.
 class TimerInterface {
 public:
+  TimerInterface() : global_offset_nanoseconds_(0), global_skew_(0), global_skew_reference_local_nanoseconds_(0) {}
+
   // Returns the nanoseconds elapsed since the program started in this computer.
   // Timer resolution is platform-dependent.
   virtual uint64_t GetLocalNanoseconds() const = 0;
@@ -15,14 +17,35 @@ public:
   // The nanosecond count may jump to the future faster than real time, if the local time fell
   // behind the time of other computers.
   // Timer resolution is platform-dependent.
-  virtual uint64_t GetGlobalNanoseconds() const { return GetLocalNanoseconds() + global_offset_nanoseconds_; }
+  virtual uint64_t GetGlobalNanoseconds() const { return LocalToGlobalNanoseconds(GetLocalNanoseconds()); }
+
+  // Global time at the given local time:
+  //   global = local + global_offset + global_skew * (local - global_skew_reference_local)
+  uint64_t LocalToGlobalNanoseconds(uint64_t local_ns) const {
+    uint64_t global_ns = local_ns + global_offset_nanoseconds_;
+    if (global_skew_ != 0) {
+      global_ns += static_cast<int64_t>(global_skew_ * static_cast<double>(static_cast<int64_t>(local_ns - global_skew_reference_local_nanoseconds_)));
+    }
+    return global_ns;
+  }
 
   // Gets/sets the time offset of the global time for synchronization purposes.
   const uint64_t &global_offset_nanoseconds() const { return global_offset_nanoseconds_; }
   uint64_t &global_offset_nanoseconds() { return global_offset_nanoseconds_; }
 
+  // Makes the global time run `skew` times faster than the local time, e.g. 50e-6 for 50 ppm,
+  // with the offset taking effect at `reference_local_ns`. Lets synchronized clocks stay
+  // together between synchronizations, despite the different rates of their oscillators.
+  void SetGlobalSkew(double skew, uint64_t reference_local_ns) {
+    global_skew_ = skew;
+    global_skew_reference_local_nanoseconds_ = reference_local_ns;
+  }
+  double global_skew() const { return global_skew_; }
+
 private:
   uint64_t global_offset_nanoseconds_;
+  double global_skew_;
+  uint64_t global_skew_reference_local_nanoseconds_;
 };
 
 #endif  // TIMER_INTERFACE_
\ No newline at end of file
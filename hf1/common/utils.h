@@ -6,8 +6,6 @@
 #include <functional>
 #include <math.h>
 
-#ifdef ARDUINO
-
 template<typename ParamType> class EndOfScopeExecutor {
 public:
   EndOfScopeExecutor(void (*fn)(ParamType), ParamType param) : fn_(fn), param_(param) {}
@@ -43,8 +41,6 @@ private:
 // }
 #define PUSH_POP_WRAPPER(state_type, push_fn, pop_fn) for(struct { bool done; EndOfScopeExecutor<state_type> pop_executor; } s = { .done = false, .pop_executor = EndOfScopeExecutor<state_type>(&pop_fn, push_fn()) }; !s.done; s.done = true)
 
-#endif
-
 void Uint64ToString(uint64_t number, char *str);
 
 // Maps `radians` to [-pi, pi).
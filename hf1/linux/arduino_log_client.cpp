@@ -0,0 +1,60 @@
+#include "arduino_log_client.h"
+#include "deferred_logger.h"
+#include <stdio.h>
+
+#define kRecordsOffset (sizeof(P2PStreamLogsProgress) - kP2PMaxLogRecordsLength)
+
+Status ArduinoLogClient::Start() {
+  num_records_ = num_dropped_records_ = 0;
+  const P2PVoid request;
+  return Request(sizeof(request), &request);
+}
+
+Status ArduinoLogClient::Stop() {
+  return Cancel();
+}
+
+void ArduinoLogClient::OnProgress(int payload_length, const void *payload) {
+  P2PActionClientHandlerBase::OnProgress(payload_length, payload);
+  if (payload_length < static_cast<int>(kRecordsOffset)) {
+    LOG_ERROR("Malformed Arduino log progress.");
+    return;
+  }
+  const auto &progress = *reinterpret_cast<const P2PStreamLogsProgress *>(payload);
+  const int num_dropped_records = NetworkToLocal<kP2PLocalEndianness>(progress.num_dropped_records);
+  if (num_dropped_records > 0) {
+    num_dropped_records_ += num_dropped_records;
+    char msg[64];
+    snprintf(msg, sizeof(msg), "The Arduino dropped %d log messages.", num_dropped_records);
+    LOG_WARNING(msg);
+  }
+
+  const int records_length = payload_length - kRecordsOffset;
+  int offset = 0;
+  while (offset < records_length) {
+    DeferredLogRecord record;
+    const int record_length = DecodeDeferredLogRecord(&progress.records[offset], records_length - offset, &record);
+    if (record_length == 0) {
+      LOG_ERROR("Malformed Arduino log record.");
+      return;
+    }
+    offset += record_length;
+    ++num_records_;
+
+    char text[kMaxFormattedLogMessageLength];
+    FormatDeferredLogRecord(record, text, sizeof(text));
+    char msg[kMaxFormattedLogMessageLength + 32];
+    snprintf(msg, sizeof(msg), "[arduino %.6f] %s", record.timestamp_ns * 1e-9, text);
+    switch (record.level) {
+      case kLogWarning:
+        LOG_WARNING(msg);
+        break;
+      case kLogError:
+        LOG_ERROR(msg);
+        break;
+      default:
+        LOG_INFO(msg);
+        break;
+    }
+  }
+}
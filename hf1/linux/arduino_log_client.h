@@ -0,0 +1,33 @@
+#ifndef ARDUINO_LOG_CLIENT_INCLUDED_
+#define ARDUINO_LOG_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include <atomic>
+
+// Receives the messages logged in the Arduino, formats them and writes them to this end's
+// logger, prefixed with the Arduino's timestamp.
+class ArduinoLogClient : public P2PActionClientHandlerBase {
+public:
+  // Does not take ownsership of the pointees, which must outlive this object.
+  ArduinoLogClient(P2PPacketStreamLinux *p2p_stream, std::mutex *p2p_mutex)
+    : P2PActionClientHandlerBase(P2PAction::kStreamLogs, P2PPriority::kLow, /*default_guarantee_delivery=*/false, p2p_stream, p2p_mutex),
+      num_records_(0), num_dropped_records_(0) {}
+
+  // Requests the Arduino to stream its logs until Stop() is called.
+  Status Start();
+  // Cancels the action. The Arduino writes its logs to its USB serial port again.
+  Status Stop();
+
+  int num_records() const { return num_records_; }
+  // Messages lost in the Arduino because its buffer was full.
+  int num_dropped_records() const { return num_dropped_records_; }
+
+protected:
+  void OnProgress(int payload_length, const void *payload) override;
+
+private:
+  std::atomic<int> num_records_;
+  std::atomic<int> num_dropped_records_;
+};
+
+#endif  // ARDUINO_LOG_CLIENT_INCLUDED_
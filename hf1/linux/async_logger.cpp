@@ -0,0 +1,246 @@
+#include "async_logger.h"
+#include <time.h>
+#include <chrono>
+#include <cstdlib>
+
+#define kThreadRingIndexMask (kAsyncLogThreadCapacity - 1)
+
+static_assert((kAsyncLogThreadCapacity & (kAsyncLogThreadCapacity - 1)) == 0);
+
+static uint64_t GetMonotonicNanoseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ULL + now.tv_nsec;
+}
+
+static const char *GetLevelName(LogLevel level) {
+  switch (level) {
+    case kLogWarning:
+      return "WARNING";
+    case kLogError:
+      return "ERROR";
+    default:
+      return "INFO";
+  }
+}
+
+// Single-producer single-consumer ring of entries. The producer is the thread that owns it;
+// the consumer, whoever holds AsyncLogger::write_mutex_.
+class AsyncLogger::ThreadRing {
+public:
+  ThreadRing() : write_index_(0), read_index_(0), retired_(false) {}
+
+  // Returns the next free entry, or nullptr if the ring is full.
+  Entry *BeginWrite() {
+    const uint32_t write_index = write_index_.load(std::memory_order_relaxed);
+    if (write_index - read_index_.load(std::memory_order_acquire) >= kAsyncLogThreadCapacity) {
+      return nullptr;
+    }
+    return &entries_[write_index & kThreadRingIndexMask];
+  }
+  // Publishes the entry returned by BeginWrite().
+  void EndWrite() { write_index_.store(write_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Returns the oldest entry, or nullptr if the ring is empty.
+  const Entry *BeginRead() const {
+    const uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+    if (read_index == write_index_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &entries_[read_index & kThreadRingIndexMask];
+  }
+  // Releases the entry returned by BeginRead().
+  void EndRead() { read_index_.store(read_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Set when the owner thread exits, so that the ring is released once it is drained.
+  std::atomic<bool> &retired() { return retired_; }
+
+private:
+  Entry entries_[kAsyncLogThreadCapacity];
+  std::atomic<uint32_t> write_index_;
+  std::atomic<uint32_t> read_index_;
+  std::atomic<bool> retired_;
+};
+
+static std::atomic<uint64_t> next_instance_id(1);
+
+// Ring of the thread in the last AsyncLogger it logged to.
+struct AsyncLogger::ThreadRingCache {
+  ~ThreadRingCache() {
+    if (ring != nullptr) {
+      ring->retired() = true;
+    }
+  }
+
+  uint64_t instance_id = 0;
+  std::shared_ptr<ThreadRing> ring;
+};
+
+thread_local AsyncLogger::ThreadRingCache AsyncLogger::thread_ring_cache_;
+
+AsyncLogger::AsyncLogger(FILE *output)
+  : output_(ASSERT_NOT_NULL(output)), instance_id_(next_instance_id++), stop_(false),
+    num_dropped_messages_(0), num_reported_dropped_messages_(0),
+    writer_(&AsyncLogger::WriterLoop, this) {}
+
+AsyncLogger::~AsyncLogger() {
+  {
+    std::lock_guard<std::mutex> guard(wake_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  writer_.join();
+}
+
+AsyncLogger::ThreadRing &AsyncLogger::GetThreadRing() {
+  if (thread_ring_cache_.instance_id != instance_id_) {
+    if (thread_ring_cache_.ring != nullptr) {
+      thread_ring_cache_.ring->retired() = true;
+    }
+    thread_ring_cache_.ring = std::make_shared<ThreadRing>();
+    thread_ring_cache_.instance_id = instance_id_;
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    rings_.push_back(thread_ring_cache_.ring);
+  }
+  return *thread_ring_cache_.ring;
+}
+
+AsyncLogger::Entry *AsyncLogger::BeginEntry(LogLevel level, const char *file_name, int line, int format_id) {
+  Entry *entry = GetThreadRing().BeginWrite();
+  if (entry == nullptr) {
+    num_dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  entry->timestamp_ns = GetMonotonicNanoseconds();
+  entry->level = level;
+  entry->format_id = format_id;
+  entry->file_name = file_name;
+  entry->line = line;
+  return entry;
+}
+
+void AsyncLogger::Text(LogLevel level, const char *file_name, int line, const char *msg) {
+  Entry *entry = BeginEntry(level, file_name, line, kLogFormatText);
+  if (entry == nullptr) {
+    return;
+  }
+  const size_t length = msg == nullptr ? 0 : strnlen(msg, kMaxAsyncLogTextLength);
+  memcpy(entry->text, msg, length);
+  entry->text[length] = '\0';
+  thread_ring_cache_.ring->EndWrite();
+}
+
+void AsyncLogger::Info(const char *file_name, int line, const char *msg) {
+  Text(kLogInfo, file_name, line, msg);
+}
+
+void AsyncLogger::Warning(const char *file_name, int line, const char *msg) {
+  Text(kLogWarning, file_name, line, msg);
+}
+
+void AsyncLogger::Error(const char *file_name, int line, const char *msg) {
+  Text(kLogError, file_name, line, msg);
+}
+
+void AsyncLogger::Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args) {
+  Entry *entry = BeginEntry(level, file_name, line, format_id);
+  if (entry == nullptr) {
+    return;
+  }
+  entry->args = args;
+  thread_ring_cache_.ring->EndWrite();
+}
+
+void AsyncLogger::Fatal(const char *expr, const char *file_name, int line, const char *msg) {
+  {
+    // Show what happened before the error.
+    std::lock_guard<std::mutex> guard(write_mutex_);
+    WritePendingEntries();
+    fprintf(output_, "[FATAL] %s:%d: %s is false", file_name, line, expr);
+    if (msg != nullptr) {
+      fprintf(output_, ":\n%s", msg);
+    }
+    fprintf(output_, "\n");
+    fflush(output_);
+  }
+  exit(1);
+}
+
+void AsyncLogger::Flush() {
+  std::lock_guard<std::mutex> guard(write_mutex_);
+  WritePendingEntries();
+}
+
+void AsyncLogger::WriterLoop() {
+  for (;;) {
+    int num_written;
+    {
+      std::lock_guard<std::mutex> guard(write_mutex_);
+      num_written = WritePendingEntries();
+    }
+    if (num_written > 0) {
+      continue;
+    }
+    // Logging threads do not wake the writer, as that may take a system call: poll instead.
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    if (stop_) {
+      break;
+    }
+    wake_.wait_for(lock, std::chrono::nanoseconds(kAsyncLogWriterPeriodNs));
+  }
+  std::lock_guard<std::mutex> guard(write_mutex_);
+  WritePendingEntries();
+}
+
+int AsyncLogger::WritePendingEntries() {
+  std::vector<std::shared_ptr<ThreadRing>> rings;
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    rings = rings_;
+  }
+
+  int num_written = 0;
+  for (const auto &ring : rings) {
+    // Bound the entries taken from each ring, so that a flooding thread does not delay the
+    // messages of the others indefinitely.
+    for (int i = 0; i < kAsyncLogThreadCapacity; ++i) {
+      const Entry *entry = ring->BeginRead();
+      if (entry == nullptr) {
+        break;
+      }
+      WriteEntry(*entry);
+      ring->EndRead();
+      ++num_written;
+    }
+  }
+
+  const uint64_t num_dropped_messages = num_dropped_messages_;
+  if (num_dropped_messages != num_reported_dropped_messages_) {
+    fprintf(output_, "[WARNING] async_logger: %llu log messages dropped.\n", static_cast<unsigned long long>(num_dropped_messages - num_reported_dropped_messages_));
+    num_reported_dropped_messages_ = num_dropped_messages;
+  }
+  if (num_written > 0) {
+    fflush(output_);
+  }
+
+  // Release the rings of the threads that exited, once drained.
+  std::lock_guard<std::mutex> guard(rings_mutex_);
+  for (auto it = rings_.begin(); it != rings_.end();) {
+    if ((*it)->retired() && (*it)->BeginRead() == nullptr) {
+      it = rings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return num_written;
+}
+
+void AsyncLogger::WriteEntry(const Entry &entry) {
+  const char *msg = entry.text;
+  char formatted_msg[kMaxFormattedLogMessageLength];
+  if (entry.format_id != kLogFormatText) {
+    FormatLogMessage(entry.format_id, entry.args, formatted_msg, sizeof(formatted_msg));
+    msg = formatted_msg;
+  }
+  fprintf(output_, "[%s] %.6f %s:%d: %s\n", GetLevelName(entry.level), entry.timestamp_ns * 1e-9, entry.file_name, entry.line, msg);
+}
@@ -0,0 +1,96 @@
+#ifndef ASYNC_LOGGER_INCLUDED_
+#define ASYNC_LOGGER_INCLUDED_
+
+#include "logger_interface.h"
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Entries each logging thread can buffer before its messages are dropped.
+#define kAsyncLogThreadCapacity 1024
+// Plain text messages longer than this are truncated.
+#define kMaxAsyncLogTextLength 160
+// Time the writer thread sleeps when there is nothing to write.
+#define kAsyncLogWriterPeriodNs 10'000'000
+
+// Logger that writes messages from a background thread, so that logging threads never wait
+// for the output, nor for each other.
+//
+// Each logging thread appends its messages to its own lock-free single-producer ring, with
+// a CLOCK_MONOTONIC timestamp. Messages of the catalog in log_formats.h are captured as their
+// raw arguments, and formatted by the writer thread; plain text messages are copied. When a
+// ring is full, messages are dropped and counted, rather than slowing down the thread.
+//
+// Messages of different threads are written in the order in which the writer finds them,
+// which may differ slightly from their timestamp order. Fatal errors are not deferred: the
+// pending messages and the error are written right away, and the program exits.
+class AsyncLogger : public LoggerInterface {
+public:
+  // Starts the writer thread, which writes to `output`.
+  explicit AsyncLogger(FILE *output = stdout);
+  // Writes the pending messages and stops the writer thread. Threads must not log anymore.
+  ~AsyncLogger();
+
+  void Info(const char *file_name, int line, const char *msg) override;
+  void Warning(const char *file_name, int line, const char *msg) override;
+  void Error(const char *file_name, int line, const char *msg) override;
+  void Fatal(const char *expr, const char *file_name, int line, const char *msg) override;
+  void Formatted(LogLevel level, const char *file_name, int line, int format_id, const LogArgs &args) override;
+
+  // Blocks until the messages logged before the call are written.
+  void Flush();
+
+  // Number of messages dropped because the ring of their thread was full.
+  uint64_t num_dropped_messages() const { return num_dropped_messages_; }
+
+private:
+  typedef struct {
+    uint64_t timestamp_ns;
+    LogLevel level;
+    int format_id;
+    // __FILENAME__ of the call site, which is a string literal.
+    const char *file_name;
+    int line;
+    LogArgs args;                           // If format_id != kLogFormatText.
+    char text[kMaxAsyncLogTextLength + 1];  // If format_id == kLogFormatText.
+  } Entry;
+
+  class ThreadRing;
+  struct ThreadRingCache;
+
+  // Returns the ring of the calling thread, which it creates on first use.
+  ThreadRing &GetThreadRing();
+  // Claims a free entry of the calling thread's ring, or returns nullptr if it is full.
+  Entry *BeginEntry(LogLevel level, const char *file_name, int line, int format_id);
+  void Text(LogLevel level, const char *file_name, int line, const char *msg);
+  void WriterLoop();
+  // Writes the pending entries of all rings. Returns the number of entries written.
+  // The caller must hold write_mutex_.
+  int WritePendingEntries();
+  void WriteEntry(const Entry &entry);
+
+  FILE *const output_;
+  // Identifies this instance in the thread-local ring caches.
+  const uint64_t instance_id_;
+
+  std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<ThreadRing>> rings_;
+
+  // Serializes the consumers: the writer thread, Flush() and Fatal().
+  std::mutex write_mutex_;
+
+  std::atomic<bool> stop_;
+  std::atomic<uint64_t> num_dropped_messages_;
+  uint64_t num_reported_dropped_messages_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::thread writer_;
+
+  static thread_local ThreadRingCache thread_ring_cache_;
+};
+
+#endif  // ASYNC_LOGGER_INCLUDED_
@@ -0,0 +1,55 @@
+#include "base_state_event_log_client.h"
+#include "base_state_event_codec.h"
+#include <sstream>
+
+Status BaseStateEventLogClient::Start(const char *filename) {
+  {
+    std::lock_guard<std::mutex> guard(log_mutex_);
+    const Status status = log_.Open(filename);
+    if (status != kSuccess) {
+      return status;
+    }
+  }
+  num_batches_ = num_events_ = num_dropped_events_ = 0;
+  const P2PVoid request;
+  const Status status = Request(sizeof(request), &request);
+  if (status != kSuccess) {
+    std::lock_guard<std::mutex> guard(log_mutex_);
+    log_.Close();
+  }
+  return status;
+}
+
+Status BaseStateEventLogClient::Stop() {
+  const Status status = Cancel();
+  std::lock_guard<std::mutex> guard(log_mutex_);
+  log_.Close();
+  return status;
+}
+
+void BaseStateEventLogClient::OnProgress(int payload_length, const void *payload) {
+  P2PActionClientHandlerBase::OnProgress(payload_length, payload);
+  const auto &batch = *reinterpret_cast<const P2PRecordBaseStateEventsProgress *>(payload);
+  BaseStateEventBatchDecoder decoder(&batch, payload_length);
+  if (decoder.status() != kSuccess) {
+    LOG_ERROR("Malformed base state event batch.");
+    return;
+  }
+  std::lock_guard<std::mutex> guard(log_mutex_);
+  if (!log_.is_open()) {
+    // Progress packet sent before the cancellation arrived.
+    return;
+  }
+  if (log_.Write(batch, payload_length) != kSuccess) {
+    LOG_ERROR("Cannot write base state event batch.");
+    return;
+  }
+  ++num_batches_;
+  num_events_ += decoder.num_events();
+  if (decoder.num_dropped_events() > 0) {
+    num_dropped_events_ += decoder.num_dropped_events();
+    std::ostringstream oss;
+    oss << "The Arduino dropped " << decoder.num_dropped_events() << " base state events.";
+    LOG_WARNING(oss.str().c_str());
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef BASE_STATE_EVENT_LOG_CLIENT_INCLUDED_
+#define BASE_STATE_EVENT_LOG_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "base_state_event_log.h"
+#include <mutex>
+#include <atomic>
+
+// Records the events consumed by the Arduino's base state estimator to a binary log, which
+// base_state_filter_bench can replay offline with --log.
+class BaseStateEventLogClient : public P2PActionClientHandlerBase {
+public:
+  // Does not take ownership of the pointees, which must outlive this object.
+  BaseStateEventLogClient(P2PPacketStreamLinux *p2p_stream, std::mutex *p2p_mutex)
+    : P2PActionClientHandlerBase(P2PAction::kRecordBaseStateEvents, P2PPriority::kLow, /*default_guarantee_delivery=*/true, p2p_stream, p2p_mutex),
+      num_batches_(0), num_events_(0), num_dropped_events_(0) {}
+
+  // Creates `filename` and requests the Arduino to stream events until Stop() is called.
+  // Returns kUnavailableError if the file cannot be created, or any error of Request().
+  Status Start(const char *filename);
+  // Cancels the action and closes the log. Events in flight are lost.
+  Status Stop();
+
+  int num_batches() const { return num_batches_; }
+  int num_events() const { return num_events_; }
+  // Events lost in the Arduino because its buffer was full.
+  int num_dropped_events() const { return num_dropped_events_; }
+
+protected:
+  void OnProgress(int payload_length, const void *payload) override;
+
+private:
+  std::mutex log_mutex_;
+  BaseStateEventLogWriter log_;
+  std::atomic<int> num_batches_;
+  std::atomic<int> num_events_;
+  std::atomic<int> num_dropped_events_;
+};
+
+#endif  // BASE_STATE_EVENT_LOG_CLIENT_INCLUDED_
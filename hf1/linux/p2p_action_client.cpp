@@ -1,6 +1,5 @@
 #include "p2p_action_client.h"
 #include <string.h>
-#include <sstream>
 #include "logger_interface.h"
 #include <mutex>
 #include <iostream>
@@ -97,29 +96,28 @@ void P2PActionClient::Run() {
 
   const auto *header = reinterpret_cast<const P2PApplicationPacketHeader *>(maybe_packet->content());  
   if (header->action >= P2PAction::kCount) {
-    std::ostringstream oss;
-    oss << "Unknown action " << header->action << ".";
-    LOG_ERROR(oss.str().c_str());
+    LOG_ERROR_FMT(kLogFormatUnknownAction, header->action);
     p2p_stream_.input().Consume(maybe_packet->priority());
     return;
   }
 
   P2PActionClientHandlerBase *handler = handlers_[header->action];
   if (handler == nullptr) {
-    std::ostringstream oss;
-    oss << "No handler installed for action " << header->action << ".";
-    LOG_WARNING(oss.str().c_str());    
+    LOG_WARNING_FMT(kLogFormatNoActionHandler, header->action);
     p2p_stream_.input().Consume(maybe_packet->priority());
     return;
   }
 
-  if (header->request_id != handler->current_request_id()) {
-    // This is a response from a previous action that was cancelled.
+  if (!handler->allows_concurrent_requests_ && header->request_id != handler->current_request_id()) {
+    // This is a response from a previous action that was cancelled. Handlers with concurrent
+    // requests get the responses to all of them.
     p2p_stream_.input().Consume(maybe_packet->priority());
     return;
   }
 
   const uint8_t *payload = maybe_packet->content() + sizeof(P2PApplicationPacketHeader);
+  handler->packet_reception_local_time_ns_ = maybe_packet->reception_local_time_ns();
+  handler->packet_request_id_ = header->request_id;
   switch(header->stage) {
     case P2PActionStage::kReply:
       handler->OnReply(maybe_packet->length() - sizeof(P2PApplicationPacketHeader), payload);
@@ -128,9 +126,7 @@ void P2PActionClient::Run() {
       handler->OnProgress(maybe_packet->length() - sizeof(P2PApplicationPacketHeader), payload);
       break;
     default: {
-      std::ostringstream oss;
-      oss << "Unsupported stage " << header->stage << " for action " << header->action << ".";
-      LOG_ERROR(oss.str().c_str());
+      LOG_ERROR_FMT(kLogFormatUnsupportedActionStage, header->stage, header->action);
       break;
     }
   }
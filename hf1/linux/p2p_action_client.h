@@ -22,6 +22,8 @@ public:
       current_request_id_(0),
       p2p_mutex_(*ASSERT_NOT_NULL(p2p_mutex)),
       allows_concurrent_requests_(allows_concurrent_requests), 
+      packet_reception_local_time_ns_(0),
+      packet_request_id_(0),
       state_(kIdle) {}
 
   // Sends an action request message with the given `payload`.
@@ -44,6 +46,14 @@ public:
   // True if the action is being executed; false, otherwise.
   bool in_progress() const;
 
+  // Local time at which the packet being dispatched was received.
+  // Only valid within OnReply(), OnProgress() and their callbacks.
+  uint64_t packet_reception_local_time_ns() const { return packet_reception_local_time_ns_; }
+  // Request ID of the packet being dispatched, which may be older than the current one for
+  // handlers that allow concurrent requests.
+  // Only valid within OnReply(), OnProgress() and their callbacks.
+  P2PActionRequestID packet_request_id() const { return packet_request_id_; }
+
   // Overrides must call the parent.
   virtual void OnReply(int payload_length, const void *payload);
   virtual void OnProgress(int payload_length, const void *payload);
@@ -61,6 +71,8 @@ private:
   P2PActionRequestID current_request_id_;
   std::mutex &p2p_mutex_;
   const bool allows_concurrent_requests_;
+  uint64_t packet_reception_local_time_ns_;
+  P2PActionRequestID packet_request_id_;
 
   using State = enum { kIdle, kWaitingForResponse };
   // Since the state is atomic, we can read it without locking.
@@ -0,0 +1,11 @@
+#include "p2p_datagram_linux.h"
+#include <sys/socket.h>
+
+bool P2PDatagramLinux::Send(const void *datagram, int length) {
+  return send(fd_, datagram, length, MSG_DONTWAIT) == length;
+}
+
+int P2PDatagramLinux::Receive(void *buffer, int max_length) {
+  const int result = recv(fd_, buffer, max_length, MSG_DONTWAIT);
+  return result != -1 ? result : 0;
+}
@@ -0,0 +1,20 @@
+#ifndef P2P_DATAGRAM_LINUX_INCLUDED__
+#define P2P_DATAGRAM_LINUX_INCLUDED__
+
+#include "p2p_datagram_interface.h"
+
+// Datagrams over a socket that preserves message boundaries, e.g. one end of a
+// socketpair(AF_UNIX, SOCK_SEQPACKET) to a simulator, or a connected UDP socket.
+class P2PDatagramLinux : public P2PDatagramInterface {
+public:
+  // Does not take ownership of the socket, which must outlive this object.
+  P2PDatagramLinux(int fd) : fd_(fd) {}
+
+  virtual bool Send(const void *datagram, int length);
+  virtual int Receive(void *buffer, int max_length);
+
+private:
+  int fd_;
+};
+
+#endif  // P2P_DATAGRAM_LINUX_INCLUDED__
@@ -0,0 +1,115 @@
+#include "p2p_packet_trace_recorder.h"
+#include <algorithm>
+#include <chrono>
+
+#define kTraceRingIndexMask (kP2PPacketTraceRingCapacity - 1)
+
+static_assert((kP2PPacketTraceRingCapacity & (kP2PPacketTraceRingCapacity - 1)) == 0);
+static_assert(sizeof(P2PPacketTraceRecord) == 16);
+
+const char *GetP2PPacketTraceEventName(int event) {
+  static const char *const names[] = {
+    "committed", "first_byte_sent", "preempted", "continued", "last_byte_sent",
+    "retransmitted", "ack_received", "received", "delivered", "consumed",
+  };
+  static_assert(sizeof(names) / sizeof(names[0]) == kP2PPacketNumTraceEvents);
+  if (event < 0 || event >= kP2PPacketNumTraceEvents) {
+    return "unknown";
+  }
+  return names[event];
+}
+
+bool ReadP2PPacketTrace(FILE *input, std::vector<P2PPacketTraceRecord> *records) {
+  P2PPacketTraceFileHeader header;
+  if (fread(&header, sizeof(header), 1, input) != 1 ||
+      header.magic != kP2PPacketTraceFileMagic ||
+      header.version != kP2PPacketTraceFileVersion ||
+      header.record_size != sizeof(P2PPacketTraceRecord)) {
+    return false;
+  }
+  records->clear();
+  P2PPacketTraceRecord record;
+  while (fread(&record, sizeof(record), 1, input) == 1) {
+    records->push_back(record);
+  }
+  return true;
+}
+
+P2PPacketTraceRecorder::P2PPacketTraceRecorder(FILE *output)
+  : output_(ASSERT_NOT_NULL(output)), write_index_(0), read_index_(0), num_dropped_records_(0),
+    stop_(false) {
+  const P2PPacketTraceFileHeader header = { .magic = kP2PPacketTraceFileMagic, .version = kP2PPacketTraceFileVersion, .record_size = sizeof(P2PPacketTraceRecord) };
+  fwrite(&header, sizeof(header), 1, output_);
+  writer_ = std::thread(&P2PPacketTraceRecorder::WriterLoop, this);
+}
+
+P2PPacketTraceRecorder::~P2PPacketTraceRecorder() {
+  {
+    std::lock_guard<std::mutex> guard(wake_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  writer_.join();
+}
+
+void P2PPacketTraceRecorder::Record(P2PPacketTraceEvent event, const P2PPacket &packet, uint64_t timestamp_ns, void *self_ptr) {
+  P2PPacketTraceRecorder &self = *static_cast<P2PPacketTraceRecorder *>(self_ptr);
+  const uint32_t write_index = self.write_index_.load(std::memory_order_relaxed);
+  if (write_index - self.read_index_.load(std::memory_order_acquire) >= kP2PPacketTraceRingCapacity) {
+    self.num_dropped_records_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  P2PPacketTraceRecord &record = self.records_[write_index & kTraceRingIndexMask];
+  record.timestamp_ns = timestamp_ns;
+  record.sequence_number = static_cast<uint32_t>(packet.sequence_number());
+  record.event = event;
+  record.priority = packet.header()->priority;
+  record.flags = (packet.header()->requires_ack ? kP2PPacketTraceRequiresAck : 0) |
+                 (packet.header()->is_ack ? kP2PPacketTraceIsAck : 0) |
+                 (packet.header()->is_init ? kP2PPacketTraceIsInit : 0);
+  record.reserved = 0;
+  self.write_index_.store(write_index + 1, std::memory_order_release);
+}
+
+void P2PPacketTraceRecorder::Flush() {
+  std::lock_guard<std::mutex> guard(write_mutex_);
+  WritePendingRecords();
+}
+
+void P2PPacketTraceRecorder::WriterLoop() {
+  for (;;) {
+    int num_written;
+    {
+      std::lock_guard<std::mutex> guard(write_mutex_);
+      num_written = WritePendingRecords();
+    }
+    if (num_written > 0) {
+      continue;
+    }
+    // The stream does not wake the writer, as that may take a system call: poll instead.
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    if (stop_) {
+      break;
+    }
+    wake_.wait_for(lock, std::chrono::nanoseconds(kP2PPacketTraceWriterPeriodNs));
+  }
+  std::lock_guard<std::mutex> guard(write_mutex_);
+  WritePendingRecords();
+}
+
+int P2PPacketTraceRecorder::WritePendingRecords() {
+  const uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+  const uint32_t write_index = write_index_.load(std::memory_order_acquire);
+  const uint32_t num_pending = write_index - read_index;
+  if (num_pending == 0) {
+    return 0;
+  }
+  // Write the records up to the end of the ring first, if they wrap around.
+  const uint32_t first = read_index & kTraceRingIndexMask;
+  const uint32_t num_until_end = std::min<uint32_t>(num_pending, kP2PPacketTraceRingCapacity - first);
+  fwrite(&records_[first], sizeof(P2PPacketTraceRecord), num_until_end, output_);
+  fwrite(&records_[0], sizeof(P2PPacketTraceRecord), num_pending - num_until_end, output_);
+  fflush(output_);
+  read_index_.store(write_index, std::memory_order_release);
+  return num_pending;
+}
@@ -0,0 +1,103 @@
+#ifndef P2P_PACKET_TRACE_RECORDER_INCLUDED_
+#define P2P_PACKET_TRACE_RECORDER_INCLUDED_
+
+#include "p2p_packet_stream.h"
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Records the ring can buffer before they are dropped. Must be a power of two.
+#define kP2PPacketTraceRingCapacity 16384
+// Time the writer thread sleeps when there is nothing to write.
+#define kP2PPacketTraceWriterPeriodNs 10'000'000
+
+// Trace files start with a P2PPacketTraceFileHeader, followed by P2PPacketTraceRecords until
+// the end of the file, all in the host's endianness.
+#define kP2PPacketTraceFileMagic 0x54503248  // "H2PT" in little endian.
+#define kP2PPacketTraceFileVersion 1
+
+// Header fields of the traced packet, in P2PPacketTraceRecord::flags.
+#define kP2PPacketTraceRequiresAck 0x01
+#define kP2PPacketTraceIsAck 0x02
+#define kP2PPacketTraceIsInit 0x04
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint32_t version;
+  // sizeof(P2PPacketTraceRecord), so that readers can check they agree on the layout.
+  uint32_t record_size;
+} P2PPacketTraceFileHeader;
+
+typedef struct __attribute__((packed)) {
+  // Time of the stream's timer.
+  uint64_t timestamp_ns;
+  uint32_t sequence_number;
+  // P2PPacketTraceEvent.
+  uint8_t event;
+  uint8_t priority;
+  uint8_t flags;
+  uint8_t reserved;
+} P2PPacketTraceRecord;
+
+// Returns the name of a P2PPacketTraceEvent, e.g. "committed".
+const char *GetP2PPacketTraceEventName(int event);
+
+// Reads all the records of the trace file in `input`. Returns false if the file is not a
+// trace, or its version or layout are not supported.
+bool ReadP2PPacketTrace(FILE *input, std::vector<P2PPacketTraceRecord> *records);
+
+// Writes the packet lifetime events of a P2P packet stream to a binary trace file, from a
+// background thread, so that tracing does not slow down the stream.
+//
+// The stream appends the events to a fixed-size lock-free single-producer ring, which the
+// writer thread drains. All calls to the traced stream must be serialized, as they must
+// anyway, e.g. with the mutex shared with the P2PActionClientHandlers. When the ring is full,
+// events are dropped and counted.
+//
+// Usage:
+//   P2PPacketTraceRecorder recorder(output);
+//   p2p_stream.packet_tracer(recorder.tracer());
+class P2PPacketTraceRecorder {
+public:
+  // Writes the file header, and starts the writer thread, which writes to `output`.
+  explicit P2PPacketTraceRecorder(FILE *output);
+  // Writes the pending records and stops the writer thread. The traced stream must not be
+  // used anymore, or its tracer must be reset first.
+  ~P2PPacketTraceRecorder();
+
+  // Tracer to pass to the stream.
+  P2PPacketTracer tracer() { return P2PPacketTracer(&P2PPacketTraceRecorder::Record, this); }
+
+  // Blocks until the records of the events before the call are written.
+  void Flush();
+
+  // Number of events dropped because the ring was full.
+  uint64_t num_dropped_records() const { return num_dropped_records_; }
+
+private:
+  static void Record(P2PPacketTraceEvent event, const P2PPacket &packet, uint64_t timestamp_ns, void *self);
+  void WriterLoop();
+  // Writes the pending records. Returns the number of records written.
+  // The caller must hold write_mutex_.
+  int WritePendingRecords();
+
+  FILE *const output_;
+
+  P2PPacketTraceRecord records_[kP2PPacketTraceRingCapacity];
+  std::atomic<uint32_t> write_index_;
+  std::atomic<uint32_t> read_index_;
+  std::atomic<uint64_t> num_dropped_records_;
+
+  // Serializes the consumers: the writer thread and Flush().
+  std::mutex write_mutex_;
+
+  std::atomic<bool> stop_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::thread writer_;
+};
+
+#endif  // P2P_PACKET_TRACE_RECORDER_INCLUDED_
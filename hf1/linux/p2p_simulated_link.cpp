@@ -0,0 +1,134 @@
+#include "p2p_simulated_link.h"
+#include "logger_interface.h"
+#include <algorithm>
+
+// Start, data and stop bits of an 8N1 UART frame.
+#define kBitsPerByte 10
+
+P2PSimulatedLink::ByteStream::ByteStream(Channel *output, Channel *input)
+  : P2PByteStreamInterface<kLittleEndian>(Handler{ .object = nullptr }), output_(*output), input_(*input) {}
+
+int P2PSimulatedLink::ByteStream::Write(const void *buffer, int length) {
+  return output_.Write(static_cast<const uint8_t *>(buffer), length);
+}
+
+int P2PSimulatedLink::ByteStream::Read(void *buffer, int length) {
+  return input_.Read(static_cast<uint8_t *>(buffer), length);
+}
+
+int P2PSimulatedLink::ByteStream::GetBurstMaxLength() {
+  return output_.config().burst_max_length;
+}
+
+int P2PSimulatedLink::ByteStream::GetBurstIngestionNanosecondsPerByte() {
+  return output_.config().burst_ingestion_ns_per_byte;
+}
+
+int P2PSimulatedLink::ByteStream::GetAtomicSendMaxLength() {
+  return output_.config().atomic_send_max_length;
+}
+
+P2PSimulatedLink::P2PSimulatedLink(TimerInterface *timer, const P2PSimulatedLinkConfig &config)
+  : a_to_b_(*ASSERT_NOT_NULL(timer), config.a_to_b, 2 * config.seed),
+    b_to_a_(*timer, config.b_to_a, 2 * config.seed + 1),
+    a_(&a_to_b_, &b_to_a_),
+    b_(&b_to_a_, &a_to_b_) {}
+
+void P2PSimulatedLink::Disconnect(uint64_t duration_ns) {
+  a_to_b_.Disconnect(duration_ns);
+  b_to_a_.Disconnect(duration_ns);
+}
+
+P2PSimulatedLink::Channel::Channel(TimerInterface &timer, const P2PSimulatedChannelConfig &config, uint32_t seed)
+  : timer_(timer),
+    config_(config),
+    byte_ns_(config.baud_rate > 0 ? kBitsPerByte * 1'000'000'000ULL / config.baud_rate : 0),
+    random_(seed),
+    uniform_(0.0, 1.0),
+    line_idle_ns_(0),
+    in_burst_(false),
+    disconnected_until_ns_(0),
+    stats_{} {
+  ASSERT(config.transmitter_fifo_size > 0);
+  ASSERT(config.receiver_fifo_size > 0);
+  ASSERT(config.mean_burst_length_bytes >= 1);
+}
+
+int P2PSimulatedLink::Channel::Write(const uint8_t *bytes, int length) {
+  const uint64_t now_ns = timer_.GetLocalNanoseconds();
+  line_idle_ns_ = std::max(line_idle_ns_, now_ns);
+  int num_accepted = length;
+  if (byte_ns_ > 0) {
+    // Bytes not fully sent yet, including the one going out.
+    const int num_queued = (line_idle_ns_ - now_ns + byte_ns_ - 1) / byte_ns_;
+    num_accepted = std::max(0, std::min(length, config_.transmitter_fifo_size - num_queued));
+  }
+  for (int i = 0; i < num_accepted; ++i) {
+    line_idle_ns_ += byte_ns_;
+    ++stats_.num_written_bytes;
+    // Draw the impairments of every byte, so that a disconnection does not change those of
+    // the following ones.
+    const bool is_dropped = Draw(config_.byte_drop_probability);
+    const uint8_t value = Corrupt(bytes[i]);
+    if (now_ns < disconnected_until_ns_) {
+      ++stats_.num_disconnected_bytes;
+    } else if (is_dropped) {
+      ++stats_.num_dropped_bytes;
+    } else {
+      if (value != bytes[i]) {
+        ++stats_.num_corrupted_bytes;
+      }
+      in_flight_.push_back(InFlightByte{ .arrival_ns = line_idle_ns_ + config_.latency_ns, .value = value });
+    }
+  }
+  return num_accepted;
+}
+
+int P2PSimulatedLink::Channel::Read(uint8_t *bytes, int length) {
+  Deliver(timer_.GetLocalNanoseconds());
+  int num_read = 0;
+  while (num_read < length && !receiver_fifo_.empty()) {
+    bytes[num_read++] = receiver_fifo_.front();
+    receiver_fifo_.pop_front();
+  }
+  stats_.num_read_bytes += num_read;
+  return num_read;
+}
+
+void P2PSimulatedLink::Channel::Disconnect(uint64_t duration_ns) {
+  const uint64_t now_ns = timer_.GetLocalNanoseconds();
+  stats_.num_disconnected_bytes += in_flight_.size() + receiver_fifo_.size();
+  in_flight_.clear();
+  receiver_fifo_.clear();
+  disconnected_until_ns_ = now_ns + duration_ns;
+}
+
+void P2PSimulatedLink::Channel::Deliver(uint64_t now_ns) {
+  // Bytes arrive in order, as the latency is constant.
+  while (!in_flight_.empty() && in_flight_.front().arrival_ns <= now_ns) {
+    if (static_cast<int>(receiver_fifo_.size()) < config_.receiver_fifo_size) {
+      receiver_fifo_.push_back(in_flight_.front().value);
+    } else {
+      ++stats_.num_overrun_bytes;
+    }
+    in_flight_.pop_front();
+  }
+}
+
+uint8_t P2PSimulatedLink::Channel::Corrupt(uint8_t value) {
+  if (in_burst_) {
+    in_burst_ = !Draw(1.0 / config_.mean_burst_length_bytes);
+  } else {
+    in_burst_ = Draw(config_.burst_start_probability);
+  }
+  const double bit_error_rate = in_burst_ ? config_.burst_bit_error_rate : config_.bit_error_rate;
+  if (bit_error_rate <= 0) {
+    return value;
+  }
+  for (int bit = 0; bit < 8; ++bit) {
+    if (Draw(bit_error_rate)) {
+      value ^= 1 << bit;
+    }
+  }
+  return value;
+}
@@ -0,0 +1,145 @@
+#ifndef P2P_SIMULATED_LINK_INCLUDED_
+#define P2P_SIMULATED_LINK_INCLUDED_
+
+#include "p2p_byte_stream_interface.h"
+#include "timer_interface.h"
+#include <stdint.h>
+#include <deque>
+#include <random>
+
+// Impairments of one direction of a P2PSimulatedLink, and the burst parameters its sender
+// reports to the packet stream.
+typedef struct {
+  // Line rate, with 10 bits per byte as in 8N1 UART framing. 0 for an infinitely fast link.
+  uint32_t baud_rate = 1'000'000;
+  // From the last bit of a byte leaving the sender to the byte reaching the receiver.
+  uint64_t latency_ns = 0;
+  // Bytes the sender buffers while they go out at the line rate. Write() accepts no more.
+  int transmitter_fifo_size = 64;
+  // Received bytes the receiver holds until they are read. Bytes arriving when it is full
+  // are lost (overrun).
+  int receiver_fifo_size = 64;
+  // Probability of each byte being lost.
+  double byte_drop_probability = 0;
+  // Probability of each bit being flipped, outside of error bursts.
+  double bit_error_rate = 0;
+  // Error bursts follow a Gilbert-Elliott model: a burst starts at each byte with
+  // `burst_start_probability`, lasts `mean_burst_length_bytes` on average (geometrically
+  // distributed), and flips each of its bits with `burst_bit_error_rate`.
+  double burst_start_probability = 0;
+  double mean_burst_length_bytes = 8;
+  double burst_bit_error_rate = 0.5;
+  // Returned by the sender's P2PByteStreamInterface getters.
+  int burst_max_length = 64;
+  int burst_ingestion_ns_per_byte = 0;
+  int atomic_send_max_length = 4;
+} P2PSimulatedChannelConfig;
+
+typedef struct {
+  P2PSimulatedChannelConfig a_to_b;
+  P2PSimulatedChannelConfig b_to_a;
+  // Seeds the impairments; links with the same config and calls behave identically.
+  uint32_t seed = 1;
+} P2PSimulatedLinkConfig;
+
+typedef struct {
+  // Accepted by Write().
+  uint64_t num_written_bytes;
+  // Returned by Read().
+  uint64_t num_read_bytes;
+  uint64_t num_dropped_bytes;
+  // Delivered with at least one bit flipped.
+  uint64_t num_corrupted_bytes;
+  // Lost because the receiver's FIFO was full.
+  uint64_t num_overrun_bytes;
+  // Lost because the link was disconnected.
+  uint64_t num_disconnected_bytes;
+} P2PSimulatedChannelStats;
+
+// In-memory point-to-point link between two byte streams, `a()` and `b()`, with the
+// bandwidth, latency, buffering and errors of a serial line.
+//
+// The link is driven by `timer`: a byte written at some time is readable at the other end
+// once it has gone out at the line rate and the latency has elapsed. With a VirtualTimer,
+// simulations run faster than real time and, given the seed, are deterministic.
+//
+// The link is not synchronized: both ends must be used from the same thread.
+class P2PSimulatedLink {
+  class Channel;
+
+public:
+  // End of the link. Writes go out through one channel and reads come from the other one.
+  class ByteStream : public P2PByteStreamInterface<kLittleEndian> {
+  public:
+    ByteStream(Channel *output, Channel *input);
+
+    int Write(const void *buffer, int length) override;
+    int Read(void *buffer, int length) override;
+    int GetBurstMaxLength() override;
+    int GetBurstIngestionNanosecondsPerByte() override;
+    int GetAtomicSendMaxLength() override;
+
+  private:
+    Channel &output_;
+    Channel &input_;
+  };
+
+  // Does not take ownership of the timer, which must outlive this object.
+  P2PSimulatedLink(TimerInterface *timer, const P2PSimulatedLinkConfig &config = P2PSimulatedLinkConfig());
+
+  ByteStream &a() { return a_; }
+  ByteStream &b() { return b_; }
+
+  // Loses all bytes in flight or waiting to be read, and those written in the next
+  // `duration_ns`, as if the cable was unplugged and plugged back.
+  void Disconnect(uint64_t duration_ns);
+
+  const P2PSimulatedChannelStats &a_to_b_stats() const { return a_to_b_.stats(); }
+  const P2PSimulatedChannelStats &b_to_a_stats() const { return b_to_a_.stats(); }
+
+private:
+  // One direction of the link.
+  class Channel {
+  public:
+    Channel(TimerInterface &timer, const P2PSimulatedChannelConfig &config, uint32_t seed);
+
+    int Write(const uint8_t *bytes, int length);
+    int Read(uint8_t *bytes, int length);
+    void Disconnect(uint64_t duration_ns);
+
+    const P2PSimulatedChannelConfig &config() const { return config_; }
+    const P2PSimulatedChannelStats &stats() const { return stats_; }
+
+  private:
+    typedef struct {
+      uint64_t arrival_ns;
+      uint8_t value;
+    } InFlightByte;
+
+    // Moves the bytes that arrived by `now_ns` to the receiver's FIFO.
+    void Deliver(uint64_t now_ns);
+    // Returns the byte as the receiver gets it.
+    uint8_t Corrupt(uint8_t value);
+    bool Draw(double probability) { return probability > 0 && uniform_(random_) < probability; }
+
+    TimerInterface &timer_;
+    const P2PSimulatedChannelConfig config_;
+    const uint64_t byte_ns_;
+    std::mt19937 random_;
+    std::uniform_real_distribution<double> uniform_;
+    std::deque<InFlightByte> in_flight_;
+    std::deque<uint8_t> receiver_fifo_;
+    // When the sender finishes sending the bytes written so far.
+    uint64_t line_idle_ns_;
+    bool in_burst_;
+    uint64_t disconnected_until_ns_;
+    P2PSimulatedChannelStats stats_;
+  };
+
+  Channel a_to_b_;
+  Channel b_to_a_;
+  ByteStream a_;
+  ByteStream b_;
+};
+
+#endif  // P2P_SIMULATED_LINK_INCLUDED_
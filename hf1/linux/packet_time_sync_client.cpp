@@ -0,0 +1,172 @@
+#include "packet_time_sync_client.h"
+#include "network.h"
+#include "logger_interface.h"
+
+// Exchanges whose minimum-delay sample is kept in each round.
+#define kTimeSyncExchangesPerRound 8
+// Time between consecutive exchanges of a round, so that they do not queue behind each other.
+#define kTimeBetweenExchangesNs 2'000'000ULL
+// Maximum time to wait for each reply. Lost replies are retried.
+#define kMaxReplyDelayNs 100'000'000ULL
+#define kMaxLostRepliesPerRound 4
+// Maximum time to complete a round, e.g. if the output queue is saturated.
+#define kMaxRoundDurationNs 2'000'000'000ULL
+// New models that would move the global time backwards by more than this request the
+// Arduino to advance its global time instead. Smaller corrections are applied as they are.
+#define kMaxGlobalTimeBackStepNs 1'000'000ULL
+
+PacketTimeSyncClient::PacketTimeSyncClient(SyncTimeActionClientHandler *sync_action_handler, TimerInterface *system_timer)
+  : sync_action_handler_(*ASSERT_NOT_NULL(sync_action_handler)),
+    system_timer_(*ASSERT_NOT_NULL(system_timer)),
+    state_(kIdle),
+    sync_requested_(false),
+    last_sync_status_(kNotAttempted),
+    num_exchanges_(0),
+    num_lost_replies_(0),
+    round_start_local_ns_(0),
+    request_sent_local_ns_(0),
+    reply_received_local_ns_(0),
+    pending_advance_global_ns_(0),
+    advance_in_flight_(false) {}
+
+void PacketTimeSyncClient::RequestTimeSync() {
+  sync_requested_ = true;
+}
+
+void PacketTimeSyncClient::OnReply(const P2PSyncTimeReply &reply) {
+  // Called while dispatching the reply packet, so its reception time is available.
+  std::lock_guard<std::mutex> guard(reply_mutex_);
+  reply_ = TimestampedReply{reply, sync_action_handler_.packet_reception_local_time_ns()};
+}
+
+void PacketTimeSyncClient::Fail() {
+  sync_requested_ = false;
+  state_ = kIdle;
+  last_sync_status_ = kError;
+}
+
+void PacketTimeSyncClient::Run() {
+  const uint64_t now_ns = system_timer_.GetLocalNanoseconds();
+  if (state_ != kIdle && now_ns - round_start_local_ns_ > kMaxRoundDurationNs) {
+    LOG_ERROR("Time synchronization round timed out.");
+    sync_action_handler_.Cancel();
+    Fail();
+    return;
+  }
+
+  switch (state_) {
+    case kIdle:
+      if (sync_requested_) {
+        num_exchanges_ = 0;
+        num_lost_replies_ = 0;
+        round_start_local_ns_ = now_ns;
+        last_sync_status_ = kInProgress;
+        state_ = kSendRequest;
+      }
+      break;
+
+    case kSendRequest: {
+      {
+        std::lock_guard<std::mutex> guard(reply_mutex_);
+        reply_ = std::nullopt;
+      }
+      P2PSyncTimeRequest request = {};
+      request.mode = kTimeSyncTwoWay;
+      request.advance_global_ns = LocalToNetwork<kP2PLocalEndianness>(pending_advance_global_ns_);
+      // Stamp right before queueing the request.
+      request_sent_local_ns_ = system_timer_.GetLocalNanoseconds();
+      const Status status = sync_action_handler_.Request(request,
+        [this](const P2PSyncTimeRequest &, const P2PSyncTimeReply &reply) { OnReply(reply); },
+        [](const P2PSyncTimeRequest &, const P2PVoid &) {});
+      if (status == kSuccess) {
+        advance_in_flight_ = pending_advance_global_ns_ > 0;
+        state_ = kWaitForReply;
+      }
+      // Otherwise, retry in the next call.
+      break;
+    }
+
+    case kWaitForReply: {
+      std::optional<TimestampedReply> reply;
+      {
+        std::lock_guard<std::mutex> guard(reply_mutex_);
+        reply = reply_;
+      }
+      if (!reply.has_value()) {
+        if (now_ns - request_sent_local_ns_ > kMaxReplyDelayNs) {
+          // The request or the reply was lost.
+          sync_action_handler_.Cancel();
+          if (advance_in_flight_) {
+            // The Arduino may have advanced its global time or not: start the round over,
+            // which will find out.
+            estimator_.Reset();
+            pending_advance_global_ns_ = 0;
+            advance_in_flight_ = false;
+            num_exchanges_ = 0;
+          }
+          if (++num_lost_replies_ > kMaxLostRepliesPerRound) {
+            LOG_ERROR("Too many lost time synchronization replies.");
+            Fail();
+          } else {
+            state_ = kSendRequest;
+          }
+        }
+        break;
+      }
+
+      if (advance_in_flight_) {
+        // The Arduino's global time moved: older samples no longer apply.
+        estimator_.Reset();
+        pending_advance_global_ns_ = 0;
+        advance_in_flight_ = false;
+      }
+      TimeSyncExchange exchange;
+      exchange.request_transmission_local_ns = request_sent_local_ns_;
+      exchange.request_reception_remote_ns = NetworkToLocal<kP2PLocalEndianness>(reply->reply.request_reception_global_ns);
+      exchange.reply_transmission_remote_ns = NetworkToLocal<kP2PLocalEndianness>(reply->reply.reply_transmission_global_ns);
+      exchange.reply_reception_local_ns = reply->reception_local_ns;
+      if (estimator_.AddExchange(exchange) != kSuccess) {
+        LOG_WARNING("Inconsistent time synchronization timestamps.");
+      }
+      reply_received_local_ns_ = now_ns;
+      if (++num_exchanges_ < kTimeSyncExchangesPerRound) {
+        state_ = kWaitForNextExchange;
+      } else {
+        FinishRound();
+      }
+      break;
+    }
+
+    case kWaitForNextExchange:
+      if (now_ns - reply_received_local_ns_ >= kTimeBetweenExchangesNs) {
+        state_ = kSendRequest;
+      }
+      break;
+  }
+}
+
+void PacketTimeSyncClient::FinishRound() {
+  if (estimator_.EndRound() != kSuccess) {
+    LOG_ERROR("No valid time synchronization exchanges.");
+    Fail();
+    return;
+  }
+
+  const uint64_t now_ns = system_timer_.GetLocalNanoseconds();
+  const uint64_t current_global_ns = system_timer_.GetGlobalNanoseconds();
+  const uint64_t arduino_global_ns = estimator_.LocalToRemoteNanoseconds(now_ns);
+  if (static_cast<int64_t>(current_global_ns - arduino_global_ns) > static_cast<int64_t>(kMaxGlobalTimeBackStepNs)) {
+    // The Arduino is behind: have it catch up, and start over.
+    pending_advance_global_ns_ = current_global_ns - arduino_global_ns;
+    num_exchanges_ = 0;
+    state_ = kSendRequest;
+    return;
+  }
+
+  // From now on, the global time follows the Arduino's.
+  system_timer_.global_offset_nanoseconds() = static_cast<uint64_t>(estimator_.offset_ns());
+  system_timer_.SetGlobalSkew(estimator_.skew(), estimator_.reference_local_ns());
+  sync_requested_ = false;
+  state_ = kIdle;
+  last_sync_status_ = kOk;
+}
@@ -0,0 +1,80 @@
+#ifndef PACKET_TIME_SYNC_CLIENT_INCLUDED_
+#define PACKET_TIME_SYNC_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "timer_interface.h"
+#include "time_sync_estimator.h"
+#include <mutex>
+#include <atomic>
+#include <optional>
+
+// Synchronizes the global time with the Arduino with NTP-like exchanges of timestamped
+// packets, over any byte stream.
+//
+// Each synchronization is a round of kTimeSyncExchangesPerRound exchanges, whose
+// minimum-delay sample updates an offset and skew model of the Arduino's global time (see
+// TimeSyncEstimator). The model is then set as the global time of the system timer, which
+// stays accurate between synchronizations, so these can be rare.
+//
+// As with the GPIO edge synchronization, only the clock that is behind is advanced: if the
+// Arduino's global time is behind this end's, the Arduino is requested to advance it.
+class PacketTimeSyncClient {
+public:
+  using SyncTimeActionClientHandler = P2PActionClientHandler<P2PSyncTimeRequest, P2PSyncTimeReply, P2PVoid>;
+
+  // Does not take ownsership of the pointees, which must outlive this object.
+  PacketTimeSyncClient(SyncTimeActionClientHandler *sync_action_handler, TimerInterface *system_timer);
+
+  // Starts a synchronization round, if none is in progress.
+  void RequestTimeSync();
+
+  // Runs the client logic. Must be called periodically from a single thread, without the
+  // P2P mutex locked.
+  void Run();
+
+  using SyncStatus = enum {
+    kNotAttempted,
+    kInProgress,
+    kOk,
+    kError
+  };
+  bool sync_in_progress() const { return last_sync_status_ == kInProgress; }
+  SyncStatus last_sync_status() const { return last_sync_status_; }
+
+  // Model of the last synchronization. Only valid in the thread that calls Run().
+  const TimeSyncEstimator &estimator() const { return estimator_; }
+
+private:
+  typedef struct {
+    P2PSyncTimeReply reply;
+    uint64_t reception_local_ns;
+  } TimestampedReply;
+
+  void OnReply(const P2PSyncTimeReply &reply);
+  void FinishRound();
+  void Fail();
+
+  SyncTimeActionClientHandler &sync_action_handler_;
+  TimerInterface &system_timer_;
+  TimeSyncEstimator estimator_;
+
+  enum State { kIdle, kSendRequest, kWaitForReply, kWaitForNextExchange };
+  State state_;
+  std::atomic<bool> sync_requested_;
+  std::atomic<SyncStatus> last_sync_status_;
+  int num_exchanges_;
+  int num_lost_replies_;
+  uint64_t round_start_local_ns_;
+  uint64_t request_sent_local_ns_;
+  uint64_t reply_received_local_ns_;
+  // Global time the Arduino must advance with the next request.
+  uint64_t pending_advance_global_ns_;
+  // The Arduino advanced its global time with the request in flight.
+  bool advance_in_flight_;
+
+  // Protects reply_, which the reply callback sets from the P2P thread.
+  std::mutex reply_mutex_;
+  std::optional<TimestampedReply> reply_;
+};
+
+#endif  // PACKET_TIME_SYNC_CLIENT_INCLUDED_
@@ -0,0 +1,133 @@
+#include "periodic_runnable_stats_client.h"
+#include "log_histogram.h"
+#include "network.h"
+#include <sstream>
+#include <iomanip>
+#include <string.h>
+
+// Maximum time to wait for the reply to each request. The other end may have restarted.
+#define kMaxReplyDelayNs 500'000'000ULL
+
+typedef LogHistogram<kP2PPeriodicRunnablePeriodErrorHistogramNumBuckets, kP2PPeriodicRunnablePeriodErrorHistogramMinBucketLog2> PeriodErrorHistogram;
+typedef LogHistogram<kP2PPeriodicRunnableRunHistogramNumBuckets, kP2PPeriodicRunnableRunHistogramMinBucketLog2> RunHistogram;
+
+PeriodicRunnableStatsClient::PeriodicRunnableStatsClient(GetPeriodicRunnableStatsActionClientHandler *action_handler, TimerInterface *system_timer)
+  : action_handler_(*ASSERT_NOT_NULL(action_handler)),
+    system_timer_(*ASSERT_NOT_NULL(system_timer)),
+    state_(kIdle),
+    last_snapshot_status_(kDoesNotExistError),
+    reset_(false),
+    next_index_(0),
+    request_sent_timestamp_ns_(0) {}
+
+Status PeriodicRunnableStatsClient::RequestSnapshot(bool reset) {
+  State expected = kIdle;
+  if (!state_.compare_exchange_strong(expected, kSendRequest)) {
+    return kExistsError;
+  }
+  reset_ = reset;
+  next_index_ = 0;
+  pending_snapshot_.clear();
+  return kSuccess;
+}
+
+void PeriodicRunnableStatsClient::Run() {
+  switch (state_) {
+    case kIdle:
+      break;
+
+    case kSendRequest: {
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply_ = std::nullopt;
+      }
+      P2PGetPeriodicRunnableStatsRequest request;
+      request.index = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(next_index_));
+      request.reset = reset_ ? 1 : 0;
+      const Status status = action_handler_.Request(request,
+        [this](const P2PGetPeriodicRunnableStatsRequest &, const P2PGetPeriodicRunnableStatsReply &reply) { OnReply(reply); },
+        [](const P2PGetPeriodicRunnableStatsRequest &, const P2PVoid &) {});
+      if (status == kSuccess) {
+        request_sent_timestamp_ns_ = system_timer_.GetLocalNanoseconds();
+        state_ = kWaitForReply;
+      }
+      // Otherwise, retry in the next call.
+      break;
+    }
+
+    case kWaitForReply: {
+      std::optional<P2PGetPeriodicRunnableStatsReply> reply;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply = reply_;
+      }
+      if (!reply.has_value()) {
+        if (system_timer_.GetLocalNanoseconds() - request_sent_timestamp_ns_ > kMaxReplyDelayNs) {
+          action_handler_.Cancel();
+          FinishSnapshot(kUnavailableError);
+        }
+        break;
+      }
+      const Status status = static_cast<Status>(NetworkToLocal<kP2PLocalEndianness>(reply->status_code));
+      if (status != kSuccess) {
+        FinishSnapshot(status);
+        break;
+      }
+      pending_snapshot_.push_back(*reply);
+      ++next_index_;
+      if (next_index_ >= NetworkToLocal<kP2PLocalEndianness>(reply->num_runnables)) {
+        FinishSnapshot(kSuccess);
+      } else {
+        state_ = kSendRequest;
+      }
+      break;
+    }
+  }
+}
+
+std::vector<P2PGetPeriodicRunnableStatsReply> PeriodicRunnableStatsClient::snapshot() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return snapshot_;
+}
+
+void PeriodicRunnableStatsClient::OnReply(const P2PGetPeriodicRunnableStatsReply &reply) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  reply_ = reply;
+}
+
+void PeriodicRunnableStatsClient::FinishSnapshot(Status status) {
+  if (status == kSuccess) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    snapshot_ = pending_snapshot_;
+  }
+  last_snapshot_status_ = status;
+  state_ = kIdle;
+}
+
+template<typename THistogram> static THistogram HistogramFromNetwork(const uint32_t *network_counts, uint32_t network_max_value) {
+  uint32_t counts[THistogram::num_buckets()];
+  for (int i = 0; i < THistogram::num_buckets(); ++i) {
+    counts[i] = NetworkToLocal<kP2PLocalEndianness>(network_counts[i]);
+  }
+  return THistogram::FromCounts(counts, NetworkToLocal<kP2PLocalEndianness>(network_max_value));
+}
+
+std::string PeriodicRunnableStatsClient::Format(const P2PGetPeriodicRunnableStatsReply &stats) {
+  const PeriodErrorHistogram period_error = HistogramFromNetwork<PeriodErrorHistogram>(stats.period_error_histogram, stats.max_period_error_nanos);
+  const RunHistogram run = HistogramFromNetwork<RunHistogram>(stats.run_histogram, stats.max_run_nanos);
+  // Percentiles are bucket upper bounds, so they are rounded up to powers of two.
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  oss << std::string(stats.name, strnlen(stats.name, sizeof(stats.name)))
+      << " period:" << NetworkToLocal<kP2PLocalEndianness>(stats.period_nanos) * 1e-6 << "ms"
+      << " runs:" << NetworkToLocal<kP2PLocalEndianness>(stats.num_runs)
+      << " overruns:" << NetworkToLocal<kP2PLocalEndianness>(stats.num_overruns)
+      << " skipped:" << NetworkToLocal<kP2PLocalEndianness>(stats.num_skipped_periods)
+      << " period_error(p50<=" << period_error.Percentile(0.5f) * 1e-3
+      << " p99<=" << period_error.Percentile(0.99f) * 1e-3
+      << " max=" << period_error.max_value() * 1e-3 << ")us"
+      << " run(p50<=" << run.Percentile(0.5f) * 1e-3
+      << " p99<=" << run.Percentile(0.99f) * 1e-3
+      << " max=" << run.max_value() * 1e-3 << ")us";
+  return oss.str();
+}
@@ -0,0 +1,60 @@
+#ifndef PERIODIC_RUNNABLE_STATS_CLIENT_INCLUDED_
+#define PERIODIC_RUNNABLE_STATS_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "timer_interface.h"
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Fetches the timing stats of all instrumented periodic runnables of the Arduino, one
+// request per runnable.
+class PeriodicRunnableStatsClient {
+public:
+  using GetPeriodicRunnableStatsActionClientHandler = P2PActionClientHandler<P2PGetPeriodicRunnableStatsRequest, P2PGetPeriodicRunnableStatsReply, P2PVoid>;
+
+  // Does not take ownsership of the pointees, which must outlive this object.
+  PeriodicRunnableStatsClient(GetPeriodicRunnableStatsActionClientHandler *action_handler, TimerInterface *system_timer);
+
+  // Starts fetching a snapshot of the stats. If `reset` is true, the Arduino clears the
+  // stats of each runnable after sending them.
+  // Returns kExistsError if a snapshot is already being fetched.
+  Status RequestSnapshot(bool reset);
+
+  // Runs the client logic. Must be called periodically from a single thread, without the
+  // P2P mutex locked.
+  void Run();
+
+  bool snapshot_in_progress() const { return state_ != kIdle; }
+  // Status of the last snapshot request; kUnavailableError if it timed out.
+  Status last_snapshot_status() const { return last_snapshot_status_; }
+  // The last complete snapshot, one entry per runnable.
+  std::vector<P2PGetPeriodicRunnableStatsReply> snapshot();
+
+  // Formats the stats of one runnable in a single line, e.g. for logging.
+  static std::string Format(const P2PGetPeriodicRunnableStatsReply &stats);
+
+private:
+  void OnReply(const P2PGetPeriodicRunnableStatsReply &reply);
+  void FinishSnapshot(Status status);
+
+  GetPeriodicRunnableStatsActionClientHandler &action_handler_;
+  TimerInterface &system_timer_;
+
+  enum State { kIdle, kSendRequest, kWaitForReply };
+  std::atomic<State> state_;
+  std::atomic<Status> last_snapshot_status_;
+  bool reset_;
+  int next_index_;
+  uint64_t request_sent_timestamp_ns_;
+  std::vector<P2PGetPeriodicRunnableStatsReply> pending_snapshot_;
+
+  // Protects the members below, which the reply callback accesses from the P2P thread.
+  std::mutex mutex_;
+  std::optional<P2PGetPeriodicRunnableStatsReply> reply_;
+  std::vector<P2PGetPeriodicRunnableStatsReply> snapshot_;
+};
+
+#endif  // PERIODIC_RUNNABLE_STATS_CLIENT_INCLUDED_
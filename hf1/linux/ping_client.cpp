@@ -0,0 +1,53 @@
+#include "ping_client.h"
+#include <stddef.h>
+
+#define kRequestPayloadOffset offsetof(P2PPingRequest, payload)
+#define kReplyPayloadOffset offsetof(P2PPingReply, payload)
+
+// The payload is derived from the send time, so that replies can be checked without keeping
+// the requests. Bytes stay below the lowest token, as the protocol requires.
+static uint8_t PayloadByte(uint64_t send_ns, int index) {
+  return (send_ns + index) % kP2PLowestToken;
+}
+
+Status PingClient::Ping(int payload_length, P2PPriority priority, bool guarantee_delivery) {
+  ASSERT(payload_length >= 0 && payload_length <= kP2PMaxPingPayloadLength);
+  P2PPingRequest request;
+  const uint64_t send_ns = system_timer_.GetLocalNanoseconds();
+  request.client_send_ns = LocalToNetwork<kP2PLocalEndianness>(send_ns);
+  request.guarantee_reply_delivery = guarantee_delivery;
+  for (int i = 0; i < payload_length; ++i) {
+    request.payload[i] = PayloadByte(send_ns, i);
+  }
+  return Request(kRequestPayloadOffset + payload_length, &request, priority, guarantee_delivery);
+}
+
+void PingClient::TakeResults(std::vector<Result> *results) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  results->insert(results->end(), results_.begin(), results_.end());
+  results_.clear();
+}
+
+void PingClient::OnReply(int payload_length, const void *payload) {
+  P2PActionClientHandlerBase::OnReply(payload_length, payload);
+  if (payload_length < static_cast<int>(kReplyPayloadOffset)) {
+    LOG_ERROR("Malformed ping reply.");
+    ++num_malformed_replies_;
+    return;
+  }
+  const auto &reply = *reinterpret_cast<const P2PPingReply *>(payload);
+  const uint64_t send_ns = NetworkToLocal<kP2PLocalEndianness>(reply.client_send_ns);
+  for (int i = 0; i < payload_length - static_cast<int>(kReplyPayloadOffset); ++i) {
+    if (reply.payload[i] != PayloadByte(send_ns, i)) {
+      LOG_ERROR("Ping reply with a different payload.");
+      ++num_malformed_replies_;
+      return;
+    }
+  }
+  Result result;
+  result.send_ns = send_ns;
+  result.round_trip_ns = packet_reception_local_time_ns() - send_ns;
+  result.server_processing_ns = NetworkToLocal<kP2PLocalEndianness>(reply.server_transmit_ns) - NetworkToLocal<kP2PLocalEndianness>(reply.server_receive_ns);
+  std::lock_guard<std::mutex> guard(mutex_);
+  results_.push_back(result);
+}
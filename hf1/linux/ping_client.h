@@ -0,0 +1,51 @@
+#ifndef PING_CLIENT_INCLUDED_
+#define PING_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "timer_interface.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Measures the round trip time of the P2P link with ping requests, several of which may be
+// in flight, and the time the Arduino took to reply to each of them.
+class PingClient : public P2PActionClientHandlerBase {
+public:
+  typedef struct {
+    // Local time at which the request was sent.
+    uint64_t send_ns;
+    uint64_t round_trip_ns;
+    // From the reception of the request to the commit of the reply, in the Arduino.
+    uint64_t server_processing_ns;
+  } Result;
+
+  // Does not take ownsership of the pointees, which must outlive this object.
+  // `system_timer` must be the P2P stream's, which timestamps the received packets.
+  PingClient(P2PPacketStreamLinux *p2p_stream, std::mutex *p2p_mutex, const TimerInterface *system_timer)
+    : P2PActionClientHandlerBase(P2PAction::kPing, P2PPriority::kMedium, /*default_guarantee_delivery=*/false, p2p_stream, p2p_mutex, /*allows_concurrent_requests=*/true),
+      system_timer_(*ASSERT_NOT_NULL(system_timer)), num_malformed_replies_(0) {}
+
+  // Sends a ping with `payload_length` bytes of payload, up to kP2PMaxPingPayloadLength.
+  // `guarantee_delivery` applies to both the request and the reply.
+  // Returns kUnavailableError if there are no P2P packet slots available.
+  Status Ping(int payload_length, P2PPriority priority, bool guarantee_delivery);
+
+  // Moves the results of the replies received since the previous call to `results`.
+  void TakeResults(std::vector<Result> *results);
+
+  // Replies which payload is not the one sent.
+  int num_malformed_replies() const { return num_malformed_replies_; }
+
+protected:
+  void OnReply(int payload_length, const void *payload) override;
+
+private:
+  const TimerInterface &system_timer_;
+  std::atomic<int> num_malformed_replies_;
+
+  // Protects the results, which OnReply() adds from the P2P thread.
+  std::mutex mutex_;
+  std::vector<Result> results_;
+};
+
+#endif  // PING_CLIENT_INCLUDED_
@@ -0,0 +1,137 @@
+#include "profiler_client.h"
+#include "network.h"
+#include <sstream>
+#include <iomanip>
+#include <string.h>
+
+// Maximum time to wait for the reply to each request. The other end may have restarted.
+#define kMaxReplyDelayNs 500'000'000ULL
+
+ProfilerClient::ProfilerClient(GetProfilerSectionsActionClientHandler *action_handler, TimerInterface *system_timer)
+  : action_handler_(*ASSERT_NOT_NULL(action_handler)),
+    system_timer_(*ASSERT_NOT_NULL(system_timer)),
+    state_(kIdle),
+    last_request_status_(kDoesNotExistError),
+    reset_(false),
+    next_index_(0),
+    request_sent_timestamp_ns_(0) {}
+
+Status ProfilerClient::RequestSections(bool reset) {
+  State expected = kIdle;
+  if (!state_.compare_exchange_strong(expected, kSendRequest)) {
+    return kExistsError;
+  }
+  reset_ = reset;
+  next_index_ = 0;
+  pending_sections_.clear();
+  return kSuccess;
+}
+
+void ProfilerClient::Run() {
+  switch (state_) {
+    case kIdle:
+      break;
+
+    case kSendRequest: {
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply_ = std::nullopt;
+      }
+      P2PGetProfilerSectionsRequest request;
+      request.first_index = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(next_index_));
+      request.reset = reset_ ? 1 : 0;
+      const Status status = action_handler_.Request(request,
+        [this](const P2PGetProfilerSectionsRequest &, const P2PGetProfilerSectionsReply &reply) { OnReply(reply); },
+        [](const P2PGetProfilerSectionsRequest &, const P2PVoid &) {});
+      if (status == kSuccess) {
+        request_sent_timestamp_ns_ = system_timer_.GetLocalNanoseconds();
+        state_ = kWaitForReply;
+      }
+      // Otherwise, retry in the next call.
+      break;
+    }
+
+    case kWaitForReply: {
+      std::optional<P2PGetProfilerSectionsReply> reply;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply = reply_;
+      }
+      if (!reply.has_value()) {
+        if (system_timer_.GetLocalNanoseconds() - request_sent_timestamp_ns_ > kMaxReplyDelayNs) {
+          action_handler_.Cancel();
+          FinishRequest(kUnavailableError);
+        }
+        break;
+      }
+      const Status status = static_cast<Status>(NetworkToLocal<kP2PLocalEndianness>(reply->status_code));
+      const int num_sections = NetworkToLocal<kP2PLocalEndianness>(reply->num_sections);
+      if (status == kDoesNotExistError && next_index_ == 0 && num_sections == 0) {
+        // No section has run yet.
+        FinishRequest(kSuccess);
+        break;
+      }
+      if (status != kSuccess) {
+        FinishRequest(status);
+        break;
+      }
+      const double seconds_per_cycle = 1.0 / NetworkToLocal<kP2PLocalEndianness>(reply->cycles_per_second);
+      const int num_returned_sections = std::min<int>(NetworkToLocal<kP2PLocalEndianness>(reply->num_returned_sections), kP2PMaxProfilerSectionsPerReply);
+      for (int i = 0; i < num_returned_sections; ++i) {
+        const P2PProfilerSection &reply_section = reply->sections[i];
+        Section section;
+        section.name = std::string(reply_section.name, strnlen(reply_section.name, sizeof(reply_section.name)));
+        section.count = NetworkToLocal<kP2PLocalEndianness>(reply_section.count);
+        section.min_seconds = NetworkToLocal<kP2PLocalEndianness>(reply_section.min_cycles) * seconds_per_cycle;
+        section.max_seconds = NetworkToLocal<kP2PLocalEndianness>(reply_section.max_cycles) * seconds_per_cycle;
+        section.total_seconds = NetworkToLocal<kP2PLocalEndianness>(reply_section.total_cycles) * seconds_per_cycle;
+        section.mean_seconds = section.count > 0 ? section.total_seconds / section.count : 0;
+        pending_sections_.push_back(section);
+      }
+      next_index_ += num_returned_sections;
+      if (num_returned_sections == 0 || next_index_ >= num_sections) {
+        FinishRequest(kSuccess);
+      } else {
+        state_ = kSendRequest;
+      }
+      break;
+    }
+  }
+}
+
+std::vector<ProfilerClient::Section> ProfilerClient::sections() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return sections_;
+}
+
+void ProfilerClient::OnReply(const P2PGetProfilerSectionsReply &reply) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  reply_ = reply;
+}
+
+void ProfilerClient::FinishRequest(Status status) {
+  if (status == kSuccess) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    sections_ = pending_sections_;
+  }
+  last_request_status_ = status;
+  state_ = kIdle;
+}
+
+std::string ProfilerClient::Format(const std::vector<Section> &sections) {
+  std::ostringstream oss;
+  oss << std::left << std::setw(kP2PMaxProfilerSectionNameLength) << "section" << std::right
+      << std::setw(10) << "count" 
+      << std::setw(12) << "min[us]" << std::setw(12) << "mean[us]" << std::setw(12) << "max[us]" 
+      << std::setw(12) << "total[ms]" << "\n";
+  oss << std::fixed;
+  for (const Section &section : sections) {
+    oss << std::left << std::setw(kP2PMaxProfilerSectionNameLength) << section.name << std::right
+        << std::setw(10) << section.count << std::setprecision(2)
+        << std::setw(12) << section.min_seconds * 1e6
+        << std::setw(12) << section.mean_seconds * 1e6
+        << std::setw(12) << section.max_seconds * 1e6
+        << std::setw(12) << section.total_seconds * 1e3 << "\n";
+  }
+  return oss.str();
+}
@@ -0,0 +1,69 @@
+#ifndef PROFILER_CLIENT_INCLUDED_
+#define PROFILER_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "timer_interface.h"
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Fetches the table of profiler sections of the Arduino (see PROFILE_SCOPE), a few sections
+// per request.
+class ProfilerClient {
+public:
+  using GetProfilerSectionsActionClientHandler = P2PActionClientHandler<P2PGetProfilerSectionsRequest, P2PGetProfilerSectionsReply, P2PVoid>;
+
+  struct Section {
+    std::string name;
+    uint32_t count;
+    double min_seconds;
+    double max_seconds;
+    double mean_seconds;
+    double total_seconds;
+  };
+
+  // Does not take ownsership of the pointees, which must outlive this object.
+  ProfilerClient(GetProfilerSectionsActionClientHandler *action_handler, TimerInterface *system_timer);
+
+  // Starts fetching the table. If `reset` is true, the Arduino clears the sections after
+  // sending them.
+  // Returns kExistsError if the table is already being fetched.
+  Status RequestSections(bool reset);
+
+  // Runs the client logic. Must be called periodically from a single thread, without the
+  // P2P mutex locked.
+  void Run();
+
+  bool request_in_progress() const { return state_ != kIdle; }
+  // Status of the last request; kUnavailableError if it timed out.
+  Status last_request_status() const { return last_request_status_; }
+  // The last complete table.
+  std::vector<Section> sections();
+
+  // Formats `sections` as a table, one row per section.
+  static std::string Format(const std::vector<Section> &sections);
+
+private:
+  void OnReply(const P2PGetProfilerSectionsReply &reply);
+  void FinishRequest(Status status);
+
+  GetProfilerSectionsActionClientHandler &action_handler_;
+  TimerInterface &system_timer_;
+
+  enum State { kIdle, kSendRequest, kWaitForReply };
+  std::atomic<State> state_;
+  std::atomic<Status> last_request_status_;
+  bool reset_;
+  int next_index_;
+  uint64_t request_sent_timestamp_ns_;
+  std::vector<Section> pending_sections_;
+
+  // Protects the members below, which the reply callback accesses from the P2P thread.
+  std::mutex mutex_;
+  std::optional<P2PGetProfilerSectionsReply> reply_;
+  std::vector<Section> sections_;
+};
+
+#endif  // PROFILER_CLIENT_INCLUDED_
@@ -0,0 +1,123 @@
+#include "ring_buffer_stats_client.h"
+#include "network.h"
+#include <sstream>
+#include <iomanip>
+#include <string.h>
+
+// Maximum time to wait for the reply to each request. The other end may have restarted.
+#define kMaxReplyDelayNs 500'000'000ULL
+
+RingBufferStatsClient::RingBufferStatsClient(GetRingBufferStatsActionClientHandler *action_handler, TimerInterface *system_timer)
+  : action_handler_(*ASSERT_NOT_NULL(action_handler)),
+    system_timer_(*ASSERT_NOT_NULL(system_timer)),
+    state_(kIdle),
+    last_snapshot_status_(kDoesNotExistError),
+    reset_(false),
+    next_index_(0),
+    request_sent_timestamp_ns_(0) {}
+
+Status RingBufferStatsClient::RequestSnapshot(bool reset) {
+  State expected = kIdle;
+  if (!state_.compare_exchange_strong(expected, kSendRequest)) {
+    return kExistsError;
+  }
+  reset_ = reset;
+  next_index_ = 0;
+  pending_snapshot_.clear();
+  return kSuccess;
+}
+
+void RingBufferStatsClient::Run() {
+  switch (state_) {
+    case kIdle:
+      break;
+
+    case kSendRequest: {
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply_ = std::nullopt;
+      }
+      P2PGetRingBufferStatsRequest request;
+      request.index = LocalToNetwork<kP2PLocalEndianness>(static_cast<uint8_t>(next_index_));
+      request.reset = reset_ ? 1 : 0;
+      const Status status = action_handler_.Request(request,
+        [this](const P2PGetRingBufferStatsRequest &, const P2PGetRingBufferStatsReply &reply) { OnReply(reply); },
+        [](const P2PGetRingBufferStatsRequest &, const P2PVoid &) {});
+      if (status == kSuccess) {
+        request_sent_timestamp_ns_ = system_timer_.GetLocalNanoseconds();
+        state_ = kWaitForReply;
+      }
+      // Otherwise, retry in the next call.
+      break;
+    }
+
+    case kWaitForReply: {
+      std::optional<P2PGetRingBufferStatsReply> reply;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        reply = reply_;
+      }
+      if (!reply.has_value()) {
+        if (system_timer_.GetLocalNanoseconds() - request_sent_timestamp_ns_ > kMaxReplyDelayNs) {
+          action_handler_.Cancel();
+          FinishSnapshot(kUnavailableError);
+        }
+        break;
+      }
+      const Status status = static_cast<Status>(NetworkToLocal<kP2PLocalEndianness>(reply->status_code));
+      if (status != kSuccess) {
+        FinishSnapshot(status);
+        break;
+      }
+      pending_snapshot_.push_back(*reply);
+      ++next_index_;
+      if (next_index_ >= NetworkToLocal<kP2PLocalEndianness>(reply->num_buffers)) {
+        FinishSnapshot(kSuccess);
+      } else {
+        state_ = kSendRequest;
+      }
+      break;
+    }
+  }
+}
+
+std::vector<P2PGetRingBufferStatsReply> RingBufferStatsClient::snapshot() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return snapshot_;
+}
+
+void RingBufferStatsClient::OnReply(const P2PGetRingBufferStatsReply &reply) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  reply_ = reply;
+}
+
+void RingBufferStatsClient::FinishSnapshot(Status status) {
+  if (status == kSuccess) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    snapshot_ = pending_snapshot_;
+  }
+  last_snapshot_status_ = status;
+  state_ = kIdle;
+}
+
+std::string RingBufferStatsClient::Format(const std::vector<P2PGetRingBufferStatsReply> &snapshot) {
+  std::ostringstream oss;
+  oss << std::left << std::setw(kP2PMaxRingBufferNameLength) << "buffer" << std::right
+      << std::setw(10) << "capacity" << std::setw(10) << "max" << std::setw(10) << "mean"
+      << std::setw(12) << "overwrites" << std::setw(12) << "period[s]" << "\n";
+  oss << std::fixed;
+  for (const P2PGetRingBufferStatsReply &stats : snapshot) {
+    const uint64_t occupancy_cycles = NetworkToLocal<kP2PLocalEndianness>(stats.occupancy_cycles);
+    const uint64_t elapsed_cycles = NetworkToLocal<kP2PLocalEndianness>(stats.elapsed_cycles);
+    const uint32_t cycles_per_second = NetworkToLocal<kP2PLocalEndianness>(stats.cycles_per_second);
+    oss << std::left << std::setw(kP2PMaxRingBufferNameLength) << std::string(stats.name, strnlen(stats.name, sizeof(stats.name))) << std::right
+        << std::setw(10) << static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(stats.capacity))
+        << std::setw(10) << static_cast<int>(NetworkToLocal<kP2PLocalEndianness>(stats.high_water_mark))
+        << std::setprecision(3)
+        << std::setw(10) << (elapsed_cycles > 0 ? static_cast<double>(occupancy_cycles) / elapsed_cycles : 0.0)
+        << std::setw(12) << NetworkToLocal<kP2PLocalEndianness>(stats.num_overwrites)
+        << std::setprecision(1)
+        << std::setw(12) << (cycles_per_second > 0 ? static_cast<double>(elapsed_cycles) / cycles_per_second : 0.0) << "\n";
+  }
+  return oss.str();
+}
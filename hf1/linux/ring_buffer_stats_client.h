@@ -0,0 +1,60 @@
+#ifndef RING_BUFFER_STATS_CLIENT_INCLUDED_
+#define RING_BUFFER_STATS_CLIENT_INCLUDED_
+
+#include "p2p_action_client.h"
+#include "timer_interface.h"
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Fetches the occupancy stats of the fixed-size buffers of the Arduino (P2P packet buffers
+// and event queues), one request per buffer.
+class RingBufferStatsClient {
+public:
+  using GetRingBufferStatsActionClientHandler = P2PActionClientHandler<P2PGetRingBufferStatsRequest, P2PGetRingBufferStatsReply, P2PVoid>;
+
+  // Does not take ownsership of the pointees, which must outlive this object.
+  RingBufferStatsClient(GetRingBufferStatsActionClientHandler *action_handler, TimerInterface *system_timer);
+
+  // Starts fetching a snapshot of the stats. If `reset` is true, the Arduino clears the
+  // stats of each buffer after sending them.
+  // Returns kExistsError if a snapshot is already being fetched.
+  Status RequestSnapshot(bool reset);
+
+  // Runs the client logic. Must be called periodically from a single thread, without the
+  // P2P mutex locked.
+  void Run();
+
+  bool snapshot_in_progress() const { return state_ != kIdle; }
+  // Status of the last snapshot request; kUnavailableError if it timed out.
+  Status last_snapshot_status() const { return last_snapshot_status_; }
+  // The last complete snapshot, one entry per buffer.
+  std::vector<P2PGetRingBufferStatsReply> snapshot();
+
+  // Formats `snapshot` as a table, one row per buffer.
+  static std::string Format(const std::vector<P2PGetRingBufferStatsReply> &snapshot);
+
+private:
+  void OnReply(const P2PGetRingBufferStatsReply &reply);
+  void FinishSnapshot(Status status);
+
+  GetRingBufferStatsActionClientHandler &action_handler_;
+  TimerInterface &system_timer_;
+
+  enum State { kIdle, kSendRequest, kWaitForReply };
+  std::atomic<State> state_;
+  std::atomic<Status> last_snapshot_status_;
+  bool reset_;
+  int next_index_;
+  uint64_t request_sent_timestamp_ns_;
+  std::vector<P2PGetRingBufferStatsReply> pending_snapshot_;
+
+  // Protects the members below, which the reply callback accesses from the P2P thread.
+  std::mutex mutex_;
+  std::optional<P2PGetRingBufferStatsReply> reply_;
+  std::vector<P2PGetRingBufferStatsReply> snapshot_;
+};
+
+#endif  // RING_BUFFER_STATS_CLIENT_INCLUDED_
@@ -0,0 +1,38 @@
+#include "arduino_comms_sim.h"
+#include "p2p_packet_stream_arduino.h"
+#include "p2p_action_server.h"
+#include "ping_action_handler.h"
+#include "sync_time_action_handler.h"
+
+class ArduinoCommsSim::Impl {
+public:
+  Impl(P2PByteStreamInterface<kLittleEndian> *byte_stream, TimerInterface *timer, GUIDFactoryInterface &guid_factory)
+    : p2p_stream_(byte_stream, timer, guid_factory),
+      action_server_(&p2p_stream_),
+      ping_action_handler_(&p2p_stream_, timer),
+      sync_time_action_handler_(&p2p_stream_, timer) {
+    action_server_.Register(&ping_action_handler_);
+    action_server_.Register(&sync_time_action_handler_);
+  }
+
+  void Run() {
+    p2p_stream_.input().Run();
+    p2p_stream_.output().Run();
+    action_server_.Run();
+  }
+
+private:
+  P2PPacketStreamArduino p2p_stream_;
+  P2PActionServer action_server_;
+  PingActionHandler ping_action_handler_;
+  SyncTimeActionHandler sync_time_action_handler_;
+};
+
+ArduinoCommsSim::ArduinoCommsSim(P2PByteStreamInterface<kLittleEndian> *byte_stream, TimerInterface *timer, GUIDFactoryInterface &guid_factory)
+  : impl_(new Impl(byte_stream, timer, guid_factory)) {}
+
+ArduinoCommsSim::~ArduinoCommsSim() {}
+
+void ArduinoCommsSim::Run() {
+  impl_->Run();
+}
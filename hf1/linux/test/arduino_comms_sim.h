@@ -0,0 +1,29 @@
+#ifndef ARDUINO_COMMS_SIM_
+#define ARDUINO_COMMS_SIM_
+
+#include "p2p_byte_stream_interface.h"
+#include "guid_factory_interface.h"
+#include "timer_interface.h"
+#include <memory>
+
+// The Arduino's end of the P2P link: its packet stream and action server, with the
+// firmware's action handlers, for end-to-end tests of the Linux clients.
+//
+// The Arduino's stream configuration clashes with the Linux one, so it is only visible in
+// this class' translation unit.
+class ArduinoCommsSim {
+public:
+  // Does not take ownership of the pointees, which must outlive this object.
+  // `timer` is the Arduino's system timer.
+  ArduinoCommsSim(P2PByteStreamInterface<kLittleEndian> *byte_stream, TimerInterface *timer, GUIDFactoryInterface &guid_factory);
+  ~ArduinoCommsSim();
+
+  // Runs the packet stream and the action server once, as the firmware's comms task does.
+  void Run();
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+#endif  // ARDUINO_COMMS_SIM_
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "async_logger.h"
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Captures the output of an AsyncLogger in memory.
+class AsyncLoggerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    output_ = open_memstream(&buffer_, &buffer_size_);
+    ASSERT_NE(output_, nullptr);
+  }
+
+  void TearDown() override {
+    fclose(output_);
+    free(buffer_);
+  }
+
+  std::string Output() {
+    fflush(output_);
+    return std::string(buffer_, buffer_size_);
+  }
+
+  FILE *output_ = nullptr;
+  char *buffer_ = nullptr;
+  size_t buffer_size_ = 0;
+};
+
+TEST_F(AsyncLoggerTest, WritesTextAndFormattedMessages) {
+  {
+    AsyncLogger logger(output_);
+    logger.Warning("file.cpp", 12, "Plain text.");
+    logger.Formatted(kLogInfo, "other.cpp", 34, kLogFormatMonitorBaseState, MakeLogArgs(5));
+    logger.Flush();
+  }
+  const std::string output = Output();
+  EXPECT_NE(output.find("[WARNING] "), std::string::npos);
+  EXPECT_NE(output.find(" file.cpp:12: Plain text.\n"), std::string::npos);
+  EXPECT_NE(output.find(" other.cpp:34: monitor_base_state(max_updates=5)\n"), std::string::npos);
+  EXPECT_LT(output.find("Plain text."), output.find("monitor_base_state"));
+}
+
+TEST_F(AsyncLoggerTest, TruncatesLongText) {
+  const std::string long_text(2 * kMaxAsyncLogTextLength, 'x');
+  {
+    AsyncLogger logger(output_);
+    logger.Info("file.cpp", 1, long_text.c_str());
+  }
+  const std::string output = Output();
+  EXPECT_NE(output.find(long_text.substr(0, kMaxAsyncLogTextLength) + "\n"), std::string::npos);
+  EXPECT_EQ(output.find(long_text.substr(0, kMaxAsyncLogTextLength + 1)), std::string::npos);
+}
+
+TEST_F(AsyncLoggerTest, KeepsMessagesOfAllThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumMessagesPerThread = 100;
+  {
+    AsyncLogger logger(output_);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&logger, t]() {
+        for (int i = 0; i < kNumMessagesPerThread; ++i) {
+          logger.Formatted(kLogInfo, "thread.cpp", t, kLogFormatMonitorBaseState, MakeLogArgs(i));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(logger.num_dropped_messages(), 0);
+  }
+  const std::string output = Output();
+  for (int t = 0; t < kNumThreads; ++t) {
+    const std::string last = "thread.cpp:" + std::to_string(t) + ": monitor_base_state(max_updates=" + std::to_string(kNumMessagesPerThread - 1) + ")";
+    EXPECT_NE(output.find(last), std::string::npos);
+  }
+}
+
+TEST(AsyncLoggerFloodTest, DropsMessagesRatherThanBlocking) {
+  // The writer blocks on the pipe once it is full, until the reader below starts.
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  FILE *output = fdopen(fds[1], "w");
+  ASSERT_NE(output, nullptr);
+  std::string output_text;
+  std::thread reader;
+  {
+    AsyncLogger logger(output);
+    for (int i = 0; i < 100 * kAsyncLogThreadCapacity; ++i) {
+      logger.Formatted(kLogError, "flood.cpp", 1, kLogFormatMonitorBaseState, MakeLogArgs(i));
+    }
+    EXPECT_GT(logger.num_dropped_messages(), 0);
+
+    reader = std::thread([&output_text, fd = fds[0]]() {
+      char buffer[4096];
+      ssize_t length;
+      while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        output_text.append(buffer, length);
+      }
+    });
+  }
+  fclose(output);
+  reader.join();
+  close(fds[0]);
+  EXPECT_NE(output_text.find("log messages dropped."), std::string::npos);
+}
@@ -0,0 +1,36 @@
+#ifndef LOOPBACK_BYTE_STREAM_
+#define LOOPBACK_BYTE_STREAM_
+
+#include "p2p_byte_stream_interface.h"
+#include <deque>
+
+// End of an in-memory lossless link. Two streams with swapped queues are both ends.
+class LoopbackByteStream : public P2PByteStreamInterface<kLittleEndian> {
+public:
+  // Does not take ownership of the queues, which must outlive this object.
+  LoopbackByteStream(std::deque<uint8_t> *input, std::deque<uint8_t> *output)
+    : P2PByteStreamInterface<kLittleEndian>(Handler{ .object = nullptr }), input_(*input), output_(*output) {}
+
+  int Write(const void *buffer, int length) override {
+    const uint8_t *bytes = static_cast<const uint8_t *>(buffer);
+    output_.insert(output_.end(), bytes, bytes + length);
+    return length;
+  }
+  int Read(void *buffer, int length) override {
+    int num_read = 0;
+    while (num_read < length && !input_.empty()) {
+      static_cast<uint8_t *>(buffer)[num_read++] = input_.front();
+      input_.pop_front();
+    }
+    return num_read;
+  }
+  int GetBurstMaxLength() override { return 1024; }
+  int GetBurstIngestionNanosecondsPerByte() override { return 0; }
+  int GetAtomicSendMaxLength() override { return 4; }
+
+private:
+  std::deque<uint8_t> &input_;
+  std::deque<uint8_t> &output_;
+};
+
+#endif  // LOOPBACK_BYTE_STREAM_
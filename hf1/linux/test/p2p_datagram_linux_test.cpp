@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "p2p_datagram_linux.h"
+#include "p2p_packet_stream_linux.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// Two packet streams, `a` and `b`, in datagram mode at both ends of a socket pair, with their
+// handshake done.
+class P2PDatagramLinuxTest : public ::testing::Test {
+protected:
+  P2PDatagramLinuxTest() : sockets_(CreateSocketPair()), a_datagrams_(sockets_[0]), b_datagrams_(sockets_[1]),
+      a_(&a_datagrams_, &timer_, guid_factory_), b_(&b_datagrams_, &timer_, guid_factory_) {
+    Run();
+  }
+
+  ~P2PDatagramLinuxTest() {
+    close(sockets_[0]);
+    close(sockets_[1]);
+  }
+
+  static std::vector<int> CreateSocketPair() {
+    int sockets[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets), 0);
+    return { sockets[0], sockets[1] };
+  }
+
+  void Run(int num_iterations = 200) {
+    for (int i = 0; i < num_iterations; ++i) {
+      a_.input().Run(); a_.output().Run();
+      b_.input().Run(); b_.output().Run();
+    }
+  }
+
+  // Commits a packet from `a` with `content`.
+  void Send(P2PPriority priority, bool guarantee_delivery, const std::vector<uint8_t> &content) {
+    auto packet = a_.output().NewPacket(priority);
+    ASSERT_TRUE(packet.ok());
+    memcpy(packet->content(), content.data(), content.size());
+    packet->length() = content.size();
+    ASSERT_TRUE(a_.output().Commit(priority, guarantee_delivery));
+  }
+
+  // Returns the content of the oldest packet received by `b`, and consumes it.
+  std::vector<uint8_t> Receive(P2PPriority priority) {
+    auto packet = b_.input().OldestPacket();
+    EXPECT_TRUE(packet.ok());
+    if (!packet.ok()) {
+      return {};
+    }
+    EXPECT_EQ(packet->priority(), priority);
+    std::vector<uint8_t> content(packet->content(), packet->content() + packet->length());
+    b_.input().Consume(priority);
+    return content;
+  }
+
+  std::vector<int> sockets_;
+  P2PDatagramLinux a_datagrams_, b_datagrams_;
+  TimerLinux timer_;
+  GUIDFactory guid_factory_;
+  P2PPacketStreamLinux a_, b_;
+};
+
+TEST_F(P2PDatagramLinuxTest, DeliversPacketsByPriorityWithoutEscaping) {
+  // Tokens would be escaped with a byte stream.
+  const std::vector<uint8_t> tokens(kP2PMaxContentLength, kP2PStartToken);
+  const std::vector<uint8_t> mixed = { 0x00, kP2PStartToken, kP2PSpecialToken, 0xaa, 0xff };
+  Send(P2PPriority::kLow, /*guarantee_delivery=*/false, mixed);
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, tokens);
+  Send(P2PPriority::kHigh, /*guarantee_delivery=*/false, {});
+  Run();
+
+  EXPECT_EQ(Receive(P2PPriority::kHigh), std::vector<uint8_t>());
+  EXPECT_EQ(Receive(P2PPriority::kMedium), tokens);
+  EXPECT_EQ(Receive(P2PPriority::kLow), mixed);
+  EXPECT_FALSE(b_.input().OldestPacket().ok());
+  // The guaranteed-delivery packet was ACKed.
+  EXPECT_EQ(a_.output().NumCommittedPackets(P2PPriority::kMedium), 0);
+  EXPECT_EQ(b_.input().stats().num_malformed_headers(), 0);
+}
+
+TEST_F(P2PDatagramLinuxTest, DiscardsMalformedDatagrams) {
+  P2PPacket packet;
+  packet.header()->priority = P2PPriority::kMedium;
+  packet.length() = 10;
+  // Shorter than the header, and shorter than the length in the header.
+  ASSERT_TRUE(a_datagrams_.Send(packet.header(), 2));
+  ASSERT_TRUE(a_datagrams_.Send(packet.header(), sizeof(P2PHeader) + 5));
+  Run();
+
+  EXPECT_FALSE(b_.input().OldestPacket().ok());
+  EXPECT_EQ(b_.input().stats().num_malformed_headers(), 2);
+
+  // The link keeps working.
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, { 1, 2, 3 });
+  Run();
+  EXPECT_EQ(Receive(P2PPriority::kMedium), std::vector<uint8_t>({ 1, 2, 3 }));
+}
+
+TEST_F(P2PDatagramLinuxTest, WaitsForTheACKBeforeRetransmitting) {
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, { 1, 2, 3 });
+  // The transport is lossless: the ACK arrives as soon as `b` runs.
+  EXPECT_EQ(a_.output().Run(), 0);
+  for (int i = 0; i < 100; ++i) {
+    const uint64_t time_to_retransmission_ns = a_.output().Run();
+    EXPECT_GT(time_to_retransmission_ns, 0);
+    EXPECT_LE(time_to_retransmission_ns, kP2PDatagramRetransmissionTimeoutNs);
+  }
+  Run();
+
+  EXPECT_EQ(Receive(P2PPriority::kMedium), std::vector<uint8_t>({ 1, 2, 3 }));
+  EXPECT_EQ(b_.input().stats().num_duplicate_packets(), 0);
+  EXPECT_EQ(a_.output().NumCommittedPackets(P2PPriority::kMedium), 0);
+}
+
+TEST_F(P2PDatagramLinuxTest, RetransmitsAfterTheTimeout) {
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, { 1, 2, 3 });
+  a_.output().Run();
+  // Lose the datagram.
+  uint8_t datagram[kP2PMaxDatagramLength];
+  ASSERT_GT(b_datagrams_.Receive(datagram, sizeof(datagram)), 0);
+  Run();
+  EXPECT_FALSE(b_.input().OldestPacket().ok());
+
+  usleep(kP2PDatagramRetransmissionTimeoutNs / 1000);
+  Run();
+  EXPECT_EQ(Receive(P2PPriority::kMedium), std::vector<uint8_t>({ 1, 2, 3 }));
+}
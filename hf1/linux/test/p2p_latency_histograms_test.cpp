@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "p2p_packet_stream_linux.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include "loopback_byte_stream.h"
+#include <atomic>
+#include <thread>
+
+TEST(P2PLatencyHistogramsTest, MeasuresPacketLatencies) {
+  std::deque<uint8_t> a_to_b, b_to_a;
+  LoopbackByteStream a_bytes(&b_to_a, &a_to_b), b_bytes(&a_to_b, &b_to_a);
+  TimerLinux timer;
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux a(&a_bytes, &timer, guid_factory), b(&b_bytes, &timer, guid_factory);
+  auto run = [&]() {
+    for (int i = 0; i < 2000; ++i) {
+      a.input().Run(); a.output().Run();
+      b.input().Run(); b.output().Run();
+    }
+  };
+  // Handshake.
+  run();
+
+  constexpr int kNumPackets = 5;
+  for (int i = 0; i < kNumPackets; ++i) {
+    auto packet = a.output().NewPacket(P2PPriority::kMedium);
+    ASSERT_TRUE(packet.ok());
+    packet->length() = 10;
+    ASSERT_TRUE(a.output().Commit(P2PPriority::kMedium, /*guarantee_delivery=*/true));
+    run();
+    ASSERT_TRUE(b.input().OldestPacket().ok());
+    b.input().Consume(P2PPriority::kMedium);
+  }
+
+  P2PPacketStreamLinux::OutputStream::LatencyHistograms::Snapshot output;
+  a.output().latency_histograms().Read(&output);
+  for (int metric = 0; metric < P2PPacketStreamLinux::OutputStream::kNumLatencyMetrics; ++metric) {
+    const P2PLatencyHistogram &histogram = output.histograms[metric][P2PPriority::kMedium];
+    EXPECT_EQ(histogram.total_count(), kNumPackets) << "metric " << metric;
+    EXPECT_GE(histogram.Percentile(0.99f), histogram.Percentile(0.5f));
+    EXPECT_GE(histogram.max_value(), histogram.Percentile(0.5f));
+  }
+  EXPECT_EQ(output.histograms[P2PPacketStreamLinux::OutputStream::kQueueingDelay][P2PPriority::kLow].total_count(), 0);
+
+  P2PPacketStreamLinux::InputStream::LatencyHistograms::Snapshot input;
+  b.input().latency_histograms().Read(&input);
+  EXPECT_EQ(input.histograms[P2PPacketStreamLinux::InputStream::kRetrievalDelay][P2PPriority::kMedium].total_count(), kNumPackets);
+
+  // Resets take effect right away for readers.
+  a.output().latency_histograms().Reset();
+  a.output().latency_histograms().Read(&output);
+  EXPECT_EQ(output.histograms[P2PPacketStreamLinux::OutputStream::kWireTime][P2PPriority::kMedium].total_count(), 0);
+}
+
+TEST(P2PLatencyHistogramsTest, SnapshotsFromOtherThreadsAreConsistent) {
+  typedef P2PLatencyHistograms<2> TestHistograms;
+  TestHistograms histograms;
+  std::atomic<bool> stop(false);
+  std::thread writer([&]() {
+    for (uint64_t i = 0; !stop; ++i) {
+      // Every sample goes to both metrics, so that they always have the same count.
+      histograms.Add(0, P2PPriority::kHigh, i * 1000);
+      histograms.Add(1, P2PPriority::kHigh, i * 1000);
+    }
+  });
+  TestHistograms::Snapshot snapshot;
+  do {
+    histograms.Read(&snapshot);
+  } while (snapshot.histograms[1][P2PPriority::kHigh].total_count() == 0);
+  for (int i = 0; i < 10000; ++i) {
+    histograms.Read(&snapshot);
+    const P2PLatencyHistogram &first = snapshot.histograms[0][P2PPriority::kHigh];
+    const P2PLatencyHistogram &second = snapshot.histograms[1][P2PPriority::kHigh];
+    uint32_t sum = 0;
+    for (int bucket = 0; bucket < P2PLatencyHistogram::num_buckets(); ++bucket) {
+      sum += first.count(bucket);
+    }
+    ASSERT_EQ(sum, first.total_count());
+    // The first metric may be one sample ahead.
+    ASSERT_LE(first.total_count() - second.total_count(), 1);
+    if (i % 1000 == 0) {
+      histograms.Reset();
+    }
+  }
+  stop = true;
+  writer.join();
+}
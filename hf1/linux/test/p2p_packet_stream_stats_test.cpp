@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "p2p_packet_stream_linux.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include "loopback_byte_stream.h"
+
+// Two packet streams, `a` and `b`, at both ends of a loopback link, with their handshake done.
+class P2PPacketStreamStatsTest : public ::testing::Test {
+protected:
+  P2PPacketStreamStatsTest()
+    : a_bytes_(&b_to_a_, &a_to_b_), b_bytes_(&a_to_b_, &b_to_a_),
+      a_(&a_bytes_, &timer_, guid_factory_), b_(&b_bytes_, &timer_, guid_factory_) {
+    Run();
+  }
+
+  void Run(int num_iterations = 2000) {
+    for (int i = 0; i < num_iterations; ++i) {
+      a_.input().Run(); a_.output().Run();
+      b_.input().Run(); b_.output().Run();
+    }
+  }
+
+  // Commits a packet from `a` with `value` as content.
+  void Send(P2PPriority priority, bool guarantee_delivery, uint8_t value) {
+    auto packet = a_.output().NewPacket(priority);
+    ASSERT_TRUE(packet.ok());
+    packet->content()[0] = value;
+    packet->length() = 1;
+    ASSERT_TRUE(a_.output().Commit(priority, guarantee_delivery));
+  }
+
+  std::deque<uint8_t> a_to_b_, b_to_a_;
+  LoopbackByteStream a_bytes_, b_bytes_;
+  TimerLinux timer_;
+  GUIDFactory guid_factory_;
+  P2PPacketStreamLinux a_, b_;
+};
+
+TEST_F(P2PPacketStreamStatsTest, CountsLineNoiseAndChecksumErrors) {
+  b_.input().Run();
+  const uint8_t noise[] = { 0x01, 0x02, 0x03 };
+  a_to_b_.insert(a_to_b_.end(), noise, noise + sizeof(noise));
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, 42);
+  // Corrupt the content of the first transmission, which is after the noise.
+  while (a_to_b_.size() < sizeof(noise) + sizeof(P2PHeader) + 1 + sizeof(P2PFooter)) {
+    a_.output().Run();
+  }
+  a_to_b_[sizeof(noise) + sizeof(P2PHeader)] ^= 0x01;
+  Run();
+
+  const auto &stats = b_.input().stats();
+  EXPECT_EQ(stats.num_skipped_bytes(), sizeof(noise));
+  EXPECT_EQ(stats.num_checksum_errors(), 1);
+  EXPECT_EQ(stats.num_malformed_headers(), 0);
+  // The retransmission got in.
+  auto packet = b_.input().OldestPacket();
+  ASSERT_TRUE(packet.ok());
+  EXPECT_EQ(packet->content()[0], 42);
+}
+
+TEST_F(P2PPacketStreamStatsTest, CountsPacketsDroppedForLackOfBufferSpace) {
+  // P2PPacketStreamLinux's input capacity, minus the slot for the packet being received.
+  constexpr int num_slots = 15;
+  for (int i = 0; i < num_slots + 3; ++i) {
+    Send(P2PPriority::kLow, /*guarantee_delivery=*/false, i);
+    Run(100);
+  }
+
+  EXPECT_EQ(b_.input().stats().num_dropped_packets(), 3);
+  // The oldest packets are kept.
+  ASSERT_EQ(b_.input().NumAvailablePackets(P2PPriority::kLow), num_slots);
+  for (int i = 0; i < num_slots; ++i) {
+    auto packet = b_.input().OldestPacket();
+    ASSERT_TRUE(packet.ok());
+    EXPECT_EQ(packet->content()[0], i);
+    b_.input().Consume(P2PPriority::kLow);
+  }
+}
+
+TEST_F(P2PPacketStreamStatsTest, CountsDuplicatesOfPacketsWithLostACKs) {
+  Send(P2PPriority::kMedium, /*guarantee_delivery=*/true, 42);
+  while (b_.input().NumAvailablePackets(P2PPriority::kMedium) == 0) {
+    a_.output().Run();
+    b_.input().Run();
+  }
+  // Lose the ACKs until `a` retransmits.
+  while (b_.input().stats().num_duplicate_packets() == 0) {
+    a_.output().Run();
+    b_.input().Run();
+    b_.output().Run();
+    b_to_a_.clear();
+  }
+  Run();
+
+  EXPECT_EQ(b_.input().NumAvailablePackets(P2PPriority::kMedium), 1);
+  EXPECT_EQ(a_.output().NumCommittedPackets(P2PPriority::kMedium), 0);
+}
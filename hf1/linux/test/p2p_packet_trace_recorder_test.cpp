@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "p2p_packet_trace_recorder.h"
+#include "p2p_packet_stream_linux.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include "loopback_byte_stream.h"
+#include <vector>
+
+static std::vector<P2PPacketTraceRecord> ReadTrace(FILE *file) {
+  rewind(file);
+  std::vector<P2PPacketTraceRecord> records;
+  EXPECT_TRUE(ReadP2PPacketTrace(file, &records));
+  return records;
+}
+
+// Returns the events of the data packets (not ACKs, nor handshakes) in the trace.
+static std::vector<int> DataPacketEvents(const std::vector<P2PPacketTraceRecord> &records) {
+  std::vector<int> events;
+  for (const P2PPacketTraceRecord &record : records) {
+    if (!(record.flags & (kP2PPacketTraceIsAck | kP2PPacketTraceIsInit))) {
+      events.push_back(record.event);
+    }
+  }
+  return events;
+}
+
+TEST(P2PPacketTraceRecorderTest, TracesReliablePacketLifetime) {
+  std::deque<uint8_t> a_to_b, b_to_a;
+  LoopbackByteStream a_bytes(&b_to_a, &a_to_b), b_bytes(&a_to_b, &b_to_a);
+  TimerLinux timer;
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux a(&a_bytes, &timer, guid_factory), b(&b_bytes, &timer, guid_factory);
+  FILE *a_file = tmpfile(), *b_file = tmpfile();
+  ASSERT_NE(a_file, nullptr);
+  ASSERT_NE(b_file, nullptr);
+  {
+    P2PPacketTraceRecorder a_recorder(a_file), b_recorder(b_file);
+    a.packet_tracer(a_recorder.tracer());
+    b.packet_tracer(b_recorder.tracer());
+
+    auto run = [&]() {
+      for (int i = 0; i < 2000; ++i) {
+        a.input().Run(); a.output().Run();
+        b.input().Run(); b.output().Run();
+      }
+    };
+    // Handshake.
+    run();
+    auto packet = a.output().NewPacket(P2PPriority::kMedium);
+    ASSERT_TRUE(packet.ok());
+    packet->content()[0] = 42;
+    packet->length() = 1;
+    ASSERT_TRUE(a.output().Commit(P2PPriority::kMedium, /*guarantee_delivery=*/true));
+    run();
+    auto received = b.input().OldestPacket();
+    ASSERT_TRUE(received.ok());
+    EXPECT_EQ(received->content()[0], 42);
+    EXPECT_TRUE(b.input().Consume(received->priority()));
+
+    a.packet_tracer(P2PPacketTracer());
+    b.packet_tracer(P2PPacketTracer());
+    EXPECT_EQ(a_recorder.num_dropped_records(), 0);
+    EXPECT_EQ(b_recorder.num_dropped_records(), 0);
+  }
+
+  const std::vector<P2PPacketTraceRecord> a_records = ReadTrace(a_file);
+  const std::vector<int> a_events = DataPacketEvents(a_records);
+  // The packet may be retransmitted before the ACK gets in.
+  ASSERT_GE(a_events.size(), 4);
+  EXPECT_EQ(a_events[0], kP2PPacketCommitted);
+  EXPECT_EQ(a_events[1], kP2PPacketFirstByteSent);
+  EXPECT_EQ(a_events[2], kP2PPacketLastByteSent);
+  EXPECT_EQ(a_events.back(), kP2PPacketAckReceived);
+  for (const P2PPacketTraceRecord &record : a_records) {
+    if (!(record.flags & (kP2PPacketTraceIsAck | kP2PPacketTraceIsInit))) {
+      EXPECT_EQ(record.priority, P2PPriority::kMedium);
+      EXPECT_EQ(record.flags, kP2PPacketTraceRequiresAck);
+    }
+  }
+  for (size_t i = 1; i < a_records.size(); ++i) {
+    EXPECT_GE(a_records[i].timestamp_ns, a_records[i - 1].timestamp_ns);
+  }
+
+  const std::vector<int> b_events = DataPacketEvents(ReadTrace(b_file));
+  EXPECT_EQ(b_events, std::vector<int>({ kP2PPacketReceived, kP2PPacketDelivered, kP2PPacketConsumed }));
+  fclose(a_file);
+  fclose(b_file);
+}
+
+TEST(P2PPacketTraceRecorderTest, TracesPreemptionAndContinuation) {
+  std::deque<uint8_t> a_to_b, b_to_a;
+  LoopbackByteStream a_bytes(&b_to_a, &a_to_b), b_bytes(&a_to_b, &b_to_a);
+  TimerLinux timer;
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux a(&a_bytes, &timer, guid_factory), b(&b_bytes, &timer, guid_factory);
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  {
+    P2PPacketTraceRecorder recorder(file);
+    auto run = [&](int num_iterations) {
+      for (int i = 0; i < num_iterations; ++i) {
+        a.input().Run(); a.output().Run();
+        b.input().Run(); b.output().Run();
+      }
+    };
+    run(2000);
+    a.output().packet_tracer(recorder.tracer());
+
+    auto low = a.output().NewPacket(P2PPriority::kLow);
+    ASSERT_TRUE(low.ok());
+    low->length() = 100;
+    memset(low->content(), 1, low->length());
+    ASSERT_TRUE(a.output().Commit(P2PPriority::kLow, /*guarantee_delivery=*/false));
+    // Start sending the low priority packet, past its header.
+    while (a_to_b.size() < sizeof(P2PHeader) + 8) {
+      a.output().Run();
+    }
+    auto high = a.output().NewPacket(P2PPriority::kHigh);
+    ASSERT_TRUE(high.ok());
+    high->length() = 1;
+    ASSERT_TRUE(a.output().Commit(P2PPriority::kHigh, /*guarantee_delivery=*/false));
+    run(2000);
+    a.output().packet_tracer(P2PPacketTracer());
+  }
+
+  std::vector<int> low_events, high_events;
+  for (const P2PPacketTraceRecord &record : ReadTrace(file)) {
+    (record.priority == P2PPriority::kLow ? low_events : high_events).push_back(record.event);
+  }
+  EXPECT_EQ(low_events, std::vector<int>({ kP2PPacketCommitted, kP2PPacketFirstByteSent, kP2PPacketPreempted, kP2PPacketContinued, kP2PPacketLastByteSent }));
+  EXPECT_EQ(high_events, std::vector<int>({ kP2PPacketCommitted, kP2PPacketFirstByteSent, kP2PPacketLastByteSent }));
+  fclose(file);
+}
+
+TEST(P2PPacketTraceRecorderTest, CountsDroppedRecords) {
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  constexpr int kNumRecords = 4 * kP2PPacketTraceRingCapacity;
+  uint64_t num_dropped_records;
+  {
+    P2PPacketTraceRecorder recorder(file);
+    P2PPacketTracer tracer = recorder.tracer();
+    P2PPacket packet;
+    TimerLinux timer;
+    for (int i = 0; i < kNumRecords; ++i) {
+      packet.sequence_number() = i;
+      tracer(kP2PPacketCommitted, packet, timer);
+    }
+    recorder.Flush();
+    num_dropped_records = recorder.num_dropped_records();
+  }
+  const std::vector<P2PPacketTraceRecord> records = ReadTrace(file);
+  EXPECT_EQ(records.size() + num_dropped_records, kNumRecords);
+  // Records are written in order, skipping the dropped ones.
+  for (size_t i = 1; i < records.size(); ++i) {
+    EXPECT_GT(records[i].sequence_number, records[i - 1].sequence_number);
+  }
+  fclose(file);
+}
+
+TEST(P2PPacketTraceRecorderTest, RejectsOtherFiles) {
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  fputs("not a trace", file);
+  rewind(file);
+  std::vector<P2PPacketTraceRecord> records;
+  EXPECT_FALSE(ReadP2PPacketTrace(file, &records));
+  fclose(file);
+}
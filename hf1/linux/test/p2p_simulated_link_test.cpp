@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "p2p_simulated_link.h"
+#include "p2p_packet_stream_linux.h"
+#include "virtual_timer.h"
+#include "guid_factory.h"
+#include <math.h>
+#include <vector>
+
+// Writes `length` bytes with values 0, 1, 2... from `a` to `b`.
+static int WriteSequence(P2PSimulatedLink &link, int length) {
+  std::vector<uint8_t> bytes(length);
+  for (int i = 0; i < length; ++i) {
+    bytes[i] = i;
+  }
+  return link.a().Write(bytes.data(), length);
+}
+
+static std::vector<uint8_t> ReadAll(P2PByteStreamInterface<kLittleEndian> &stream) {
+  std::vector<uint8_t> bytes(1024);
+  bytes.resize(stream.Read(bytes.data(), bytes.size()));
+  return bytes;
+}
+
+TEST(P2PSimulatedLinkTest, DeliversBytesAtLineRateAfterLatency) {
+  VirtualTimer timer;
+  P2PSimulatedLinkConfig config;
+  config.a_to_b.baud_rate = 1'000'000;  // 10 us per byte.
+  config.a_to_b.latency_ns = 100'000;
+  P2PSimulatedLink link(&timer, config);
+
+  ASSERT_EQ(WriteSequence(link, 3), 3);
+  timer.Advance(109'999);
+  EXPECT_TRUE(ReadAll(link.b()).empty());
+  timer.Advance(1);
+  EXPECT_EQ(ReadAll(link.b()), std::vector<uint8_t>({ 0 }));
+  timer.Advance(20'000);
+  EXPECT_EQ(ReadAll(link.b()), std::vector<uint8_t>({ 1, 2 }));
+  EXPECT_TRUE(ReadAll(link.a()).empty());
+  EXPECT_EQ(link.a_to_b_stats().num_read_bytes, 3);
+}
+
+TEST(P2PSimulatedLinkTest, AcceptsWritesUpToTheTransmitterFifoSize) {
+  VirtualTimer timer;
+  P2PSimulatedLinkConfig config;
+  config.a_to_b.transmitter_fifo_size = 8;
+  P2PSimulatedLink link(&timer, config);
+
+  EXPECT_EQ(WriteSequence(link, 20), 8);
+  EXPECT_EQ(WriteSequence(link, 20), 0);
+  // Two bytes go out at 1 Mbaud.
+  timer.Advance(20'000);
+  EXPECT_EQ(WriteSequence(link, 20), 2);
+}
+
+TEST(P2PSimulatedLinkTest, LosesBytesWhenTheReceiverFifoOverruns) {
+  VirtualTimer timer;
+  P2PSimulatedLinkConfig config;
+  config.a_to_b.transmitter_fifo_size = 100;
+  config.a_to_b.receiver_fifo_size = 16;
+  P2PSimulatedLink link(&timer, config);
+
+  ASSERT_EQ(WriteSequence(link, 40), 40);
+  timer.Advance(1'000'000);
+  const std::vector<uint8_t> bytes = ReadAll(link.b());
+  ASSERT_EQ(bytes.size(), 16);
+  EXPECT_EQ(bytes.back(), 15);
+  EXPECT_EQ(link.a_to_b_stats().num_overrun_bytes, 24);
+}
+
+TEST(P2PSimulatedLinkTest, DisconnectionLosesBytesInFlightAndWritten) {
+  VirtualTimer timer;
+  P2PSimulatedLink link(&timer);
+
+  ASSERT_EQ(WriteSequence(link, 10), 10);
+  link.Disconnect(/*duration_ns=*/1'000'000);
+  timer.Advance(500'000);
+  ASSERT_EQ(WriteSequence(link, 10), 10);
+  timer.Advance(500'000);
+  EXPECT_TRUE(ReadAll(link.b()).empty());
+  ASSERT_EQ(WriteSequence(link, 10), 10);
+  timer.Advance(500'000);
+  EXPECT_EQ(ReadAll(link.b()).size(), 10);
+  EXPECT_EQ(link.a_to_b_stats().num_disconnected_bytes, 20);
+}
+
+TEST(P2PSimulatedLinkTest, ImpairmentsAreDeterministicUnderASeed) {
+  auto transfer = [](uint32_t seed) {
+    VirtualTimer timer;
+    P2PSimulatedLinkConfig config;
+    config.a_to_b.baud_rate = 0;
+    config.a_to_b.transmitter_fifo_size = 1000;
+    config.a_to_b.receiver_fifo_size = 1000;
+    config.a_to_b.byte_drop_probability = 0.01;
+    config.a_to_b.bit_error_rate = 0.001;
+    config.a_to_b.burst_start_probability = 0.01;
+    config.seed = seed;
+    P2PSimulatedLink link(&timer, config);
+    WriteSequence(link, 1000);
+    return ReadAll(link.b());
+  };
+  EXPECT_EQ(transfer(1), transfer(1));
+  EXPECT_NE(transfer(1), transfer(2));
+}
+
+TEST(P2PSimulatedLinkTest, ErrorRatesMatchTheConfig) {
+  VirtualTimer timer;
+  P2PSimulatedLinkConfig config;
+  config.a_to_b.baud_rate = 0;
+  config.a_to_b.transmitter_fifo_size = 1 << 20;
+  config.a_to_b.receiver_fifo_size = 1 << 20;
+  config.a_to_b.byte_drop_probability = 0.05;
+  config.a_to_b.bit_error_rate = 0.01;
+  P2PSimulatedLink link(&timer, config);
+
+  constexpr int kNumBytes = 100'000;
+  std::vector<uint8_t> bytes(kNumBytes, 0);
+  ASSERT_EQ(link.a().Write(bytes.data(), kNumBytes), kNumBytes);
+  const P2PSimulatedChannelStats &stats = link.a_to_b_stats();
+  EXPECT_NEAR(stats.num_dropped_bytes, 0.05 * kNumBytes, 0.005 * kNumBytes);
+  // A delivered byte is corrupted if any of its 8 bits flips.
+  const double corrupted_ratio = (1 - 0.05) * (1 - pow(1 - 0.01, 8));
+  EXPECT_NEAR(stats.num_corrupted_bytes, corrupted_ratio * kNumBytes, 0.005 * kNumBytes);
+}
+
+TEST(P2PSimulatedLinkTest, PacketStreamsDeliverReliablePacketsOverANoisyLink) {
+  VirtualTimer timer;
+  P2PSimulatedLinkConfig config;
+  config.a_to_b.latency_ns = config.b_to_a.latency_ns = 200'000;
+  config.a_to_b.bit_error_rate = config.b_to_a.bit_error_rate = 1e-4;
+  config.a_to_b.burst_start_probability = config.b_to_a.burst_start_probability = 1e-4;
+  P2PSimulatedLink link(&timer, config);
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux a(&link.a(), &timer, guid_factory), b(&link.b(), &timer, guid_factory);
+
+  constexpr int kNumPackets = 50;
+  int num_sent = 0;
+  std::vector<uint8_t> received;
+  // 10 virtual seconds, in steps of 10 us.
+  for (int step = 0; step < 1'000'000 && static_cast<int>(received.size()) < kNumPackets; ++step) {
+    if (num_sent < kNumPackets && a.output().NumAvailableSlots(P2PPriority::kMedium) > 0) {
+      auto packet = a.output().NewPacket(P2PPriority::kMedium);
+      ASSERT_TRUE(packet.ok());
+      packet->length() = 100;
+      for (int i = 0; i < packet->length(); ++i) {
+        packet->content()[i] = num_sent;
+      }
+      ASSERT_TRUE(a.output().Commit(P2PPriority::kMedium, /*guarantee_delivery=*/true));
+      ++num_sent;
+    }
+    // The streams read a byte per call: poll faster than bytes arrive.
+    for (int i = 0; i < 4; ++i) {
+      a.input().Run(); a.output().Run();
+      b.input().Run(); b.output().Run();
+    }
+    auto packet = b.input().OldestPacket();
+    if (packet.ok()) {
+      received.push_back(packet->content()[0]);
+      b.input().Consume(packet->priority());
+    }
+    timer.Advance(10'000);
+  }
+
+  ASSERT_EQ(received.size(), kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(received[i], i);
+  }
+  EXPECT_GT(link.a_to_b_stats().num_corrupted_bytes, 0);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "packet_time_sync_client.h"
+#include "arduino_comms_sim.h"
+#include "p2p_simulated_link.h"
+#include "virtual_timer.h"
+#include "guid_factory.h"
+
+// Local clock of the Arduino, which started `offset_ns` before the reference clock and runs
+// `skew` faster than it.
+class SkewedTimer : public TimerInterface {
+public:
+  // Does not take ownership of the pointee, which must outlive this object.
+  SkewedTimer(const TimerInterface *reference, uint64_t offset_ns, double skew)
+    : reference_(*ASSERT_NOT_NULL(reference)), offset_ns_(offset_ns), skew_(skew) {}
+
+  uint64_t GetLocalNanoseconds() const override {
+    const uint64_t reference_ns = reference_.GetLocalNanoseconds();
+    return reference_ns + offset_ns_ + static_cast<int64_t>(skew_ * static_cast<double>(reference_ns));
+  }
+
+private:
+  const TimerInterface &reference_;
+  const uint64_t offset_ns_;
+  const double skew_;
+};
+
+// Synchronizes with the firmware's time sync action handler, over a simulated serial link.
+class PacketTimeSyncClientTest : public ::testing::Test {
+protected:
+  static constexpr uint64_t kArduinoOffsetNs = 3'000'000'000;
+  static constexpr double kArduinoSkew = 40e-6;
+  // The request and the reply differ in size and in the time they wait to go out, which
+  // biases the offset by a fraction of the ~1 ms round trip.
+  static constexpr int64_t kMaxGlobalTimeErrorNs = 100'000;
+
+  PacketTimeSyncClientTest()
+    : arduino_timer_(&timer_, kArduinoOffsetNs, kArduinoSkew),
+      link_(&timer_, LinkConfig()),
+      p2p_stream_(&link_.a(), &timer_, guid_factory_),
+      arduino_(&link_.b(), &arduino_timer_, guid_factory_),
+      action_client_(&p2p_stream_, &timer_),
+      sync_action_handler_(P2PAction::kTimeSync, P2PPriority::kHigh, /*default_guarantee_delivery=*/false, &p2p_stream_, &p2p_mutex_),
+      time_sync_client_(&sync_action_handler_, &timer_) {
+    action_client_.Register(&sync_action_handler_);
+  }
+
+  static P2PSimulatedLinkConfig LinkConfig() {
+    P2PSimulatedLinkConfig config;
+    config.a_to_b.latency_ns = config.b_to_a.latency_ns = 200'000;
+    return config;
+  }
+
+  // Runs both ends for `duration_ns` of virtual time, in steps of 10 us.
+  void RunFor(uint64_t duration_ns) {
+    for (uint64_t elapsed_ns = 0; elapsed_ns < duration_ns; elapsed_ns += 10'000) {
+      // The streams read a byte per call: poll faster than bytes arrive.
+      for (int i = 0; i < 2; ++i) {
+        std::lock_guard<std::mutex> guard(p2p_mutex_);
+        p2p_stream_.input().Run();
+        p2p_stream_.output().Run();
+        action_client_.Run();
+        arduino_.Run();
+      }
+      time_sync_client_.Run();
+      timer_.Advance(10'000);
+    }
+  }
+
+  // Requests a synchronization round and runs until it finishes.
+  void Sync() {
+    time_sync_client_.RequestTimeSync();
+    RunFor(50'000'000);
+    ASSERT_EQ(time_sync_client_.last_sync_status(), PacketTimeSyncClient::kOk);
+  }
+
+  // How far the Linux global time is ahead of the Arduino's.
+  int64_t GlobalTimeError() const {
+    return static_cast<int64_t>(timer_.GetGlobalNanoseconds() - arduino_timer_.GetGlobalNanoseconds());
+  }
+
+  VirtualTimer timer_;
+  SkewedTimer arduino_timer_;
+  P2PSimulatedLink link_;
+  GUIDFactory guid_factory_;
+  P2PPacketStreamLinux p2p_stream_;
+  ArduinoCommsSim arduino_;
+  std::mutex p2p_mutex_;
+  P2PActionClient action_client_;
+  PacketTimeSyncClient::SyncTimeActionClientHandler sync_action_handler_;
+  PacketTimeSyncClient time_sync_client_;
+};
+
+TEST_F(PacketTimeSyncClientTest, ConvergesToTheArduinoOffsetAndSkew) {
+  // Let the link start.
+  RunFor(10'000'000);
+  for (int round = 0; round < 4; ++round) {
+    Sync();
+    RunFor(1'000'000'000);
+  }
+  Sync();
+
+  const TimeSyncEstimator &estimator = time_sync_client_.estimator();
+  EXPECT_NEAR(estimator.skew(), kArduinoSkew, 1e-6);
+  EXPECT_NEAR(static_cast<int64_t>(estimator.LocalToRemoteNanoseconds(timer_.GetLocalNanoseconds()) - arduino_timer_.GetGlobalNanoseconds()), 0, kMaxGlobalTimeErrorNs);
+  EXPECT_NEAR(GlobalTimeError(), 0, kMaxGlobalTimeErrorNs);
+  // With the skew applied, the clocks stay together long after the synchronization.
+  RunFor(2'000'000'000);
+  EXPECT_NEAR(GlobalTimeError(), 0, kMaxGlobalTimeErrorNs);
+  // The Arduino was ahead, so it was never asked to advance its global time.
+  EXPECT_EQ(arduino_timer_.global_offset_nanoseconds(), 0);
+}
+
+TEST_F(PacketTimeSyncClientTest, AdvancesTheArduinoWhenItIsBehind) {
+  constexpr uint64_t kLinuxGlobalOffsetNs = 5'000'000'000;
+  timer_.global_offset_nanoseconds() = kLinuxGlobalOffsetNs;
+  RunFor(10'000'000);
+  const uint64_t global_before_sync_ns = timer_.GetGlobalNanoseconds();
+  Sync();
+
+  EXPECT_NEAR(static_cast<int64_t>(arduino_timer_.global_offset_nanoseconds()), static_cast<int64_t>(kLinuxGlobalOffsetNs - kArduinoOffsetNs), kMaxGlobalTimeErrorNs);
+  EXPECT_NEAR(GlobalTimeError(), 0, kMaxGlobalTimeErrorNs);
+  EXPECT_GT(timer_.GetGlobalNanoseconds(), global_before_sync_ns);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "ping_client.h"
+#include "arduino_comms_sim.h"
+#include "p2p_simulated_link.h"
+#include "virtual_timer.h"
+#include "guid_factory.h"
+#include <stddef.h>
+
+// Pings the firmware's ping action handler, over a simulated serial link.
+class PingClientTest : public ::testing::Test {
+protected:
+  static constexpr uint64_t kLatencyNs = 200'000;
+
+  PingClientTest()
+    : link_(&timer_, LinkConfig()),
+      p2p_stream_(&link_.a(), &timer_, guid_factory_),
+      arduino_(&link_.b(), &timer_, guid_factory_),
+      action_client_(&p2p_stream_, &timer_),
+      ping_client_(&p2p_stream_, &p2p_mutex_, &timer_) {
+    action_client_.Register(&ping_client_);
+    // Let the link start.
+    RunFor(10'000'000);
+  }
+
+  static P2PSimulatedLinkConfig LinkConfig() {
+    P2PSimulatedLinkConfig config;
+    config.a_to_b.latency_ns = config.b_to_a.latency_ns = kLatencyNs;
+    return config;
+  }
+
+  // Runs both ends for `duration_ns` of virtual time, in steps of 10 us.
+  void RunFor(uint64_t duration_ns) {
+    for (uint64_t elapsed_ns = 0; elapsed_ns < duration_ns; elapsed_ns += 10'000) {
+      // The streams read a byte per call: poll faster than bytes arrive.
+      for (int i = 0; i < 2; ++i) {
+        std::lock_guard<std::mutex> guard(p2p_mutex_);
+        p2p_stream_.input().Run();
+        p2p_stream_.output().Run();
+        action_client_.Run();
+        arduino_.Run();
+      }
+      timer_.Advance(10'000);
+    }
+  }
+
+  // Pings and returns the results of the replies received within 20 ms.
+  std::vector<PingClient::Result> PingAndWait(int payload_length) {
+    EXPECT_EQ(ping_client_.Ping(payload_length, P2PPriority::kMedium, /*guarantee_delivery=*/false), kSuccess);
+    RunFor(20'000'000);
+    std::vector<PingClient::Result> results;
+    ping_client_.TakeResults(&results);
+    return results;
+  }
+
+  VirtualTimer timer_;
+  P2PSimulatedLink link_;
+  GUIDFactory guid_factory_;
+  P2PPacketStreamLinux p2p_stream_;
+  ArduinoCommsSim arduino_;
+  std::mutex p2p_mutex_;
+  P2PActionClient action_client_;
+  PingClient ping_client_;
+};
+
+TEST_F(PingClientTest, EchoesShortPayloads) {
+  for (const int payload_length : { 0, 5 }) {
+    const std::vector<PingClient::Result> results = PingAndWait(payload_length);
+    ASSERT_EQ(results.size(), 1) << "payload length " << payload_length;
+    EXPECT_GT(results[0].round_trip_ns, 2 * kLatencyNs);
+    EXPECT_LT(results[0].server_processing_ns, results[0].round_trip_ns);
+  }
+  EXPECT_EQ(ping_client_.num_malformed_replies(), 0);
+}
+
+TEST_F(PingClientTest, ServerDropsRequestsOfInvalidSize) {
+  const uint8_t request[sizeof(P2PPingRequest) + 1] = {};
+  // Longer than the largest ping, and shorter than the fields before the payload.
+  ASSERT_EQ(ping_client_.Request(sizeof(request), request), kSuccess);
+  ASSERT_EQ(ping_client_.Request(offsetof(P2PPingRequest, payload) - 1, request), kSuccess);
+  RunFor(20'000'000);
+  std::vector<PingClient::Result> results;
+  ping_client_.TakeResults(&results);
+  EXPECT_TRUE(results.empty());
+  EXPECT_EQ(ping_client_.num_malformed_replies(), 0);
+
+  // The server goes on serving valid requests.
+  EXPECT_EQ(PingAndWait(kP2PMaxPingPayloadLength).size(), 1);
+}
+
+TEST_F(PingClientTest, AcceptsRepliesToConcurrentRequestsOutOfOrder) {
+  ASSERT_EQ(ping_client_.Ping(10, P2PPriority::kLow, /*guarantee_delivery=*/false), kSuccess);
+  timer_.Advance(1'000);
+  // The request with the higher priority goes out first, and so does its reply.
+  ASSERT_EQ(ping_client_.Ping(10, P2PPriority::kHigh, /*guarantee_delivery=*/true), kSuccess);
+  RunFor(20'000'000);
+
+  std::vector<PingClient::Result> results;
+  ping_client_.TakeResults(&results);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_GT(results[0].send_ns, results[1].send_ns);
+  EXPECT_EQ(ping_client_.num_malformed_replies(), 0);
+}
@@ -0,0 +1,60 @@
+// Measures the cost per call of the clocks TimerLinux can use, and of the alternatives.
+//
+// Usage: timer_linux_bench [--calls <n>]
+
+#include "timer_linux.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+
+#define kDefaultNumCalls 10'000'000
+
+// Keeps the compiler from optimizing the reads out.
+static volatile uint64_t sink;
+
+static void Measure(const char *name, int num_calls, const std::function<uint64_t()> &read) {
+  const auto start = std::chrono::steady_clock::now();
+  uint64_t sum = 0;
+  for (int i = 0; i < num_calls; ++i) {
+    sum += read();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  sink = sum;
+  const double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+  printf("%-32s %8.2f ns/call\n", name, total_ns / num_calls);
+}
+
+static uint64_t ReadClock(clockid_t clock_id) {
+  struct timespec now;
+  clock_gettime(clock_id, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ULL + now.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  int num_calls = kDefaultNumCalls;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc) {
+      num_calls = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--calls <n>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const TimerLinux raw_timer(TimerLinux::kMonotonicRaw);
+  const TimerLinux cycle_timer(TimerLinux::kCycleCounter);
+  printf("Invariant cycle counter: %s\n\n", TimerLinux::HasInvariantCycleCounter() ? "yes" : "no");
+
+  Measure("system_clock::now()", num_calls, []() { return static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()); });
+  Measure("steady_clock::now()", num_calls, []() { return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()); });
+  Measure("CLOCK_MONOTONIC", num_calls, []() { return ReadClock(CLOCK_MONOTONIC); });
+  Measure("CLOCK_MONOTONIC_RAW", num_calls, []() { return ReadClock(CLOCK_MONOTONIC_RAW); });
+  Measure("CLOCK_MONOTONIC_COARSE", num_calls, []() { return ReadClock(CLOCK_MONOTONIC_COARSE); });
+  Measure("ReadCycleCounter()", num_calls, []() { return TimerLinux::ReadCycleCounter(); });
+  Measure("TimerLinux(kMonotonicRaw)", num_calls, [&raw_timer]() { return raw_timer.GetLocalNanoseconds(); });
+  Measure(cycle_timer.source() == TimerLinux::kCycleCounter ? "TimerLinux(kCycleCounter)" : "TimerLinux(kCycleCounter) [fallback]", num_calls,
+          [&cycle_timer]() { return cycle_timer.GetLocalNanoseconds(); });
+  return 0;
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include "timer_linux.h"
+#include <unistd.h>
+
+TEST(TimerLinuxTest, IsMonotonic) {
+  for (TimerLinux::Source source : { TimerLinux::kMonotonicRaw, TimerLinux::kCycleCounter }) {
+    TimerLinux timer(source);
+    uint64_t last_ns = timer.GetLocalNanoseconds();
+    for (int i = 0; i < 100'000; ++i) {
+      const uint64_t now_ns = timer.GetLocalNanoseconds();
+      ASSERT_GE(now_ns, last_ns);
+      last_ns = now_ns;
+    }
+  }
+}
+
+TEST(TimerLinuxTest, CycleCounterFallsBackWithoutInvariantCounter) {
+  TimerLinux timer(TimerLinux::kCycleCounter);
+  EXPECT_EQ(timer.source(), TimerLinux::HasInvariantCycleCounter() ? TimerLinux::kCycleCounter : TimerLinux::kMonotonicRaw);
+}
+
+TEST(TimerLinuxTest, CycleCounterTracksMonotonicRaw) {
+  TimerLinux raw_timer(TimerLinux::kMonotonicRaw);
+  TimerLinux cycle_timer(TimerLinux::kCycleCounter);
+  const uint64_t raw_start_ns = raw_timer.GetLocalNanoseconds();
+  const uint64_t cycle_start_ns = cycle_timer.GetLocalNanoseconds();
+  usleep(200'000);
+  const uint64_t raw_elapsed_ns = raw_timer.GetLocalNanoseconds() - raw_start_ns;
+  const uint64_t cycle_elapsed_ns = cycle_timer.GetLocalNanoseconds() - cycle_start_ns;
+  // Allow for preemption between the reads, besides the calibration error.
+  EXPECT_NEAR(static_cast<double>(cycle_elapsed_ns), static_cast<double>(raw_elapsed_ns), 1e6);
+}
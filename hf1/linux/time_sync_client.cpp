@@ -155,7 +155,8 @@ void TimeSyncClient::Run() {
             break;
 
         case kSendTimeSyncRequest: {
-            P2PSyncTimeRequest request;
+            P2PSyncTimeRequest request = {};
+            request.mode = kTimeSyncGPIOEdge;
             // The edge was received some time between setting the output pin and receiving the event from the loopback pin: use the mid-point.
             // It is guaranteed that the rising edge will have been processed in the other end by the time the request is received.
             last_edge_estimated_local_timestamp_ns_ = (last_edge_set_local_timestamp_ns_ + last_edge_detect_local_timestamp_ns_copy_) / 2;
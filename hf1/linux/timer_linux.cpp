@@ -0,0 +1,67 @@
+#include "timer_linux.h"
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+// Time during which the TSC is compared to CLOCK_MONOTONIC_RAW to calibrate it.
+#define kTSCCalibrationNs 50'000'000ULL
+// Attempts to read both clocks back to back, of which the tightest pair is kept.
+#define kTSCCalibrationNumSamples 16
+
+#if defined(__x86_64__)
+// Reads the TSC and CLOCK_MONOTONIC_RAW at (almost) the same instant.
+static void ReadClockPair(uint64_t *cycles, uint64_t *ns) {
+  uint64_t best_window = ~0ULL;
+  for (int i = 0; i < kTSCCalibrationNumSamples; ++i) {
+    const uint64_t before = TimerLinux::ReadCycleCounter();
+    const uint64_t sample_ns = TimerLinux::GetMonotonicRawNanoseconds();
+    const uint64_t after = TimerLinux::ReadCycleCounter();
+    if (after - before < best_window) {
+      best_window = after - before;
+      *cycles = before + (after - before) / 2;
+      *ns = sample_ns;
+    }
+  }
+}
+#endif
+
+bool TimerLinux::HasInvariantCycleCounter() {
+#if defined(__x86_64__)
+  // CPUID 8000_0007h:EDX[8] is the invariant TSC flag.
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+    return false;
+  }
+  __cpuid(0x80000007, eax, ebx, ecx, edx);
+  return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+  // The generic timer runs at a fixed frequency by architecture.
+  return true;
+#else
+  return false;
+#endif
+}
+
+TimerLinux::TimerLinux(Source source)
+  : source_(source), start_ns_(GetMonotonicRawNanoseconds()), start_cycles_(0), nanoseconds_per_cycle_q32_(0) {
+  if (source_ != kCycleCounter) {
+    return;
+  }
+  if (!HasInvariantCycleCounter()) {
+    source_ = kMonotonicRaw;
+    return;
+  }
+#if defined(__x86_64__)
+  uint64_t end_cycles, end_ns;
+  ReadClockPair(&start_cycles_, &start_ns_);
+  do {
+    ReadClockPair(&end_cycles, &end_ns);
+  } while (end_ns - start_ns_ < kTSCCalibrationNs);
+  nanoseconds_per_cycle_q32_ = static_cast<uint64_t>((static_cast<unsigned __int128>(end_ns - start_ns_) << 32) / (end_cycles - start_cycles_));
+#elif defined(__aarch64__)
+  uint64_t cycles_per_second;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(cycles_per_second));
+  start_cycles_ = ReadCycleCounter();
+  nanoseconds_per_cycle_q32_ = static_cast<uint64_t>((static_cast<unsigned __int128>(1'000'000'000ULL) << 32) / cycles_per_second);
+#endif
+}
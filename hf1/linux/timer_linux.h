@@ -2,23 +2,68 @@
 #define TIMER_LINUX_
 
 #include "timer_interface.h"
-#include <chrono>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
+// Timer on a clock that never jumps: CLOCK_MONOTONIC_RAW is not adjusted by NTP, so packet
+// delays and time synchronization are not disturbed by clock corrections.
+//
+// Reading CLOCK_MONOTONIC_RAW takes a vDSO call. The kCycleCounter source reads the CPU's
+// cycle counter instead (the TSC on x86, CNTVCT_EL0 on ARM64), which takes a few cycles, and
+// converts it with a rate calibrated against CLOCK_MONOTONIC_RAW at construction. On x86, the
+// calibration error makes the timer run a few ppm faster or slower than CLOCK_MONOTONIC_RAW,
+// which time synchronization absorbs as part of the skew between computers.
 class TimerLinux : public TimerInterface {
 public:
-  TimerLinux() : start_time_(GetEpochNanoseconds()) {}
+  typedef enum {
+    kMonotonicRaw = 0,
+    // Falls back to kMonotonicRaw if the cycle counter does not tick at a constant rate.
+    kCycleCounter
+  } Source;
 
-  virtual uint64_t GetLocalNanoseconds() const {
-    return GetEpochNanoseconds() - start_time_;
+  explicit TimerLinux(Source source = kMonotonicRaw);
+
+  uint64_t GetLocalNanoseconds() const override {
+    if (source_ == kCycleCounter) {
+      const uint64_t elapsed_cycles = ReadCycleCounter() - start_cycles_;
+      return static_cast<uint64_t>((static_cast<unsigned __int128>(elapsed_cycles) * nanoseconds_per_cycle_q32_) >> 32);
+    }
+    return GetMonotonicRawNanoseconds() - start_ns_;
+  }
+
+  // Source actually used.
+  Source source() const { return source_; }
+
+  static uint64_t GetMonotonicRawNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1'000'000'000ULL + now.tv_nsec;
   }
 
-protected:
-  static uint64_t GetEpochNanoseconds() {
-    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  // True if the cycle counter ticks at a constant rate, regardless of frequency scaling
+  // and sleep states, and is synchronized across cores.
+  static bool HasInvariantCycleCounter();
+
+  static uint64_t ReadCycleCounter() {
+#if defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t cycles;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(cycles));
+    return cycles;
+#else
+    return 0;
+#endif
   }
- 
+
 private:
-  uint64_t start_time_;
+  Source source_;
+  uint64_t start_ns_;
+  uint64_t start_cycles_;
+  // Nanoseconds per cycle, in Q32.32 fixed point.
+  uint64_t nanoseconds_per_cycle_q32_;
 };
 
 #endif	// TIMER_LINUX_
@@ -0,0 +1,425 @@
+// Measures the throughput and latencies of P2PPacketStream over a P2PSimulatedLink, on virtual
+// time, over a grid of payload lengths, line rates, burst parameters and bit error rates.
+// Writes one CSV row per configuration, metric and priority.
+//
+// Usage: hf1_p2p_bench --output <file> [--seconds <virtual seconds>] [--seed <number>]
+//                      [--payloads <values>] [--bauds <values>] [--bursts <values>]
+//                      [--ingestions <values>] [--tx_fifos <values>]
+//                      [--bit_error_rates <values>]
+//
+// --bursts and --ingestions are the burst maximum length and the burst ingestion time per
+// byte [ns] both ends report to their streams. --tx_fifos are the sizes of the transmitter
+// FIFOs, whose bytes a higher priority packet cannot preempt. Values are comma-separated.
+// Every metric runs for --seconds of virtual time (2 by default) on a new link, with a new
+// pair of streams.
+//
+// Metrics, in microseconds unless stated otherwise:
+//   goodput_bps              Payload bits per second delivered with a saturated best-effort
+//                            kLow queue; `count` is the number of packets delivered.
+//   delivery_ratio           Fraction of those packets delivered intact.
+//   undetected_corruptions   Those packets delivered corrupted, as the P2P checksum did not
+//                            catch the errors.
+//   reliable_goodput_bps     Same, with guaranteed-delivery kMedium packets.
+//   latency_us               From commit to reception, per priority, with every priority
+//                            offered Poisson arrivals for a third of 50% of the line rate.
+//   preemption_latency_us    From commit to reception of small kHigh packets, while a
+//                            saturated kLow queue keeps the line busy.
+//   round_trip_us            From the commit of a guaranteed-delivery packet to its ACK
+//                            releasing it from the output queue, one packet at a time.
+//   round_trip_timeouts      Round trips not completed in a second.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "p2p_simulated_link.h"
+#include "p2p_packet_stream_linux.h"
+#include "virtual_timer.h"
+#include "guid_factory.h"
+
+// Payloads start with the commit time of the packet and a hash of the rest of the payload,
+// to detect corrupted packets that the P2P checksum misses.
+#define kTimestampLength sizeof(uint64_t)
+#define kHashLength sizeof(uint32_t)
+#define kMinPayloadLength (kTimestampLength + kHashLength)
+#define kHandshakeNs 20'000'000ULL
+#define kMaxRoundTripNs 1'000'000'000ULL
+// Fraction of the line rate offered in the latency metric.
+#define kLatencyOfferedLoad 0.5
+// Mean interval between the kHigh packets of the preemption metric.
+#define kPreemptionMeanIntervalNs 2'000'000
+
+typedef struct {
+  int payload_length;
+  uint32_t baud_rate;
+  int burst_max_length;
+  int burst_ingestion_ns_per_byte;
+  int transmitter_fifo_size;
+  double bit_error_rate;
+  uint32_t seed;
+  uint64_t duration_ns;
+} BenchConfig;
+
+// Count, mean and percentiles of a set of samples.
+typedef struct {
+  size_t count;
+  double mean;
+  double p50;
+  double p99;
+  double max;
+} BenchSummary;
+
+// FNV-1a hash of the payload, skipping the hash itself.
+static uint32_t HashPayload(const uint8_t *payload, int length) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < length; ++i) {
+    if (i < static_cast<int>(kTimestampLength) || i >= static_cast<int>(kMinPayloadLength)) {
+      hash = (hash ^ payload[i]) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+static BenchSummary Summarize(std::vector<double> samples) {
+  BenchSummary summary = {};
+  summary.count = samples.size();
+  if (samples.empty()) {
+    return summary;
+  }
+  std::sort(samples.begin(), samples.end());
+  double total = 0;
+  for (double sample : samples) {
+    total += sample;
+  }
+  summary.mean = total / samples.size();
+  summary.p50 = samples[(samples.size() - 1) / 2];
+  summary.p99 = samples[(samples.size() - 1) * 99 / 100];
+  summary.max = samples.back();
+  return summary;
+}
+
+// A pair of packet streams, `a` sending to `b`, at both ends of a simulated link, after their
+// handshake.
+class BenchLink {
+public:
+  explicit BenchLink(const BenchConfig &config)
+    : link_(&timer_, LinkConfig(config)),
+      a_(&link_.a(), &timer_, guid_factory_), b_(&link_.b(), &timer_, guid_factory_),
+      random_(config.seed), num_corrupted_packets_(0) {
+    // The streams read a byte per call: poll a few times per byte, as a busy host would.
+    const uint64_t byte_ns = config.baud_rate > 0 ? 10'000'000'000ULL / config.baud_rate : 0;
+    step_ns_ = std::min<uint64_t>(std::max<uint64_t>(byte_ns / 4, 100), 10'000);
+    while (timer_.GetLocalNanoseconds() < kHandshakeNs) {
+      Step();
+    }
+  }
+
+  // Runs the streams and advances the time.
+  void Step() {
+    a_.input().Run(); a_.output().Run();
+    b_.input().Run(); b_.output().Run();
+    timer_.Advance(step_ns_);
+  }
+
+  // Commits a packet from `a` with `payload_length` bytes, the first ones being the current
+  // time. Returns false if the queue is full.
+  bool Send(P2PPriority priority, int payload_length, bool guarantee_delivery) {
+    if (a_.output().NumAvailableSlots(priority) <= 0) {
+      return false;
+    }
+    auto packet = a_.output().NewPacket(priority);
+    if (!packet.ok()) {
+      return false;
+    }
+    const uint64_t now_ns = timer_.GetLocalNanoseconds();
+    memcpy(packet->content(), &now_ns, kTimestampLength);
+    // Random content, so that as many bytes are escaped as in real traffic.
+    for (int i = kMinPayloadLength; i < payload_length; ++i) {
+      packet->content()[i] = random_();
+    }
+    const uint32_t hash = HashPayload(packet->content(), payload_length);
+    memcpy(packet->content() + kTimestampLength, &hash, kHashLength);
+    packet->length() = payload_length;
+    return a_.output().Commit(priority, guarantee_delivery);
+  }
+
+  // Consumes the packets received by `b`, calling `on_packet(priority, latency_ns, length)`
+  // for each of them, except for the corrupted ones, which are counted.
+  template<typename Callback> void Receive(Callback on_packet) {
+    for (;;) {
+      auto packet = b_.input().OldestPacket();
+      if (!packet.ok()) {
+        return;
+      }
+      uint32_t hash;
+      memcpy(&hash, packet->content() + kTimestampLength, kHashLength);
+      if (packet->length() < kMinPayloadLength || hash != HashPayload(packet->content(), packet->length())) {
+        ++num_corrupted_packets_;
+      } else {
+        uint64_t commit_ns;
+        memcpy(&commit_ns, packet->content(), kTimestampLength);
+        on_packet(packet->priority(), timer_.GetLocalNanoseconds() - commit_ns, packet->length());
+      }
+      b_.input().Consume(packet->priority());
+    }
+  }
+
+  uint64_t now_ns() const { return timer_.GetLocalNanoseconds(); }
+  P2PPacketStreamLinux &a() { return a_; }
+  std::mt19937 &random() { return random_; }
+  // Packets delivered with a corrupted payload.
+  size_t num_corrupted_packets() const { return num_corrupted_packets_; }
+
+private:
+  static P2PSimulatedLinkConfig LinkConfig(const BenchConfig &config) {
+    P2PSimulatedLinkConfig link_config;
+    for (P2PSimulatedChannelConfig *channel : { &link_config.a_to_b, &link_config.b_to_a }) {
+      channel->baud_rate = config.baud_rate;
+      channel->bit_error_rate = config.bit_error_rate;
+      channel->burst_max_length = config.burst_max_length;
+      channel->burst_ingestion_ns_per_byte = config.burst_ingestion_ns_per_byte;
+      channel->transmitter_fifo_size = config.transmitter_fifo_size;
+    }
+    link_config.seed = config.seed;
+    return link_config;
+  }
+
+  VirtualTimer timer_;
+  GUIDFactory guid_factory_;
+  P2PSimulatedLink link_;
+  P2PPacketStreamLinux a_;
+  P2PPacketStreamLinux b_;
+  std::mt19937 random_;
+  uint64_t step_ns_;
+  size_t num_corrupted_packets_;
+};
+
+static void PrintRow(FILE *output, const BenchConfig &config, const char *metric, int priority, const BenchSummary &summary) {
+  fprintf(output, "%d,%u,%d,%d,%d,%g,%u,%s,%d,%zu,%.3f,%.3f,%.3f,%.3f\n",
+          config.payload_length, config.baud_rate, config.burst_max_length,
+          config.burst_ingestion_ns_per_byte, config.transmitter_fifo_size, config.bit_error_rate, config.seed, metric, priority,
+          summary.count, summary.mean, summary.p50, summary.p99, summary.max);
+}
+
+static void PrintValue(FILE *output, const BenchConfig &config, const char *metric, int priority, size_t count, double value) {
+  PrintRow(output, config, metric, priority, BenchSummary{ .count = count, .mean = value, .p50 = value, .p99 = value, .max = value });
+}
+
+static void MeasureGoodput(const BenchConfig &config, bool guarantee_delivery, FILE *output) {
+  BenchLink link(config);
+  const P2PPriority priority = guarantee_delivery ? P2PPriority::kMedium : P2PPriority::kLow;
+  const uint64_t start_ns = link.now_ns();
+  size_t num_sent = 0, num_received = 0;
+  uint64_t received_bytes = 0;
+  while (link.now_ns() - start_ns < config.duration_ns) {
+    while (link.Send(priority, config.payload_length, guarantee_delivery)) {
+      ++num_sent;
+    }
+    link.Step();
+    link.Receive([&](int, uint64_t, int length) {
+      ++num_received;
+      received_bytes += length;
+    });
+  }
+  const double goodput_bps = received_bytes * 8 * 1e9 / config.duration_ns;
+  if (guarantee_delivery) {
+    PrintValue(output, config, "reliable_goodput_bps", priority, num_received, goodput_bps);
+  } else {
+    PrintValue(output, config, "goodput_bps", priority, num_received, goodput_bps);
+    // Packets still queued when the run ended were not lost.
+    const size_t num_queued = link.a().output().NumCommittedPackets(priority);
+    PrintValue(output, config, "delivery_ratio", priority, num_sent, num_sent > num_queued ? static_cast<double>(num_received) / (num_sent - num_queued) : 0);
+    PrintValue(output, config, "undetected_corruptions", priority, link.num_corrupted_packets(), link.num_corrupted_packets());
+  }
+}
+
+static void MeasureLatencies(const BenchConfig &config, FILE *output) {
+  BenchLink link(config);
+  // Poisson arrivals for each priority, at a third of the offered load. The wire time of a
+  // packet ignores escaped bytes.
+  const double packet_ns = (sizeof(P2PHeader) + config.payload_length + sizeof(P2PFooter)) * 10e9 / config.baud_rate;
+  std::exponential_distribution<double> interval_ns(kLatencyOfferedLoad / ((P2PPriority::kNumLevels - 1) * packet_ns));
+  std::vector<double> latencies_us[P2PPriority::kNumLevels];
+  uint64_t next_send_ns[P2PPriority::kNumLevels];
+  for (int priority = P2PPriority::kHigh; priority < P2PPriority::kNumLevels; ++priority) {
+    next_send_ns[priority] = link.now_ns() + interval_ns(link.random());
+  }
+  const uint64_t start_ns = link.now_ns();
+  while (link.now_ns() - start_ns < config.duration_ns) {
+    for (int priority = P2PPriority::kHigh; priority < P2PPriority::kNumLevels; ++priority) {
+      if (link.now_ns() >= next_send_ns[priority]) {
+        link.Send(priority, config.payload_length, /*guarantee_delivery=*/false);
+        next_send_ns[priority] = link.now_ns() + interval_ns(link.random());
+      }
+    }
+    link.Step();
+    link.Receive([&](int priority, uint64_t latency_ns, int) {
+      latencies_us[priority].push_back(latency_ns * 1e-3);
+    });
+  }
+  for (int priority = P2PPriority::kHigh; priority < P2PPriority::kNumLevels; ++priority) {
+    PrintRow(output, config, "latency_us", priority, Summarize(latencies_us[priority]));
+  }
+}
+
+static void MeasurePreemptionLatency(const BenchConfig &config, FILE *output) {
+  BenchLink link(config);
+  std::exponential_distribution<double> interval_ns(1.0 / kPreemptionMeanIntervalNs);
+  std::vector<double> latencies_us;
+  uint64_t next_send_ns = link.now_ns() + interval_ns(link.random());
+  const uint64_t start_ns = link.now_ns();
+  while (link.now_ns() - start_ns < config.duration_ns) {
+    while (link.Send(P2PPriority::kLow, config.payload_length, /*guarantee_delivery=*/false)) {}
+    if (link.now_ns() >= next_send_ns) {
+      link.Send(P2PPriority::kHigh, kMinPayloadLength, /*guarantee_delivery=*/false);
+      next_send_ns = link.now_ns() + interval_ns(link.random());
+    }
+    link.Step();
+    link.Receive([&](int priority, uint64_t latency_ns, int) {
+      if (priority == P2PPriority::kHigh) {
+        latencies_us.push_back(latency_ns * 1e-3);
+      }
+    });
+  }
+  PrintRow(output, config, "preemption_latency_us", P2PPriority::kHigh, Summarize(latencies_us));
+}
+
+static void MeasureRoundTrip(const BenchConfig &config, FILE *output) {
+  BenchLink link(config);
+  const P2PPriority priority = P2PPriority::kMedium;
+  std::vector<double> round_trips_us;
+  size_t num_timeouts = 0;
+  const uint64_t start_ns = link.now_ns();
+  while (link.now_ns() - start_ns < config.duration_ns) {
+    if (!link.Send(priority, config.payload_length, /*guarantee_delivery=*/true)) {
+      link.Step();
+      continue;
+    }
+    const uint64_t commit_ns = link.now_ns();
+    // The ACK removes the packet from the output queue.
+    while (link.a().output().NumCommittedPackets(priority) > 0 && link.now_ns() - commit_ns < kMaxRoundTripNs) {
+      link.Step();
+      link.Receive([](int, uint64_t, int) {});
+    }
+    if (link.a().output().NumCommittedPackets(priority) > 0) {
+      ++num_timeouts;
+    } else {
+      round_trips_us.push_back((link.now_ns() - commit_ns) * 1e-3);
+    }
+  }
+  PrintRow(output, config, "round_trip_us", priority, Summarize(round_trips_us));
+  PrintValue(output, config, "round_trip_timeouts", priority, num_timeouts, num_timeouts);
+}
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s --output <file> [--seconds <virtual seconds>] [--seed <number>]\n"
+          "       [--payloads <values>] [--bauds <values>] [--bursts <values>]\n"
+          "       [--ingestions <values>] [--tx_fifos <values>] [--bit_error_rates <values>]\n", program);
+}
+
+static bool ParseNumbers(const char *text, std::vector<double> *numbers) {
+  numbers->clear();
+  const char *start = text;
+  for (;;) {
+    char *end;
+    numbers->push_back(strtod(start, &end));
+    if (end == start || (*end != ',' && *end != '\0')) {
+      return false;
+    }
+    if (*end == '\0') {
+      return true;
+    }
+    start = end + 1;
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *output_path = nullptr;
+  double seconds = 2;
+  uint32_t seed = 1;
+  std::vector<double> payloads = {16, 64, 160}, bauds = {115200, 1'000'000}, bursts = {64},
+                      ingestions = {0}, tx_fifos = {64}, bit_error_rates = {0, 1e-5, 1e-4};
+  for (int arg = 1; arg < argc; ++arg) {
+    const bool has_value = arg + 1 < argc;
+    bool ok = has_value;
+    if (has_value && strcmp(argv[arg], "--output") == 0) {
+      output_path = argv[++arg];
+    } else if (has_value && strcmp(argv[arg], "--seconds") == 0) {
+      seconds = atof(argv[++arg]);
+    } else if (has_value && strcmp(argv[arg], "--seed") == 0) {
+      seed = atoi(argv[++arg]);
+    } else if (has_value && strcmp(argv[arg], "--payloads") == 0) {
+      ok = ParseNumbers(argv[++arg], &payloads);
+    } else if (has_value && strcmp(argv[arg], "--bauds") == 0) {
+      ok = ParseNumbers(argv[++arg], &bauds);
+    } else if (has_value && strcmp(argv[arg], "--bursts") == 0) {
+      ok = ParseNumbers(argv[++arg], &bursts);
+    } else if (has_value && strcmp(argv[arg], "--ingestions") == 0) {
+      ok = ParseNumbers(argv[++arg], &ingestions);
+    } else if (has_value && strcmp(argv[arg], "--tx_fifos") == 0) {
+      ok = ParseNumbers(argv[++arg], &tx_fifos);
+    } else if (has_value && strcmp(argv[arg], "--bit_error_rates") == 0) {
+      ok = ParseNumbers(argv[++arg], &bit_error_rates);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (output_path == nullptr || seconds <= 0) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  for (double payload : payloads) {
+    if (payload < kMinPayloadLength || payload > kP2PMaxContentLength) {
+      fprintf(stderr, "Payloads must have between %zu and %d bytes.\n", kMinPayloadLength, kP2PMaxContentLength);
+      return 1;
+    }
+  }
+  for (double baud : bauds) {
+    if (baud <= 0) {
+      fprintf(stderr, "Line rates must be positive.\n");
+      return 1;
+    }
+  }
+  for (double tx_fifo : tx_fifos) {
+    if (tx_fifo < 1) {
+      fprintf(stderr, "Transmitter FIFOs must hold at least a byte.\n");
+      return 1;
+    }
+  }
+  FILE *output = fopen(output_path, "w");
+  if (output == nullptr) {
+    perror(output_path);
+    return 1;
+  }
+
+  std::vector<BenchConfig> configs;
+  for (double payload : payloads) for (double baud : bauds) for (double burst : bursts)
+  for (double ingestion : ingestions) for (double tx_fifo : tx_fifos) for (double bit_error_rate : bit_error_rates) {
+    configs.push_back(BenchConfig{ .payload_length = static_cast<int>(payload), .baud_rate = static_cast<uint32_t>(baud),
+                                   .burst_max_length = static_cast<int>(burst), .burst_ingestion_ns_per_byte = static_cast<int>(ingestion),
+                                   .transmitter_fifo_size = static_cast<int>(tx_fifo),
+                                   .bit_error_rate = bit_error_rate, .seed = seed, .duration_ns = static_cast<uint64_t>(seconds * 1e9) });
+  }
+
+  fprintf(output, "payload_length,baud_rate,burst_max_length,burst_ingestion_ns_per_byte,transmitter_fifo_size,bit_error_rate,seed,metric,priority,count,mean,p50,p99,max\n");
+  for (size_t i = 0; i < configs.size(); ++i) {
+    MeasureGoodput(configs[i], /*guarantee_delivery=*/false, output);
+    MeasureGoodput(configs[i], /*guarantee_delivery=*/true, output);
+    MeasureLatencies(configs[i], output);
+    MeasurePreemptionLatency(configs[i], output);
+    MeasureRoundTrip(configs[i], output);
+    fflush(output);
+    fprintf(stderr, "\r%zu/%zu configurations", i + 1, configs.size());
+  }
+  fprintf(stderr, "\n");
+  fclose(output);
+  printf("Results written to %s.\n", output_path);
+  return 0;
+}
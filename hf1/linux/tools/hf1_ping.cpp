@@ -0,0 +1,234 @@
+// Measures the round trip time of the P2P link to the Arduino with floods of ping requests,
+// at each priority, with and without guaranteed delivery.
+//
+// Usage: hf1_ping [--count <n>] [--interval_us <us>] [--payload <bytes>]
+//                 [--priorities <values>] [--guarantee <values>] [--timeout_ms <ms>]
+//   --count        Pings per configuration (100 by default).
+//   --interval_us  Time between pings (10000 by default). With 0, pings are sent as fast as
+//                  the output stream has room for them.
+//   --payload      Payload bytes per ping, up to kP2PMaxPingPayloadLength (16 by default).
+//   --priorities   Comma-separated among high, medium and low (all of them by default).
+//   --guarantee    Comma-separated among on and off (both by default). Applies to both the
+//                  requests and the replies.
+//   --timeout_ms   Time to wait for the replies after the last ping (1000 by default).
+//                  Pings not replied by then count as lost.
+//
+// Prints, per configuration, the loss, the round trip time percentiles and histogram, and
+// the time the Arduino took to process the requests, without the time the replies waited
+// in its output queue.
+
+#include "uart.h"
+#include "p2p_byte_stream_linux.h"
+#include "p2p_packet_stream_linux.h"
+#include "p2p_action_client.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include "ping_client.h"
+#include "async_logger.h"
+#include "log_histogram.h"
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// From 64 us to 2 s.
+typedef LogHistogram<16, 16> RoundTripHistogram;
+#define kMaxHistogramBarLength 50
+
+typedef struct {
+  P2PPriority priority;
+  bool guarantee_delivery;
+} PingConfig;
+
+static const char *PriorityName(P2PPriority priority) {
+  switch (priority) {
+    case P2PPriority::kHigh:
+      return "high";
+    case P2PPriority::kMedium:
+      return "medium";
+    default:
+      return "low";
+  }
+}
+
+static std::vector<std::string> SplitList(const char *list) {
+  std::vector<std::string> values;
+  const char *start = list;
+  for (const char *c = list; ; ++c) {
+    if (*c == ',' || *c == '\0') {
+      values.emplace_back(start, c - start);
+      if (*c == '\0') {
+        return values;
+      }
+      start = c + 1;
+    }
+  }
+}
+
+static bool ParsePriorities(const char *list, std::vector<P2PPriority> *priorities) {
+  for (const std::string &value : SplitList(list)) {
+    if (value == "high") {
+      priorities->push_back(P2PPriority::kHigh);
+    } else if (value == "medium") {
+      priorities->push_back(P2PPriority::kMedium);
+    } else if (value == "low") {
+      priorities->push_back(P2PPriority::kLow);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool ParseGuarantees(const char *list, std::vector<bool> *guarantees) {
+  for (const std::string &value : SplitList(list)) {
+    if (value == "on") {
+      guarantees->push_back(true);
+    } else if (value == "off") {
+      guarantees->push_back(false);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void PrintResults(const PingConfig &config, int num_sent, std::vector<PingClient::Result> results) {
+  const int num_received = results.size();
+  printf("priority=%s guarantee=%s sent=%d received=%d loss=%.1f%%\n",
+    PriorityName(config.priority), config.guarantee_delivery ? "on" : "off", num_sent, num_received,
+    num_sent > 0 ? 100.0 * (num_sent - num_received) / num_sent : 0.0);
+  if (results.empty()) {
+    return;
+  }
+
+  std::sort(results.begin(), results.end(), [](const PingClient::Result &a, const PingClient::Result &b) { return a.round_trip_ns < b.round_trip_ns; });
+  const auto round_trip_us = [&](int percent) { return results[(results.size() - 1) * percent / 100].round_trip_ns * 1e-3; };
+  printf("  round_trip_us   p50=%.0f p90=%.0f p99=%.0f max=%.0f\n", round_trip_us(50), round_trip_us(90), round_trip_us(99), round_trip_us(100));
+
+  uint64_t total_processing_ns = 0, max_processing_ns = 0;
+  RoundTripHistogram histogram;
+  for (const PingClient::Result &result : results) {
+    total_processing_ns += result.server_processing_ns;
+    max_processing_ns = std::max(max_processing_ns, result.server_processing_ns);
+    histogram.Add(result.round_trip_ns);
+  }
+  printf("  processing_us   mean=%.1f max=%.1f\n", total_processing_ns * 1e-3 / results.size(), max_processing_ns * 1e-3);
+
+  uint32_t max_count = 0;
+  for (int i = 0; i < histogram.num_buckets(); ++i) {
+    max_count = std::max(max_count, histogram.count(i));
+  }
+  for (int i = 0; i < histogram.num_buckets(); ++i) {
+    if (histogram.count(i) == 0) {
+      continue;
+    }
+    const int bar_length = (histogram.count(i) * kMaxHistogramBarLength + max_count - 1) / max_count;
+    const std::string upper_bound = i == histogram.num_buckets() - 1 ? "inf" : std::to_string(RoundTripHistogram::BucketUpperBound(i) / 1000);
+    printf("  [%7llu, %7s) us %6u %s\n", static_cast<unsigned long long>(RoundTripHistogram::BucketLowerBound(i) / 1000), upper_bound.c_str(), histogram.count(i), std::string(bar_length, '#').c_str());
+  }
+}
+
+int main(int argc, char **argv) {
+  int count = 100;
+  uint64_t interval_ns = 10'000'000;
+  int payload_length = 16;
+  uint64_t timeout_ns = 1'000'000'000;
+  std::vector<P2PPriority> priorities;
+  std::vector<bool> guarantees;
+  bool ok = true;
+  for (int i = 1; i < argc && ok; ++i) {
+    if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = atoi(argv[++i]);
+      ok = count > 0;
+    } else if (strcmp(argv[i], "--interval_us") == 0 && i + 1 < argc) {
+      interval_ns = strtoull(argv[++i], nullptr, 10) * 1000;
+    } else if (strcmp(argv[i], "--payload") == 0 && i + 1 < argc) {
+      payload_length = atoi(argv[++i]);
+      ok = payload_length >= 0 && payload_length <= kP2PMaxPingPayloadLength;
+    } else if (strcmp(argv[i], "--priorities") == 0 && i + 1 < argc) {
+      ok = ParsePriorities(argv[++i], &priorities);
+    } else if (strcmp(argv[i], "--guarantee") == 0 && i + 1 < argc) {
+      ok = ParseGuarantees(argv[++i], &guarantees);
+    } else if (strcmp(argv[i], "--timeout_ms") == 0 && i + 1 < argc) {
+      timeout_ns = strtoull(argv[++i], nullptr, 10) * 1'000'000;
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok) {
+    fprintf(stderr, "Usage: %s [--count <n>] [--interval_us <us>] [--payload <bytes>] [--priorities <values>] [--guarantee <values>] [--timeout_ms <ms>]\n", argv[0]);
+    return 1;
+  }
+  if (priorities.empty()) {
+    priorities = { P2PPriority::kHigh, P2PPriority::kMedium, P2PPriority::kLow };
+  }
+  if (guarantees.empty()) {
+    guarantees = { false, true };
+  }
+
+  // Logs go to stderr, not to interleave with the results.
+  AsyncLogger logger(stderr);
+  SetLogger(&logger);
+
+  Uart uart;
+  P2PByteStreamLinux byte_stream(uart.fd());
+  TimerLinux timer;
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux p2p_stream(&byte_stream, &timer, guid_factory);
+  std::mutex p2p_mutex;
+  P2PActionClient action_client(&p2p_stream, &timer);
+  PingClient ping_client(&p2p_stream, &p2p_mutex, &timer);
+  action_client.Register(&ping_client);
+
+  const auto run_link = [&]() {
+    {
+      std::lock_guard<std::mutex> guard(p2p_mutex);
+      p2p_stream.input().Run();
+      p2p_stream.output().Run();
+      action_client.Run();
+    }
+    uart.CanReadOrWrite(/*timeout_ms=*/1);
+  };
+
+  for (const P2PPriority priority : priorities) {
+    for (bool guarantee_delivery : guarantees) {
+      const PingConfig config = { priority, guarantee_delivery };
+      // Replies to the pings of the previous configuration that arrive late are left out.
+      const uint64_t start_ns = timer.GetLocalNanoseconds();
+      std::vector<PingClient::Result> results;
+      int num_sent = 0;
+      uint64_t next_ping_ns = start_ns;
+      uint64_t last_ping_ns = start_ns;
+      while (num_sent < count || (static_cast<int>(results.size()) < num_sent && timer.GetLocalNanoseconds() - last_ping_ns < timeout_ns)) {
+        const uint64_t now_ns = timer.GetLocalNanoseconds();
+        if (num_sent < count && now_ns >= next_ping_ns) {
+          // If the output stream is full, retry in the next iteration.
+          if (ping_client.Ping(payload_length, priority, guarantee_delivery) == kSuccess) {
+            ++num_sent;
+            last_ping_ns = now_ns;
+            next_ping_ns += interval_ns;
+          }
+        }
+        run_link();
+        std::vector<PingClient::Result> new_results;
+        ping_client.TakeResults(&new_results);
+        for (const PingClient::Result &result : new_results) {
+          if (result.send_ns >= start_ns) {
+            results.push_back(result);
+          }
+        }
+      }
+      PrintResults(config, num_sent, results);
+    }
+  }
+
+  if (ping_client.num_malformed_replies() > 0) {
+    fprintf(stderr, "%d replies had a different payload than their ping.\n", ping_client.num_malformed_replies());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,148 @@
+// Dumps the profiler sections of the Arduino and, optionally, the timing stats of its
+// periodic runnables and the occupancy of its buffers.
+//
+// Usage: hf1_profile [--reset] [--runnables] [--buffers] [--p2p_trace <file>]
+//   --reset      Clears the stats in the Arduino after dumping them, so that the next run
+//                covers only the time in between.
+//   --runnables  Also dumps the period error and run time of the controllers and estimators.
+//   --buffers    Also dumps the high-water mark, mean occupancy and overwrites of the P2P
+//                packet buffers and the estimator's event buffer.
+//   --p2p_trace  Records the lifetime of every packet of the link to a trace file, which
+//                p2p_trace_to_json converts for chrome://tracing.
+
+#include "uart.h"
+#include "p2p_byte_stream_linux.h"
+#include "p2p_packet_stream_linux.h"
+#include "p2p_action_client.h"
+#include "guid_factory.h"
+#include "timer_linux.h"
+#include "profiler_client.h"
+#include "periodic_runnable_stats_client.h"
+#include "ring_buffer_stats_client.h"
+#include "async_logger.h"
+#include "p2p_packet_trace_recorder.h"
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <unistd.h>
+
+// Time to wait for the Arduino to answer all requests.
+#define kTimeoutNs 5'000'000'000ULL
+
+int main(int argc, char **argv) {
+  bool reset = false;
+  bool dump_runnables = false;
+  bool dump_buffers = false;
+  const char *p2p_trace_path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--reset") == 0) {
+      reset = true;
+    } else if (strcmp(argv[i], "--runnables") == 0) {
+      dump_runnables = true;
+    } else if (strcmp(argv[i], "--buffers") == 0) {
+      dump_buffers = true;
+    } else if (strcmp(argv[i], "--p2p_trace") == 0 && i + 1 < argc) {
+      p2p_trace_path = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--reset] [--runnables] [--buffers] [--p2p_trace <file>]" << std::endl;
+      return 1;
+    }
+  }
+
+  // Logs go to stderr, not to interleave with the tables.
+  AsyncLogger logger(stderr);
+  SetLogger(&logger);
+
+  Uart uart;
+  P2PByteStreamLinux byte_stream(uart.fd());
+  TimerLinux timer;
+  GUIDFactory guid_factory;
+  P2PPacketStreamLinux p2p_stream(&byte_stream, &timer, guid_factory);
+  FILE *p2p_trace_file = nullptr;
+  std::unique_ptr<P2PPacketTraceRecorder> p2p_trace_recorder;
+  if (p2p_trace_path != nullptr) {
+    p2p_trace_file = fopen(p2p_trace_path, "wb");
+    if (p2p_trace_file == nullptr) {
+      perror(p2p_trace_path);
+      return 1;
+    }
+    p2p_trace_recorder = std::make_unique<P2PPacketTraceRecorder>(p2p_trace_file);
+    p2p_stream.packet_tracer(p2p_trace_recorder->tracer());
+  }
+  std::mutex p2p_mutex;
+  P2PActionClient action_client(&p2p_stream, &timer);
+
+  ProfilerClient::GetProfilerSectionsActionClientHandler profiler_handler(P2PAction::kGetProfilerSections, P2PPriority::kLow, /*default_guarantee_delivery=*/true, &p2p_stream, &p2p_mutex);
+  action_client.Register(&profiler_handler);
+  ProfilerClient profiler_client(&profiler_handler, &timer);
+
+  PeriodicRunnableStatsClient::GetPeriodicRunnableStatsActionClientHandler stats_handler(P2PAction::kGetPeriodicRunnableStats, P2PPriority::kLow, /*default_guarantee_delivery=*/true, &p2p_stream, &p2p_mutex);
+  action_client.Register(&stats_handler);
+  PeriodicRunnableStatsClient stats_client(&stats_handler, &timer);
+
+  RingBufferStatsClient::GetRingBufferStatsActionClientHandler buffer_stats_handler(P2PAction::kGetRingBufferStats, P2PPriority::kLow, /*default_guarantee_delivery=*/true, &p2p_stream, &p2p_mutex);
+  action_client.Register(&buffer_stats_handler);
+  RingBufferStatsClient buffer_stats_client(&buffer_stats_handler, &timer);
+
+  ASSERT(profiler_client.RequestSections(reset) == kSuccess);
+  if (dump_runnables) {
+    ASSERT(stats_client.RequestSnapshot(reset) == kSuccess);
+  }
+  if (dump_buffers) {
+    ASSERT(buffer_stats_client.RequestSnapshot(reset) == kSuccess);
+  }
+
+  const uint64_t start_ns = timer.GetLocalNanoseconds();
+  while (profiler_client.request_in_progress() || stats_client.snapshot_in_progress() || buffer_stats_client.snapshot_in_progress()) {
+    if (timer.GetLocalNanoseconds() - start_ns > kTimeoutNs) {
+      std::cerr << "Timed out waiting for the Arduino." << std::endl;
+      return 1;
+    }
+    {
+      std::lock_guard<std::mutex> guard(p2p_mutex);
+      p2p_stream.input().Run();
+      p2p_stream.output().Run();
+      action_client.Run();
+    }
+    profiler_client.Run();
+    stats_client.Run();
+    buffer_stats_client.Run();
+    uart.CanReadOrWrite(/*timeout_ms=*/1);
+  }
+
+  if (p2p_trace_recorder != nullptr) {
+    {
+      std::lock_guard<std::mutex> guard(p2p_mutex);
+      p2p_stream.packet_tracer(P2PPacketTracer());
+    }
+    p2p_trace_recorder.reset();
+    fclose(p2p_trace_file);
+  }
+
+  if (profiler_client.last_request_status() != kSuccess) {
+    std::cerr << "Cannot get the profiler sections: status " << profiler_client.last_request_status() << std::endl;
+    return 1;
+  }
+  std::cout << ProfilerClient::Format(profiler_client.sections());
+
+  if (dump_runnables) {
+    if (stats_client.last_snapshot_status() != kSuccess) {
+      std::cerr << "Cannot get the periodic runnable stats: status " << stats_client.last_snapshot_status() << std::endl;
+      return 1;
+    }
+    std::cout << std::endl;
+    for (const auto &stats : stats_client.snapshot()) {
+      std::cout << PeriodicRunnableStatsClient::Format(stats) << std::endl;
+    }
+  }
+
+  if (dump_buffers) {
+    if (buffer_stats_client.last_snapshot_status() != kSuccess) {
+      std::cerr << "Cannot get the buffer stats: status " << buffer_stats_client.last_snapshot_status() << std::endl;
+      return 1;
+    }
+    std::cout << std::endl << RingBufferStatsClient::Format(buffer_stats_client.snapshot());
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+// Converts a P2P packet trace written by P2PPacketTraceRecorder to the Chrome trace event
+// JSON format, to be opened in chrome://tracing or Perfetto.
+//
+// Usage: p2p_trace_to_json <trace file> <JSON file>
+//
+// Every packet is an async span, from its commit to its ACK (or its last byte, if it does
+// not require one) in the output, and from its reception to its consumption in the input,
+// with the events in between as instants. Spans are grouped by direction and priority, and
+// their end events carry the span's latency, so that the tail latencies stand out.
+
+#include "p2p_packet_trace_recorder.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <map>
+#include <tuple>
+
+static bool IsOutputEvent(int event) {
+  return event < kP2PPacketReceived;
+}
+
+static bool IsSpanBegin(const P2PPacketTraceRecord &record) {
+  return record.event == kP2PPacketCommitted || record.event == kP2PPacketReceived;
+}
+
+static bool IsSpanEnd(const P2PPacketTraceRecord &record) {
+  if (record.event == kP2PPacketLastByteSent) {
+    return !(record.flags & kP2PPacketTraceRequiresAck);
+  }
+  return record.event == kP2PPacketAckReceived || record.event == kP2PPacketConsumed;
+}
+
+static void PrintSpanName(FILE *output, const P2PPacketTraceRecord &record) {
+  fprintf(output, "\"%s%s%" PRIu32 "\"", (record.flags & kP2PPacketTraceIsInit) ? "init " : "",
+          (record.flags & kP2PPacketTraceIsAck) ? "ack " : "#", record.sequence_number);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <trace file> <JSON file>\n", argv[0]);
+    return 1;
+  }
+  FILE *input = fopen(argv[1], "rb");
+  if (input == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<P2PPacketTraceRecord> records;
+  const bool ok = ReadP2PPacketTrace(input, &records);
+  fclose(input);
+  if (!ok) {
+    fprintf(stderr, "%s is not a supported P2P packet trace.\n", argv[1]);
+    return 1;
+  }
+  FILE *output = fopen(argv[2], "w");
+  if (output == nullptr) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  // The direction is the process and the priority, the thread.
+  fprintf(output, "{\"traceEvents\":[\n");
+  fprintf(output, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"output\"}},\n");
+  fprintf(output, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":2,\"args\":{\"name\":\"input\"}}");
+
+  // Begin timestamp of the open spans, by direction, priority, flags and sequence number.
+  // ACKs reuse the sequence number of the packets they acknowledge, so the flags tell them
+  // apart.
+  std::map<std::tuple<bool, int, int, uint32_t>, uint64_t> span_begin_ns;
+  const uint64_t start_ns = records.empty() ? 0 : records.front().timestamp_ns;
+  int num_events = 0;
+  for (const P2PPacketTraceRecord &record : records) {
+    const bool is_output = IsOutputEvent(record.event);
+    const auto key = std::make_tuple(is_output, record.priority, record.flags, record.sequence_number);
+    const char *phase = "n";
+    uint64_t latency_ns = 0;
+    if (IsSpanBegin(record)) {
+      phase = "b";
+      span_begin_ns[key] = record.timestamp_ns;
+    } else if (IsSpanEnd(record)) {
+      const auto it = span_begin_ns.find(key);
+      if (it == span_begin_ns.end()) {
+        // The span began before the trace did.
+        continue;
+      }
+      phase = "e";
+      latency_ns = record.timestamp_ns - it->second;
+      span_begin_ns.erase(it);
+    }
+    fprintf(output, ",\n{\"ph\":\"%s\",\"cat\":\"p2p\",\"name\":", phase);
+    PrintSpanName(output, record);
+    fprintf(output, ",\"id\":\"%d-%d-%d-%" PRIu32 "\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"args\":{\"event\":\"%s\"",
+            is_output, record.priority, record.flags, record.sequence_number, is_output ? 1 : 2,
+            record.priority, (record.timestamp_ns - start_ns) * 1e-3, GetP2PPacketTraceEventName(record.event));
+    if (phase[0] == 'e') {
+      fprintf(output, ",\"latency_us\":%.3f", latency_ns * 1e-3);
+    }
+    fprintf(output, "}}");
+    ++num_events;
+  }
+  fprintf(output, "\n]}\n");
+  fclose(output);
+  printf("%d of %zu records converted.\n", num_events, records.size());
+  return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef VIRTUAL_TIMER_INCLUDED_
+#define VIRTUAL_TIMER_INCLUDED_
+
+#include "timer_interface.h"
+
+// Timer whose time only moves when told to, so that simulations run faster than real time
+// and are reproducible.
+class VirtualTimer : public TimerInterface {
+public:
+  VirtualTimer() : now_ns_(0) {}
+
+  uint64_t GetLocalNanoseconds() const override { return now_ns_; }
+
+  void Advance(uint64_t nanoseconds) { now_ns_ += nanoseconds; }
+
+private:
+  uint64_t now_ns_;
+};
+
+#endif  // VIRTUAL_TIMER_INCLUDED_